@@ -0,0 +1,100 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include "BasicTypes.h"
+
+namespace Diligent
+{
+
+// Counts heap allocations of the app and attributes them to the phases of every frame.
+//
+// When the app is built with DILIGENT_SAMPLES_TRACK_ALLOCATIONS CMake option, global operator new and delete
+// are replaced with versions that increment per-thread counters, so that the counting does not contend between
+// threads. The allocations of a phase are the difference between the counters of the thread that runs the phase
+// at its end and at its beginning. Allocations of other threads, such as background workers that run concurrently
+// with the frame, are not attributed to the phase. Allocations that bypass operator new, such as those made
+// with malloc by third-party libraries, are not counted.
+class AllocationTracker
+{
+public:
+    struct Counters
+    {
+        Uint64 NumAllocations   = 0;
+        Uint64 NumBytes         = 0;
+        Uint64 NumDeallocations = 0;
+    };
+
+    // Returns true if global operator new and delete are instrumented
+    static bool IsAvailable();
+
+    // Returns the counters of the calling thread since it started
+    static Counters GetThreadCounters();
+
+    enum PHASE : Uint32
+    {
+        PHASE_UPDATE = 0,
+        PHASE_RENDER,
+        PHASE_PRESENT,
+        PHASE_COUNT
+    };
+    static const char* GetPhaseName(PHASE Phase);
+
+    // Both must be called by the thread that runs the phase
+    void BeginPhase(PHASE Phase);
+    void EndPhase(PHASE Phase);
+
+    // Completes the frame. If Measure is true, the allocations of the frame are added to the statistics.
+    void EndFrame(bool Measure);
+
+    // Allocations of the phase in the last completed frame
+    const Counters& GetLastFrameCounters(PHASE Phase) const { return m_LastFrame[Phase]; }
+
+    struct Statistics
+    {
+        Uint32 NumFrames = 0;
+
+        // Number of frames that allocated memory in this phase
+        Uint32 NumAllocatingFrames = 0;
+
+        Uint64 TotalAllocations = 0;
+        Uint64 TotalBytes       = 0;
+        Uint64 MaxAllocations   = 0;
+        Uint64 MaxBytes         = 0;
+    };
+    // Statistics of the measured frames
+    const Statistics& GetStatistics(PHASE Phase) const { return m_Stats[Phase]; }
+
+private:
+    Counters   m_PhaseStart[PHASE_COUNT];
+    Counters   m_CurrFrame[PHASE_COUNT];
+    Counters   m_LastFrame[PHASE_COUNT];
+    Statistics m_Stats[PHASE_COUNT];
+};
+
+} // namespace Diligent
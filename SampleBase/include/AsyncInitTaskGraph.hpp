@@ -0,0 +1,128 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BasicTypes.h"
+
+namespace Diligent
+{
+
+// Graph of tasks that initialize a sample, e.g. decode textures, build meshes and create pipeline states,
+// while the app keeps presenting frames.
+//
+// Every task starts once all its dependencies are complete. The tasks are executed by a set of worker
+// threads and, while it waits for the graph, by the thread that calls Wait(). If a task throws an
+// exception, the tasks that have not started yet are skipped and Wait() rethrows the exception.
+class AsyncInitTaskGraph
+{
+public:
+    using TaskFunc = std::function<void()>;
+    using TaskId   = Uint32;
+
+    AsyncInitTaskGraph() = default;
+    ~AsyncInitTaskGraph();
+
+    // clang-format off
+    AsyncInitTaskGraph           (const AsyncInitTaskGraph&) = delete;
+    AsyncInitTaskGraph& operator=(const AsyncInitTaskGraph&) = delete;
+    // clang-format on
+
+    // Adds a task that runs after all tasks in Dependencies are complete and returns its ID.
+    // Weight is the relative duration of the task that is used to compute the progress.
+    // Tasks can only be added before the graph is started.
+    TaskId AddTask(std::string Name, TaskFunc Func, std::initializer_list<TaskId> Dependencies = {}, float Weight = 1);
+
+    // Starts NumThreads worker threads. If NumThreads is 0, all tasks are executed by Wait().
+    void Start(Uint32 NumThreads);
+
+    // Executes the remaining tasks on the calling thread along with the workers and returns when all tasks
+    // are complete. Rethrows the exception of the first task that has failed.
+    void Wait();
+
+    // Skips the tasks that have not started yet and joins the worker threads.
+    void Cancel();
+
+    bool IsComplete() const;
+
+    Uint32 GetNumTasks() const { return static_cast<Uint32>(m_Tasks.size()); }
+
+    struct Status
+    {
+        Uint32 NumCompletedTasks = 0;
+
+        // Completed fraction of the total weight of all tasks
+        float Progress = 0;
+
+        // Names of the running tasks, separated by commas
+        std::string RunningTasks;
+    };
+    Status GetStatus() const;
+
+private:
+    // Takes a ready task and executes it. Returns false if there are no ready tasks and WaitForTask is false,
+    // or if all tasks are complete.
+    bool ProcessTask(std::unique_lock<std::mutex>& Lock, bool WaitForTask);
+    void WorkerThreadFunc();
+    void JoinWorkers();
+
+    struct Task
+    {
+        std::string         Name;
+        TaskFunc            Func;
+        float               Weight         = 1;
+        Uint32              NumPendingDeps = 0;
+        bool                IsRunning      = false;
+        std::vector<TaskId> Dependents;
+    };
+    std::vector<Task>        m_Tasks;
+    std::vector<std::thread> m_Workers;
+
+    mutable std::mutex      m_Mtx;
+    std::condition_variable m_CV; // Signals that a task has become ready or that all tasks are complete
+
+    // Protected by m_Mtx
+    std::deque<TaskId> m_ReadyTasks;
+    Uint32             m_NumCompletedTasks = 0;
+    float              m_CompletedWeight   = 0;
+    float              m_TotalWeight       = 0;
+    bool               m_Started           = false;
+    bool               m_Cancelled         = false;
+    std::exception_ptr m_pException;
+};
+
+} // namespace Diligent
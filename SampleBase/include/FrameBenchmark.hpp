@@ -0,0 +1,128 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "BasicTypes.h"
+#include "Timer.hpp"
+
+namespace Diligent
+{
+
+// Collects the timings of the fixed-timestep benchmark mode of the sample app and writes their summary.
+//
+// The app drives every frame with the same simulated time step, so that runs on different machines
+// process the same sequence of frames. The first NumWarmupFrames frames are not measured to exclude
+// shader compilation and other one-time costs. The summary is written as JSON or, if the output file
+// name ends with .csv, as a list of metric,value pairs.
+class FrameBenchmark
+{
+public:
+    struct Settings
+    {
+        Uint32      NumFrames       = 0;
+        Uint32      NumWarmupFrames = 10;
+        double      TimeStep        = 1.0 / 60.0;
+        std::string OutputPath      = "benchmark.json";
+    };
+
+    enum PHASE : Uint32
+    {
+        PHASE_UPDATE = 0,
+        PHASE_RENDER,
+        PHASE_PRESENT,
+        PHASE_FRAME,
+        PHASE_GPU,
+        PHASE_COUNT
+    };
+
+    explicit FrameBenchmark(const Settings& BenchmarkSettings);
+
+    const Settings& GetSettings() const { return m_Settings; }
+
+    // Simulated time of the current frame
+    double GetFrameTime() const { return m_FrameIndex * m_Settings.TimeStep; }
+    Uint32 GetFrameIndex() const { return m_FrameIndex; }
+
+    bool IsWarmup() const { return m_FrameIndex < m_Settings.NumWarmupFrames; }
+    bool IsComplete() const { return m_FrameIndex >= m_Settings.NumWarmupFrames + m_Settings.NumFrames; }
+
+    void BeginFrame();
+    void EndFrame();
+
+    void BeginPhase(PHASE Phase);
+    void EndPhase(PHASE Phase);
+
+    // Records the time of the phase in seconds. Samples of the warm-up frames are ignored.
+    void AddSample(PHASE Phase, double Time);
+
+    // Adds a descriptive property of the run, such as the device type, to the summary
+    void SetProperty(const char* Name, std::string Value);
+
+    // Adds a value that is measured once per run, such as the startup time, to the summary
+    void SetMetric(const char* Name, double Value);
+
+    struct Statistics
+    {
+        Uint32 NumSamples = 0;
+        double Mean       = 0;
+        double Min        = 0;
+        double P50        = 0;
+        double P90        = 0;
+        double P95        = 0;
+        double P99        = 0;
+        double Max        = 0;
+    };
+    Statistics ComputeStatistics(PHASE Phase) const;
+
+    static const char* GetPhaseName(PHASE Phase);
+
+    std::string GetJSON() const;
+    std::string GetCSV() const;
+
+    // Writes the summary to the output file
+    bool WriteSummary() const;
+
+private:
+    const Settings m_Settings;
+
+    Timer  m_Timer;
+    Uint32 m_FrameIndex     = 0;
+    double m_FrameStartTime = 0;
+    double m_PhaseStartTime[PHASE_COUNT]{};
+
+    std::vector<double> m_Samples[PHASE_COUNT];
+
+    std::vector<std::pair<std::string, std::string>> m_Properties;
+    std::vector<std::pair<std::string, double>>      m_Metrics;
+};
+
+} // namespace Diligent
@@ -0,0 +1,127 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "BasicTypes.h"
+#include "ParallelFrameRecorder.hpp"
+
+namespace Diligent
+{
+
+// Compares a captured frame with its golden image on all CPU cores.
+//
+// The image is split into square tiles that the threads take from a shared counter, and every tile
+// is compared row by row with SIMD instructions directly in the mapped staging memory. The difference
+// of a pixel is the maximum absolute difference of its color channels; alpha is ignored. If early exit
+// is enabled, the threads stop taking new tiles as soon as the number of pixels whose difference exceeds
+// the threshold is over the budget, so the counts of a failed comparison may be incomplete.
+class GoldenImageComparer
+{
+public:
+    explicit GoldenImageComparer(Uint32 NumWorkers);
+
+    // clang-format off
+    GoldenImageComparer           (const GoldenImageComparer&) = delete;
+    GoldenImageComparer& operator=(const GoldenImageComparer&) = delete;
+    // clang-format on
+
+    struct CompareAttribs
+    {
+        Uint32 Width  = 0;
+        Uint32 Height = 0;
+
+        // Captured image with four 8-bit channels in RGBA or, if CapturedBGRA is true, BGRA order.
+        // If FlipY is true, the rows are stored bottom-up.
+        const Uint8* pCaptured      = nullptr;
+        size_t       CapturedStride = 0;
+        bool         CapturedBGRA   = false;
+        bool         FlipY          = false;
+
+        // Golden image with three (RGB) or four (RGBA) 8-bit channels
+        const Uint8* pGolden           = nullptr;
+        size_t       GoldenStride      = 0;
+        Uint32       GoldenNumChannels = 3;
+
+        // Pixels with a difference above the threshold are bad
+        Uint32 Threshold = 0;
+
+        // Number of bad pixels that the comparison tolerates
+        Uint32 MaxBadPixels = 0;
+
+        // Stop the comparison as soon as the number of bad pixels exceeds MaxBadPixels
+        bool EarlyExit = false;
+    };
+
+    struct Result
+    {
+        // Number of pixels that differ, including the bad ones
+        Uint32 NumDiffPixels = 0;
+        Uint32 NumBadPixels  = 0;
+        Uint32 MaxDiff       = 0;
+
+        // False if the comparison stopped early and some tiles were not compared
+        bool Complete = true;
+    };
+
+    Result Compare(const CompareAttribs& Attribs);
+
+    // Builds the RGBA8 heatmap of the last comparison with the same attributes. Pixels that match are shown as the
+    // dimmed golden image, differences within the threshold in blue and bad pixels from red to yellow by their
+    // difference. Tiles that were skipped because of early exit are tinted purple.
+    void ComputeHeatmap(const CompareAttribs& Attribs, std::vector<Uint8>& Heatmap);
+
+    static constexpr Uint32 TileSize = 128;
+
+private:
+    struct TileResult
+    {
+        Uint32 NumDiffPixels = 0;
+        Uint32 NumBadPixels  = 0;
+        Uint32 MaxDiff       = 0;
+        bool   Compared      = false;
+    };
+    void CompareTile(const CompareAttribs& Attribs, Uint32 Tile, Uint32 Subset, TileResult& Res, Uint8* pHeatmap);
+
+    const Uint8* GetGoldenRow(const CompareAttribs& Attribs, Uint32 Row, Uint32 X0, Uint32 NumPixels, Uint32 Subset);
+
+    ParallelTaskPool m_Workers;
+
+    // Golden image row converted to the channel order of the captured image, one buffer per subset
+    std::vector<std::vector<Uint8>> m_GoldenRows;
+    // Pixel differences of a tile row, one buffer per subset
+    std::vector<std::vector<Uint8>> m_DiffRows;
+
+    std::vector<TileResult> m_Tiles;
+    std::atomic<Uint32>     m_NumBadPixels{0};
+    std::atomic<bool>       m_Abort{false};
+};
+
+} // namespace Diligent
@@ -0,0 +1,113 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "BasicTypes.h"
+#include "Timer.hpp"
+
+namespace Diligent
+{
+
+class SampleBase;
+
+// Collects the results of the golden image suite that processes all samples built into the golden image
+// runner with a single engine instance, and writes them as a JUnit XML or a JSON report.
+class GoldenImageSuite
+{
+public:
+    struct SampleInfo
+    {
+        // Sample name, e.g. "Tutorial01_HelloTriangle"
+        const char* Name = nullptr;
+
+        // Folder of the sample relative to the repository root, e.g. "Tutorials"
+        const char* Folder = nullptr;
+
+        // Directory the sample loads its assets from
+        const char* AssetsDir = nullptr;
+
+        // Sample-specific command line arguments, e.g. "--show_ui 0"
+        const char* Args = "";
+
+        SampleBase* (*Create)() = nullptr;
+    };
+
+    // Registers a sample built into the golden image runner.
+    // All samples must be registered before the application is created.
+    static void RegisterSample(const SampleInfo& Info);
+
+    // Returns the registered samples. The list is empty in all regular sample applications.
+    static const std::vector<SampleInfo>& GetRegisteredSamples();
+
+    enum class STATUS
+    {
+        Passed,
+        Failed,
+        Skipped
+    };
+
+    struct TestResult
+    {
+        std::string Name;
+        STATUS      Status    = STATUS::Passed;
+        int         ErrorCode = 0;
+        std::string Message;
+
+        // Time from the start of the test to its end, in seconds
+        double Time = 0;
+    };
+
+    // SuiteName identifies the configuration, e.g. "GoldenImages.vk"
+    explicit GoldenImageSuite(std::string SuiteName);
+
+    void BeginTest(std::string Name);
+    void EndTest(STATUS Status, int ErrorCode = 0, std::string Message = {});
+
+    const std::vector<TestResult>& GetResults() const { return m_Results; }
+    Uint32                         GetNumResults(STATUS Status) const;
+
+    std::string GetJUnitXML() const;
+    std::string GetJSON() const;
+
+    // Writes the report to the file. The report is written in JSON format if
+    // the file name ends with .json, and in JUnit XML format otherwise.
+    bool WriteReport(const std::string& Path) const;
+
+private:
+    const std::string m_SuiteName;
+
+    Timer  m_Timer;
+    double m_TestStartTime = 0;
+
+    std::vector<TestResult> m_Results;
+};
+
+} // namespace Diligent
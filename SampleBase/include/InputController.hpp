@@ -87,6 +87,13 @@ enum INPUT_KEY_STATE_FLAGS : Uint8
 };
 DEFINE_FLAG_ENUM_OPERATORS(INPUT_KEY_STATE_FLAGS)
 
+// Complete state of the input controller that is recorded and replayed by the sample app
+struct InputState
+{
+    MouseState            Mouse;
+    INPUT_KEY_STATE_FLAGS Keys[static_cast<size_t>(InputKeys::TotalKeys)] = {};
+};
+
 class InputControllerBase
 {
 public:
@@ -119,6 +126,23 @@ public:
         }
     }
 
+    InputState GetState() const
+    {
+        InputState State;
+        State.Mouse = m_MouseState;
+        for (size_t i = 0; i < static_cast<size_t>(InputKeys::TotalKeys); ++i)
+            State.Keys[i] = m_Keys[i];
+        return State;
+    }
+
+    // Overrides the state received from the platform, e.g. when the input is replayed
+    void SetState(const InputState& State)
+    {
+        m_MouseState = State.Mouse;
+        for (size_t i = 0; i < static_cast<size_t>(InputKeys::TotalKeys); ++i)
+            m_Keys[i] = State.Keys[i];
+    }
+
 protected:
     MouseState            m_MouseState;
     INPUT_KEY_STATE_FLAGS m_Keys[static_cast<size_t>(InputKeys::TotalKeys)] = {};
@@ -183,6 +207,10 @@ protected:
 
             void ClearState(){}
 
+            InputState GetState()const{return InputState{};}
+
+            void SetState(const InputState& State){}
+
         private:
             MouseState m_MouseState;
         };
@@ -0,0 +1,79 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "BasicTypes.h"
+#include "InputController.hpp"
+
+namespace Diligent
+{
+
+// Per-frame input controller state that the sample app records and replays with a fixed time step,
+// so that every run of a sample follows the same camera path and processes the same sequence of frames.
+//
+// A record is only stored for the frames where the state differs from the previous frame. The file
+// starts with a header (magic, version, number of keys, number of frames and time step) followed by
+// the records, each containing the frame index, mouse position, wheel delta, button flags and key states.
+class InputRecording
+{
+public:
+    InputRecording() = default;
+
+    explicit InputRecording(double TimeStep) :
+        m_TimeStep{TimeStep}
+    {}
+
+    // Adds the state of the frame. Frames must be added in increasing order.
+    void AddFrame(Uint32 Frame, const InputState& State);
+
+    // Returns the state of the frame, or false if the frame is past the end of the recording
+    bool GetFrame(Uint32 Frame, InputState& State) const;
+
+    bool Save(const char* Path) const;
+    bool Load(const char* Path);
+
+    // Simulated time step, in seconds, that the recording must be replayed with
+    double GetTimeStep() const { return m_TimeStep; }
+    Uint32 GetNumFrames() const { return m_NumFrames; }
+    size_t GetNumRecords() const { return m_Records.size(); }
+
+private:
+    struct Record
+    {
+        Uint32     Frame = 0;
+        InputState State;
+    };
+
+    double              m_TimeStep  = 0;
+    Uint32              m_NumFrames = 0;
+    std::vector<Record> m_Records;
+};
+
+} // namespace Diligent
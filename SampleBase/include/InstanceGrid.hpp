@@ -0,0 +1,75 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "BasicTypes.h"
+
+namespace Diligent
+{
+
+// Randomly scaled, rotated and displaced objects that are placed in the cells of a GridSize^3 grid
+// spanning the [-1, +1] cube. Used by the Tutorial04 and Tutorial16 samples.
+struct InstanceGridAttribs
+{
+    Uint32 GridSize = 1;
+
+    // Objects are scaled by BaseScale / GridSize times a random factor in [MinScale, MaxScale)
+    float BaseScale = 0.6f;
+    float MinScale  = 0.3f;
+    float MaxScale  = 1.0f;
+
+    // Maximum random offset of an object from the cell center, in cell units
+    float MaxOffset = 0.15f;
+
+    Uint32 Seed = 0;
+};
+
+// Random streams 0 .. InstanceGridNumStreams - 1 are used by GenerateInstanceGrid().
+// Samples may use the following streams to derive other per-cell values with GetInstanceGridRandom().
+static constexpr Uint32 InstanceGridNumStreams = 7;
+
+// Returns a random value in [0, 1) that only depends on the seed, the cell index and the stream.
+float GetInstanceGridRandom(Uint32 Seed, Uint32 Cell, Uint32 Stream);
+
+// Returns the name of the instruction set used by GenerateInstanceGrid().
+const char* GetInstanceGridISA();
+
+// Writes world matrices of cells [FirstCell, EndCell) to pDst, where the index of cell (x, y, z) is
+// (x * GridSize + y) * GridSize + z. The matrix of cell i is written at byte offset (i - FirstCell) * Stride,
+// or at pCellSlots[i] * Stride if the cells are reordered in the buffer with the pCellSlots table.
+// Each matrix is RotationX * RotationY * RotationZ * Scale * Translation, stored as float4x4.
+//
+// Every cell is generated from its own random values only, so different threads may generate
+// non-overlapping ranges concurrently and the result does not depend on how the cells are split.
+// If pDst and Stride are 16-byte aligned, the matrices are written with non-temporal stores that
+// bypass the cache, which suits write-combined GPU upload memory.
+void GenerateInstanceGrid(const InstanceGridAttribs& Attribs, Uint32 FirstCell, Uint32 EndCell, void* pDst, size_t Stride, const Uint32* pCellSlots = nullptr);
+
+} // namespace Diligent
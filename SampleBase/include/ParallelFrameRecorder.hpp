@@ -0,0 +1,182 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "DeviceContext.h"
+#include "CommandList.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+// Persistent pool of worker threads that process and record the frame in parallel.
+//
+// The frame is split into 1 + NumWorkers subsets. Subset 0 is processed by the thread that submits
+// the job, subset 1 + i by worker i that records its commands into the i-th deferred context.
+// Idle workers sleep on a condition variable, and the submitting thread blocks on another one while
+// it waits for the workers, so no thread ever spins.
+//
+// Workers do not wait for their command lists to be submitted: a deferred context finishes the frame
+// right before it starts recording the next one. The next frame may thus be dispatched as soon as
+// ExecuteCommandLists() returns, while the GPU is still executing the previous one.
+//
+// A job may also distribute a range of items between the subsets with SetWorkItems() and NextChunk().
+// With a non-zero chunk size, the subsets take chunks of items from a shared atomic counter until
+// none remain, so a thread that has been descheduled or got heavier items does not stall the frame.
+class ParallelFrameRecorder
+{
+public:
+    // Processes subset Subset of the frame.
+    using JobFunc = std::function<void(Uint32 Subset)>;
+
+    // Records subset Subset of the frame into pCtx.
+    using RecordFunc = std::function<void(IDeviceContext* pCtx, Uint32 Subset)>;
+
+    ParallelFrameRecorder() = default;
+    ~ParallelFrameRecorder();
+
+    // clang-format off
+    ParallelFrameRecorder           (const ParallelFrameRecorder&) = delete;
+    ParallelFrameRecorder& operator=(const ParallelFrameRecorder&) = delete;
+    // clang-format on
+
+    // Starts NumWorkers threads. Worker i records its subset into DeferredContexts[i].
+    void Start(const std::vector<RefCntAutoPtr<IDeviceContext>>& DeferredContexts, Uint32 NumWorkers);
+
+    // Starts NumWorkers threads without deferred contexts that may only run ParallelFor() jobs.
+    void Start(Uint32 NumWorkers);
+
+    // Waits for the current job and joins all worker threads.
+    void Stop();
+
+    Uint32 GetNumWorkers() const { return static_cast<Uint32>(m_Workers.size()); }
+    Uint32 GetNumSubsets() const { return 1 + GetNumWorkers(); }
+
+    // Runs Job for all subsets and returns when every subset has been processed.
+    void ParallelFor(const JobFunc& Job);
+
+    // Starts recording subsets 1 .. NumWorkers on the worker threads and returns immediately.
+    // Record is not copied and must stay alive until ExecuteCommandLists() returns.
+    void BeginRecording(const RecordFunc& Record);
+
+    // Waits until the workers finish recording, executes their command lists
+    // on the immediate context in the subset order and releases them.
+    void ExecuteCommandLists(IDeviceContext* pImmediateCtx);
+
+    // Records subset 0 into pImmediateCtx on the calling thread while the workers record
+    // the remaining subsets, then executes the workers' command lists.
+    void RecordFrame(IDeviceContext* pImmediateCtx, const RecordFunc& Record);
+
+    // Sets the range of items [0, NumItems) that the subsets of the next job process with NextChunk().
+    // If ChunkSize is 0, every subset gets one contiguous slice of the range.
+    // Must not be called while a job is running.
+    void SetWorkItems(Uint32 NumItems, Uint32 ChunkSize);
+
+    // Returns the next range of items [Start, End) for the subset, or false if there are none left.
+    bool NextChunk(Uint32 Subset, Uint32& Start, Uint32& End);
+
+    struct SubsetStatistics
+    {
+        // Time the subset spent in the last job, in seconds
+        double JobTime = 0;
+
+        // Number of items and chunks the subset took with NextChunk()
+        Uint32 NumItems  = 0;
+        Uint32 NumChunks = 0;
+    };
+    // Statistics of the last job. The time of subset 0 is only measured by ParallelFor() and RecordFrame().
+    const SubsetStatistics& GetSubsetStatistics(Uint32 Subset) const { return m_SubsetStats[Subset].Stats; }
+
+private:
+    enum class JobType
+    {
+        Process,
+        Record
+    };
+    void StartWorkers(const RefCntAutoPtr<IDeviceContext>* pDeferredContexts, Uint32 NumWorkers);
+    void Dispatch(JobType Type);
+    void Wait();
+    void WorkerThreadFunc(Uint32 WorkerId, Uint64 FirstJobId);
+
+    struct Worker
+    {
+        std::thread                   Thread;
+        RefCntAutoPtr<IDeviceContext> pCtx;
+        RefCntAutoPtr<ICommandList>   pCmdList;
+
+        // Set when the context has recorded a command list, but has not finished the frame yet
+        bool FinishFramePending = false;
+    };
+    std::vector<Worker> m_Workers;
+
+    std::mutex              m_Mtx;
+    std::condition_variable m_JobCV;  // Signals the workers that a new job is available
+    std::condition_variable m_DoneCV; // Signals the submitting thread that all workers are done
+
+    // Protected by m_Mtx
+    Uint64  m_JobId             = 0;
+    Uint32  m_NumPendingWorkers = 0;
+    bool    m_Stop              = false;
+    JobType m_JobType           = JobType::Process;
+
+    // Only modified while the workers are idle
+    const JobFunc*    m_pJob                = nullptr;
+    const RecordFunc* m_pRecord             = nullptr;
+    bool              m_RecordingInProgress = false;
+
+    std::vector<ICommandList*> m_CmdListPtrs;
+
+    // Item counter shared by all subsets, on its own cache line to avoid false sharing
+    alignas(64) std::atomic<Uint32> m_NextItem{0};
+
+    Uint32 m_NumItems  = 0;
+    Uint32 m_ChunkSize = 0;
+
+    // Every subset only writes its own entry
+    struct alignas(64) SubsetState
+    {
+        SubsetStatistics Stats;
+
+        // Set when the subset has taken its slice of the items in static mode
+        bool SliceTaken = false;
+    };
+    std::vector<SubsetState> m_SubsetStats = std::vector<SubsetState>(1);
+};
+
+// Worker pool for jobs that do not record commands, e.g. generating data on the CPU with ParallelFor().
+// The pool is started with Start(NumWorkers) and never creates or uses deferred contexts.
+using ParallelTaskPool = ParallelFrameRecorder;
+
+} // namespace Diligent
@@ -30,6 +30,7 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <functional>
 
 #include "NativeAppBase.hpp"
 #include "RefCntAutoPtr.hpp"
@@ -40,11 +41,21 @@
 #include "SampleBase.hpp"
 #include "ScreenCapture.hpp"
 #include "Image.h"
+#include "FrameBenchmark.hpp"
+#include "GoldenImageSuite.hpp"
+#include "VideoCapture.hpp"
+#include "RenderStateCache.h"
+#include "Timer.hpp"
 
 namespace Diligent
 {
 
 class ImGuiImplDiligent;
+class DurationQueryHelper;
+class AsyncInitTaskGraph;
+class AllocationTracker;
+class InputRecording;
+class GoldenImageComparer;
 
 class SampleApp : public NativeAppBase
 {
@@ -68,7 +79,12 @@ public:
 
     virtual GoldenImageMode GetGoldenImageMode() const override final
     {
-        return m_GoldenImgMode;
+        // The native app loop exits after the frame is presented in golden image mode and returns
+        // GetExitCode(). The same path is used to quit when the app requests an exit, see RequestExit().
+        if (m_bExitRequested)
+            return m_GoldenImgMode != GoldenImageMode::None ? m_GoldenImgMode : GoldenImageMode::Capture;
+        // The golden image suite needs to process one frame per sample.
+        return m_pGoldenImgSuite ? GoldenImageMode::None : m_GoldenImgMode;
     }
 
     virtual int GetExitCode() const override final
@@ -89,7 +105,10 @@ public:
 
 protected:
     void InitializeDiligentEngine(const NativeWindow* pWindow);
+    void ModifyEngineInitInfo(const SampleBase::ModifyEngineInitInfoAttribs& Attribs);
     void InitializeSample();
+    void FinishSampleInitialization();
+    void UpdateProgressOverlay();
     void UpdateAdaptersDialog();
     void UpdateAppSettings(bool IsInitialization);
 
@@ -107,8 +126,33 @@ protected:
     }
 
     void CompareGoldenImage(const std::string& FileName, ScreenCapture::CaptureInfo& Capture);
+    void SaveGoldenImageHeatmap(const std::string& GoldenImgFileName, const std::vector<Uint8>& Heatmap, Uint32 Width, Uint32 Height) const;
     void SaveScreenCapture(const std::string& FileName, ScreenCapture::CaptureInfo& Capture);
 
+    void EndAllocationTrackingFrame();
+    void UpdateAllocationsWindow();
+
+    void LoadRenderStateCache();
+    void SaveRenderStateCache();
+
+    void RecordOrReplayInput();
+
+    void FinishVideoCapture();
+    void SaveInputRecording();
+
+    void EnableBenchmarkFeatures(EngineCreateInfo& EngineCI) const;
+    void FinishBenchmark();
+
+    // Stops the app after the current frame. The native app loop returns m_ExitCode,
+    // and the app is destroyed normally.
+    void RequestExit();
+
+    // Creates and initializes the next sample of the golden image suite with InitializeTheSample.
+    // Samples that fail to initialize are recorded as failed and skipped. Returns false when no samples are left.
+    bool CreateNextSuiteSample(const std::function<void()>& InitializeTheSample);
+    void FinishSuiteSample();
+    void FinishGoldenImageSuite();
+
     RENDER_DEVICE_TYPE                         m_DeviceType = RENDER_DEVICE_TYPE_UNDEFINED;
     RefCntAutoPtr<IEngineFactory>              m_pEngineFactory;
     RefCntAutoPtr<IRenderDevice>               m_pDevice;
@@ -157,11 +201,70 @@ protected:
     } m_ScreenCaptureInfo;
     std::unique_ptr<ScreenCapture> m_pScreenCapture;
 
+    // Streaming capture of all frames into a single video file, enabled by the --capture_video command line option
+    VideoCapture::CreateInfo      m_VideoCaptureCI;
+    std::unique_ptr<VideoCapture> m_pVideoCapture;
+
     std::unique_ptr<ImGuiImplDiligent> m_pImGui;
 
     GoldenImageMode m_GoldenImgMode           = GoldenImageMode::None;
     int             m_GoldenImgPixelTolerance = 0;
     int             m_ExitCode                = 0;
+    bool            m_bExitRequested          = false;
+
+    // Number of pixels above the tolerance that the golden image validation accepts, and whether the comparison
+    // stops once it is exceeded. A heatmap of the differences is written to m_GoldenImgHeatmapDir on failure.
+    int                                  m_GoldenImgMaxBadPixels = 0;
+    bool                                 m_bGoldenImgEarlyExit   = false;
+    std::string                          m_GoldenImgHeatmapDir;
+    std::unique_ptr<GoldenImageComparer> m_pGoldenImgComparer;
+
+    // Render state cache that the sample uses to create shaders and pipeline states,
+    // disabled by the --render_state_cache 0 command line option
+    bool                             m_bUseRenderStateCache = true;
+    RefCntAutoPtr<IRenderStateCache> m_pRenderStateCache;
+    std::string                      m_RenderStateCachePath;
+    const char*                      m_RenderStateCacheStatus = "disabled";
+
+    // Initialization tasks of the sample that run while the app presents the progress overlay,
+    // disabled by the --async_init 0 command line option
+    bool                                m_bAsyncInit = true;
+    std::unique_ptr<AsyncInitTaskGraph> m_pInitTasks;
+
+    // Heap allocations of every frame phase, enabled by the --track_allocations and --assert_no_allocations command line options
+    std::unique_ptr<AllocationTracker> m_pAllocTracker;
+    bool                               m_bAssertNoAllocations = false;
+    Uint32                             m_NumInteractiveFrames = 0;
+
+    // Input controller state of every interactive frame that is recorded by the --input_record and replayed by
+    // the --input_replay command line options. Both modes advance every frame by the time step of the recording.
+    std::unique_ptr<InputRecording> m_pInputRecording;
+    std::string                     m_InputRecordingPath;
+    bool                            m_bReplayInput = false;
+
+    // Times, in seconds since the app creation, when the first frame was presented and when the first frame
+    // of the initialized sample was presented, and the duration of the sample initialization itself
+    Timer  m_StartupTimer;
+    double m_SampleInitStartTime = 0;
+    double m_FirstFrameTime      = 0;
+    double m_TimeToInteractive   = 0;
+    double m_SampleInitTime      = 0;
+
+    // Fixed-timestep benchmark mode, enabled by the --benchmark_frames command line option
+    FrameBenchmark::Settings             m_BenchmarkSettings;
+    std::unique_ptr<FrameBenchmark>      m_pBenchmark;
+    std::unique_ptr<DurationQueryHelper> m_pGPUFrameTimer;
+
+    // Golden image suite mode of the golden image runner that processes all registered samples with one device
+    std::unique_ptr<GoldenImageSuite> m_pGoldenImgSuite;
+    std::vector<DeviceFeatures>       m_SuiteRequiredFeatures;
+    std::vector<const char*>          m_SuiteSkipReasons;
+    std::string                       m_GoldenImgReportPath = "golden_images.xml";
+    std::string                       m_GoldenImgSkipList;
+    std::string                       m_ModeName;
+    size_t                            m_SuiteSampleId        = 0;
+    double                            m_SuiteSampleStartTime = -1;
+    bool                              m_SuiteShowUI          = true;
 };
 
 } // namespace Diligent
@@ -38,11 +38,13 @@
 #include "BasicMath.hpp"
 #include "AppBase.hpp"
 #include "FlagEnum.h"
+#include "RenderStateCache.hpp"
 
 namespace Diligent
 {
 
 class ImGuiImplDiligent;
+class AsyncInitTaskGraph;
 
 struct SampleInitInfo
 {
@@ -53,6 +55,9 @@ struct SampleInitInfo
     Uint32             NumDeferredCtx  = 0;
     ISwapChain*        pSwapChain      = nullptr;
     ImGuiImplDiligent* pImGui          = nullptr;
+
+    // Render state cache of the application, or null if the cache is disabled
+    IRenderStateCache* pStateCache = nullptr;
 };
 
 struct DesiredApplicationSettings
@@ -169,6 +174,18 @@ public:
 
     virtual void Initialize(const SampleInitInfo& InitInfo) = 0;
 
+    /// Called by the framework after Initialize() to let the sample add the tasks that complete its initialization,
+    /// such as texture decoding, mesh building and pipeline state creation, to the graph.
+    ///
+    /// \remarks    The tasks run on worker threads while the framework keeps presenting frames with a progress overlay.
+    ///             They may create device objects, but must not use the device contexts. Once all tasks are complete,
+    ///             the framework calls FinishInitialization() on the main thread, and only then starts updating and
+    ///             rendering the sample.
+    virtual void CreateInitializationTasks(AsyncInitTaskGraph& Tasks) {}
+
+    /// Called by the framework on the main thread when all initialization tasks are complete.
+    virtual void FinishInitialization() {}
+
     virtual void Render() = 0;
 
     virtual void Update(double CurrTime, double ElapsedTime, bool DoUpdateUI) = 0;
@@ -209,12 +226,20 @@ protected:
     // Returns pretransform matrix that matches the current screen rotation
     float4x4 GetSurfacePretransformMatrix(const float3& f3CameraViewAxis) const;
 
+    // Returns the device wrapper that creates shaders and pipeline states through the render state
+    // cache of the application, or directly through the device if the cache is disabled.
+    RenderDeviceWithCache_N GetRenderDeviceWithCache() const
+    {
+        return RenderDeviceWithCache_N{m_pDevice, m_pRenderStateCache};
+    }
+
     RefCntAutoPtr<IEngineFactory>              m_pEngineFactory;
     RefCntAutoPtr<IRenderDevice>               m_pDevice;
     RefCntAutoPtr<IDeviceContext>              m_pImmediateContext;
     std::vector<RefCntAutoPtr<IDeviceContext>> m_pDeferredContexts;
     RefCntAutoPtr<ISwapChain>                  m_pSwapChain;
     ImGuiImplDiligent*                         m_pImGui = nullptr;
+    RefCntAutoPtr<IRenderStateCache>           m_pRenderStateCache;
 
     float  m_fSmoothFPS         = 0;
     double m_LastFPSTime        = 0;
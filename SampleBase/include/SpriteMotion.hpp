@@ -0,0 +1,96 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "BasicTypes.h"
+
+namespace Diligent
+{
+
+// Structure-of-arrays store of 2D sprites that move inside the [-Bounds, +Bounds] square,
+// rotate, and bounce off the square borders. Used by the Tutorial09 and Tutorial10 samples.
+struct SpriteMotionSoA
+{
+    std::vector<float>  PosX;
+    std::vector<float>  PosY;
+    std::vector<float>  MoveDirX;
+    std::vector<float>  MoveDirY;
+    std::vector<float>  Angle;
+    std::vector<float>  RotSpeed;
+    std::vector<Uint32> NumBounces;
+
+    // Per-sprite constants that UpdateSpriteInstances() writes to the instance data
+    std::vector<float> Size;
+    std::vector<float> TexArrInd;
+
+    void Resize(size_t Count);
+
+    size_t GetCount() const { return PosX.size(); }
+
+    // Reorders the sprites so that sprite i takes the values of sprite Order[i].
+    void Reorder(const std::vector<Uint32>& Order);
+};
+
+struct SpriteMotionUpdateAttribs
+{
+    float ElapsedTime = 0;
+    float Bounds      = 0.95f;
+
+    // When a sprite bounces, its rotation speed is set to a random value in [-MaxRotSpeed, +MaxRotSpeed).
+    float MaxRotSpeed = 0;
+
+    // The random value only depends on the seed, the sprite index and the number of times
+    // the sprite has bounced, so the result does not depend on how the sprites are split
+    // between threads.
+    Uint32 Seed = 0;
+};
+
+// Returns the name of the instruction set used by UpdateSpriteMotion().
+const char* GetSpriteMotionISA();
+
+// Advances sprites [Start, End). Different threads may update non-overlapping ranges concurrently.
+void UpdateSpriteMotion(SpriteMotionSoA& Sprites, size_t Start, size_t End, const SpriteMotionUpdateAttribs& Attribs);
+
+// Per-instance data of the Tutorial09 and Tutorial10 batch shaders. The structure is padded
+// to 32 bytes so that every instance is written with two aligned 16-byte stores.
+struct SpriteInstanceData
+{
+    float RotationAndScale[4];
+    float Center[2];
+    float TexArrInd;
+    float Padding;
+};
+
+// Advances sprites [Start, End) the same way as UpdateSpriteMotion() and writes their instance data
+// to pDst[0] .. pDst[End - Start - 1] in the same pass. If pDst is 16-byte aligned, the data is written
+// with non-temporal stores that bypass the cache, which suits write-combined GPU upload memory.
+void UpdateSpriteInstances(SpriteMotionSoA& Sprites, size_t Start, size_t End, const SpriteMotionUpdateAttribs& Attribs, SpriteInstanceData* pDst);
+
+} // namespace Diligent
@@ -52,6 +52,18 @@ public:
             InputControllerBase::ClearState();
         }
 
+        InputState GetState()
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            return InputControllerBase::GetState();
+        }
+
+        void SetState(const InputState& State)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            InputControllerBase::SetState(State);
+        }
+
         void OnKeyDown(InputKeys Key)
         {
             std::lock_guard<std::mutex> lock(mtx);
@@ -124,6 +136,16 @@ public:
         m_SharedState->ClearState();
     }
 
+    InputState GetState() const
+    {
+        return m_SharedState->GetState();
+    }
+
+    void SetState(const InputState& State)
+    {
+        m_SharedState->SetState(State);
+    }
+
 private:
     std::shared_ptr<SharedControllerState> m_SharedState{new SharedControllerState};
 };
@@ -0,0 +1,160 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "SwapChain.h"
+#include "Fence.h"
+#include "RefCntAutoPtr.hpp"
+#include "FileWrapper.hpp"
+
+namespace Diligent
+{
+
+// Records the frames of the sample app into a single video stream without stalling the render thread.
+//
+// Every captured back buffer is copied into one of ReadbackLatency staging textures, and a fence tells when
+// the GPU has finished the copy. Completed frames are read back in order, up to ReadbackLatency frames late,
+// into one of MaxQueuedFrames CPU buffers that a background thread converts and writes to the output, so the
+// memory usage is bounded. The render thread only waits when the GPU or the writer fall behind by more than
+// that, which is reported in the statistics.
+//
+// The output format is selected by the file extension:
+//   .y4m  - uncompressed YUV 4:2:0 stream that most players and encoders read
+//   .rgba - raw RGBA frames without a header
+//   other - raw frames are piped into an external ffmpeg process that encodes them into the file
+class VideoCapture
+{
+public:
+    struct CreateInfo
+    {
+        std::string Path;
+        double      FrameRate       = 30;
+        Uint32      ReadbackLatency = 3;
+        Uint32      MaxQueuedFrames = 4;
+
+        // Output options of the ffmpeg encoder
+        std::string FFmpegArgs = "-c:v libx264 -preset veryfast -crf 18 -pix_fmt yuv420p";
+    };
+
+    // Opens the output stream. Throws an exception if the swap chain format is not supported
+    // or the output can't be opened.
+    VideoCapture(IRenderDevice* pDevice, ISwapChain* pSwapChain, const CreateInfo& CI);
+    ~VideoCapture();
+
+    // clang-format off
+    VideoCapture           (const VideoCapture&) = delete;
+    VideoCapture& operator=(const VideoCapture&) = delete;
+    // clang-format on
+
+    // Copies the current back buffer into the stream if a new video frame is due at time CurrTime,
+    // and reads back the frames that the GPU has finished copying. Must be called before Present().
+    void CaptureFrame(ISwapChain* pSwapChain, IDeviceContext* pCtx, double CurrTime);
+
+    // Reads back all pending frames, waits until the writer has written them and closes the stream.
+    // Returns false if any frame could not be written.
+    bool Finish(IDeviceContext* pCtx);
+
+    struct Statistics
+    {
+        // Frames copied from the back buffer, and frames skipped because the window was resized
+        Uint32 NumFrames        = 0;
+        Uint32 NumSkippedFrames = 0;
+
+        // Number of times and total time, in seconds, that the render thread waited for the GPU or the writer
+        Uint32 NumStalls = 0;
+        double StallTime = 0;
+    };
+    const Statistics& GetStatistics() const { return m_Stats; }
+
+private:
+    enum class FORMAT
+    {
+        Y4M,
+        RawRGBA,
+        FFmpeg
+    };
+
+    void ReadBackFrame(IDeviceContext* pCtx, bool Wait);
+    void StopWriter();
+    void WriterThreadFunc();
+    bool WriteFrame(const std::vector<Uint8>& Pixels);
+    bool Write(const void* pData, size_t Size);
+
+    const CreateInfo m_CI;
+    FORMAT           m_Format = FORMAT::Y4M;
+    Uint32           m_Width  = 0;
+    Uint32           m_Height = 0;
+    bool             m_BGRA   = false;
+    bool             m_FlipY  = false;
+
+    struct StagingSlot
+    {
+        RefCntAutoPtr<ITexture> pTexture;
+        Uint64                  FenceValue = 0;
+    };
+    std::vector<StagingSlot> m_Slots;
+    RefCntAutoPtr<IFence>    m_pFence;
+    Uint64                   m_NumCopiedFrames = 0;
+    Uint64                   m_NumReadFrames   = 0;
+
+    // Time of the first frame and the number of video frames that are due since then
+    double m_StartTime      = -1;
+    Uint64 m_NumVideoFrames = 0;
+
+    std::unique_ptr<FileWrapper> m_pFile;
+    FILE*                        m_pPipe = nullptr;
+
+    // CPU frame buffers are either free or queued for the writer
+    std::vector<std::vector<Uint8>> m_Buffers;
+    std::vector<size_t>             m_FreeBuffers;
+    std::deque<size_t>              m_QueuedBuffers;
+    std::mutex                      m_Mtx;
+    std::condition_variable         m_QueueCV;
+    std::condition_variable         m_FreeCV;
+    bool                            m_Stop        = false;
+    bool                            m_WriteFailed = false;
+    std::thread                     m_WriterThread;
+
+    // Only used by the writer thread
+    std::vector<Uint8> m_ConvertedFrame;
+
+    Statistics m_Stats;
+};
+
+} // namespace Diligent
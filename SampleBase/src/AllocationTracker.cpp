@@ -0,0 +1,302 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "AllocationTracker.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+#if DILIGENT_TRACK_ALLOCATIONS
+
+namespace
+{
+
+// Counters of one thread, on their own cache line to avoid false sharing
+struct alignas(64) ThreadCounters
+{
+    std::atomic<Uint64> NumAllocations{0};
+    std::atomic<Uint64> NumBytes{0};
+    std::atomic<Uint64> NumDeallocations{0};
+};
+
+// Every thread takes the next free slot when it allocates memory for the first time. The threads that
+// start after all slots have been taken share the last slot. Slots are never released, so the counts
+// of the threads that have exited are preserved.
+//
+// All counters are constant-initialized, so that they can be used by the allocations of the static
+// constructors that run before the dynamic initialization of this file.
+constexpr Uint32    MaxThreadSlots = 256;
+ThreadCounters      g_ThreadCounters[MaxThreadSlots + 1];
+std::atomic<Uint32> g_NumThreadSlots{0};
+
+thread_local ThreadCounters* t_pThreadCounters = nullptr;
+
+ThreadCounters& GetCurrentThreadCounters()
+{
+    ThreadCounters* pCounters = t_pThreadCounters;
+    if (pCounters == nullptr)
+    {
+        const Uint32 Slot = g_NumThreadSlots.fetch_add(1, std::memory_order_relaxed);
+        pCounters         = &g_ThreadCounters[std::min(Slot, MaxThreadSlots)];
+        t_pThreadCounters = pCounters;
+    }
+    return *pCounters;
+}
+
+// Relaxed atomic increments are sufficient as a thread only reads its own counters.
+// Every thread but those that share the last slot updates its own cache line, so the increments are uncontended.
+void CountAllocation(size_t Size)
+{
+    ThreadCounters& Counters = GetCurrentThreadCounters();
+    Counters.NumAllocations.fetch_add(1, std::memory_order_relaxed);
+    Counters.NumBytes.fetch_add(Size, std::memory_order_relaxed);
+}
+
+void CountDeallocation(void* Ptr)
+{
+    if (Ptr != nullptr)
+        GetCurrentThreadCounters().NumDeallocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* Allocate(size_t Size)
+{
+    if (Size == 0)
+        Size = 1;
+
+    for (;;)
+    {
+        if (void* Ptr = std::malloc(Size))
+        {
+            CountAllocation(Size);
+            return Ptr;
+        }
+
+        std::new_handler Handler = std::get_new_handler();
+        if (Handler == nullptr)
+            throw std::bad_alloc{};
+        Handler();
+    }
+}
+
+void* AllocateNoThrow(size_t Size) noexcept
+{
+    try
+    {
+        return Allocate(Size);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void Deallocate(void* Ptr) noexcept
+{
+    CountDeallocation(Ptr);
+    std::free(Ptr);
+}
+
+#    if defined(__cpp_aligned_new)
+
+void* AllocateAligned(size_t Size, std::align_val_t Alignment)
+{
+    const size_t Align = std::max(static_cast<size_t>(Alignment), sizeof(void*));
+    if (Size == 0)
+        Size = 1;
+
+    for (;;)
+    {
+#        ifdef _MSC_VER
+        void* Ptr = _aligned_malloc(Size, Align);
+#        else
+        void* Ptr = nullptr;
+        if (posix_memalign(&Ptr, Align, Size) != 0)
+            Ptr = nullptr;
+#        endif
+        if (Ptr != nullptr)
+        {
+            CountAllocation(Size);
+            return Ptr;
+        }
+
+        std::new_handler Handler = std::get_new_handler();
+        if (Handler == nullptr)
+            throw std::bad_alloc{};
+        Handler();
+    }
+}
+
+void* AllocateAlignedNoThrow(size_t Size, std::align_val_t Alignment) noexcept
+{
+    try
+    {
+        return AllocateAligned(Size, Alignment);
+    }
+    catch (...)
+    {
+        return nullptr;
+    }
+}
+
+void DeallocateAligned(void* Ptr) noexcept
+{
+    CountDeallocation(Ptr);
+#        ifdef _MSC_VER
+    _aligned_free(Ptr);
+#        else
+    std::free(Ptr);
+#        endif
+}
+
+#    endif
+
+} // namespace
+
+bool AllocationTracker::IsAvailable()
+{
+    return true;
+}
+
+AllocationTracker::Counters AllocationTracker::GetThreadCounters()
+{
+    // The threads that share the last slot also count the allocations of each other
+    const ThreadCounters& ThreadCnt = GetCurrentThreadCounters();
+
+    Counters Cnt;
+    Cnt.NumAllocations   = ThreadCnt.NumAllocations.load(std::memory_order_relaxed);
+    Cnt.NumBytes         = ThreadCnt.NumBytes.load(std::memory_order_relaxed);
+    Cnt.NumDeallocations = ThreadCnt.NumDeallocations.load(std::memory_order_relaxed);
+    return Cnt;
+}
+
+#else
+
+bool AllocationTracker::IsAvailable()
+{
+    return false;
+}
+
+AllocationTracker::Counters AllocationTracker::GetThreadCounters()
+{
+    return {};
+}
+
+#endif
+
+const char* AllocationTracker::GetPhaseName(PHASE Phase)
+{
+    switch (Phase)
+    {
+        // clang-format off
+        case PHASE_UPDATE:  return "update";
+        case PHASE_RENDER:  return "render";
+        case PHASE_PRESENT: return "present";
+        // clang-format on
+        default:
+            UNEXPECTED("Unexpected phase");
+            return "unknown";
+    }
+}
+
+void AllocationTracker::BeginPhase(PHASE Phase)
+{
+    m_PhaseStart[Phase] = GetThreadCounters();
+}
+
+void AllocationTracker::EndPhase(PHASE Phase)
+{
+    const Counters ThreadCnt = GetThreadCounters();
+
+    Counters& Curr = m_CurrFrame[Phase];
+    Curr.NumAllocations += ThreadCnt.NumAllocations - m_PhaseStart[Phase].NumAllocations;
+    Curr.NumBytes += ThreadCnt.NumBytes - m_PhaseStart[Phase].NumBytes;
+    Curr.NumDeallocations += ThreadCnt.NumDeallocations - m_PhaseStart[Phase].NumDeallocations;
+}
+
+void AllocationTracker::EndFrame(bool Measure)
+{
+    for (Uint32 Phase = 0; Phase < PHASE_COUNT; ++Phase)
+    {
+        const Counters& Curr = m_CurrFrame[Phase];
+        if (Measure)
+        {
+            Statistics& Stats = m_Stats[Phase];
+            ++Stats.NumFrames;
+            if (Curr.NumAllocations > 0)
+                ++Stats.NumAllocatingFrames;
+            Stats.TotalAllocations += Curr.NumAllocations;
+            Stats.TotalBytes += Curr.NumBytes;
+            Stats.MaxAllocations = std::max(Stats.MaxAllocations, Curr.NumAllocations);
+            Stats.MaxBytes       = std::max(Stats.MaxBytes, Curr.NumBytes);
+        }
+        m_LastFrame[Phase] = Curr;
+        m_CurrFrame[Phase] = {};
+    }
+}
+
+} // namespace Diligent
+
+#if DILIGENT_TRACK_ALLOCATIONS
+
+// Replacements of the global allocation functions, see [new.delete]
+
+// clang-format off
+void* operator new  (std::size_t Size)                                 { return Diligent::Allocate(Size); }
+void* operator new[](std::size_t Size)                                 { return Diligent::Allocate(Size); }
+void* operator new  (std::size_t Size, const std::nothrow_t&) noexcept { return Diligent::AllocateNoThrow(Size); }
+void* operator new[](std::size_t Size, const std::nothrow_t&) noexcept { return Diligent::AllocateNoThrow(Size); }
+
+void operator delete  (void* Ptr) noexcept                        { Diligent::Deallocate(Ptr); }
+void operator delete[](void* Ptr) noexcept                        { Diligent::Deallocate(Ptr); }
+void operator delete  (void* Ptr, const std::nothrow_t&) noexcept { Diligent::Deallocate(Ptr); }
+void operator delete[](void* Ptr, const std::nothrow_t&) noexcept { Diligent::Deallocate(Ptr); }
+void operator delete  (void* Ptr, std::size_t) noexcept           { Diligent::Deallocate(Ptr); }
+void operator delete[](void* Ptr, std::size_t) noexcept           { Diligent::Deallocate(Ptr); }
+
+#    if defined(__cpp_aligned_new)
+void* operator new  (std::size_t Size, std::align_val_t Alignment)                                 { return Diligent::AllocateAligned(Size, Alignment); }
+void* operator new[](std::size_t Size, std::align_val_t Alignment)                                 { return Diligent::AllocateAligned(Size, Alignment); }
+void* operator new  (std::size_t Size, std::align_val_t Alignment, const std::nothrow_t&) noexcept { return Diligent::AllocateAlignedNoThrow(Size, Alignment); }
+void* operator new[](std::size_t Size, std::align_val_t Alignment, const std::nothrow_t&) noexcept { return Diligent::AllocateAlignedNoThrow(Size, Alignment); }
+
+void operator delete  (void* Ptr, std::align_val_t) noexcept                        { Diligent::DeallocateAligned(Ptr); }
+void operator delete[](void* Ptr, std::align_val_t) noexcept                        { Diligent::DeallocateAligned(Ptr); }
+void operator delete  (void* Ptr, std::align_val_t, const std::nothrow_t&) noexcept { Diligent::DeallocateAligned(Ptr); }
+void operator delete[](void* Ptr, std::align_val_t, const std::nothrow_t&) noexcept { Diligent::DeallocateAligned(Ptr); }
+void operator delete  (void* Ptr, std::size_t, std::align_val_t) noexcept           { Diligent::DeallocateAligned(Ptr); }
+void operator delete[](void* Ptr, std::size_t, std::align_val_t) noexcept           { Diligent::DeallocateAligned(Ptr); }
+#    endif
+// clang-format on
+
+#endif
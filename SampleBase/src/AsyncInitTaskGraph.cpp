@@ -0,0 +1,203 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "AsyncInitTaskGraph.hpp"
+
+#include <algorithm>
+
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+AsyncInitTaskGraph::~AsyncInitTaskGraph()
+{
+    Cancel();
+}
+
+AsyncInitTaskGraph::TaskId AsyncInitTaskGraph::AddTask(std::string Name, TaskFunc Func, std::initializer_list<TaskId> Dependencies, float Weight)
+{
+    VERIFY(!m_Started, "Tasks can't be added after the graph has been started");
+    VERIFY(Weight >= 0, "Task weight must not be negative");
+
+    const TaskId Id = static_cast<TaskId>(m_Tasks.size());
+    for (TaskId Dep : Dependencies)
+    {
+        // Tasks may only depend on the previously added tasks, so the graph never has cycles
+        VERIFY(Dep < Id, "Task '", Name, "' depends on the task ", Dep, " that has not been added yet");
+        m_Tasks[Dep].Dependents.push_back(Id);
+    }
+
+    Task NewTask;
+    NewTask.Name           = std::move(Name);
+    NewTask.Func           = std::move(Func);
+    NewTask.Weight         = Weight;
+    NewTask.NumPendingDeps = static_cast<Uint32>(Dependencies.size());
+    m_Tasks.emplace_back(std::move(NewTask));
+
+    m_TotalWeight += Weight;
+    return Id;
+}
+
+void AsyncInitTaskGraph::Start(Uint32 NumThreads)
+{
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        VERIFY(!m_Started, "The graph has already been started");
+        m_Started = true;
+        for (TaskId Id = 0; Id < m_Tasks.size(); ++Id)
+        {
+            if (m_Tasks[Id].NumPendingDeps == 0)
+                m_ReadyTasks.push_back(Id);
+        }
+    }
+
+    // There is no point in starting more threads than there are tasks
+    NumThreads = std::min(NumThreads, GetNumTasks());
+    m_Workers.reserve(NumThreads);
+    for (Uint32 i = 0; i < NumThreads; ++i)
+        m_Workers.emplace_back(&AsyncInitTaskGraph::WorkerThreadFunc, this);
+}
+
+bool AsyncInitTaskGraph::ProcessTask(std::unique_lock<std::mutex>& Lock, bool WaitForTask)
+{
+    while (m_ReadyTasks.empty())
+    {
+        if (m_NumCompletedTasks == m_Tasks.size() || !WaitForTask)
+            return false;
+        m_CV.wait(Lock);
+    }
+
+    const TaskId Id = m_ReadyTasks.front();
+    m_ReadyTasks.pop_front();
+    Task& T = m_Tasks[Id];
+
+    // Once a task has failed or the graph has been cancelled, the remaining tasks are only marked as complete
+    if (!m_Cancelled && !m_pException)
+    {
+        T.IsRunning = true;
+        Lock.unlock();
+
+        std::exception_ptr pException;
+        try
+        {
+            T.Func();
+        }
+        catch (...)
+        {
+            pException = std::current_exception();
+        }
+
+        Lock.lock();
+        T.IsRunning = false;
+        if (pException && !m_pException)
+            m_pException = pException;
+    }
+    // Release the resources captured by the task
+    T.Func = nullptr;
+
+    ++m_NumCompletedTasks;
+    m_CompletedWeight += T.Weight;
+    for (TaskId Dependent : T.Dependents)
+    {
+        VERIFY_EXPR(m_Tasks[Dependent].NumPendingDeps > 0);
+        if (--m_Tasks[Dependent].NumPendingDeps == 0)
+            m_ReadyTasks.push_back(Dependent);
+    }
+    // Wake up the threads that wait for the new ready tasks or for the completion of the graph
+    m_CV.notify_all();
+
+    return true;
+}
+
+void AsyncInitTaskGraph::WorkerThreadFunc()
+{
+    std::unique_lock<std::mutex> Lock{m_Mtx};
+    while (ProcessTask(Lock, true))
+    {
+    }
+}
+
+void AsyncInitTaskGraph::JoinWorkers()
+{
+    for (std::thread& Worker : m_Workers)
+        Worker.join();
+    m_Workers.clear();
+}
+
+void AsyncInitTaskGraph::Wait()
+{
+    if (!m_Started)
+        Start(0);
+
+    {
+        std::unique_lock<std::mutex> Lock{m_Mtx};
+        while (ProcessTask(Lock, true))
+        {
+        }
+    }
+    JoinWorkers();
+
+    if (m_pException)
+        std::rethrow_exception(m_pException);
+}
+
+void AsyncInitTaskGraph::Cancel()
+{
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        m_Cancelled = true;
+    }
+    // The workers skip the remaining tasks and exit once the running ones are complete
+    JoinWorkers();
+}
+
+bool AsyncInitTaskGraph::IsComplete() const
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+    return m_NumCompletedTasks == m_Tasks.size();
+}
+
+AsyncInitTaskGraph::Status AsyncInitTaskGraph::GetStatus() const
+{
+    std::lock_guard<std::mutex> Lock{m_Mtx};
+
+    Status Stat;
+    Stat.NumCompletedTasks = m_NumCompletedTasks;
+    Stat.Progress          = m_TotalWeight > 0 ? m_CompletedWeight / m_TotalWeight : (m_NumCompletedTasks == m_Tasks.size() ? 1.f : 0.f);
+    for (const Task& T : m_Tasks)
+    {
+        if (!T.IsRunning)
+            continue;
+        if (!Stat.RunningTasks.empty())
+            Stat.RunningTasks += ", ";
+        Stat.RunningTasks += T.Name;
+    }
+    return Stat;
+}
+
+} // namespace Diligent
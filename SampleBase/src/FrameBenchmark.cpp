@@ -0,0 +1,237 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "FrameBenchmark.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+
+#include "DebugUtilities.hpp"
+#include "FileWrapper.hpp"
+#include "ReportUtils.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Returns the nearest-rank percentile of the sorted samples
+double GetPercentile(const std::vector<double>& SortedSamples, double Percentile)
+{
+    VERIFY_EXPR(!SortedSamples.empty());
+    const size_t Rank = static_cast<size_t>(std::ceil(Percentile / 100.0 * static_cast<double>(SortedSamples.size())));
+    return SortedSamples[std::min(std::max(Rank, size_t{1}), SortedSamples.size()) - 1];
+}
+
+} // namespace
+
+using namespace ReportUtils;
+
+FrameBenchmark::FrameBenchmark(const Settings& BenchmarkSettings) :
+    m_Settings{BenchmarkSettings}
+{
+    for (std::vector<double>& Samples : m_Samples)
+        Samples.reserve(m_Settings.NumFrames);
+}
+
+void FrameBenchmark::BeginFrame()
+{
+    m_FrameStartTime = m_Timer.GetElapsedTime();
+}
+
+void FrameBenchmark::EndFrame()
+{
+    AddSample(PHASE_FRAME, m_Timer.GetElapsedTime() - m_FrameStartTime);
+    ++m_FrameIndex;
+}
+
+void FrameBenchmark::BeginPhase(PHASE Phase)
+{
+    m_PhaseStartTime[Phase] = m_Timer.GetElapsedTime();
+}
+
+void FrameBenchmark::EndPhase(PHASE Phase)
+{
+    AddSample(Phase, m_Timer.GetElapsedTime() - m_PhaseStartTime[Phase]);
+}
+
+void FrameBenchmark::AddSample(PHASE Phase, double Time)
+{
+    VERIFY_EXPR(Phase < PHASE_COUNT);
+    if (!IsWarmup() && !IsComplete())
+        m_Samples[Phase].push_back(Time);
+}
+
+void FrameBenchmark::SetProperty(const char* Name, std::string Value)
+{
+    m_Properties.emplace_back(Name, std::move(Value));
+}
+
+void FrameBenchmark::SetMetric(const char* Name, double Value)
+{
+    m_Metrics.emplace_back(Name, Value);
+}
+
+FrameBenchmark::Statistics FrameBenchmark::ComputeStatistics(PHASE Phase) const
+{
+    Statistics Stats;
+
+    std::vector<double> Samples = m_Samples[Phase];
+    if (Samples.empty())
+        return Stats;
+
+    std::sort(Samples.begin(), Samples.end());
+    Stats.NumSamples = static_cast<Uint32>(Samples.size());
+    Stats.Mean       = std::accumulate(Samples.begin(), Samples.end(), 0.0) / static_cast<double>(Samples.size());
+    Stats.Min        = Samples.front();
+    Stats.P50        = GetPercentile(Samples, 50);
+    Stats.P90        = GetPercentile(Samples, 90);
+    Stats.P95        = GetPercentile(Samples, 95);
+    Stats.P99        = GetPercentile(Samples, 99);
+    Stats.Max        = Samples.back();
+    return Stats;
+}
+
+const char* FrameBenchmark::GetPhaseName(PHASE Phase)
+{
+    static_assert(PHASE_COUNT == 5, "Please update the switch below to handle the new phase");
+    switch (Phase)
+    {
+        // clang-format off
+        case PHASE_UPDATE:  return "update";
+        case PHASE_RENDER:  return "render";
+        case PHASE_PRESENT: return "present";
+        case PHASE_FRAME:   return "frame";
+        case PHASE_GPU:     return "gpu";
+        // clang-format on
+        default:
+            UNEXPECTED("Unexpected phase");
+            return "";
+    }
+}
+
+std::string FrameBenchmark::GetJSON() const
+{
+    std::stringstream ss;
+    ss << "{\n";
+    for (const auto& Property : m_Properties)
+        ss << "    " << QuoteJSONString(Property.first) << ": " << QuoteJSONString(Property.second) << ",\n";
+    ss << "    \"frames\": " << m_Settings.NumFrames << ",\n";
+    ss << "    \"warmup_frames\": " << m_Settings.NumWarmupFrames << ",\n";
+    ss << "    \"time_step_ms\": " << m_Settings.TimeStep * 1000.0 << ",\n";
+
+    ss << "    \"metrics\": {";
+    for (size_t i = 0; i < m_Metrics.size(); ++i)
+        ss << (i > 0 ? ",\n" : "\n") << "        " << QuoteJSONString(m_Metrics[i].first) << ": " << m_Metrics[i].second;
+    ss << (m_Metrics.empty() ? "},\n" : "\n    },\n");
+
+    ss << "    \"phases\": {";
+    ss << std::fixed << std::setprecision(4);
+    bool IsFirstPhase = true;
+    for (Uint32 Phase = 0; Phase < PHASE_COUNT; ++Phase)
+    {
+        const Statistics Stats = ComputeStatistics(static_cast<PHASE>(Phase));
+        if (Stats.NumSamples == 0)
+            continue;
+
+        ss << (IsFirstPhase ? "\n" : ",\n");
+        ss << "        " << QuoteJSONString(GetPhaseName(static_cast<PHASE>(Phase))) << ": {"
+           << "\"samples\": " << Stats.NumSamples
+           << ", \"mean_ms\": " << Stats.Mean * 1000.0
+           << ", \"min_ms\": " << Stats.Min * 1000.0
+           << ", \"p50_ms\": " << Stats.P50 * 1000.0
+           << ", \"p90_ms\": " << Stats.P90 * 1000.0
+           << ", \"p95_ms\": " << Stats.P95 * 1000.0
+           << ", \"p99_ms\": " << Stats.P99 * 1000.0
+           << ", \"max_ms\": " << Stats.Max * 1000.0 << "}";
+        IsFirstPhase = false;
+    }
+    ss << (IsFirstPhase ? "}\n" : "\n    }\n");
+    ss << "}\n";
+    return ss.str();
+}
+
+std::string FrameBenchmark::GetCSV() const
+{
+    std::stringstream ss;
+    ss << "metric,value\n";
+    for (const auto& Property : m_Properties)
+        ss << QuoteCSVString(Property.first) << ',' << QuoteCSVString(Property.second) << '\n';
+    ss << "frames," << m_Settings.NumFrames << '\n';
+    ss << "warmup_frames," << m_Settings.NumWarmupFrames << '\n';
+    ss << "time_step_ms," << m_Settings.TimeStep * 1000.0 << '\n';
+    for (const auto& Metric : m_Metrics)
+        ss << QuoteCSVString(Metric.first) << ',' << Metric.second << '\n';
+
+    ss << std::fixed << std::setprecision(4);
+    for (Uint32 Phase = 0; Phase < PHASE_COUNT; ++Phase)
+    {
+        const Statistics Stats = ComputeStatistics(static_cast<PHASE>(Phase));
+        if (Stats.NumSamples == 0)
+            continue;
+
+        const char* Name = GetPhaseName(static_cast<PHASE>(Phase));
+        ss << Name << ".samples," << Stats.NumSamples << '\n'
+           << Name << ".mean_ms," << Stats.Mean * 1000.0 << '\n'
+           << Name << ".min_ms," << Stats.Min * 1000.0 << '\n'
+           << Name << ".p50_ms," << Stats.P50 * 1000.0 << '\n'
+           << Name << ".p90_ms," << Stats.P90 * 1000.0 << '\n'
+           << Name << ".p95_ms," << Stats.P95 * 1000.0 << '\n'
+           << Name << ".p99_ms," << Stats.P99 * 1000.0 << '\n'
+           << Name << ".max_ms," << Stats.Max * 1000.0 << '\n';
+    }
+    return ss.str();
+}
+
+bool FrameBenchmark::WriteSummary() const
+{
+    const std::string& Path  = m_Settings.OutputPath;
+    const bool         IsCSV = HasExtension(Path, ".csv");
+
+    const std::string Summary = IsCSV ? GetCSV() : GetJSON();
+
+    FileWrapper pFile{Path.c_str(), EFileAccessMode::Overwrite};
+    if (!pFile)
+    {
+        LOG_ERROR_MESSAGE("Failed to create benchmark summary file '", Path, "'.");
+        return false;
+    }
+
+    if (!pFile->Write(Summary.data(), Summary.size()))
+    {
+        LOG_ERROR_MESSAGE("Failed to write benchmark summary file '", Path, "'.");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace Diligent
@@ -0,0 +1,287 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "GoldenImageComparer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "DebugUtilities.hpp"
+#include "SIMDMath.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+constexpr Uint32 TilesPerChunk = 4;
+
+// Expands a row of RGB or RGBA pixels to four bytes per pixel and optionally swaps the red and blue channels.
+// The fourth byte of the expanded pixels is zero: alpha is ignored by the comparison.
+void ExpandRow(const Uint8* pSrc, Uint32 NumChannels, bool SwapRB, Uint32 NumPixels, Uint8* pDst)
+{
+    const Uint32 R = SwapRB ? 2 : 0;
+    const Uint32 B = SwapRB ? 0 : 2;
+    for (Uint32 i = 0; i < NumPixels; ++i)
+    {
+        const Uint8* pSrcPixel = pSrc + i * NumChannels;
+        Uint8*       pDstPixel = pDst + i * 4;
+
+        pDstPixel[0] = pSrcPixel[R];
+        pDstPixel[1] = pSrcPixel[1];
+        pDstPixel[2] = pSrcPixel[B];
+        pDstPixel[3] = 0;
+    }
+}
+
+inline Uint32 AbsDiff(Uint8 a, Uint8 b)
+{
+    return a > b ? a - b : b - a;
+}
+
+// Compares two rows of four-byte pixels with the same channel order, ignoring the fourth channel.
+// If pDiff is not null, writes the difference of every pixel to it.
+void CompareRow(const Uint8* pRow1, const Uint8* pRow2, Uint32 NumPixels, Uint32 Threshold,
+                Uint32& NumDiffPixels, Uint32& NumBadPixels, Uint32& MaxDiff, Uint8* pDiff)
+{
+    Uint32 i = 0;
+#if SAMPLE_BASE_SSE2
+    {
+        const __m128i RGBMask    = _mm_set1_epi32(0x00FFFFFF);
+        const __m128i ByteMask   = _mm_set1_epi32(0xFF);
+        const __m128i Zero       = _mm_setzero_si128();
+        const __m128i ThresholdV = _mm_set1_epi32(static_cast<int>(Threshold));
+
+        // Comparison masks are -1, so subtracting them counts the pixels in every lane
+        __m128i DiffCount = Zero;
+        __m128i BadCount  = Zero;
+        __m128i Max       = Zero;
+        for (; i + 4 <= NumPixels; i += 4)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow1 + i * 4));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow2 + i * 4));
+
+            // |a - b| for every channel, then the maximum of the three channels of every pixel
+            const __m128i d = _mm_and_si128(_mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a)), RGBMask);
+            __m128i       m = _mm_max_epu8(d, _mm_srli_epi32(d, 8));
+            m               = _mm_and_si128(_mm_max_epu8(m, _mm_srli_epi32(m, 16)), ByteMask);
+
+            DiffCount = _mm_sub_epi32(DiffCount, _mm_cmpgt_epi32(m, Zero));
+            BadCount  = _mm_sub_epi32(BadCount, _mm_cmpgt_epi32(m, ThresholdV));
+            Max       = _mm_max_epu8(Max, m);
+
+            if (pDiff != nullptr)
+            {
+                const __m128i Packed = _mm_packus_epi16(_mm_packs_epi32(m, m), Zero);
+                const int     Diff4  = _mm_cvtsi128_si32(Packed);
+                std::memcpy(pDiff + i, &Diff4, sizeof(Diff4));
+            }
+        }
+
+        alignas(16) Uint32 Lanes[3][4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(Lanes[0]), DiffCount);
+        _mm_store_si128(reinterpret_cast<__m128i*>(Lanes[1]), BadCount);
+        _mm_store_si128(reinterpret_cast<__m128i*>(Lanes[2]), Max);
+        for (Uint32 l = 0; l < 4; ++l)
+        {
+            NumDiffPixels += Lanes[0][l];
+            NumBadPixels += Lanes[1][l];
+            MaxDiff = std::max(MaxDiff, Lanes[2][l]);
+        }
+    }
+#endif
+
+    for (; i < NumPixels; ++i)
+    {
+        const Uint8* a = pRow1 + i * 4;
+        const Uint8* b = pRow2 + i * 4;
+
+        const Uint32 Diff = std::max(std::max(AbsDiff(a[0], b[0]), AbsDiff(a[1], b[1])), AbsDiff(a[2], b[2]));
+        if (Diff > 0)
+            ++NumDiffPixels;
+        if (Diff > Threshold)
+            ++NumBadPixels;
+        MaxDiff = std::max(MaxDiff, Diff);
+
+        if (pDiff != nullptr)
+            pDiff[i] = static_cast<Uint8>(Diff);
+    }
+}
+
+// Writes the heatmap color of a pixel. Luminance is the same for RGB and BGR order.
+void WriteHeatmapPixel(Uint8* pDst, const Uint8* pGolden, Uint32 Diff, Uint32 Threshold, bool Compared)
+{
+    const Uint8 Background = static_cast<Uint8>((pGolden[0] + 2 * pGolden[1] + pGolden[2]) / 16);
+    if (!Compared)
+    {
+        pDst[0] = static_cast<Uint8>(Background + 64);
+        pDst[1] = Background;
+        pDst[2] = static_cast<Uint8>(Background + 64);
+    }
+    else if (Diff == 0)
+    {
+        pDst[0] = pDst[1] = pDst[2] = Background;
+    }
+    else if (Diff <= Threshold)
+    {
+        pDst[0] = 0;
+        pDst[1] = 0;
+        pDst[2] = static_cast<Uint8>(128 + Diff * 127 / std::max(Threshold, 1u));
+    }
+    else
+    {
+        pDst[0] = 255;
+        pDst[1] = static_cast<Uint8>((Diff - Threshold) * 255 / (255 - Threshold));
+        pDst[2] = 0;
+    }
+    pDst[3] = 255;
+}
+
+} // namespace
+
+GoldenImageComparer::GoldenImageComparer(Uint32 NumWorkers)
+{
+    m_Workers.Start(NumWorkers);
+
+    const Uint32 NumSubsets = m_Workers.GetNumSubsets();
+    m_GoldenRows.resize(NumSubsets, std::vector<Uint8>(TileSize * 4));
+    m_DiffRows.resize(NumSubsets, std::vector<Uint8>(TileSize));
+}
+
+const Uint8* GoldenImageComparer::GetGoldenRow(const CompareAttribs& Attribs, Uint32 Row, Uint32 X0, Uint32 NumPixels, Uint32 Subset)
+{
+    const Uint8* pSrc = Attribs.pGolden + Row * Attribs.GoldenStride + X0 * Attribs.GoldenNumChannels;
+    if (Attribs.GoldenNumChannels == 4 && !Attribs.CapturedBGRA)
+        return pSrc;
+
+    Uint8* pDst = m_GoldenRows[Subset].data();
+    ExpandRow(pSrc, Attribs.GoldenNumChannels, Attribs.CapturedBGRA, NumPixels, pDst);
+    return pDst;
+}
+
+void GoldenImageComparer::CompareTile(const CompareAttribs& Attribs, Uint32 Tile, Uint32 Subset, TileResult& Res, Uint8* pHeatmap)
+{
+    const Uint32 NumTilesX = (Attribs.Width + TileSize - 1) / TileSize;
+    const Uint32 X0        = (Tile % NumTilesX) * TileSize;
+    const Uint32 Y0        = (Tile / NumTilesX) * TileSize;
+    const Uint32 X1        = std::min(X0 + TileSize, Attribs.Width);
+    const Uint32 Y1        = std::min(Y0 + TileSize, Attribs.Height);
+    const Uint32 NumPixels = X1 - X0;
+
+    // The heatmap only needs the differences of the tiles that have them
+    const bool   ComputeDiff = pHeatmap != nullptr && Res.Compared && Res.NumDiffPixels > 0;
+    Uint8* const pDiffRow    = ComputeDiff ? m_DiffRows[Subset].data() : nullptr;
+
+    TileResult TileRes;
+    for (Uint32 y = Y0; y < Y1; ++y)
+    {
+        const Uint8* pGoldenRow = GetGoldenRow(Attribs, y, X0, NumPixels, Subset);
+        if (pHeatmap == nullptr || ComputeDiff)
+        {
+            const Uint32 CapturedRow   = Attribs.FlipY ? Attribs.Height - 1 - y : y;
+            const Uint8* pCapturedData = Attribs.pCaptured + CapturedRow * Attribs.CapturedStride + X0 * 4;
+            CompareRow(pCapturedData, pGoldenRow, NumPixels, Attribs.Threshold,
+                       TileRes.NumDiffPixels, TileRes.NumBadPixels, TileRes.MaxDiff, pDiffRow);
+        }
+
+        if (pHeatmap != nullptr)
+        {
+            Uint8* pDst = pHeatmap + (size_t{y} * Attribs.Width + X0) * 4;
+            for (Uint32 x = 0; x < NumPixels; ++x)
+                WriteHeatmapPixel(pDst + x * 4, pGoldenRow + x * 4, pDiffRow != nullptr ? pDiffRow[x] : 0, Attribs.Threshold, Res.Compared);
+        }
+    }
+
+    if (pHeatmap == nullptr)
+    {
+        TileRes.Compared = true;
+        Res              = TileRes;
+    }
+}
+
+GoldenImageComparer::Result GoldenImageComparer::Compare(const CompareAttribs& Attribs)
+{
+    VERIFY_EXPR(Attribs.pCaptured != nullptr && Attribs.pGolden != nullptr);
+    VERIFY(Attribs.GoldenNumChannels == 3 || Attribs.GoldenNumChannels == 4, "Golden image must have 3 or 4 channels");
+
+    const Uint32 NumTiles = ((Attribs.Width + TileSize - 1) / TileSize) * ((Attribs.Height + TileSize - 1) / TileSize);
+    m_Tiles.assign(NumTiles, TileResult{});
+    m_NumBadPixels.store(0);
+    m_Abort.store(false);
+
+    m_Workers.SetWorkItems(NumTiles, TilesPerChunk);
+    m_Workers.ParallelFor([&](Uint32 Subset) {
+        Uint32 Start = 0;
+        Uint32 End   = 0;
+        while (!m_Abort.load(std::memory_order_relaxed) && m_Workers.NextChunk(Subset, Start, End))
+        {
+            for (Uint32 Tile = Start; Tile < End && !m_Abort.load(std::memory_order_relaxed); ++Tile)
+            {
+                TileResult& Res = m_Tiles[Tile];
+                CompareTile(Attribs, Tile, Subset, Res, nullptr);
+
+                if (Attribs.EarlyExit && Res.NumBadPixels > 0)
+                {
+                    const Uint32 NumBadPixels = m_NumBadPixels.fetch_add(Res.NumBadPixels, std::memory_order_relaxed) + Res.NumBadPixels;
+                    if (NumBadPixels > Attribs.MaxBadPixels)
+                        m_Abort.store(true, std::memory_order_relaxed);
+                }
+            }
+        }
+    });
+
+    Result Res;
+    for (const TileResult& Tile : m_Tiles)
+    {
+        Res.NumDiffPixels += Tile.NumDiffPixels;
+        Res.NumBadPixels += Tile.NumBadPixels;
+        Res.MaxDiff = std::max(Res.MaxDiff, Tile.MaxDiff);
+        Res.Complete &= Tile.Compared;
+    }
+    return Res;
+}
+
+void GoldenImageComparer::ComputeHeatmap(const CompareAttribs& Attribs, std::vector<Uint8>& Heatmap)
+{
+    const Uint32 NumTiles = ((Attribs.Width + TileSize - 1) / TileSize) * ((Attribs.Height + TileSize - 1) / TileSize);
+    VERIFY(m_Tiles.size() == NumTiles, "The heatmap must be computed with the attributes of the last comparison");
+
+    Heatmap.resize(size_t{Attribs.Width} * Attribs.Height * 4);
+    m_Workers.SetWorkItems(NumTiles, TilesPerChunk);
+    m_Workers.ParallelFor([&](Uint32 Subset) {
+        Uint32 Start = 0;
+        Uint32 End   = 0;
+        while (m_Workers.NextChunk(Subset, Start, End))
+        {
+            for (Uint32 Tile = Start; Tile < End; ++Tile)
+                CompareTile(Attribs, Tile, Subset, m_Tiles[Tile], Heatmap.data());
+        }
+    });
+}
+
+} // namespace Diligent
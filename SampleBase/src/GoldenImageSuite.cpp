@@ -0,0 +1,201 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "GoldenImageSuite.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+#include "DebugUtilities.hpp"
+#include "FileWrapper.hpp"
+#include "ReportUtils.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+std::vector<GoldenImageSuite::SampleInfo>& GetSampleRegistry()
+{
+    // Function-local static is initialized on first use, so the samples may be
+    // registered by static initializers of other translation units.
+    static std::vector<GoldenImageSuite::SampleInfo> Registry;
+    return Registry;
+}
+
+const char* GetStatusString(GoldenImageSuite::STATUS Status)
+{
+    switch (Status)
+    {
+        // clang-format off
+        case GoldenImageSuite::STATUS::Passed:  return "passed";
+        case GoldenImageSuite::STATUS::Failed:  return "failed";
+        case GoldenImageSuite::STATUS::Skipped: return "skipped";
+        // clang-format on
+        default:
+            UNEXPECTED("Unexpected test status");
+            return "";
+    }
+}
+
+} // namespace
+
+using namespace ReportUtils;
+
+void GoldenImageSuite::RegisterSample(const SampleInfo& Info)
+{
+    VERIFY_EXPR(Info.Name != nullptr && Info.Create != nullptr);
+    GetSampleRegistry().push_back(Info);
+}
+
+const std::vector<GoldenImageSuite::SampleInfo>& GoldenImageSuite::GetRegisteredSamples()
+{
+    return GetSampleRegistry();
+}
+
+GoldenImageSuite::GoldenImageSuite(std::string SuiteName) :
+    m_SuiteName{std::move(SuiteName)}
+{
+    m_Results.reserve(GetRegisteredSamples().size());
+}
+
+void GoldenImageSuite::BeginTest(std::string Name)
+{
+    m_Results.emplace_back();
+    m_Results.back().Name = std::move(Name);
+    m_TestStartTime       = m_Timer.GetElapsedTime();
+}
+
+void GoldenImageSuite::EndTest(STATUS Status, int ErrorCode, std::string Message)
+{
+    VERIFY(!m_Results.empty(), "BeginTest() must be called first");
+
+    TestResult& Result = m_Results.back();
+    Result.Status      = Status;
+    Result.ErrorCode   = ErrorCode;
+    Result.Message     = std::move(Message);
+    Result.Time        = m_Timer.GetElapsedTime() - m_TestStartTime;
+}
+
+Uint32 GoldenImageSuite::GetNumResults(STATUS Status) const
+{
+    Uint32 Count = 0;
+    for (const TestResult& Result : m_Results)
+    {
+        if (Result.Status == Status)
+            ++Count;
+    }
+    return Count;
+}
+
+std::string GoldenImageSuite::GetJUnitXML() const
+{
+    double TotalTime = 0;
+    for (const TestResult& Result : m_Results)
+        TotalTime += Result.Time;
+
+    const std::string SuiteName = EscapeXMLString(m_SuiteName);
+
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    ss << "<testsuites tests=\"" << m_Results.size() << "\" failures=\"" << GetNumResults(STATUS::Failed)
+       << "\" skipped=\"" << GetNumResults(STATUS::Skipped) << "\" time=\"" << TotalTime << "\">\n";
+    ss << "    <testsuite name=\"" << SuiteName << "\" tests=\"" << m_Results.size() << "\" failures=\"" << GetNumResults(STATUS::Failed)
+       << "\" skipped=\"" << GetNumResults(STATUS::Skipped) << "\" time=\"" << TotalTime << "\">\n";
+    for (const TestResult& Result : m_Results)
+    {
+        ss << "        <testcase classname=\"" << SuiteName << "\" name=\"" << EscapeXMLString(Result.Name) << "\" time=\"" << Result.Time << '"';
+        switch (Result.Status)
+        {
+            case STATUS::Passed:
+                ss << "/>\n";
+                break;
+
+            case STATUS::Failed:
+                ss << ">\n            <failure type=\"" << Result.ErrorCode << "\" message=\"" << EscapeXMLString(Result.Message) << "\"/>\n"
+                   << "        </testcase>\n";
+                break;
+
+            case STATUS::Skipped:
+                ss << ">\n            <skipped message=\"" << EscapeXMLString(Result.Message) << "\"/>\n"
+                   << "        </testcase>\n";
+                break;
+        }
+    }
+    ss << "    </testsuite>\n";
+    ss << "</testsuites>\n";
+    return ss.str();
+}
+
+std::string GoldenImageSuite::GetJSON() const
+{
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3);
+    ss << "{\n";
+    ss << "    \"suite\": " << QuoteJSONString(m_SuiteName) << ",\n";
+    ss << "    \"passed\": " << GetNumResults(STATUS::Passed) << ",\n";
+    ss << "    \"failed\": " << GetNumResults(STATUS::Failed) << ",\n";
+    ss << "    \"skipped\": " << GetNumResults(STATUS::Skipped) << ",\n";
+    ss << "    \"tests\": [";
+    for (size_t i = 0; i < m_Results.size(); ++i)
+    {
+        const TestResult& Result = m_Results[i];
+        ss << (i > 0 ? ",\n" : "\n")
+           << "        {\"name\": " << QuoteJSONString(Result.Name)
+           << ", \"status\": \"" << GetStatusString(Result.Status) << '"'
+           << ", \"error_code\": " << Result.ErrorCode
+           << ", \"message\": " << QuoteJSONString(Result.Message)
+           << ", \"time\": " << Result.Time << "}";
+    }
+    ss << (m_Results.empty() ? "]\n" : "\n    ]\n");
+    ss << "}\n";
+    return ss.str();
+}
+
+bool GoldenImageSuite::WriteReport(const std::string& Path) const
+{
+    const std::string Report = HasExtension(Path, ".json") ? GetJSON() : GetJUnitXML();
+
+    FileWrapper pFile{Path.c_str(), EFileAccessMode::Overwrite};
+    if (!pFile)
+    {
+        LOG_ERROR_MESSAGE("Failed to create golden image report file '", Path, "'.");
+        return false;
+    }
+
+    if (!pFile->Write(Report.data(), Report.size()))
+    {
+        LOG_ERROR_MESSAGE("Failed to write golden image report file '", Path, "'.");
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace Diligent
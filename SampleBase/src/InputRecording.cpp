@@ -0,0 +1,210 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "InputRecording.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+#include "DebugUtilities.hpp"
+#include "FileWrapper.hpp"
+#include "DataBlobImpl.hpp"
+#include "GraphicsAccessories.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+constexpr char   InputRecordingMagic[4] = {'D', 'G', 'I', 'R'};
+constexpr Uint32 InputRecordingVersion  = 1;
+constexpr Uint32 NumInputKeys           = static_cast<Uint32>(InputKeys::TotalKeys);
+
+// All values are stored in the native byte order, which is little-endian on all supported platforms
+// clang-format off
+constexpr size_t HeaderSize = sizeof(InputRecordingMagic) + sizeof(Uint32) * 4 + sizeof(double);
+constexpr size_t RecordSize = sizeof(Uint32) + sizeof(Float32) * 3 + sizeof(Uint8) + sizeof(Uint8) * NumInputKeys;
+// clang-format on
+
+bool operator==(const InputState& LHS, const InputState& RHS)
+{
+    // clang-format off
+    return LHS.Mouse.PosX        == RHS.Mouse.PosX        &&
+           LHS.Mouse.PosY        == RHS.Mouse.PosY        &&
+           LHS.Mouse.ButtonFlags == RHS.Mouse.ButtonFlags &&
+           LHS.Mouse.WheelDelta  == RHS.Mouse.WheelDelta  &&
+           std::memcmp(LHS.Keys, RHS.Keys, sizeof(LHS.Keys)) == 0;
+    // clang-format on
+}
+
+template <typename T>
+void WriteValue(std::vector<Uint8>& Data, const T& Value)
+{
+    const size_t Offset = Data.size();
+    Data.resize(Offset + sizeof(Value));
+    std::memcpy(&Data[Offset], &Value, sizeof(Value));
+}
+
+template <typename T>
+T ReadValue(const Uint8*& pData)
+{
+    T Value;
+    std::memcpy(&Value, pData, sizeof(Value));
+    pData += sizeof(Value);
+    return Value;
+}
+
+} // namespace
+
+void InputRecording::AddFrame(Uint32 Frame, const InputState& State)
+{
+    VERIFY(Frame >= m_NumFrames, "Frame ", Frame, " has already been recorded");
+
+    if (m_Records.empty() || !(m_Records.back().State == State))
+        m_Records.push_back({Frame, State});
+
+    m_NumFrames = Frame + 1;
+}
+
+bool InputRecording::GetFrame(Uint32 Frame, InputState& State) const
+{
+    if (Frame >= m_NumFrames)
+        return false;
+
+    // The state of the frame is stored in the last record at or before it
+    auto it = std::upper_bound(m_Records.begin(), m_Records.end(), Frame,
+                               [](Uint32 Val, const Record& Rec) { return Val < Rec.Frame; });
+    State   = it != m_Records.begin() ? std::prev(it)->State : InputState{};
+    return true;
+}
+
+bool InputRecording::Save(const char* Path) const
+{
+    std::vector<Uint8> Data;
+    Data.reserve(HeaderSize + RecordSize * m_Records.size());
+
+    for (char c : InputRecordingMagic)
+        WriteValue(Data, c);
+    WriteValue(Data, InputRecordingVersion);
+    WriteValue(Data, NumInputKeys);
+    WriteValue(Data, m_NumFrames);
+    WriteValue(Data, static_cast<Uint32>(m_Records.size()));
+    WriteValue(Data, m_TimeStep);
+    VERIFY_EXPR(Data.size() == HeaderSize);
+
+    for (const Record& Rec : m_Records)
+    {
+        WriteValue(Data, Rec.Frame);
+        WriteValue(Data, Rec.State.Mouse.PosX);
+        WriteValue(Data, Rec.State.Mouse.PosY);
+        WriteValue(Data, Rec.State.Mouse.WheelDelta);
+        WriteValue(Data, static_cast<Uint8>(Rec.State.Mouse.ButtonFlags));
+        for (INPUT_KEY_STATE_FLAGS Key : Rec.State.Keys)
+            WriteValue(Data, static_cast<Uint8>(Key));
+    }
+    VERIFY_EXPR(Data.size() == HeaderSize + RecordSize * m_Records.size());
+
+    FileWrapper pFile{Path, EFileAccessMode::Overwrite};
+    if (!pFile)
+    {
+        LOG_ERROR_MESSAGE("Failed to create input recording file '", Path, "'.");
+        return false;
+    }
+
+    if (!pFile->Write(Data.data(), Data.size()))
+    {
+        LOG_ERROR_MESSAGE("Failed to write input recording file '", Path, "'.");
+        return false;
+    }
+
+    LOG_INFO_MESSAGE("Saved ", m_NumFrames, " frames of input (", m_Records.size(), " records, ", FormatMemorySize(Data.size()), ") to '", Path, "'.");
+    return true;
+}
+
+bool InputRecording::Load(const char* Path)
+{
+    FileWrapper                 pFile{Path};
+    RefCntAutoPtr<DataBlobImpl> pData = DataBlobImpl::Create();
+    if (!pFile || !pFile->Read(pData))
+    {
+        LOG_ERROR_MESSAGE("Failed to read input recording file '", Path, "'.");
+        return false;
+    }
+
+    const size_t DataSize = pData->GetSize();
+    const Uint8* pCurr    = static_cast<const Uint8*>(pData->GetConstDataPtr());
+    if (DataSize < HeaderSize || std::memcmp(pCurr, InputRecordingMagic, sizeof(InputRecordingMagic)) != 0)
+    {
+        LOG_ERROR_MESSAGE("'", Path, "' is not an input recording file.");
+        return false;
+    }
+    pCurr += sizeof(InputRecordingMagic);
+
+    const Uint32 Version    = ReadValue<Uint32>(pCurr);
+    const Uint32 NumKeys    = ReadValue<Uint32>(pCurr);
+    const Uint32 NumFrames  = ReadValue<Uint32>(pCurr);
+    const Uint32 NumRecords = ReadValue<Uint32>(pCurr);
+    const double TimeStep   = ReadValue<double>(pCurr);
+    if (Version != InputRecordingVersion || NumKeys != NumInputKeys)
+    {
+        LOG_ERROR_MESSAGE("Input recording file '", Path, "' was created by an incompatible version of the app.");
+        return false;
+    }
+    if (DataSize != HeaderSize + RecordSize * NumRecords || !(TimeStep > 0))
+    {
+        LOG_ERROR_MESSAGE("Input recording file '", Path, "' is corrupted.");
+        return false;
+    }
+
+    std::vector<Record> Records(NumRecords);
+    for (Record& Rec : Records)
+    {
+        Rec.Frame                   = ReadValue<Uint32>(pCurr);
+        Rec.State.Mouse.PosX        = ReadValue<Float32>(pCurr);
+        Rec.State.Mouse.PosY        = ReadValue<Float32>(pCurr);
+        Rec.State.Mouse.WheelDelta  = ReadValue<Float32>(pCurr);
+        Rec.State.Mouse.ButtonFlags = static_cast<MouseState::BUTTON_FLAGS>(ReadValue<Uint8>(pCurr));
+        for (INPUT_KEY_STATE_FLAGS& Key : Rec.State.Keys)
+            Key = static_cast<INPUT_KEY_STATE_FLAGS>(ReadValue<Uint8>(pCurr));
+
+        if (Rec.Frame >= NumFrames || (&Rec != Records.data() && Rec.Frame <= (&Rec - 1)->Frame))
+        {
+            LOG_ERROR_MESSAGE("Input recording file '", Path, "' is corrupted.");
+            return false;
+        }
+    }
+
+    m_TimeStep  = TimeStep;
+    m_NumFrames = NumFrames;
+    m_Records   = std::move(Records);
+
+    return true;
+}
+
+} // namespace Diligent
@@ -0,0 +1,253 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "InstanceGrid.hpp"
+
+#include "DebugUtilities.hpp"
+#include "SIMDMath.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+using namespace SIMDMath;
+
+// Random streams of GenerateInstanceGrid()
+constexpr Uint32 StreamOffsetX = 0;
+constexpr Uint32 StreamScale   = 3;
+constexpr Uint32 StreamAngleX  = 4;
+static_assert(StreamAngleX + 3 == InstanceGridNumStreams, "Unexpected number of random streams");
+
+// Byte offset of the cell matrix in the destination buffer
+inline size_t GetCellOffset(Uint32 Cell, Uint32 FirstCell, size_t Stride, const Uint32* pCellSlots)
+{
+    return (pCellSlots != nullptr ? pCellSlots[Cell] : Cell - FirstCell) * Stride;
+}
+
+inline void GetCellCoords(Uint32 GridSize, Uint32 Cell, float Coords[3])
+{
+    Coords[0] = static_cast<float>(Cell / (GridSize * GridSize));
+    Coords[1] = static_cast<float>((Cell / GridSize) % GridSize);
+    Coords[2] = static_cast<float>(Cell % GridSize);
+}
+
+#if !SAMPLE_BASE_SSE2
+void WriteCellMatrix(const InstanceGridAttribs& Attribs, Uint32 Cell, float* pDst)
+{
+    const float CellSize = 2.f / static_cast<float>(Attribs.GridSize);
+
+    float Coords[3];
+    GetCellCoords(Attribs.GridSize, Cell, Coords);
+
+    float Translation[3];
+    for (Uint32 c = 0; c < 3; ++c)
+    {
+        const float Offset = (HashToUnorm(CounterHash(Attribs.Seed, Cell, StreamOffsetX + c)) * 2.f - 1.f) * Attribs.MaxOffset;
+        Translation[c]     = (Coords[c] + 0.5f + Offset) * CellSize - 1.f;
+    }
+
+    const float u     = HashToUnorm(CounterHash(Attribs.Seed, Cell, StreamScale));
+    const float Scale = Attribs.BaseScale / static_cast<float>(Attribs.GridSize) * (Attribs.MinScale + u * (Attribs.MaxScale - Attribs.MinScale));
+
+    float Sin[3], Cos[3];
+    for (Uint32 c = 0; c < 3; ++c)
+    {
+        const float Angle = (HashToUnorm(CounterHash(Attribs.Seed, Cell, StreamAngleX + c)) * 2.f - 1.f) * Pi;
+        SinCos(Angle, Sin[c], Cos[c]);
+    }
+    const float sx = Sin[0], cx = Cos[0];
+    const float sy = Sin[1], cy = Cos[1];
+    const float sz = Sin[2], cz = Cos[2];
+
+    // clang-format off
+    const float Matrix[16] =
+    {
+        Scale * (cy * cz),                Scale * (cy * sz),                Scale * (-sy),     0,
+        Scale * (sx * sy * cz - cx * sz), Scale * (sx * sy * sz + cx * cz), Scale * (sx * cy), 0,
+        Scale * (cx * sy * cz + sx * sz), Scale * (cx * sy * sz - sx * cz), Scale * (cx * cy), 0,
+        Translation[0],                   Translation[1],                   Translation[2],    1
+    };
+    // clang-format on
+    for (Uint32 i = 0; i < 16; ++i)
+        pDst[i] = Matrix[i];
+}
+#endif
+
+#if SAMPLE_BASE_SSE2
+// Generates the matrices of four cells starting at GroupStart and writes the ones that are in [FirstCell, EndCell)
+template <bool Stream>
+void WriteCellMatrices4(const InstanceGridAttribs& Attribs, Uint32 GroupStart, Uint32 FirstCell, Uint32 EndCell, Uint8* pDst, size_t Stride, const Uint32* pCellSlots)
+{
+    const __m128i Seed     = _mm_set1_epi32(static_cast<int>(Attribs.Seed));
+    const __m128i Cell     = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(GroupStart)), _mm_setr_epi32(0, 1, 2, 3));
+    const __m128  One      = _mm_set1_ps(1.f);
+    const __m128  CellSize = _mm_set1_ps(2.f / static_cast<float>(Attribs.GridSize));
+
+    auto Random = [&](Uint32 StreamId) {
+        return HashToUnorm4(CounterHash4(Seed, Cell, _mm_set1_epi32(static_cast<int>(StreamId))));
+    };
+    // Random value in [-1, 1)
+    auto SignedRandom = [&](Uint32 StreamId) {
+        const __m128 u = Random(StreamId);
+        return _mm_sub_ps(_mm_add_ps(u, u), One);
+    };
+
+    // Integer division has no SIMD counterpart, so cell coordinates are computed per lane
+    alignas(16) float Coords[3][4];
+    for (Uint32 l = 0; l < 4; ++l)
+    {
+        float LaneCoords[3];
+        GetCellCoords(Attribs.GridSize, GroupStart + l, LaneCoords);
+        for (Uint32 c = 0; c < 3; ++c)
+            Coords[c][l] = LaneCoords[c];
+    }
+
+    __m128 Translation[3];
+    for (Uint32 c = 0; c < 3; ++c)
+    {
+        const __m128 Offset = _mm_mul_ps(SignedRandom(StreamOffsetX + c), _mm_set1_ps(Attribs.MaxOffset));
+        Translation[c]      = _mm_sub_ps(_mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_load_ps(Coords[c]), _mm_set1_ps(0.5f)), Offset), CellSize), One);
+    }
+
+    const __m128 Scale = _mm_mul_ps(_mm_set1_ps(Attribs.BaseScale / static_cast<float>(Attribs.GridSize)),
+                                    _mm_add_ps(_mm_set1_ps(Attribs.MinScale), _mm_mul_ps(Random(StreamScale), _mm_set1_ps(Attribs.MaxScale - Attribs.MinScale))));
+
+    __m128 Sin[3], Cos[3];
+    for (Uint32 c = 0; c < 3; ++c)
+        SinCos4(_mm_mul_ps(SignedRandom(StreamAngleX + c), _mm_set1_ps(Pi)), Sin[c], Cos[c]);
+
+    const __m128 sx = Sin[0], cx = Cos[0];
+    const __m128 sy = Sin[1], cy = Cos[1];
+    const __m128 sz = Sin[2], cz = Cos[2];
+
+    const __m128 sxsy = _mm_mul_ps(sx, sy);
+    const __m128 cxsy = _mm_mul_ps(cx, sy);
+
+    // Rows of the rotation matrix RotationX * RotationY * RotationZ scaled by Scale, one cell per lane
+    __m128 r00 = _mm_mul_ps(Scale, _mm_mul_ps(cy, cz));
+    __m128 r01 = _mm_mul_ps(Scale, _mm_mul_ps(cy, sz));
+    __m128 r02 = _mm_mul_ps(Scale, _mm_xor_ps(sy, _mm_set1_ps(-0.f)));
+    __m128 r03 = _mm_setzero_ps();
+
+    __m128 r10 = _mm_mul_ps(Scale, _mm_sub_ps(_mm_mul_ps(sxsy, cz), _mm_mul_ps(cx, sz)));
+    __m128 r11 = _mm_mul_ps(Scale, _mm_add_ps(_mm_mul_ps(sxsy, sz), _mm_mul_ps(cx, cz)));
+    __m128 r12 = _mm_mul_ps(Scale, _mm_mul_ps(sx, cy));
+    __m128 r13 = _mm_setzero_ps();
+
+    __m128 r20 = _mm_mul_ps(Scale, _mm_add_ps(_mm_mul_ps(cxsy, cz), _mm_mul_ps(sx, sz)));
+    __m128 r21 = _mm_mul_ps(Scale, _mm_sub_ps(_mm_mul_ps(cxsy, sz), _mm_mul_ps(sx, cz)));
+    __m128 r22 = _mm_mul_ps(Scale, _mm_mul_ps(cx, cy));
+    __m128 r23 = _mm_setzero_ps();
+
+    __m128 r30 = Translation[0];
+    __m128 r31 = Translation[1];
+    __m128 r32 = Translation[2];
+    __m128 r33 = One;
+
+    // After the transposition, rXY holds row X of the matrix of cell Y
+    _MM_TRANSPOSE4_PS(r00, r01, r02, r03);
+    _MM_TRANSPOSE4_PS(r10, r11, r12, r13);
+    _MM_TRANSPOSE4_PS(r20, r21, r22, r23);
+    _MM_TRANSPOSE4_PS(r30, r31, r32, r33);
+
+    const __m128 Rows[4][4] =
+        {
+            {r00, r10, r20, r30},
+            {r01, r11, r21, r31},
+            {r02, r12, r22, r32},
+            {r03, r13, r23, r33},
+        };
+    for (Uint32 l = 0; l < 4; ++l)
+    {
+        const Uint32 CellInd = GroupStart + l;
+        if (CellInd < FirstCell || CellInd >= EndCell)
+            continue;
+
+        float* pMatrix = reinterpret_cast<float*>(pDst + GetCellOffset(CellInd, FirstCell, Stride, pCellSlots));
+        for (Uint32 r = 0; r < 4; ++r)
+        {
+            if (Stream)
+                _mm_stream_ps(pMatrix + r * 4, Rows[l][r]);
+            else
+                _mm_storeu_ps(pMatrix + r * 4, Rows[l][r]);
+        }
+    }
+}
+
+template <bool Stream>
+void GenerateInstanceGridSIMD(const InstanceGridAttribs& Attribs, Uint32 FirstCell, Uint32 EndCell, Uint8* pDst, size_t Stride, const Uint32* pCellSlots)
+{
+    // Cells are always processed in the same groups of four, so the result of every cell
+    // does not depend on the range boundaries.
+    for (Uint32 GroupStart = FirstCell & ~3u; GroupStart < EndCell; GroupStart += 4)
+        WriteCellMatrices4<Stream>(Attribs, GroupStart, FirstCell, EndCell, pDst, Stride, pCellSlots);
+
+    if (Stream)
+    {
+        // Non-temporal stores are weakly ordered: make them visible before the buffer is unmapped
+        _mm_sfence();
+    }
+}
+#endif
+
+} // namespace
+
+float GetInstanceGridRandom(Uint32 Seed, Uint32 Cell, Uint32 Stream)
+{
+    return HashToUnorm(CounterHash(Seed, Cell, Stream));
+}
+
+const char* GetInstanceGridISA()
+{
+#if SAMPLE_BASE_SSE2
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
+
+void GenerateInstanceGrid(const InstanceGridAttribs& Attribs, Uint32 FirstCell, Uint32 EndCell, void* pDst, size_t Stride, const Uint32* pCellSlots)
+{
+    VERIFY_EXPR(Attribs.GridSize > 0);
+    VERIFY_EXPR(FirstCell <= EndCell && EndCell <= Attribs.GridSize * Attribs.GridSize * Attribs.GridSize);
+    VERIFY(Stride >= sizeof(float) * 16, "Stride is too small to hold a matrix");
+
+    Uint8* pData = static_cast<Uint8*>(pDst);
+#if SAMPLE_BASE_SSE2
+    if (((reinterpret_cast<size_t>(pData) | Stride) & 15) == 0)
+        GenerateInstanceGridSIMD<true>(Attribs, FirstCell, EndCell, pData, Stride, pCellSlots);
+    else
+        GenerateInstanceGridSIMD<false>(Attribs, FirstCell, EndCell, pData, Stride, pCellSlots);
+#else
+    for (Uint32 Cell = FirstCell; Cell < EndCell; ++Cell)
+        WriteCellMatrix(Attribs, Cell, reinterpret_cast<float*>(pData + GetCellOffset(Cell, FirstCell, Stride, pCellSlots)));
+#endif
+}
+
+} // namespace Diligent
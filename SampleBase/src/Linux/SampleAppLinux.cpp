@@ -66,7 +66,8 @@ public:
     {
         auto handled = static_cast<ImGuiImplLinuxX11*>(m_pImGui.get())->HandleXEvent(xev);
         // Always handle mouse move, button release and key release events
-        if (!handled || xev->type == ButtonRelease || xev->type == MotionNotify || xev->type == KeyRelease)
+        // There is no sample after the golden image suite is finished
+        if (m_TheSample && (!handled || xev->type == ButtonRelease || xev->type == MotionNotify || xev->type == KeyRelease))
         {
             handled = m_TheSample->GetInputController().HandleXEvent(xev);
         }
@@ -99,7 +100,8 @@ public:
         auto handled   = static_cast<ImGuiImplLinuxXCB*>(m_pImGui.get())->HandleXCBEvent(event);
         auto EventType = event->response_type & 0x7f;
         // Always handle mouse move, button release and key release events
-        if (!handled || EventType == XCB_MOTION_NOTIFY || EventType == XCB_BUTTON_RELEASE || EventType == XCB_KEY_RELEASE)
+        // There is no sample after the golden image suite is finished
+        if (m_TheSample && (!handled || EventType == XCB_MOTION_NOTIFY || EventType == XCB_BUTTON_RELEASE || EventType == XCB_KEY_RELEASE))
         {
             handled = m_TheSample->GetInputController().HandleXCBEvent(event);
         }
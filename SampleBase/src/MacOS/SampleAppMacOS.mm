@@ -133,6 +133,9 @@ public:
         }
 
         std::lock_guard<std::mutex> lock(AppMutex);
+        // There is no sample after the golden image suite is finished
+        if (!m_TheSample)
+            return;
         auto& inputController = m_TheSample->GetInputController();
 
         auto HandleKeyEvent = [](NSEvent* event, InputController& inputController)
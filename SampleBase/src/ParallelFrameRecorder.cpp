@@ -0,0 +1,283 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "ParallelFrameRecorder.hpp"
+
+#include <algorithm>
+
+#include "DebugUtilities.hpp"
+#include "Timer.hpp"
+
+namespace Diligent
+{
+
+ParallelFrameRecorder::~ParallelFrameRecorder()
+{
+    Stop();
+}
+
+void ParallelFrameRecorder::Start(const std::vector<RefCntAutoPtr<IDeviceContext>>& DeferredContexts, Uint32 NumWorkers)
+{
+    VERIFY(NumWorkers <= DeferredContexts.size(), "Every worker requires its own deferred context");
+    for (Uint32 i = 0; i < NumWorkers; ++i)
+        VERIFY(DeferredContexts[i] && DeferredContexts[i]->GetDesc().IsDeferred, "Worker ", i, " requires a deferred context");
+
+    StartWorkers(DeferredContexts.data(), NumWorkers);
+}
+
+void ParallelFrameRecorder::Start(Uint32 NumWorkers)
+{
+    StartWorkers(nullptr, NumWorkers);
+}
+
+void ParallelFrameRecorder::StartWorkers(const RefCntAutoPtr<IDeviceContext>* pDeferredContexts, Uint32 NumWorkers)
+{
+    VERIFY(m_Workers.empty(), "Worker threads are already running");
+
+    m_Stop = false;
+    m_Workers.resize(NumWorkers);
+    m_SubsetStats.assign(1 + NumWorkers, SubsetState{});
+    if (pDeferredContexts != nullptr)
+    {
+        for (Uint32 i = 0; i < NumWorkers; ++i)
+            m_Workers[i].pCtx = pDeferredContexts[i];
+    }
+    // Workers are started after the array is fully initialized. The current job ID is passed
+    // explicitly so that a new worker does not mistake the last completed job for a new one.
+    for (Uint32 i = 0; i < NumWorkers; ++i)
+        m_Workers[i].Thread = std::thread{&ParallelFrameRecorder::WorkerThreadFunc, this, i, m_JobId};
+}
+
+void ParallelFrameRecorder::Stop()
+{
+    if (m_Workers.empty())
+        return;
+
+    VERIFY(!m_RecordingInProgress, "Command lists recorded by the workers have not been executed");
+    Wait();
+
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        m_Stop = true;
+    }
+    m_JobCV.notify_all();
+
+    for (Worker& W : m_Workers)
+        W.Thread.join();
+    m_Workers.clear();
+}
+
+void ParallelFrameRecorder::Dispatch(JobType Type)
+{
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        VERIFY(m_NumPendingWorkers == 0, "The previous job has not been completed");
+        m_JobType           = Type;
+        m_NumPendingWorkers = GetNumWorkers();
+        ++m_JobId;
+    }
+    m_JobCV.notify_all();
+}
+
+void ParallelFrameRecorder::Wait()
+{
+    std::unique_lock<std::mutex> Lock{m_Mtx};
+    m_DoneCV.wait(Lock, [this] { return m_NumPendingWorkers == 0; });
+}
+
+void ParallelFrameRecorder::ParallelFor(const JobFunc& Job)
+{
+    if (m_Workers.empty())
+    {
+        Timer JobTimer;
+        Job(0);
+        m_SubsetStats[0].Stats.JobTime = JobTimer.GetElapsedTime();
+        return;
+    }
+
+    // The job is only referenced until Wait() returns, so there is no need to copy it
+    m_pJob = &Job;
+    Dispatch(JobType::Process);
+    {
+        Timer JobTimer;
+        Job(0);
+        m_SubsetStats[0].Stats.JobTime = JobTimer.GetElapsedTime();
+    }
+    Wait();
+    m_pJob = nullptr;
+}
+
+void ParallelFrameRecorder::BeginRecording(const RecordFunc& Record)
+{
+    VERIFY(!m_RecordingInProgress, "Command lists recorded by the workers have not been executed");
+    if (m_Workers.empty())
+        return;
+    VERIFY(m_Workers[0].pCtx, "Workers that were started without deferred contexts can't record commands");
+
+    // The function is only referenced until ExecuteCommandLists() waits for the workers
+    m_pRecord             = &Record;
+    m_RecordingInProgress = true;
+    Dispatch(JobType::Record);
+}
+
+void ParallelFrameRecorder::ExecuteCommandLists(IDeviceContext* pImmediateCtx)
+{
+    if (!m_RecordingInProgress)
+        return;
+
+    Wait();
+    m_pRecord = nullptr;
+
+    m_CmdListPtrs.clear();
+    for (Worker& W : m_Workers)
+    {
+        if (W.pCmdList)
+            m_CmdListPtrs.push_back(W.pCmdList);
+    }
+    pImmediateCtx->ExecuteCommandLists(static_cast<Uint32>(m_CmdListPtrs.size()), m_CmdListPtrs.data());
+
+    for (Worker& W : m_Workers)
+    {
+        // Release command lists now to release all outstanding references.
+        // In d3d11 mode, command lists hold references to the swap chain's back buffer
+        // that cause swap chain resize to fail.
+        W.pCmdList.Release();
+    }
+    m_RecordingInProgress = false;
+}
+
+void ParallelFrameRecorder::RecordFrame(IDeviceContext* pImmediateCtx, const RecordFunc& Record)
+{
+    BeginRecording(Record);
+    {
+        Timer JobTimer;
+        Record(pImmediateCtx, 0);
+        m_SubsetStats[0].Stats.JobTime = JobTimer.GetElapsedTime();
+    }
+    ExecuteCommandLists(pImmediateCtx);
+}
+
+void ParallelFrameRecorder::SetWorkItems(Uint32 NumItems, Uint32 ChunkSize)
+{
+    m_NumItems  = NumItems;
+    m_ChunkSize = ChunkSize;
+    m_NextItem.store(0, std::memory_order_relaxed);
+    for (SubsetState& State : m_SubsetStats)
+    {
+        State.Stats.NumItems  = 0;
+        State.Stats.NumChunks = 0;
+        State.SliceTaken      = false;
+    }
+    // The new values are published to the workers by the mutex when the next job is dispatched
+}
+
+bool ParallelFrameRecorder::NextChunk(Uint32 Subset, Uint32& Start, Uint32& End)
+{
+    SubsetState& State = m_SubsetStats[Subset];
+    if (m_ChunkSize == 0)
+    {
+        if (State.SliceTaken)
+            return false;
+        State.SliceTaken = true;
+
+        const Uint32 NumSubsets = GetNumSubsets();
+        Start                   = static_cast<Uint32>(Uint64{m_NumItems} * Subset / NumSubsets);
+        End                     = static_cast<Uint32>(Uint64{m_NumItems} * (Subset + 1) / NumSubsets);
+    }
+    else
+    {
+        // Only the counter itself needs to be atomic, so relaxed ordering is sufficient
+        Start = m_NextItem.fetch_add(m_ChunkSize, std::memory_order_relaxed);
+        if (Start >= m_NumItems)
+            return false;
+        End = std::min(Start + m_ChunkSize, m_NumItems);
+    }
+    if (Start >= End)
+        return false;
+
+    State.Stats.NumItems += End - Start;
+    ++State.Stats.NumChunks;
+    return true;
+}
+
+void ParallelFrameRecorder::WorkerThreadFunc(Uint32 WorkerId, Uint64 FirstJobId)
+{
+    Worker&      W         = m_Workers[WorkerId];
+    const Uint32 Subset    = 1 + WorkerId;
+    Uint64       LastJobId = FirstJobId;
+    for (;;)
+    {
+        JobType Type = JobType::Process;
+        {
+            std::unique_lock<std::mutex> Lock{m_Mtx};
+            m_JobCV.wait(Lock, [&] { return m_Stop || m_JobId != LastJobId; });
+            if (m_Stop)
+                break;
+            LastJobId = m_JobId;
+            Type      = m_JobType;
+        }
+
+        Timer JobTimer;
+        if (Type == JobType::Record)
+        {
+            if (W.FinishFramePending)
+            {
+                // The command list of the previous frame has been submitted by the time the next
+                // frame is dispatched, so the dynamic resources it used may now be released.
+                // IMPORTANT: In Metal backend FinishFrame must be called from the same
+                //            thread that issued rendering commands.
+                W.pCtx->FinishFrame();
+            }
+
+            W.pCtx->Begin(0);
+            (*m_pRecord)(W.pCtx, Subset);
+            W.pCtx->FinishCommandList(&W.pCmdList);
+            W.FinishFramePending = true;
+        }
+        else
+        {
+            (*m_pJob)(Subset);
+        }
+        m_SubsetStats[Subset].Stats.JobTime = JobTimer.GetElapsedTime();
+
+        bool AllDone = false;
+        {
+            std::lock_guard<std::mutex> Lock{m_Mtx};
+            AllDone = --m_NumPendingWorkers == 0;
+        }
+        if (AllDone)
+            m_DoneCV.notify_one();
+    }
+
+    if (W.FinishFramePending)
+    {
+        W.pCtx->FinishFrame();
+        W.FinishFramePending = false;
+    }
+}
+
+} // namespace Diligent
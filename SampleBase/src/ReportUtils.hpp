@@ -0,0 +1,101 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+// String helpers shared by the report writers of the sample base. Not part of the public interface.
+
+#include <string>
+
+namespace Diligent
+{
+
+namespace ReportUtils
+{
+
+inline std::string QuoteJSONString(const std::string& Str)
+{
+    std::string Quoted{'"'};
+    for (char c : Str)
+    {
+        if (c == '"' || c == '\\')
+            Quoted.push_back('\\');
+        Quoted.push_back(c >= 0 && c < ' ' ? ' ' : c);
+    }
+    Quoted.push_back('"');
+    return Quoted;
+}
+
+inline std::string QuoteCSVString(const std::string& Str)
+{
+    if (Str.find_first_of(",\"\n") == std::string::npos)
+        return Str;
+
+    std::string Quoted{'"'};
+    for (char c : Str)
+    {
+        if (c == '"')
+            Quoted.push_back('"');
+        Quoted.push_back(c);
+    }
+    Quoted.push_back('"');
+    return Quoted;
+}
+
+// Escapes the string for use in XML attribute values and text
+inline std::string EscapeXMLString(const std::string& Str)
+{
+    std::string Escaped;
+    Escaped.reserve(Str.size());
+    for (char c : Str)
+    {
+        switch (c)
+        {
+            // clang-format off
+            case '&':  Escaped += "&amp;";  break;
+            case '<':  Escaped += "&lt;";   break;
+            case '>':  Escaped += "&gt;";   break;
+            case '"':  Escaped += "&quot;"; break;
+            case '\'': Escaped += "&apos;"; break;
+            // clang-format on
+            default:
+                Escaped.push_back(c >= 0 && c < ' ' ? ' ' : c);
+        }
+    }
+    return Escaped;
+}
+
+// Returns true if the path ends with the given extension, e.g. ".csv"
+inline bool HasExtension(const std::string& Path, const char* Extension)
+{
+    const std::string Ext{Extension};
+    return Path.size() >= Ext.size() && Path.compare(Path.size() - Ext.size(), Ext.size(), Ext) == 0;
+}
+
+} // namespace ReportUtils
+
+} // namespace Diligent
@@ -0,0 +1,170 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+// Math helpers shared by the SIMD kernels of the sample base. Not part of the public interface.
+
+#include <cmath>
+
+#include "BasicTypes.h"
+
+// SSE2 is available on all x86-64 CPUs and is enabled by default by all compilers, so it is the only
+// vector instruction set the kernels use. Wider instruction sets would require per-file compiler flags
+// and runtime CPU detection.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define SAMPLE_BASE_SSE2 1
+#    include <emmintrin.h>
+#endif
+
+namespace Diligent
+{
+
+namespace SIMDMath
+{
+
+// Counter-based random number generator: hashes the key with the 'lowbias32' integer hash
+// (https://nullprogram.com/blog/2018/07/31/). All SIMD paths compute exactly the same value.
+constexpr Uint32 KeyMultiplier   = 0x9E3779B9u;
+constexpr Uint32 HashMultiplier0 = 0x7FEB352Du;
+constexpr Uint32 HashMultiplier1 = 0x846CA68Bu;
+constexpr float  Rcp24Bit        = 1.f / 16777216.f;
+
+inline Uint32 CounterHash(Uint32 Seed, Uint32 Index, Uint32 Counter)
+{
+    Uint32 x = (Index ^ Seed) * KeyMultiplier + Counter;
+    x ^= x >> 16;
+    x *= HashMultiplier0;
+    x ^= x >> 15;
+    x *= HashMultiplier1;
+    x ^= x >> 16;
+    return x;
+}
+
+// Top 24 bits give a uniformly distributed float in [0, 1)
+inline float HashToUnorm(Uint32 Hash)
+{
+    return static_cast<float>(Hash >> 8) * Rcp24Bit;
+}
+
+// Sine and cosine approximation used to build instance matrices: the angle is reduced to [-pi, pi],
+// then folded to [-pi/2, pi/2] where a degree-9 polynomial has an error below 4e-6.
+constexpr float TwoPi     = 6.28318530717958647692f;
+constexpr float InvTwoPi  = 0.15915494309189533577f;
+constexpr float TwoPiHi   = 6.28125f; // Exactly representable high part of 2*pi
+constexpr float TwoPiLo   = 1.9353071795864769253e-3f;
+constexpr float Pi        = 3.14159265358979323846f;
+constexpr float HalfPi    = 1.57079632679489661923f;
+constexpr float SinCoeff3 = -1.f / 6.f;
+constexpr float SinCoeff5 = 1.f / 120.f;
+constexpr float SinCoeff7 = -1.f / 5040.f;
+constexpr float SinCoeff9 = 1.f / 362880.f;
+static_assert(TwoPiHi + TwoPiLo == TwoPi, "Incorrect 2*pi split");
+
+inline float SinPoly(float x)
+{
+    const float x2 = x * x;
+    return x + x * x2 * (SinCoeff3 + x2 * (SinCoeff5 + x2 * (SinCoeff7 + x2 * SinCoeff9)));
+}
+
+inline void SinCos(float Angle, float& Sin, float& Cos)
+{
+    const float k = std::nearbyint(Angle * InvTwoPi);
+    const float x = (Angle - k * TwoPiHi) - k * TwoPiLo;
+
+    // sin(x) = sin(pi - x) folds [pi/2, pi] and [-pi, -pi/2] to [-pi/2, pi/2]
+    const float s = x > HalfPi ? Pi - x : (x < -HalfPi ? -Pi - x : x);
+    // cos(x) = sin(x + pi/2), where x + pi/2 is in [-pi/2, 3pi/2]
+    const float c = x + HalfPi > HalfPi ? Pi - (x + HalfPi) : x + HalfPi;
+
+    Sin = SinPoly(s);
+    Cos = SinPoly(c);
+}
+
+#if SAMPLE_BASE_SSE2
+// SSE2 has no 32-bit low multiplication, so combine the even and odd lane products
+inline __m128i MulLo32(__m128i a, __m128i b)
+{
+    const __m128i Even = _mm_mul_epu32(a, b);
+    const __m128i Odd  = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(Even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(Odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+inline __m128 Select(__m128 a, __m128 b, __m128 Mask)
+{
+    return _mm_or_ps(_mm_andnot_ps(Mask, a), _mm_and_ps(Mask, b));
+}
+
+// Same as CounterHash() for four keys
+inline __m128i CounterHash4(__m128i Seed, __m128i Index, __m128i Counter)
+{
+    __m128i x = _mm_add_epi32(MulLo32(_mm_xor_si128(Index, Seed), _mm_set1_epi32(static_cast<int>(KeyMultiplier))), Counter);
+    x         = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    x         = MulLo32(x, _mm_set1_epi32(static_cast<int>(HashMultiplier0)));
+    x         = _mm_xor_si128(x, _mm_srli_epi32(x, 15));
+    x         = MulLo32(x, _mm_set1_epi32(static_cast<int>(HashMultiplier1)));
+    x         = _mm_xor_si128(x, _mm_srli_epi32(x, 16));
+    return x;
+}
+
+inline __m128 HashToUnorm4(__m128i Hash)
+{
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(Hash, 8)), _mm_set1_ps(Rcp24Bit));
+}
+
+inline __m128 SinPoly4(__m128 x)
+{
+    const __m128 x2 = _mm_mul_ps(x, x);
+    __m128       p  = _mm_add_ps(_mm_set1_ps(SinCoeff7), _mm_mul_ps(x2, _mm_set1_ps(SinCoeff9)));
+    p               = _mm_add_ps(_mm_set1_ps(SinCoeff5), _mm_mul_ps(x2, p));
+    p               = _mm_add_ps(_mm_set1_ps(SinCoeff3), _mm_mul_ps(x2, p));
+    return _mm_add_ps(x, _mm_mul_ps(_mm_mul_ps(x, x2), p));
+}
+
+inline void SinCos4(__m128 Angle, __m128& Sin, __m128& Cos)
+{
+    // _mm_cvtps_epi32 rounds to nearest, same as std::nearbyint in the default rounding mode
+    const __m128 k = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(Angle, _mm_set1_ps(InvTwoPi))));
+    const __m128 x = _mm_sub_ps(_mm_sub_ps(Angle, _mm_mul_ps(k, _mm_set1_ps(TwoPiHi))), _mm_mul_ps(k, _mm_set1_ps(TwoPiLo)));
+
+    const __m128 PiV     = _mm_set1_ps(Pi);
+    const __m128 HalfPiV = _mm_set1_ps(HalfPi);
+
+    __m128 s = Select(x, _mm_sub_ps(PiV, x), _mm_cmpgt_ps(x, HalfPiV));
+    s        = Select(s, _mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), PiV), x), _mm_cmplt_ps(x, _mm_sub_ps(_mm_setzero_ps(), HalfPiV)));
+
+    const __m128 xc = _mm_add_ps(x, HalfPiV);
+    const __m128 c  = Select(xc, _mm_sub_ps(PiV, xc), _mm_cmpgt_ps(xc, HalfPiV));
+
+    Sin = SinPoly4(s);
+    Cos = SinPoly4(c);
+}
+#endif
+
+} // namespace SIMDMath
+
+} // namespace Diligent
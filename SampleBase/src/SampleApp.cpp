@@ -25,10 +25,13 @@
 *  of the possibility of such damages.
 */
 
+#include <algorithm>
 #include <sstream>
 #include <iomanip>
 #include <cstdlib>
 #include <cmath>
+#include <cctype>
+#include <thread>
 
 #include "PlatformDefinitions.h"
 #include "SampleApp.hpp"
@@ -39,7 +42,13 @@
 #include "FileWrapper.hpp"
 #include "CommandLineParser.hpp"
 #include "GraphicsAccessories.hpp"
-#include "ImageTools.h"
+#include "DurationQueryHelper.hpp"
+#include "FileSystem.hpp"
+#include "DataBlobImpl.hpp"
+#include "AsyncInitTaskGraph.hpp"
+#include "AllocationTracker.hpp"
+#include "InputRecording.hpp"
+#include "GoldenImageComparer.hpp"
 
 #if D3D11_SUPPORTED
 #    include "EngineFactoryD3D11.h"
@@ -73,9 +82,168 @@
 #    include <emscripten/html5_webgpu.h>
 #endif
 
+#if PLATFORM_WIN32
+#    include <direct.h>
+#elif PLATFORM_LINUX || PLATFORM_MACOS
+#    include <unistd.h>
+#endif
+
 namespace Diligent
 {
 
+namespace
+{
+
+// DeviceFeatures only consists of DEVICE_FEATURE_STATE members, so the states of all features can be processed in a loop
+constexpr size_t NumDeviceFeatures = sizeof(DeviceFeatures) / sizeof(DEVICE_FEATURE_STATE);
+
+DEVICE_FEATURE_STATE* GetFeatureStates(DeviceFeatures& Features)
+{
+    return reinterpret_cast<DEVICE_FEATURE_STATE*>(&Features);
+}
+
+const DEVICE_FEATURE_STATE* GetFeatureStates(const DeviceFeatures& Features)
+{
+    return reinterpret_cast<const DEVICE_FEATURE_STATE*>(&Features);
+}
+
+// Returns true if all features that are enabled in RequiredFeatures are also enabled in EnabledFeatures
+bool AreFeaturesEnabled(const DeviceFeatures& RequiredFeatures, const DeviceFeatures& EnabledFeatures)
+{
+    const DEVICE_FEATURE_STATE* pRequired = GetFeatureStates(RequiredFeatures);
+    const DEVICE_FEATURE_STATE* pEnabled  = GetFeatureStates(EnabledFeatures);
+    for (size_t i = 0; i < NumDeviceFeatures; ++i)
+    {
+        if (pRequired[i] == DEVICE_FEATURE_STATE_ENABLED && pEnabled[i] != DEVICE_FEATURE_STATE_ENABLED)
+            return false;
+    }
+    return true;
+}
+
+template <typename EngineCIType>
+bool ModifyEngineCICopy(EngineCreateInfo& EngineCI, const std::function<bool(EngineCreateInfo&)>& Handler)
+{
+    EngineCIType EngineCICopy = static_cast<const EngineCIType&>(EngineCI);
+    if (!Handler(EngineCICopy))
+        return false;
+
+    static_cast<EngineCIType&>(EngineCI) = EngineCICopy;
+    return true;
+}
+
+// Calls Handler with a copy of EngineCI of the type that corresponds to the device type, so that the
+// backend-specific members can be modified too. The copy is written back if Handler returns true.
+bool ModifyEngineCICopy(RENDER_DEVICE_TYPE DeviceType, EngineCreateInfo& EngineCI, const std::function<bool(EngineCreateInfo&)>& Handler)
+{
+    switch (DeviceType)
+    {
+#if D3D11_SUPPORTED
+        case RENDER_DEVICE_TYPE_D3D11:
+            return ModifyEngineCICopy<EngineD3D11CreateInfo>(EngineCI, Handler);
+#endif
+
+#if D3D12_SUPPORTED
+        case RENDER_DEVICE_TYPE_D3D12:
+            return ModifyEngineCICopy<EngineD3D12CreateInfo>(EngineCI, Handler);
+#endif
+
+#if GL_SUPPORTED || GLES_SUPPORTED
+        case RENDER_DEVICE_TYPE_GL:
+        case RENDER_DEVICE_TYPE_GLES:
+            return ModifyEngineCICopy<EngineGLCreateInfo>(EngineCI, Handler);
+#endif
+
+#if VULKAN_SUPPORTED
+        case RENDER_DEVICE_TYPE_VULKAN:
+            return ModifyEngineCICopy<EngineVkCreateInfo>(EngineCI, Handler);
+#endif
+
+#if METAL_SUPPORTED
+        case RENDER_DEVICE_TYPE_METAL:
+            return ModifyEngineCICopy<EngineMtlCreateInfo>(EngineCI, Handler);
+#endif
+
+#if WEBGPU_SUPPORTED
+        case RENDER_DEVICE_TYPE_WEBGPU:
+            return ModifyEngineCICopy<EngineWebGPUCreateInfo>(EngineCI, Handler);
+#endif
+
+        default:
+            UNEXPECTED("Unexpected device type");
+            return false;
+    }
+}
+
+std::string GetWorkingDirectory()
+{
+    char Path[4096] = {};
+#if PLATFORM_WIN32
+    if (_getcwd(Path, sizeof(Path)) == nullptr)
+        Path[0] = '\0';
+#elif PLATFORM_LINUX || PLATFORM_MACOS
+    if (getcwd(Path, sizeof(Path)) == nullptr)
+        Path[0] = '\0';
+#endif
+    return Path;
+}
+
+bool SetWorkingDirectory(const char* Path)
+{
+#if PLATFORM_WIN32
+    return _chdir(Path) == 0;
+#elif PLATFORM_LINUX || PLATFORM_MACOS
+    return chdir(Path) == 0;
+#else
+    return false;
+#endif
+}
+
+std::string MakeAbsolutePath(const std::string& Path, const std::string& BaseDir)
+{
+    if (Path.empty() || FileSystem::IsPathAbsolute(Path.c_str()))
+        return Path;
+    return BaseDir + FileSystem::SlashSymbol + Path;
+}
+
+// Returns the name of the local application data directory of the sample, e.g.
+// "DiligentEngine-Tutorial27_Post_Processing" for "Tutorial27: Post Processing"
+std::string GetRenderStateCacheAppName(const char* SampleName)
+{
+    std::string AppName = "DiligentEngine-";
+    for (const char* c = SampleName; *c != '\0'; ++c)
+    {
+        if (std::isalnum(static_cast<unsigned char>(*c)))
+            AppName.push_back(*c);
+        else if (AppName.back() != '_' && AppName.back() != '-')
+            AppName.push_back('_');
+    }
+    while (AppName.back() == '_')
+        AppName.pop_back();
+    return AppName;
+}
+
+const char* GetGoldenImageErrorString(int ExitCode)
+{
+    switch (ExitCode)
+    {
+        // clang-format off
+        case 1:  return "Screen capture is not available";
+        case 2:  return "Failed to load the golden image";
+        case 3:  return "Golden image width does not match the captured image width";
+        case 4:  return "Golden image height does not match the captured image height";
+        case 5:  return "Failed to write the screen capture file";
+        case 6:  return "Failed to create the screen capture file";
+        case 7:  return "Failed to write the output file";
+        case 8:  return "Memory was allocated in a steady-state frame";
+        case 9:  return "Failed to write the video file";
+        case 10: return "Golden image validation failed";
+        // clang-format on
+        default: return "Unexpected error";
+    }
+}
+
+} // namespace
+
 SampleApp::SampleApp() :
     m_TheSample{CreateSample()},
     m_AppTitle{m_TheSample->GetSampleName()}
@@ -85,9 +253,18 @@ SampleApp::SampleApp() :
 
 SampleApp::~SampleApp()
 {
+    // The initialization tasks reference the sample
+    m_pInitTasks.reset();
     m_pImGui.reset();
     m_TheSample.reset();
 
+    FinishVideoCapture();
+
+    SaveRenderStateCache();
+    m_pRenderStateCache.Release();
+
+    SaveInputRecording();
+
     if (!m_pDeviceContexts.empty())
     {
         for (Uint32 q = 0; q < m_NumImmediateContexts; ++q)
@@ -133,7 +310,7 @@ void SampleApp::UpdateAppSettings(bool IsInitialization)
 
 void SampleApp::InitializeDiligentEngine(const NativeWindow* pWindow)
 {
-    if (m_ScreenCaptureInfo.AllowCapture)
+    if (m_ScreenCaptureInfo.AllowCapture || !m_VideoCaptureCI.Path.empty())
         m_SwapChainInitDesc.Usage |= SWAP_CHAIN_USAGE_COPY_SOURCE;
 
 #if PLATFORM_MACOS
@@ -248,7 +425,7 @@ void SampleApp::InitializeDiligentEngine(const NativeWindow* pWindow)
                 EngineCI.SetValidationLevel(static_cast<VALIDATION_LEVEL>(m_ValidationLevel));
 
             EngineCI.AdapterId = FindAdapter(pFactoryD3D11, EngineCI.GraphicsAPIVersion, m_AdapterAttribs);
-            m_TheSample->ModifyEngineInitInfo({pFactoryD3D11, m_DeviceType, EngineCI, m_SwapChainInitDesc});
+            ModifyEngineInitInfo({pFactoryD3D11, m_DeviceType, EngineCI, m_SwapChainInitDesc});
 
             if (m_AdapterType != ADAPTER_TYPE_SOFTWARE && EngineCI.AdapterId != DEFAULT_ADAPTER_ID)
             {
@@ -309,7 +486,7 @@ void SampleApp::InitializeDiligentEngine(const NativeWindow* pWindow)
 #    endif
             }
 
-            m_TheSample->ModifyEngineInitInfo({pFactoryD3D12, m_DeviceType, EngineCI, m_SwapChainInitDesc});
+            ModifyEngineInitInfo({pFactoryD3D12, m_DeviceType, EngineCI, m_SwapChainInitDesc});
 
             if (m_AdapterType != ADAPTER_TYPE_SOFTWARE && EngineCI.AdapterId != DEFAULT_ADAPTER_ID)
             {
@@ -359,7 +536,7 @@ void SampleApp::InitializeDiligentEngine(const NativeWindow* pWindow)
             if (m_ValidationLevel >= 0)
                 EngineCI.SetValidationLevel(static_cast<VALIDATION_LEVEL>(m_ValidationLevel));
 
-            m_TheSample->ModifyEngineInitInfo({pFactoryOpenGL, m_DeviceType, EngineCI, m_SwapChainInitDesc});
+            ModifyEngineInitInfo({pFactoryOpenGL, m_DeviceType, EngineCI, m_SwapChainInitDesc});
 
             if (m_bForceNonSeprblProgs)
                 EngineCI.Features.SeparablePrograms = DEVICE_FEATURE_STATE_DISABLED;
@@ -408,7 +585,7 @@ void SampleApp::InitializeDiligentEngine(const NativeWindow* pWindow)
             m_pEngineFactory             = pFactoryVk;
 
             EngineCI.AdapterId = FindAdapter(pFactoryVk, EngineCI.GraphicsAPIVersion, m_AdapterAttribs);
-            m_TheSample->ModifyEngineInitInfo({pFactoryVk, m_DeviceType, EngineCI, m_SwapChainInitDesc});
+            ModifyEngineInitInfo({pFactoryVk, m_DeviceType, EngineCI, m_SwapChainInitDesc});
 
             if (m_bVulkanCompatibilityMode)
             {
@@ -441,7 +618,7 @@ void SampleApp::InitializeDiligentEngine(const NativeWindow* pWindow)
             IEngineFactoryMtl* pFactoryMtl = GetEngineFactoryMtl();
             m_pEngineFactory               = pFactoryMtl;
 
-            m_TheSample->ModifyEngineInitInfo({pFactoryMtl, m_DeviceType, EngineCI, m_SwapChainInitDesc});
+            ModifyEngineInitInfo({pFactoryMtl, m_DeviceType, EngineCI, m_SwapChainInitDesc});
 
             NumImmediateContexts = std::max(1u, EngineCI.NumImmediateContexts);
             ppContexts.resize(NumImmediateContexts + EngineCI.NumDeferredContexts);
@@ -474,7 +651,7 @@ void SampleApp::InitializeDiligentEngine(const NativeWindow* pWindow)
 
             NumImmediateContexts = std::max(1u, EngineCI.NumImmediateContexts);
             ppContexts.resize(NumImmediateContexts + EngineCI.NumDeferredContexts);
-            m_TheSample->ModifyEngineInitInfo({pFactoryWebGPU, m_DeviceType, EngineCI, m_SwapChainInitDesc});
+            ModifyEngineInitInfo({pFactoryWebGPU, m_DeviceType, EngineCI, m_SwapChainInitDesc});
 
             if (EngineCI.NumDeferredContexts != 0)
             {
@@ -529,6 +706,9 @@ void SampleApp::InitializeDiligentEngine(const NativeWindow* pWindow)
 
         m_pScreenCapture.reset(new ScreenCapture(m_pDevice));
     }
+
+    if (!m_VideoCaptureCI.Path.empty())
+        m_pVideoCapture = std::make_unique<VideoCapture>(m_pDevice, m_pSwapChain, m_VideoCaptureCI);
 }
 
 void SampleApp::InitializeSample()
@@ -570,9 +750,336 @@ void SampleApp::InitializeSample()
     InitInfo.NumDeferredCtx = static_cast<Uint32>(m_pDeviceContexts.size()) - m_NumImmediateContexts;
     InitInfo.pSwapChain     = m_pSwapChain;
     InitInfo.pImGui         = m_pImGui.get();
-    m_TheSample->Initialize(InitInfo);
 
+    // Golden image runs always compile shaders from source, so that they are not affected by the cache contents
+    if (m_bUseRenderStateCache && !m_pRenderStateCache && m_GoldenImgMode == GoldenImageMode::None)
+        LoadRenderStateCache();
+    InitInfo.pStateCache = m_pRenderStateCache;
+
+    m_SampleInitStartTime = m_StartupTimer.GetElapsedTime();
+
+    // Golden image modes capture the first frame, so the sample must be fully initialized before it is rendered
+    const bool InitializeAsync = m_bAsyncInit && m_GoldenImgMode == GoldenImageMode::None;
+
+    std::unique_ptr<AsyncInitTaskGraph> pInitTasks;
+
+    auto InitializeTheSample = [&]() {
+        pInitTasks = std::make_unique<AsyncInitTaskGraph>();
+        m_TheSample->Initialize(InitInfo);
+        m_TheSample->CreateInitializationTasks(*pInitTasks);
+        if (!InitializeAsync || pInitTasks->GetNumTasks() == 0)
+        {
+            pInitTasks->Wait();
+            m_TheSample->FinishInitialization();
+        }
+    };
+
+    if (m_pGoldenImgSuite)
+    {
+        if (!CreateNextSuiteSample(InitializeTheSample))
+        {
+            FinishGoldenImageSuite();
+            return;
+        }
+    }
+    else
+    {
+        InitializeTheSample();
+    }
+
+    if (InitializeAsync && pInitTasks->GetNumTasks() > 0)
+    {
+        // The app presents the progress overlay until all tasks are complete, see Update()
+        pInitTasks->Start(std::max(std::thread::hardware_concurrency(), 2u) - 1u);
+        m_pInitTasks = std::move(pInitTasks);
+        return;
+    }
+
+    FinishSampleInitialization();
+}
+
+void SampleApp::FinishSampleInitialization()
+{
+    const SwapChainDesc& SCDesc = m_pSwapChain->GetDesc();
     m_TheSample->WindowResize(SCDesc.Width, SCDesc.Height);
+
+    m_SampleInitTime = m_StartupTimer.GetElapsedTime() - m_SampleInitStartTime;
+
+    if (m_pBenchmark && m_pDevice->GetDeviceInfo().Features.TimestampQueries)
+        m_pGPUFrameTimer.reset(new DurationQueryHelper{m_pDevice, m_MaxFrameLatency + 1});
+}
+
+void SampleApp::UpdateProgressOverlay()
+{
+    const SwapChainDesc&             SCDesc = m_pSwapChain->GetDesc();
+    const AsyncInitTaskGraph::Status Status = m_pInitTasks->GetStatus();
+
+    const float WndWidth = std::min(400.f, static_cast<float>(SCDesc.Width));
+    ImGui::SetNextWindowSize(ImVec2(WndWidth, 0), ImGuiCond_Always);
+    ImGui::SetNextWindowPos(ImVec2(static_cast<float>(SCDesc.Width) * 0.5f, static_cast<float>(SCDesc.Height) * 0.5f), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
+    if (ImGui::Begin("Loading", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings))
+    {
+        ImGui::TextUnformatted(m_TheSample->GetSampleName());
+        ImGui::ProgressBar(Status.Progress);
+        ImGui::Text("%u of %u tasks complete", Status.NumCompletedTasks, m_pInitTasks->GetNumTasks());
+        if (!Status.RunningTasks.empty())
+            ImGui::TextWrapped("%s", Status.RunningTasks.c_str());
+    }
+    ImGui::End();
+}
+
+void SampleApp::EndAllocationTrackingFrame()
+{
+    // Frames of the benchmark are measured after the warm-up, other frames after the same number
+    // of frames since the sample has been initialized.
+    const bool IsSteadyState = !m_pInitTasks &&
+        (m_pBenchmark ? !m_pBenchmark->IsWarmup() && !m_pBenchmark->IsComplete() : m_NumInteractiveFrames >= m_BenchmarkSettings.NumWarmupFrames);
+    m_pAllocTracker->EndFrame(IsSteadyState);
+
+    if (!IsSteadyState || !m_bAssertNoAllocations)
+        return;
+
+    for (Uint32 Phase = 0; Phase < AllocationTracker::PHASE_COUNT; ++Phase)
+    {
+        const AllocationTracker::Counters& Counters = m_pAllocTracker->GetLastFrameCounters(static_cast<AllocationTracker::PHASE>(Phase));
+        if (Counters.NumAllocations == 0)
+            continue;
+
+        // Only the first frame that allocates memory is reported to not flood the log
+        if (m_ExitCode != 8)
+        {
+            LOG_ERROR_MESSAGE("Frame ", m_NumInteractiveFrames, ": ", AllocationTracker::GetPhaseName(static_cast<AllocationTracker::PHASE>(Phase)),
+                              " phase made ", Counters.NumAllocations, " allocations (", Counters.NumBytes, " bytes) in steady state");
+        }
+        m_ExitCode = 8;
+    }
+}
+
+void SampleApp::UpdateAllocationsWindow()
+{
+    // This window must not allocate memory itself, so the text is only formatted by ImGui
+    ImGui::SetNextWindowPos(ImVec2(10, static_cast<float>(m_pSwapChain->GetDesc().Height) - 10), ImGuiCond_FirstUseEver, ImVec2(0, 1));
+    if (ImGui::Begin("Allocations", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
+    {
+        ImGui::TextUnformatted("Phase     Allocs      Bytes   Avg allocs");
+        for (Uint32 Phase = 0; Phase < AllocationTracker::PHASE_COUNT; ++Phase)
+        {
+            const AllocationTracker::Counters&   Counters = m_pAllocTracker->GetLastFrameCounters(static_cast<AllocationTracker::PHASE>(Phase));
+            const AllocationTracker::Statistics& Stats    = m_pAllocTracker->GetStatistics(static_cast<AllocationTracker::PHASE>(Phase));
+            ImGui::Text("%-8s %7llu %10llu %12.1f", AllocationTracker::GetPhaseName(static_cast<AllocationTracker::PHASE>(Phase)),
+                        static_cast<unsigned long long>(Counters.NumAllocations), static_cast<unsigned long long>(Counters.NumBytes),
+                        Stats.NumFrames > 0 ? static_cast<double>(Stats.TotalAllocations) / Stats.NumFrames : 0.0);
+        }
+        if (m_bAssertNoAllocations)
+        {
+            if (m_ExitCode == 8)
+                ImGui::TextColored(ImVec4{1, 0.25f, 0.25f, 1}, "Steady-state allocations detected");
+            else
+                ImGui::TextColored(ImVec4{0.25f, 1, 0.25f, 1}, "No steady-state allocations");
+        }
+    }
+    ImGui::End();
+}
+
+void SampleApp::LoadRenderStateCache()
+{
+    RenderStateCacheCreateInfo CacheCI;
+    CacheCI.pDevice  = m_pDevice;
+    CacheCI.LogLevel = RENDER_STATE_CACHE_LOG_LEVEL_NORMAL;
+    CreateRenderStateCache(CacheCI, &m_pRenderStateCache);
+    if (!m_pRenderStateCache)
+    {
+        LOG_ERROR_MESSAGE("Failed to create render state cache");
+        return;
+    }
+    m_RenderStateCacheStatus = "cold";
+
+    m_RenderStateCachePath = FileSystem::GetLocalAppDataDirectory(GetRenderStateCacheAppName(m_TheSample->GetSampleName()).c_str());
+    if (!FileSystem::PathExists(m_RenderStateCachePath.c_str()))
+        FileSystem::CreateDirectory(m_RenderStateCachePath.c_str());
+
+    if (!FileSystem::IsSlash(m_RenderStateCachePath.back()))
+        m_RenderStateCachePath.push_back(FileSystem::SlashSymbol);
+
+    // Shaders and pipeline states are device-specific and differ between debug and release builds,
+    // so every device type and build configuration uses its own cache file.
+    m_RenderStateCachePath += "state_cache_";
+    m_RenderStateCachePath += GetRenderDeviceTypeShortString(m_DeviceType);
+#ifdef DILIGENT_DEBUG
+    m_RenderStateCachePath += "_d";
+#else
+    m_RenderStateCachePath += "_r";
+#endif
+    m_RenderStateCachePath += ".bin";
+
+    if (!FileSystem::FileExists(m_RenderStateCachePath.c_str()))
+    {
+        LOG_INFO_MESSAGE("Render state cache file '", m_RenderStateCachePath, "' does not exist");
+        return;
+    }
+
+    FileWrapper                 CacheDataFile{m_RenderStateCachePath.c_str()};
+    RefCntAutoPtr<DataBlobImpl> pCacheData = DataBlobImpl::Create();
+    if (CacheDataFile && CacheDataFile->Read(pCacheData) && m_pRenderStateCache->Load(pCacheData))
+    {
+        LOG_INFO_MESSAGE("Loaded render state cache file '", m_RenderStateCachePath, "' (", FormatMemorySize(pCacheData->GetSize()), ")");
+        m_RenderStateCacheStatus = "warm";
+    }
+    else
+    {
+        LOG_WARNING_MESSAGE("Failed to load render state cache file '", m_RenderStateCachePath, "'. The cache will be rebuilt.");
+    }
+}
+
+void SampleApp::SaveRenderStateCache()
+{
+    if (!m_pRenderStateCache || m_RenderStateCachePath.empty())
+        return;
+
+    RefCntAutoPtr<IDataBlob> pCacheData;
+    if (!m_pRenderStateCache->WriteToBlob(0, &pCacheData) || !pCacheData)
+    {
+        LOG_ERROR_MESSAGE("Failed to write render state cache data");
+        return;
+    }
+
+    FileWrapper CacheDataFile{m_RenderStateCachePath.c_str(), EFileAccessMode::Overwrite};
+    if (CacheDataFile && CacheDataFile->Write(pCacheData->GetConstDataPtr(), pCacheData->GetSize()))
+    {
+        LOG_INFO_MESSAGE("Saved render state cache file '", m_RenderStateCachePath, "' (", FormatMemorySize(pCacheData->GetSize()), ")");
+    }
+    else
+    {
+        LOG_ERROR_MESSAGE("Failed to save render state cache file '", m_RenderStateCachePath, "'");
+    }
+}
+
+void SampleApp::RecordOrReplayInput()
+{
+    InputController& Controller = m_TheSample->GetInputController();
+    // Frames are counted from the first frame of the initialized sample, which is also the first benchmark frame
+    const Uint32 Frame = m_NumInteractiveFrames;
+
+    if (!m_bReplayInput)
+    {
+        m_pInputRecording->AddFrame(Frame, Controller.GetState());
+        return;
+    }
+
+    InputState State;
+    if (m_pInputRecording->GetFrame(Frame, State))
+    {
+        Controller.SetState(State);
+        return;
+    }
+
+    if (Frame == m_pInputRecording->GetNumFrames())
+    {
+        LOG_INFO_MESSAGE("Input replay finished after ", Frame, " frames");
+    }
+
+    if (m_pBenchmark)
+    {
+        // Benchmark frames past the end of the recording must not depend on the live input either,
+        // so the camera stays where the recording has left it
+        if (m_pInputRecording->GetNumFrames() > 0)
+            m_pInputRecording->GetFrame(m_pInputRecording->GetNumFrames() - 1, State);
+        State.Mouse.ButtonFlags = MouseState::BUTTON_FLAG_NONE;
+        State.Mouse.WheelDelta  = 0;
+        for (INPUT_KEY_STATE_FLAGS& Key : State.Keys)
+            Key = INPUT_KEY_STATE_FLAG_KEY_NONE;
+        Controller.SetState(State);
+    }
+}
+
+void SampleApp::FinishVideoCapture()
+{
+    if (!m_pVideoCapture)
+        return;
+
+    if (!m_pVideoCapture->Finish(GetImmediateContext()))
+        m_ExitCode = 9;
+    m_pVideoCapture.reset();
+}
+
+void SampleApp::SaveInputRecording()
+{
+    if (!m_pInputRecording || m_bReplayInput)
+        return;
+
+    if (!m_pInputRecording->Save(m_InputRecordingPath.c_str()))
+        m_ExitCode = 7;
+    m_pInputRecording.reset();
+}
+
+void SampleApp::ModifyEngineInitInfo(const SampleBase::ModifyEngineInitInfoAttribs& Attribs)
+{
+    m_TheSample->ModifyEngineInitInfo(Attribs);
+
+    if (m_pGoldenImgSuite)
+    {
+        // All samples of the suite share the device and the swap chain. Every sample modifies its own copy of the
+        // create info, and only the changes that do not affect other samples are merged into the shared one:
+        // the device is created with the features that any of the samples requests, with the largest number of
+        // deferred contexts and with the backend-specific settings, such as dynamic heap sizes, of the last sample
+        // that changes them. Features that a sample requires are only requested as optional, so that the device
+        // can always be created, and the samples whose required features are not supported are skipped.
+        // Samples that need a specific adapter, custom immediate contexts or different swap chain formats
+        // can't share the device and the swap chain and are skipped too.
+        const std::vector<GoldenImageSuite::SampleInfo>& Samples = GoldenImageSuite::GetRegisteredSamples();
+        m_SuiteRequiredFeatures.assign(Samples.size(), DeviceFeatures{});
+        m_SuiteSkipReasons.assign(Samples.size(), nullptr);
+        for (size_t i = 0; i < Samples.size(); ++i)
+        {
+            std::unique_ptr<SampleBase> pSample{Samples[i].Create()};
+
+            ModifyEngineCICopy(Attribs.DeviceType, Attribs.EngineCI, [&](EngineCreateInfo& SampleEngineCI) {
+                SwapChainDesc SampleSCDesc = Attribs.SCDesc;
+                pSample->ModifyEngineInitInfo({Attribs.pFactory, Attribs.DeviceType, SampleEngineCI, SampleSCDesc});
+
+                if (SampleEngineCI.AdapterId != Attribs.EngineCI.AdapterId)
+                    m_SuiteSkipReasons[i] = "The sample requires a specific adapter";
+                else if (SampleEngineCI.NumImmediateContexts != Attribs.EngineCI.NumImmediateContexts ||
+                         SampleEngineCI.pImmediateContextInfo != Attribs.EngineCI.pImmediateContextInfo)
+                    m_SuiteSkipReasons[i] = "The sample requires custom immediate contexts";
+                else if (SampleSCDesc.ColorBufferFormat != Attribs.SCDesc.ColorBufferFormat ||
+                         SampleSCDesc.DepthBufferFormat != Attribs.SCDesc.DepthBufferFormat)
+                    m_SuiteSkipReasons[i] = "The sample requires different swap chain formats";
+                if (m_SuiteSkipReasons[i] != nullptr)
+                    return false;
+
+                const DEVICE_FEATURE_STATE* pSharedStates = GetFeatureStates(Attribs.EngineCI.Features);
+                DEVICE_FEATURE_STATE*       pStates       = GetFeatureStates(SampleEngineCI.Features);
+                DEVICE_FEATURE_STATE*       pRequired     = GetFeatureStates(m_SuiteRequiredFeatures[i]);
+                for (size_t f = 0; f < NumDeviceFeatures; ++f)
+                {
+                    if (pStates[f] == DEVICE_FEATURE_STATE_ENABLED)
+                    {
+                        pRequired[f] = DEVICE_FEATURE_STATE_ENABLED;
+                        pStates[f]   = DEVICE_FEATURE_STATE_OPTIONAL;
+                    }
+                    else if (pStates[f] == DEVICE_FEATURE_STATE_DISABLED)
+                    {
+                        // Keep the features requested by other samples
+                        pStates[f] = pSharedStates[f];
+                    }
+                }
+                SampleEngineCI.NumDeferredContexts = std::max(SampleEngineCI.NumDeferredContexts, Attribs.EngineCI.NumDeferredContexts);
+
+                return true;
+            });
+        }
+    }
+
+    EnableBenchmarkFeatures(Attribs.EngineCI);
+}
+
+void SampleApp::EnableBenchmarkFeatures(EngineCreateInfo& EngineCI) const
+{
+    // GPU frame time is measured with timestamp queries when the device supports them.
+    // Software adapters typically do not, in which case only CPU times are reported.
+    if (m_pBenchmark && EngineCI.Features.TimestampQueries == DEVICE_FEATURE_STATE_DISABLED)
+        EngineCI.Features.TimestampQueries = DEVICE_FEATURE_STATE_OPTIONAL;
 }
 
 void SampleApp::UpdateAdaptersDialog()
@@ -700,6 +1207,7 @@ SampleApp::CommandLineStatus SampleApp::ProcessCommandLine(int argc, const char*
 
     ArgsParser.Parse("mode", 'm',
                      [&](const char* ArgVal) {
+                         m_ModeName = ArgVal;
                          if (StrCmpNoCase(ArgVal, "d3d11_sw") == 0)
                          {
                              m_DeviceType  = RENDER_DEVICE_TYPE_D3D11;
@@ -803,6 +1311,13 @@ SampleApp::CommandLineStatus SampleApp::ProcessCommandLine(int argc, const char*
 
     ArgsParser.Parse("capture_quality", m_ScreenCaptureInfo.JpegQuality);
     ArgsParser.Parse("capture_alpha", m_ScreenCaptureInfo.KeepAlpha);
+
+    ArgsParser.Parse("capture_video", m_VideoCaptureCI.Path);
+    ArgsParser.Parse("capture_video_latency", m_VideoCaptureCI.ReadbackLatency);
+    ArgsParser.Parse("capture_video_queue", m_VideoCaptureCI.MaxQueuedFrames);
+    ArgsParser.Parse("capture_video_ffmpeg_args", m_VideoCaptureCI.FFmpegArgs);
+    // The video plays at the capture frame rate
+    m_VideoCaptureCI.FrameRate = m_ScreenCaptureInfo.CaptureFPS;
     ArgsParser.Parse("width", 'w', m_InitialWindowWidth);
     ArgsParser.Parse("height", 'h', m_InitialWindowHeight);
     ArgsParser.Parse("validation", m_ValidationLevel);
@@ -837,11 +1352,97 @@ SampleApp::CommandLineStatus SampleApp::ProcessCommandLine(int argc, const char*
     }
 
     ArgsParser.Parse("golden_image_tolerance", m_GoldenImgPixelTolerance);
+    ArgsParser.Parse("golden_image_max_bad_pixels", m_GoldenImgMaxBadPixels);
+    ArgsParser.Parse("golden_image_early_exit", m_bGoldenImgEarlyExit);
+    ArgsParser.Parse("golden_image_heatmap_dir", m_GoldenImgHeatmapDir);
     ArgsParser.Parse("vsync", m_bVSync);
     ArgsParser.Parse("non_separable_progs", m_bForceNonSeprblProgs);
     ArgsParser.Parse("vk_compatibility", m_bVulkanCompatibilityMode);
     ArgsParser.Parse("break_on_error", m_bBreakOnError);
 
+    ArgsParser.Parse("render_state_cache", m_bUseRenderStateCache);
+    ArgsParser.Parse("async_init", m_bAsyncInit);
+
+    std::string InputRecordPath;
+    std::string InputReplayPath;
+    ArgsParser.Parse("input_record", InputRecordPath);
+    ArgsParser.Parse("input_replay", InputReplayPath);
+    if (!InputRecordPath.empty() && !InputReplayPath.empty())
+    {
+        LOG_ERROR_MESSAGE("Input can't be recorded and replayed at the same time");
+        return CommandLineStatus::Error;
+    }
+    if (!InputReplayPath.empty())
+    {
+        m_pInputRecording = std::make_unique<InputRecording>();
+        if (!m_pInputRecording->Load(InputReplayPath.c_str()))
+            return CommandLineStatus::Error;
+        // The recording is replayed with the time step it was recorded with, which does not have to be given explicitly
+        m_BenchmarkSettings.TimeStep = m_pInputRecording->GetTimeStep();
+        m_InputRecordingPath         = InputReplayPath;
+        m_bReplayInput               = true;
+    }
+
+    ArgsParser.Parse("benchmark_frames", m_BenchmarkSettings.NumFrames);
+    ArgsParser.Parse("benchmark_warmup", m_BenchmarkSettings.NumWarmupFrames);
+    ArgsParser.Parse("benchmark_timestep", m_BenchmarkSettings.TimeStep);
+    ArgsParser.Parse("benchmark_output", m_BenchmarkSettings.OutputPath);
+    if (m_BenchmarkSettings.NumFrames > 0)
+    {
+        if (m_BenchmarkSettings.TimeStep <= 0)
+        {
+            LOG_ERROR_MESSAGE("Benchmark time step (", m_BenchmarkSettings.TimeStep, ") must be positive");
+            return CommandLineStatus::Error;
+        }
+        m_pBenchmark = std::make_unique<FrameBenchmark>(m_BenchmarkSettings);
+        // Benchmark runs must not depend on user interaction
+        m_bShowAdaptersDialog = false;
+    }
+
+    if (m_bReplayInput && m_BenchmarkSettings.TimeStep != m_pInputRecording->GetTimeStep())
+    {
+        // The camera would follow a different path with a different time step
+        LOG_ERROR_MESSAGE("Benchmark time step (", m_BenchmarkSettings.TimeStep, ") does not match the time step of input recording '",
+                          m_InputRecordingPath, "' (", m_pInputRecording->GetTimeStep(), ")");
+        return CommandLineStatus::Error;
+    }
+    if (!InputRecordPath.empty())
+    {
+        if (m_BenchmarkSettings.TimeStep <= 0)
+        {
+            LOG_ERROR_MESSAGE("Benchmark time step (", m_BenchmarkSettings.TimeStep, ") must be positive");
+            return CommandLineStatus::Error;
+        }
+        m_pInputRecording    = std::make_unique<InputRecording>(m_BenchmarkSettings.TimeStep);
+        m_InputRecordingPath = InputRecordPath;
+    }
+
+    ArgsParser.Parse("golden_image_report", m_GoldenImgReportPath);
+    ArgsParser.Parse("golden_image_skip", m_GoldenImgSkipList);
+
+    {
+        bool TrackAllocations = false;
+        ArgsParser.Parse("track_allocations", TrackAllocations);
+        ArgsParser.Parse("assert_no_allocations", m_bAssertNoAllocations);
+        if (TrackAllocations || m_bAssertNoAllocations)
+        {
+            if (AllocationTracker::IsAvailable())
+            {
+                m_pAllocTracker = std::make_unique<AllocationTracker>();
+            }
+            else if (m_bAssertNoAllocations)
+            {
+                // The check must not silently pass when allocations are not counted
+                LOG_ERROR_MESSAGE("Allocation tracking requires building the app with DILIGENT_SAMPLES_TRACK_ALLOCATIONS CMake option");
+                return CommandLineStatus::Error;
+            }
+            else
+            {
+                LOG_WARNING_MESSAGE("Allocation tracking requires building the app with DILIGENT_SAMPLES_TRACK_ALLOCATIONS CMake option");
+            }
+        }
+    }
+
 
     if (m_DeviceType == RENDER_DEVICE_TYPE_UNDEFINED)
     {
@@ -862,23 +1463,106 @@ SampleApp::CommandLineStatus SampleApp::ProcessCommandLine(int argc, const char*
         }
     }
 
+    if (!GoldenImageSuite::GetRegisteredSamples().empty())
+    {
+        if (m_GoldenImgMode == GoldenImageMode::None)
+        {
+            LOG_ERROR_MESSAGE("Golden image runner requires golden image mode (capture, compare or compare_update)");
+            return CommandLineStatus::Error;
+        }
+        if (m_pBenchmark)
+        {
+            LOG_ERROR_MESSAGE("Benchmark mode is not supported by the golden image runner");
+            return CommandLineStatus::Error;
+        }
+        if (m_pInputRecording)
+        {
+            LOG_ERROR_MESSAGE("Input recording and replay are not supported by the golden image runner");
+            return CommandLineStatus::Error;
+        }
+        if (!m_VideoCaptureCI.Path.empty())
+        {
+            LOG_ERROR_MESSAGE("Video capture is not supported by the golden image runner");
+            return CommandLineStatus::Error;
+        }
+
+        if (m_ModeName.empty())
+            m_ModeName = GetRenderDeviceTypeShortString(m_DeviceType);
+
+        // Samples are run from their assets directories, so all output paths must be absolute
+        const std::string WorkingDir        = GetWorkingDirectory();
+        m_ScreenCaptureInfo.Directory       = MakeAbsolutePath(m_ScreenCaptureInfo.Directory.empty() ? "." : m_ScreenCaptureInfo.Directory, WorkingDir);
+        m_ScreenCaptureInfo.AllowCapture    = true;
+        m_ScreenCaptureInfo.FramesToCapture = 1;
+        m_GoldenImgReportPath               = MakeAbsolutePath(m_GoldenImgReportPath, WorkingDir);
+        m_GoldenImgHeatmapDir               = MakeAbsolutePath(m_GoldenImgHeatmapDir, WorkingDir);
+        m_bShowAdaptersDialog               = false;
+        m_SuiteShowUI                       = m_bShowUI;
+
+        m_pGoldenImgSuite = std::make_unique<GoldenImageSuite>("GoldenImages." + m_ModeName);
+
+        // Every sample processes its own arguments when it is created
+        return CommandLineStatus::OK;
+    }
+
     return m_TheSample->ProcessCommandLine(ArgsParser.ArgC(), ArgsParser.ArgV());
 }
 
 void SampleApp::WindowResize(int width, int height)
 {
-    if (m_pSwapChain)
+    if (m_pSwapChain && !m_bExitRequested)
     {
         m_TheSample->ReleaseSwapChainBuffers();
         m_pSwapChain->Resize(width, height);
         Uint32 SCWidth  = m_pSwapChain->GetDesc().Width;
         Uint32 SCHeight = m_pSwapChain->GetDesc().Height;
-        m_TheSample->WindowResize(SCWidth, SCHeight);
+        // The sample is resized when its initialization is finished
+        if (!m_pInitTasks)
+            m_TheSample->WindowResize(SCWidth, SCHeight);
     }
 }
 
 void SampleApp::Update(double CurrTime, double ElapsedTime)
 {
+    if (m_bExitRequested)
+        return;
+
+    if (m_pInitTasks && m_pInitTasks->IsComplete())
+    {
+        // Rethrows the exception of the task that has failed, if any
+        m_pInitTasks->Wait();
+        m_pInitTasks.reset();
+        m_TheSample->FinishInitialization();
+        FinishSampleInitialization();
+    }
+
+    if (m_pAllocTracker)
+        m_pAllocTracker->BeginPhase(AllocationTracker::PHASE_UPDATE);
+
+    // Frames that are rendered while the sample is being initialized are not measured
+    if (m_pBenchmark && !m_pInitTasks)
+    {
+        // Every benchmark run simulates the same sequence of frames regardless of the actual frame rate
+        m_pBenchmark->BeginFrame();
+        CurrTime    = m_pBenchmark->GetFrameTime();
+        ElapsedTime = m_pBenchmark->GetSettings().TimeStep;
+        m_pBenchmark->BeginPhase(FrameBenchmark::PHASE_UPDATE);
+    }
+    else if (m_pGoldenImgSuite)
+    {
+        // Every sample starts at zero time as if it was run by a separate app
+        if (m_SuiteSampleStartTime < 0)
+            m_SuiteSampleStartTime = CurrTime;
+        CurrTime    = CurrTime - m_SuiteSampleStartTime;
+        ElapsedTime = std::min(ElapsedTime, CurrTime);
+    }
+    else if (m_pInputRecording && !m_pInitTasks)
+    {
+        // The same input only produces the same camera path when every frame advances by the same time step
+        CurrTime    = m_NumInteractiveFrames * m_pInputRecording->GetTimeStep();
+        ElapsedTime = m_pInputRecording->GetTimeStep();
+    }
+
     m_CurrentTime = CurrTime;
 
     UpdateAppSettings(false);
@@ -887,37 +1571,76 @@ void SampleApp::Update(double CurrTime, double ElapsedTime)
     {
         const SwapChainDesc& SCDesc = m_pSwapChain->GetDesc();
         m_pImGui->NewFrame(SCDesc.Width, SCDesc.Height, SCDesc.PreTransform);
-        if (m_bShowAdaptersDialog)
+        if (m_pInitTasks)
+        {
+            UpdateProgressOverlay();
+        }
+        else if (m_bShowAdaptersDialog)
         {
             UpdateAdaptersDialog();
         }
+
+        if (m_pAllocTracker && m_bShowUI && !m_pInitTasks)
+            UpdateAllocationsWindow();
     }
     if (m_pDevice)
     {
-        m_TheSample->Update(CurrTime, ElapsedTime, m_bShowUI);
+        if (!m_pInitTasks)
+        {
+            if (m_pInputRecording)
+                RecordOrReplayInput();
+            m_TheSample->Update(CurrTime, ElapsedTime, m_bShowUI);
+        }
         m_TheSample->GetInputController().ClearState();
     }
+
+    if (m_pBenchmark && !m_pInitTasks)
+        m_pBenchmark->EndPhase(FrameBenchmark::PHASE_UPDATE);
+
+    if (m_pAllocTracker)
+        m_pAllocTracker->EndPhase(AllocationTracker::PHASE_UPDATE);
 }
 
 void SampleApp::Render()
 {
-    if (m_NumImmediateContexts == 0 || !m_pSwapChain)
+    if (m_NumImmediateContexts == 0 || !m_pSwapChain || m_bExitRequested)
         return;
 
     IDeviceContext* pCtx = GetImmediateContext();
     pCtx->ClearStats();
 
+    if (m_pAllocTracker)
+        m_pAllocTracker->BeginPhase(AllocationTracker::PHASE_RENDER);
+
+    if (m_pBenchmark && !m_pInitTasks)
+    {
+        m_pBenchmark->BeginPhase(FrameBenchmark::PHASE_RENDER);
+        if (m_pGPUFrameTimer)
+            m_pGPUFrameTimer->Begin(pCtx);
+    }
+
     ITextureView* pRTV = m_pSwapChain->GetCurrentBackBufferRTV();
     ITextureView* pDSV = m_pSwapChain->GetDepthBufferDSV();
     pCtx->SetRenderTargets(1, &pRTV, pDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-    m_TheSample->Render();
+    if (m_pInitTasks)
+    {
+        // Only the progress overlay is rendered until the sample is initialized
+        const float ClearColor[] = {0.032f, 0.032f, 0.032f, 1.0f};
+        pCtx->ClearRenderTarget(pRTV, ClearColor, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        if (pDSV != nullptr)
+            pCtx->ClearDepthStencil(pDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    }
+    else
+    {
+        m_TheSample->Render();
+    }
 
     // Restore default render target in case the sample has changed it
     pCtx->SetRenderTargets(1, &pRTV, pDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
     if (m_pImGui)
     {
-        if (m_bShowUI)
+        if (m_bShowUI || m_pInitTasks)
         {
             // No need to call EndFrame as ImGui::Render calls it automatically
             m_pImGui->Render(pCtx);
@@ -927,6 +1650,19 @@ void SampleApp::Render()
             m_pImGui->EndFrame();
         }
     }
+
+    if (m_pBenchmark && !m_pInitTasks)
+    {
+        // The query helper returns the duration of one of the previous frames
+        // once it becomes available, so that the CPU never waits for the GPU.
+        double GPUFrameTime = 0;
+        if (m_pGPUFrameTimer && m_pGPUFrameTimer->End(pCtx, GPUFrameTime))
+            m_pBenchmark->AddSample(FrameBenchmark::PHASE_GPU, GPUFrameTime);
+        m_pBenchmark->EndPhase(FrameBenchmark::PHASE_RENDER);
+    }
+
+    if (m_pAllocTracker)
+        m_pAllocTracker->EndPhase(AllocationTracker::PHASE_RENDER);
 }
 
 void SampleApp::CompareGoldenImage(const std::string& FileName, ScreenCapture::CaptureInfo& Capture)
@@ -955,35 +1691,74 @@ void SampleApp::CompareGoldenImage(const std::string& FileName, ScreenCapture::C
         return;
     }
 
+    if (GoldenImgDesc.ComponentType != VT_UINT8 || (GoldenImgDesc.NumComponents != 3 && GoldenImgDesc.NumComponents != 4))
+    {
+        LOG_ERROR_MESSAGE("Golden image ", FileName, " must have 8-bit RGB or RGBA pixels");
+        m_ExitCode = 2;
+        return;
+    }
+
+    if (!m_pGoldenImgComparer)
+    {
+        // The main thread compares its share of the tiles too
+        const Uint32 NumCores = std::thread::hardware_concurrency();
+        m_pGoldenImgComparer  = std::make_unique<GoldenImageComparer>(NumCores > 1 ? NumCores - 1 : 0);
+    }
+
     IDeviceContext* const pCtx = GetImmediateContext();
 
     MappedTextureSubresource TexData;
     pCtx->MapTextureSubresource(Capture.pTexture, 0, 0, MAP_READ, MAP_FLAG_DO_NOT_WAIT, nullptr, TexData);
-    std::vector<Uint8> CapturedPixels = Image::ConvertImageData(
-        TexDesc.Width, TexDesc.Height,
-        reinterpret_cast<const Uint8*>(TexData.pData), static_cast<Uint32>(TexData.Stride),
-        TexDesc.Format, TEX_FORMAT_RGBA8_UNORM,
-        /*KeepAlpha = */ false,
-        /*FlipY = */ m_pDevice->GetDeviceInfo().IsGLDevice());
-    pCtx->UnmapTextureSubresource(Capture.pTexture, 0, 0);
 
-    ComputeImageDifferenceAttribs DiffAttribs;
-    DiffAttribs.Width        = TexDesc.Width;
-    DiffAttribs.Height       = TexDesc.Height;
-    DiffAttribs.pImage1      = CapturedPixels.data();
-    DiffAttribs.NumChannels1 = 3;
-    DiffAttribs.Stride1      = TexDesc.Width * 3;
-    DiffAttribs.pImage2      = pGoldenImg->GetData()->GetConstDataPtr<Uint8>();
-    DiffAttribs.NumChannels2 = GoldenImgDesc.NumComponents;
-    DiffAttribs.Stride2      = GoldenImgDesc.RowStride;
-    DiffAttribs.Threshold    = static_cast<Uint32>(m_GoldenImgPixelTolerance);
-
-    ImageDiffInfo ImgDiff;
-    ComputeImageDifference(DiffAttribs, ImgDiff);
-
-    const Uint32 NumBadPixels  = ImgDiff.NumDiffPixelsAboveThreshold;
-    const Uint32 NumDiffPixels = ImgDiff.NumDiffPixels - ImgDiff.NumDiffPixelsAboveThreshold;
+    GoldenImageComparer::CompareAttribs CmpAttribs;
+    CmpAttribs.Width             = TexDesc.Width;
+    CmpAttribs.Height            = TexDesc.Height;
+    CmpAttribs.pGolden           = pGoldenImg->GetData()->GetConstDataPtr<Uint8>();
+    CmpAttribs.GoldenStride      = GoldenImgDesc.RowStride;
+    CmpAttribs.GoldenNumChannels = GoldenImgDesc.NumComponents;
+    CmpAttribs.Threshold         = static_cast<Uint32>(m_GoldenImgPixelTolerance);
+    CmpAttribs.MaxBadPixels      = static_cast<Uint32>(m_GoldenImgMaxBadPixels);
+    CmpAttribs.EarlyExit         = m_bGoldenImgEarlyExit;
+
+    // 8-bit RGBA and BGRA captures are compared directly in the staging memory, other formats are converted first
+    std::vector<Uint8> CapturedPixels;
+    switch (TexDesc.Format)
+    {
+        case TEX_FORMAT_RGBA8_UNORM:
+        case TEX_FORMAT_RGBA8_UNORM_SRGB:
+        case TEX_FORMAT_BGRA8_UNORM:
+        case TEX_FORMAT_BGRA8_UNORM_SRGB:
+            CmpAttribs.pCaptured      = static_cast<const Uint8*>(TexData.pData);
+            CmpAttribs.CapturedStride = static_cast<size_t>(TexData.Stride);
+            CmpAttribs.CapturedBGRA   = TexDesc.Format == TEX_FORMAT_BGRA8_UNORM || TexDesc.Format == TEX_FORMAT_BGRA8_UNORM_SRGB;
+            CmpAttribs.FlipY          = m_pDevice->GetDeviceInfo().IsGLDevice();
+            break;
+
+        default:
+            CapturedPixels = Image::ConvertImageData(
+                TexDesc.Width, TexDesc.Height,
+                reinterpret_cast<const Uint8*>(TexData.pData), static_cast<Uint32>(TexData.Stride),
+                TexDesc.Format, TEX_FORMAT_RGBA8_UNORM,
+                /*KeepAlpha = */ true,
+                /*FlipY = */ m_pDevice->GetDeviceInfo().IsGLDevice());
+            CmpAttribs.pCaptured      = CapturedPixels.data();
+            CmpAttribs.CapturedStride = size_t{TexDesc.Width} * 4;
+    }
+
+    const GoldenImageComparer::Result ImgDiff = m_pGoldenImgComparer->Compare(CmpAttribs);
+
+    const Uint32 NumBadPixels  = ImgDiff.NumBadPixels;
+    const Uint32 NumDiffPixels = ImgDiff.NumDiffPixels - ImgDiff.NumBadPixels;
     const Uint32 MaxDiff       = ImgDiff.MaxDiff;
+    const bool   Passed        = NumBadPixels <= CmpAttribs.MaxBadPixels;
+
+    // The heatmap is built while the staging data is still mapped
+    std::vector<Uint8> Heatmap;
+    if (!Passed)
+        m_pGoldenImgComparer->ComputeHeatmap(CmpAttribs, Heatmap);
+
+    pCtx->UnmapTextureSubresource(Capture.pTexture, 0, 0);
+
     if (NumBadPixels == 0)
     {
         if (NumDiffPixels == 0)
@@ -996,20 +1771,62 @@ void SampleApp::CompareGoldenImage(const std::string& FileName, ScreenCapture::C
                                 " differing pixels within the threshold (", m_GoldenImgPixelTolerance, "). Maximum difference: ", MaxDiff, '.');
         }
     }
+    else if (Passed)
+    {
+        LOG_WARNING_MESSAGE(GetAppTitle(), ": golden image validation PASSED with ", NumBadPixels, " inconsistent pixels within the budget (",
+                            m_GoldenImgMaxBadPixels, ") and ", NumDiffPixels, " differing pixels within the threshold (", m_GoldenImgPixelTolerance,
+                            "). Maximum difference: ", MaxDiff, '.');
+    }
     else
     {
+        // With early exit, the comparison stops before all pixels are compared
+        const char* AtLeast = ImgDiff.Complete ? "" : "at least ";
         if (NumDiffPixels == 0)
         {
-            LOG_ERROR_MESSAGE(GetAppTitle(), ": golden image validation FAILED: ", NumBadPixels, " inconsistent pixels are found. Maximum difference: ", MaxDiff, '.');
+            LOG_ERROR_MESSAGE(GetAppTitle(), ": golden image validation FAILED: ", AtLeast, NumBadPixels, " inconsistent pixels are found. Maximum difference: ", MaxDiff, '.');
         }
         else
         {
-            LOG_ERROR_MESSAGE(GetAppTitle(), ": golden image validation FAILED: ", NumBadPixels, " inconsistent pixels and ", NumDiffPixels,
+            LOG_ERROR_MESSAGE(GetAppTitle(), ": golden image validation FAILED: ", AtLeast, NumBadPixels, " inconsistent pixels and ", NumDiffPixels,
                               " differing pixels within the threshold (", m_GoldenImgPixelTolerance, ") are found. Maximum difference: ", MaxDiff, '.');
         }
+
+        SaveGoldenImageHeatmap(FileName, Heatmap, TexDesc.Width, TexDesc.Height);
     }
 
-    m_ExitCode = NumBadPixels > 0 ? 10 : 0;
+    m_ExitCode = Passed ? 0 : 10;
+}
+
+void SampleApp::SaveGoldenImageHeatmap(const std::string& GoldenImgFileName, const std::vector<Uint8>& Heatmap, Uint32 Width, Uint32 Height) const
+{
+    // <golden image name>_diff.png in the heatmap directory or next to the golden image
+    const size_t      NameStart   = GoldenImgFileName.find_last_of("/\\") + 1; // 0 if there is no directory
+    const std::string Name        = GoldenImgFileName.substr(NameStart);
+    const std::string HeatmapPath = (m_GoldenImgHeatmapDir.empty() ? GoldenImgFileName.substr(0, NameStart) : m_GoldenImgHeatmapDir + '/') +
+        Name.substr(0, Name.find_last_of('.')) + "_diff.png";
+
+    Image::EncodeInfo Info;
+    Info.Width      = Width;
+    Info.Height     = Height;
+    Info.TexFormat  = TEX_FORMAT_RGBA8_UNORM;
+    Info.KeepAlpha  = false;
+    Info.pData      = Heatmap.data();
+    Info.Stride     = Width * 4;
+    Info.FileFormat = IMAGE_FILE_FORMAT_PNG;
+
+    RefCntAutoPtr<IDataBlob> pEncodedImage;
+    Image::Encode(Info, &pEncodedImage);
+
+    FileWrapper pFile{HeatmapPath.c_str(), EFileAccessMode::Overwrite};
+    if (pEncodedImage && pFile && pFile->Write(pEncodedImage->GetConstDataPtr(), pEncodedImage->GetSize()))
+    {
+        LOG_INFO_MESSAGE("Golden image difference heatmap is written to '", HeatmapPath, "'.");
+    }
+    else
+    {
+        // The heatmap is a diagnostic aid, so failing to write it does not change the result of the validation
+        LOG_WARNING_MESSAGE("Failed to write golden image difference heatmap '", HeatmapPath, "'.");
+    }
 }
 
 void SampleApp::SaveScreenCapture(const std::string& FileName, ScreenCapture::CaptureInfo& Capture)
@@ -1057,12 +1874,15 @@ void SampleApp::SaveScreenCapture(const std::string& FileName, ScreenCapture::Ca
 
 void SampleApp::Present()
 {
-    if (!m_pSwapChain)
+    if (!m_pSwapChain || m_bExitRequested)
         return;
 
     IDeviceContext* const pCtx = GetImmediateContext();
 
-    if (m_pScreenCapture && m_ScreenCaptureInfo.FramesToCapture > 0)
+    if (m_pAllocTracker)
+        m_pAllocTracker->BeginPhase(AllocationTracker::PHASE_PRESENT);
+
+    if (m_pScreenCapture && m_ScreenCaptureInfo.FramesToCapture > 0 && !m_pInitTasks)
     {
         if (m_CurrentTime - m_ScreenCaptureInfo.LastCaptureTime >= 1.0 / m_ScreenCaptureInfo.CaptureFPS)
         {
@@ -1088,7 +1908,32 @@ void SampleApp::Present()
         }
     }
 
-    m_pSwapChain->Present(m_bVSync ? 1 : 0);
+    if (m_pVideoCapture && !m_pInitTasks)
+    {
+        pCtx->SetRenderTargets(0, nullptr, nullptr, RESOURCE_STATE_TRANSITION_MODE_NONE);
+        m_pVideoCapture->CaptureFrame(m_pSwapChain, pCtx, m_CurrentTime);
+    }
+
+    const bool MeasureFrame = m_pBenchmark && !m_pInitTasks;
+    if (MeasureFrame)
+        m_pBenchmark->BeginPhase(FrameBenchmark::PHASE_PRESENT);
+
+    // Vertical sync is disabled in benchmark mode to measure the actual frame time
+    m_pSwapChain->Present(m_bVSync && !m_pBenchmark ? 1 : 0);
+
+    if (MeasureFrame)
+        m_pBenchmark->EndPhase(FrameBenchmark::PHASE_PRESENT);
+
+    // The first frame may only show the progress overlay, while the sample becomes
+    // interactive when its first frame is presented after the initialization.
+    if (m_FirstFrameTime == 0)
+        m_FirstFrameTime = m_StartupTimer.GetElapsedTime();
+    if (m_TimeToInteractive == 0 && !m_pInitTasks)
+    {
+        m_TimeToInteractive = m_StartupTimer.GetElapsedTime();
+        LOG_INFO_MESSAGE(m_TheSample->GetSampleName(), " is interactive after ", m_TimeToInteractive * 1000.0,
+                         " ms (first frame: ", m_FirstFrameTime * 1000.0, " ms, sample initialization: ", m_SampleInitTime * 1000.0, " ms)");
+    }
 
     if (m_pScreenCapture)
     {
@@ -1127,6 +1972,247 @@ void SampleApp::Present()
             m_pScreenCapture->RecycleStagingTexture(std::move(Capture.pTexture));
         }
     }
+
+    if (m_pAllocTracker)
+    {
+        m_pAllocTracker->EndPhase(AllocationTracker::PHASE_PRESENT);
+        EndAllocationTrackingFrame();
+    }
+    if (!m_pInitTasks)
+        ++m_NumInteractiveFrames;
+
+    if (m_pGoldenImgSuite && m_ScreenCaptureInfo.FramesToCapture == 0)
+        FinishSuiteSample();
+
+    if (MeasureFrame)
+    {
+        m_pBenchmark->EndFrame();
+        if (m_pBenchmark->IsComplete())
+            FinishBenchmark();
+    }
+}
+
+void SampleApp::FinishBenchmark()
+{
+    const SwapChainDesc& SCDesc = m_pSwapChain->GetDesc();
+
+    std::stringstream ResolutionSS;
+    ResolutionSS << SCDesc.Width << 'x' << SCDesc.Height;
+
+    m_pBenchmark->SetProperty("sample", m_TheSample->GetSampleName());
+    m_pBenchmark->SetProperty("device", GetRenderDeviceTypeString(m_DeviceType));
+    m_pBenchmark->SetProperty("adapter", m_pDevice->GetAdapterInfo().Description);
+    m_pBenchmark->SetProperty("resolution", ResolutionSS.str());
+
+    // Runs with a cold and a warm render state cache show how much of the startup time is spent
+    // compiling shaders and creating pipeline states.
+    m_pBenchmark->SetProperty("render_state_cache", m_RenderStateCacheStatus);
+    m_pBenchmark->SetMetric("first_frame_time_ms", m_FirstFrameTime * 1000.0);
+    m_pBenchmark->SetMetric("time_to_interactive_ms", m_TimeToInteractive * 1000.0);
+    m_pBenchmark->SetMetric("sample_init_time_ms", m_SampleInitTime * 1000.0);
+    LOG_INFO_MESSAGE(GetAppTitle(), " benchmark, first frame: ", m_FirstFrameTime * 1000.0, " ms, time to interactive: ", m_TimeToInteractive * 1000.0,
+                     " ms, sample initialization: ", m_SampleInitTime * 1000.0, " ms (render state cache: ", m_RenderStateCacheStatus, ")");
+
+    if (m_pAllocTracker)
+    {
+        for (Uint32 Phase = 0; Phase < AllocationTracker::PHASE_COUNT; ++Phase)
+        {
+            const AllocationTracker::Statistics& Stats = m_pAllocTracker->GetStatistics(static_cast<AllocationTracker::PHASE>(Phase));
+            if (Stats.NumFrames == 0)
+                continue;
+
+            const std::string PhaseName = AllocationTracker::GetPhaseName(static_cast<AllocationTracker::PHASE>(Phase));
+            m_pBenchmark->SetMetric((PhaseName + "_allocations_per_frame").c_str(), static_cast<double>(Stats.TotalAllocations) / Stats.NumFrames);
+            m_pBenchmark->SetMetric((PhaseName + "_allocated_bytes_per_frame").c_str(), static_cast<double>(Stats.TotalBytes) / Stats.NumFrames);
+            m_pBenchmark->SetMetric((PhaseName + "_max_allocations").c_str(), static_cast<double>(Stats.MaxAllocations));
+            m_pBenchmark->SetMetric((PhaseName + "_allocating_frames").c_str(), Stats.NumAllocatingFrames);
+        }
+    }
+
+    if (m_pVideoCapture)
+    {
+        // Shows whether the recording has slowed down the frames
+        const VideoCapture::Statistics& Stats = m_pVideoCapture->GetStatistics();
+        m_pBenchmark->SetMetric("video_frames", Stats.NumFrames);
+        m_pBenchmark->SetMetric("video_stalls", Stats.NumStalls);
+        m_pBenchmark->SetMetric("video_stall_time_ms", Stats.StallTime * 1000.0);
+    }
+
+    for (Uint32 Phase = 0; Phase < FrameBenchmark::PHASE_COUNT; ++Phase)
+    {
+        const FrameBenchmark::Statistics Stats = m_pBenchmark->ComputeStatistics(static_cast<FrameBenchmark::PHASE>(Phase));
+        if (Stats.NumSamples == 0)
+            continue;
+
+        LOG_INFO_MESSAGE(GetAppTitle(), " benchmark, ", FrameBenchmark::GetPhaseName(static_cast<FrameBenchmark::PHASE>(Phase)),
+                         ": mean ", Stats.Mean * 1000.0, " ms, p50 ", Stats.P50 * 1000.0, " ms, p99 ", Stats.P99 * 1000.0,
+                         " ms, max ", Stats.Max * 1000.0, " ms (", Stats.NumSamples, " frames)");
+    }
+
+    if (m_pBenchmark->WriteSummary())
+    {
+        LOG_INFO_MESSAGE("Benchmark summary is written to '", m_BenchmarkSettings.OutputPath, "'.");
+    }
+    else
+    {
+        m_ExitCode = 7;
+    }
+
+    // The render state cache, the input recording and the video are saved by the destructor
+    RequestExit();
+}
+
+void SampleApp::RequestExit()
+{
+    // The native app loop checks the golden image mode after every frame, see GetGoldenImageMode().
+    // Update(), Render() and Present() do nothing until the loop exits, as the sample may have
+    // already been released.
+    m_bExitRequested = true;
+}
+
+bool SampleApp::CreateNextSuiteSample(const std::function<void()>& InitializeTheSample)
+{
+    const std::vector<GoldenImageSuite::SampleInfo>& Samples = GoldenImageSuite::GetRegisteredSamples();
+    while (m_SuiteSampleId < Samples.size())
+    {
+        const size_t                        SampleId = m_SuiteSampleId++;
+        const GoldenImageSuite::SampleInfo& Info     = Samples[SampleId];
+
+        const std::string Folder = Info.Folder != nullptr ? Info.Folder : "";
+        m_pGoldenImgSuite->BeginTest(Folder.empty() ? Info.Name : Folder + '/' + Info.Name);
+
+        if (("," + m_GoldenImgSkipList + ",").find(std::string{","} + Info.Name + ",") != std::string::npos)
+        {
+            m_pGoldenImgSuite->EndTest(GoldenImageSuite::STATUS::Skipped, 0, "Skipped by the command line");
+            continue;
+        }
+
+        if (m_SuiteSkipReasons[SampleId] != nullptr)
+        {
+            m_pGoldenImgSuite->EndTest(GoldenImageSuite::STATUS::Skipped, 0, m_SuiteSkipReasons[SampleId]);
+            continue;
+        }
+
+        if (!AreFeaturesEnabled(m_SuiteRequiredFeatures[SampleId], m_pDevice->GetDeviceInfo().Features))
+        {
+            m_pGoldenImgSuite->EndTest(GoldenImageSuite::STATUS::Skipped, 0, "Required device features are not supported");
+            continue;
+        }
+
+        // Samples load their assets from the working directory
+        if (Info.AssetsDir == nullptr || !SetWorkingDirectory(Info.AssetsDir))
+        {
+            LOG_ERROR_MESSAGE("Failed to set working directory to the assets directory of ", Info.Name);
+            m_pGoldenImgSuite->EndTest(GoldenImageSuite::STATUS::Failed, 1, "Failed to set the working directory");
+            continue;
+        }
+
+        m_TheSample.reset(Info.Create());
+
+        // Sample-specific arguments are processed the same way as by a standalone sample app
+        std::vector<std::string> ArgStrings{m_AppTitle};
+        {
+            std::stringstream ArgsSS{Info.Args != nullptr ? Info.Args : ""};
+            std::string       Arg;
+            while (ArgsSS >> Arg)
+                ArgStrings.push_back(Arg);
+        }
+        std::vector<const char*> Args;
+        for (const std::string& Arg : ArgStrings)
+            Args.push_back(Arg.c_str());
+
+        CommandLineParser ArgsParser{static_cast<int>(Args.size()), Args.data()};
+        m_bShowUI = m_SuiteShowUI;
+        ArgsParser.Parse("show_ui", m_bShowUI);
+        if (m_TheSample->ProcessCommandLine(ArgsParser.ArgC(), ArgsParser.ArgV()) == CommandLineStatus::Error)
+        {
+            m_pGoldenImgSuite->EndTest(GoldenImageSuite::STATUS::Failed, 1, "Failed to process the command line");
+            m_TheSample.reset();
+            continue;
+        }
+
+        // Golden images are named the same way as by the ProcessGoldenImages scripts
+        const std::string SampleDir = Folder.empty() ? Info.Name : Folder + FileSystem::SlashSymbol + Info.Name;
+        if (m_GoldenImgMode == GoldenImageMode::Capture)
+        {
+            const std::string GoldenImgDir = m_ScreenCaptureInfo.Directory + FileSystem::SlashSymbol + SampleDir;
+            if (!FileSystem::PathExists(GoldenImgDir.c_str()))
+                FileSystem::CreateDirectory(GoldenImgDir.c_str());
+        }
+        m_ScreenCaptureInfo.FileName        = SampleDir + FileSystem::SlashSymbol + Info.Name + '_' + m_ModeName;
+        m_ScreenCaptureInfo.FramesToCapture = 1;
+        m_ScreenCaptureInfo.LastCaptureTime = -1e+10;
+        m_SuiteSampleStartTime              = -1;
+        m_ExitCode                          = 0;
+
+        // A sample that fails to initialize must not abort the entire suite
+        try
+        {
+            InitializeTheSample();
+        }
+        catch (...)
+        {
+            m_pGoldenImgSuite->EndTest(GoldenImageSuite::STATUS::Failed, 1, "Failed to initialize the sample");
+            m_TheSample.reset();
+            continue;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+void SampleApp::FinishSuiteSample()
+{
+    const std::string& TestName = m_pGoldenImgSuite->GetResults().back().Name;
+    if (m_ExitCode == 0)
+    {
+        m_pGoldenImgSuite->EndTest(GoldenImageSuite::STATUS::Passed);
+    }
+    else
+    {
+        LOG_ERROR_MESSAGE(TestName, ": ", GetGoldenImageErrorString(m_ExitCode), " (error code ", m_ExitCode, ").");
+        m_pGoldenImgSuite->EndTest(GoldenImageSuite::STATUS::Failed, m_ExitCode, GetGoldenImageErrorString(m_ExitCode));
+    }
+
+    // Release all resources of the sample before the next one is created
+    for (Uint32 q = 0; q < m_NumImmediateContexts; ++q)
+        m_pDeviceContexts[q]->WaitForIdle();
+    m_TheSample.reset();
+
+    InitializeSample();
+}
+
+void SampleApp::FinishGoldenImageSuite()
+{
+    const Uint32 NumPassed  = m_pGoldenImgSuite->GetNumResults(GoldenImageSuite::STATUS::Passed);
+    const Uint32 NumFailed  = m_pGoldenImgSuite->GetNumResults(GoldenImageSuite::STATUS::Failed);
+    const Uint32 NumSkipped = m_pGoldenImgSuite->GetNumResults(GoldenImageSuite::STATUS::Skipped);
+    if (NumFailed == 0)
+    {
+        LOG_INFO_MESSAGE(TextColorCode::Green, "Golden image suite: ", NumPassed, " tests PASSED, ", NumSkipped, " tests SKIPPED.", TextColorCode::Default);
+    }
+    else
+    {
+        LOG_ERROR_MESSAGE("Golden image suite: ", NumFailed, " tests FAILED, ", NumPassed, " tests PASSED, ", NumSkipped, " tests SKIPPED.");
+    }
+
+    // Same as ProcessGoldenImages scripts, the exit code is the number of failed tests
+    m_ExitCode = static_cast<int>(std::min(NumFailed, 255u));
+
+    if (!m_GoldenImgReportPath.empty())
+    {
+        if (m_pGoldenImgSuite->WriteReport(m_GoldenImgReportPath))
+        {
+            LOG_INFO_MESSAGE("Golden image report is written to '", m_GoldenImgReportPath, "'.");
+        }
+        else if (m_ExitCode == 0)
+        {
+            m_ExitCode = 7;
+        }
+    }
+
+    RequestExit();
 }
 
 } // namespace Diligent
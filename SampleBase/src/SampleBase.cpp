@@ -179,7 +179,8 @@ void SampleBase::Initialize(const SampleInitInfo& InitInfo)
     m_pDeferredContexts.resize(InitInfo.NumDeferredCtx);
     for (Uint32 ctx = 0; ctx < InitInfo.NumDeferredCtx; ++ctx)
         m_pDeferredContexts[ctx] = InitInfo.ppContexts[InitInfo.NumImmediateCtx + ctx];
-    m_pImGui = InitInfo.pImGui;
+    m_pImGui            = InitInfo.pImGui;
+    m_pRenderStateCache = InitInfo.pStateCache;
     ImGui::StyleColorsDiligent();
 
     const auto& SCDesc = m_pSwapChain->GetDesc();
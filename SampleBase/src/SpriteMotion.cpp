@@ -0,0 +1,291 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "SpriteMotion.hpp"
+
+#include <cmath>
+
+#include "DebugUtilities.hpp"
+#include "SIMDMath.hpp"
+
+namespace Diligent
+{
+
+void SpriteMotionSoA::Resize(size_t Count)
+{
+    for (std::vector<float>* pArray : {&PosX, &PosY, &MoveDirX, &MoveDirY, &Angle, &RotSpeed, &Size, &TexArrInd})
+        pArray->resize(Count);
+    NumBounces.resize(Count);
+}
+
+void SpriteMotionSoA::Reorder(const std::vector<Uint32>& Order)
+{
+    VERIFY_EXPR(Order.size() == GetCount());
+
+    std::vector<float> Tmp(Order.size());
+    for (std::vector<float>* pArray : {&PosX, &PosY, &MoveDirX, &MoveDirY, &Angle, &RotSpeed, &Size, &TexArrInd})
+    {
+        for (size_t i = 0; i < Order.size(); ++i)
+            Tmp[i] = (*pArray)[Order[i]];
+        pArray->swap(Tmp);
+    }
+
+    std::vector<Uint32> TmpBounces(Order.size());
+    for (size_t i = 0; i < Order.size(); ++i)
+        TmpBounces[i] = NumBounces[Order[i]];
+    NumBounces.swap(TmpBounces);
+}
+
+const char* GetSpriteMotionISA()
+{
+#if SAMPLE_BASE_SSE2
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
+
+namespace
+{
+
+using namespace SIMDMath;
+
+inline float RandomRotSpeed(Uint32 Seed, Uint32 Index, Uint32 NumBounces, float MaxRotSpeed)
+{
+    const float u = HashToUnorm(CounterHash(Seed, Index, NumBounces));
+    return (u * 2.f - 1.f) * MaxRotSpeed;
+}
+
+inline void UpdateSprite(SpriteMotionSoA& Sprites, size_t i, const SpriteMotionUpdateAttribs& Attribs)
+{
+    const float dt = Attribs.ElapsedTime;
+
+    Sprites.Angle[i] += Sprites.RotSpeed[i] * dt;
+
+    Uint32 NumBounces = 0;
+    if (std::abs(Sprites.PosX[i] + Sprites.MoveDirX[i] * dt) > Attribs.Bounds)
+    {
+        Sprites.MoveDirX[i] = -Sprites.MoveDirX[i];
+        ++NumBounces;
+    }
+    Sprites.PosX[i] += Sprites.MoveDirX[i] * dt;
+
+    if (std::abs(Sprites.PosY[i] + Sprites.MoveDirY[i] * dt) > Attribs.Bounds)
+    {
+        Sprites.MoveDirY[i] = -Sprites.MoveDirY[i];
+        ++NumBounces;
+    }
+    Sprites.PosY[i] += Sprites.MoveDirY[i] * dt;
+
+    if (NumBounces > 0)
+    {
+        Sprites.NumBounces[i] += NumBounces;
+        Sprites.RotSpeed[i] = RandomRotSpeed(Attribs.Seed, static_cast<Uint32>(i), Sprites.NumBounces[i], Attribs.MaxRotSpeed);
+    }
+}
+
+inline void WriteSpriteInstance(const SpriteMotionSoA& Sprites, size_t i, SpriteInstanceData& Dst)
+{
+    float Sin, Cos;
+    SinCos(Sprites.Angle[i], Sin, Cos);
+    const float Size = Sprites.Size[i];
+
+    // Equivalent to ScaleMatr * RotMatr in the tutorials, stored as (m00, m10, m01, m11)
+    Dst.RotationAndScale[0] = Size * Cos;
+    Dst.RotationAndScale[1] = Size * Sin;
+    Dst.RotationAndScale[2] = -(Size * Sin);
+    Dst.RotationAndScale[3] = Size * Cos;
+    Dst.Center[0]           = Sprites.PosX[i];
+    Dst.Center[1]           = Sprites.PosY[i];
+    Dst.TexArrInd           = Sprites.TexArrInd[i];
+    Dst.Padding             = 0;
+}
+
+#if SAMPLE_BASE_SSE2
+// Updates four sprites starting at i and returns their new angles and positions
+inline void UpdateSprites4(SpriteMotionSoA& Sprites, size_t i, const SpriteMotionUpdateAttribs& Attribs, __m128& Angle, __m128& PosX, __m128& PosY)
+{
+    const __m128 dt      = _mm_set1_ps(Attribs.ElapsedTime);
+    const __m128 Bounds  = _mm_set1_ps(Attribs.Bounds);
+    const __m128 SignBit = _mm_set1_ps(-0.f);
+
+    const __m128 RotSpeed = _mm_loadu_ps(&Sprites.RotSpeed[i]);
+    Angle                 = _mm_add_ps(_mm_loadu_ps(&Sprites.Angle[i]), _mm_mul_ps(RotSpeed, dt));
+    _mm_storeu_ps(&Sprites.Angle[i], Angle);
+
+    PosX        = _mm_loadu_ps(&Sprites.PosX[i]);
+    PosY        = _mm_loadu_ps(&Sprites.PosY[i]);
+    __m128 DirX = _mm_loadu_ps(&Sprites.MoveDirX[i]);
+    __m128 DirY = _mm_loadu_ps(&Sprites.MoveDirY[i]);
+
+    const __m128 BounceX = _mm_cmpgt_ps(_mm_andnot_ps(SignBit, _mm_add_ps(PosX, _mm_mul_ps(DirX, dt))), Bounds);
+    const __m128 BounceY = _mm_cmpgt_ps(_mm_andnot_ps(SignBit, _mm_add_ps(PosY, _mm_mul_ps(DirY, dt))), Bounds);
+
+    DirX = _mm_xor_ps(DirX, _mm_and_ps(BounceX, SignBit));
+    DirY = _mm_xor_ps(DirY, _mm_and_ps(BounceY, SignBit));
+    PosX = _mm_add_ps(PosX, _mm_mul_ps(DirX, dt));
+    PosY = _mm_add_ps(PosY, _mm_mul_ps(DirY, dt));
+
+    _mm_storeu_ps(&Sprites.PosX[i], PosX);
+    _mm_storeu_ps(&Sprites.PosY[i], PosY);
+    _mm_storeu_ps(&Sprites.MoveDirX[i], DirX);
+    _mm_storeu_ps(&Sprites.MoveDirY[i], DirY);
+
+    const __m128 Bounce = _mm_or_ps(BounceX, BounceY);
+    if (_mm_movemask_ps(Bounce) == 0)
+        return;
+
+    // Comparison masks are -1 in the lanes that bounced
+    __m128i NumBounces = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&Sprites.NumBounces[i]));
+    NumBounces         = _mm_sub_epi32(NumBounces, _mm_castps_si128(BounceX));
+    NumBounces         = _mm_sub_epi32(NumBounces, _mm_castps_si128(BounceY));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&Sprites.NumBounces[i]), NumBounces);
+
+    const __m128i Index = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(i)), _mm_setr_epi32(0, 1, 2, 3));
+
+    const __m128 u           = HashToUnorm4(CounterHash4(_mm_set1_epi32(static_cast<int>(Attribs.Seed)), Index, NumBounces));
+    const __m128 NewRotSpeed = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(u, u), _mm_set1_ps(1.f)), _mm_set1_ps(Attribs.MaxRotSpeed));
+
+    _mm_storeu_ps(&Sprites.RotSpeed[i], Select(RotSpeed, NewRotSpeed, Bounce));
+}
+
+// Writes instance data of four sprites. Non-temporal stores require 16-byte aligned destination.
+template <bool Stream>
+inline void WriteSpriteInstances4(const SpriteMotionSoA& Sprites, size_t i, __m128 Angle, __m128 PosX, __m128 PosY, SpriteInstanceData* pDst)
+{
+    __m128 Sin, Cos;
+    SinCos4(Angle, Sin, Cos);
+
+    const __m128 Size = _mm_loadu_ps(&Sprites.Size[i]);
+
+    __m128 r0 = _mm_mul_ps(Size, Cos);
+    __m128 r1 = _mm_mul_ps(Size, Sin);
+    __m128 r2 = _mm_xor_ps(r1, _mm_set1_ps(-0.f));
+    __m128 r3 = r0;
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    __m128 c0 = PosX;
+    __m128 c1 = PosY;
+    __m128 c2 = _mm_loadu_ps(&Sprites.TexArrInd[i]);
+    __m128 c3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+    float* pData = reinterpret_cast<float*>(pDst);
+    if (Stream)
+    {
+        _mm_stream_ps(pData + 0, r0);
+        _mm_stream_ps(pData + 4, c0);
+        _mm_stream_ps(pData + 8, r1);
+        _mm_stream_ps(pData + 12, c1);
+        _mm_stream_ps(pData + 16, r2);
+        _mm_stream_ps(pData + 20, c2);
+        _mm_stream_ps(pData + 24, r3);
+        _mm_stream_ps(pData + 28, c3);
+    }
+    else
+    {
+        _mm_storeu_ps(pData + 0, r0);
+        _mm_storeu_ps(pData + 4, c0);
+        _mm_storeu_ps(pData + 8, r1);
+        _mm_storeu_ps(pData + 12, c1);
+        _mm_storeu_ps(pData + 16, r2);
+        _mm_storeu_ps(pData + 20, c2);
+        _mm_storeu_ps(pData + 24, r3);
+        _mm_storeu_ps(pData + 28, c3);
+    }
+}
+#endif
+
+#if SAMPLE_BASE_SSE2
+size_t UpdateSpritesSIMD(SpriteMotionSoA& Sprites, size_t Start, size_t End, const SpriteMotionUpdateAttribs& Attribs)
+{
+    size_t i = Start;
+    for (; i + 4 <= End; i += 4)
+    {
+        __m128 Angle, PosX, PosY;
+        UpdateSprites4(Sprites, i, Attribs, Angle, PosX, PosY);
+    }
+    return i;
+}
+#else
+size_t UpdateSpritesSIMD(SpriteMotionSoA&, size_t Start, size_t, const SpriteMotionUpdateAttribs&)
+{
+    return Start;
+}
+#endif
+
+#if SAMPLE_BASE_SSE2
+template <bool Stream>
+size_t UpdateSpriteInstancesSIMD(SpriteMotionSoA& Sprites, size_t Start, size_t End, const SpriteMotionUpdateAttribs& Attribs, SpriteInstanceData* pDst)
+{
+    size_t i = Start;
+    for (; i + 4 <= End; i += 4)
+    {
+        __m128 Angle, PosX, PosY;
+        UpdateSprites4(Sprites, i, Attribs, Angle, PosX, PosY);
+        WriteSpriteInstances4<Stream>(Sprites, i, Angle, PosX, PosY, pDst + (i - Start));
+    }
+    if (Stream)
+    {
+        // Non-temporal stores are weakly ordered: make them visible before the buffer is unmapped
+        _mm_sfence();
+    }
+    return i;
+}
+#endif
+
+} // namespace
+
+void UpdateSpriteMotion(SpriteMotionSoA& Sprites, size_t Start, size_t End, const SpriteMotionUpdateAttribs& Attribs)
+{
+    VERIFY_EXPR(Start <= End && End <= Sprites.GetCount());
+
+    size_t i = UpdateSpritesSIMD(Sprites, Start, End, Attribs);
+    // Process the remaining sprites one by one
+    for (; i < End; ++i)
+        UpdateSprite(Sprites, i, Attribs);
+}
+
+void UpdateSpriteInstances(SpriteMotionSoA& Sprites, size_t Start, size_t End, const SpriteMotionUpdateAttribs& Attribs, SpriteInstanceData* pDst)
+{
+    VERIFY_EXPR(Start <= End && End <= Sprites.GetCount());
+
+    size_t i = Start;
+#if SAMPLE_BASE_SSE2
+    if ((reinterpret_cast<size_t>(pDst) & 15) == 0)
+        i = UpdateSpriteInstancesSIMD<true>(Sprites, Start, End, Attribs, pDst);
+    else
+        i = UpdateSpriteInstancesSIMD<false>(Sprites, Start, End, Attribs, pDst);
+#endif
+    for (; i < End; ++i)
+    {
+        UpdateSprite(Sprites, i, Attribs);
+        WriteSpriteInstance(Sprites, i, pDst[i - Start]);
+    }
+}
+
+} // namespace Diligent
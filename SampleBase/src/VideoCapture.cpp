@@ -0,0 +1,459 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "VideoCapture.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <sstream>
+
+#include "DebugUtilities.hpp"
+#include "GraphicsAccessories.hpp"
+#include "Timer.hpp"
+#include "ReportUtils.hpp"
+
+#if PLATFORM_WIN32 || PLATFORM_LINUX || PLATFORM_MACOS
+#    define VIDEO_CAPTURE_PIPE_SUPPORTED 1
+#else
+#    define VIDEO_CAPTURE_PIPE_SUPPORTED 0
+#endif
+
+namespace Diligent
+{
+
+namespace
+{
+
+FILE* OpenPipe(const std::string& Command)
+{
+#if PLATFORM_WIN32
+    return _popen(Command.c_str(), "wb");
+#elif VIDEO_CAPTURE_PIPE_SUPPORTED
+    // Writing to a pipe whose reader has exited must fail instead of terminating the process
+    std::signal(SIGPIPE, SIG_IGN);
+    return popen(Command.c_str(), "w");
+#else
+    return nullptr;
+#endif
+}
+
+int ClosePipe(FILE* pPipe)
+{
+#if PLATFORM_WIN32
+    return _pclose(pPipe);
+#elif VIDEO_CAPTURE_PIPE_SUPPORTED
+    return pclose(pPipe);
+#else
+    return -1;
+#endif
+}
+
+} // namespace
+
+VideoCapture::VideoCapture(IRenderDevice* pDevice, ISwapChain* pSwapChain, const CreateInfo& CI) :
+    m_CI{CI}
+{
+    const SwapChainDesc& SCDesc = pSwapChain->GetDesc();
+    switch (SCDesc.ColorBufferFormat)
+    {
+        case TEX_FORMAT_RGBA8_UNORM:
+        case TEX_FORMAT_RGBA8_UNORM_SRGB:
+            m_BGRA = false;
+            break;
+
+        case TEX_FORMAT_BGRA8_UNORM:
+        case TEX_FORMAT_BGRA8_UNORM_SRGB:
+            m_BGRA = true;
+            break;
+
+        default:
+            LOG_ERROR_AND_THROW("Video capture requires an 8-bit RGBA or BGRA swap chain, but its format is ", GetTextureFormatAttribs(SCDesc.ColorBufferFormat).Name);
+    }
+    if (CI.FrameRate <= 0)
+        LOG_ERROR_AND_THROW("Video capture frame rate (", CI.FrameRate, ") must be positive");
+    if (CI.ReadbackLatency == 0 || CI.MaxQueuedFrames == 0)
+        LOG_ERROR_AND_THROW("Video capture requires at least one staging texture and one queued frame");
+
+    m_Width  = SCDesc.Width;
+    m_Height = SCDesc.Height;
+    m_FlipY  = pDevice->GetDeviceInfo().IsGLDevice();
+
+    TextureDesc StagingDesc;
+    StagingDesc.Name           = "Video capture staging texture";
+    StagingDesc.Type           = RESOURCE_DIM_TEX_2D;
+    StagingDesc.Width          = m_Width;
+    StagingDesc.Height         = m_Height;
+    StagingDesc.Format         = SCDesc.ColorBufferFormat;
+    StagingDesc.Usage          = USAGE_STAGING;
+    StagingDesc.BindFlags      = BIND_NONE;
+    StagingDesc.CPUAccessFlags = CPU_ACCESS_READ;
+
+    m_Slots.resize(CI.ReadbackLatency);
+    for (StagingSlot& Slot : m_Slots)
+    {
+        pDevice->CreateTexture(StagingDesc, nullptr, &Slot.pTexture);
+        if (!Slot.pTexture)
+            LOG_ERROR_AND_THROW("Failed to create video capture staging texture");
+    }
+
+    // Fence values are the numbers of frames copied into the staging textures
+    FenceDesc FDesc;
+    FDesc.Name = "Video capture fence";
+    pDevice->CreateFence(FDesc, &m_pFence);
+    if (!m_pFence)
+        LOG_ERROR_AND_THROW("Failed to create video capture fence");
+
+    if (ReportUtils::HasExtension(CI.Path, ".y4m"))
+        m_Format = FORMAT::Y4M;
+    else if (ReportUtils::HasExtension(CI.Path, ".rgba"))
+        m_Format = FORMAT::RawRGBA;
+    else
+        m_Format = FORMAT::FFmpeg;
+
+    if (m_Format == FORMAT::FFmpeg)
+    {
+        if (!VIDEO_CAPTURE_PIPE_SUPPORTED)
+            LOG_ERROR_AND_THROW("Encoding video with ffmpeg is not supported on this platform. Use .y4m or .rgba output file.");
+
+        // ffmpeg reads the frames in the channel order of the swap chain
+        std::stringstream CommandSS;
+        CommandSS << "ffmpeg -hide_banner -loglevel error -y -f rawvideo -pix_fmt " << (m_BGRA ? "bgra" : "rgba")
+                  << " -s " << m_Width << 'x' << m_Height << " -framerate " << CI.FrameRate << " -i - "
+                  << CI.FFmpegArgs << " \"" << CI.Path << '"';
+        m_pPipe = OpenPipe(CommandSS.str());
+        if (m_pPipe == nullptr)
+            LOG_ERROR_AND_THROW("Failed to start ffmpeg to encode video file '", CI.Path, "'");
+    }
+    else
+    {
+        m_pFile = std::make_unique<FileWrapper>(CI.Path.c_str(), EFileAccessMode::Overwrite);
+        if (!*m_pFile)
+            LOG_ERROR_AND_THROW("Failed to create video file '", CI.Path, "'");
+    }
+
+    if (m_Format == FORMAT::Y4M)
+    {
+        // Full-range BT.601 with the frame rate in thousandths of a frame per second
+        std::stringstream HeaderSS;
+        HeaderSS << "YUV4MPEG2 W" << m_Width << " H" << m_Height << " F" << std::llround(CI.FrameRate * 1000) << ":1000 Ip A1:1 C420jpeg\n";
+        const std::string Header = HeaderSS.str();
+        if (!Write(Header.data(), Header.size()))
+            LOG_ERROR_AND_THROW("Failed to write video file '", CI.Path, "'");
+    }
+
+    // All memory is allocated up front, so recording does not allocate and its size is bounded
+    m_Buffers.resize(CI.MaxQueuedFrames, std::vector<Uint8>(size_t{m_Width} * m_Height * 4));
+    for (size_t i = 0; i < m_Buffers.size(); ++i)
+        m_FreeBuffers.push_back(i);
+    if (m_Format == FORMAT::Y4M)
+        m_ConvertedFrame.resize(size_t{m_Width} * m_Height + size_t{(m_Width + 1) / 2} * ((m_Height + 1) / 2) * 2);
+    else if (m_Format == FORMAT::RawRGBA && m_BGRA)
+        m_ConvertedFrame.resize(size_t{m_Width} * m_Height * 4);
+
+    m_WriterThread = std::thread{&VideoCapture::WriterThreadFunc, this};
+
+    LOG_INFO_MESSAGE("Recording ", m_Width, 'x', m_Height, " video at ", CI.FrameRate, " FPS to '", CI.Path, "' (",
+                     FormatMemorySize(m_Buffers.size() * m_Buffers[0].size()), " of frame buffers)");
+}
+
+VideoCapture::~VideoCapture()
+{
+    // Frames that have not been read back are lost if Finish() has not been called
+    StopWriter();
+}
+
+void VideoCapture::CaptureFrame(ISwapChain* pSwapChain, IDeviceContext* pCtx, double CurrTime)
+{
+    // Frames are selected by their time, so the video plays at its frame rate if the app renders faster.
+    // A small tolerance keeps the selection stable with a fixed time step that is a multiple of the frame period.
+    if (m_StartTime < 0)
+        m_StartTime = CurrTime;
+    const double VideoFrame = (CurrTime - m_StartTime) * m_CI.FrameRate + 1e-3;
+    if (VideoFrame >= static_cast<double>(m_NumVideoFrames))
+    {
+        m_NumVideoFrames = static_cast<Uint64>(VideoFrame) + 1;
+
+        ITexture*          pBackBuffer = pSwapChain->GetCurrentBackBufferRTV()->GetTexture();
+        const TextureDesc& BBDesc      = pBackBuffer->GetDesc();
+        if (BBDesc.Width == m_Width && BBDesc.Height == m_Height)
+        {
+            // The staging texture is reused after ReadbackLatency frames, so its frame must be read back first
+            if (m_NumCopiedFrames - m_NumReadFrames == m_Slots.size())
+                ReadBackFrame(pCtx, /*Wait = */ true);
+
+            StagingSlot& Slot = m_Slots[m_NumCopiedFrames % m_Slots.size()];
+
+            CopyTextureAttribs CopyAttribs{pBackBuffer, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                           Slot.pTexture, RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+            pCtx->CopyTexture(CopyAttribs);
+            Slot.FenceValue = ++m_NumCopiedFrames;
+            pCtx->EnqueueSignal(m_pFence, Slot.FenceValue);
+            ++m_Stats.NumFrames;
+        }
+        else
+        {
+            if (m_Stats.NumSkippedFrames == 0)
+            {
+                LOG_WARNING_MESSAGE("Window size (", BBDesc.Width, 'x', BBDesc.Height, ") does not match the video size (", m_Width, 'x', m_Height,
+                                    "). Frames are skipped until the original size is restored.");
+            }
+            ++m_Stats.NumSkippedFrames;
+        }
+    }
+
+    // Read back all frames that the GPU has finished copying without waiting for the rest
+    const Uint64 CompletedValue = m_pFence->GetCompletedValue();
+    while (m_NumReadFrames < m_NumCopiedFrames && m_Slots[m_NumReadFrames % m_Slots.size()].FenceValue <= CompletedValue)
+        ReadBackFrame(pCtx, /*Wait = */ false);
+}
+
+void VideoCapture::ReadBackFrame(IDeviceContext* pCtx, bool Wait)
+{
+    VERIFY_EXPR(m_NumReadFrames < m_NumCopiedFrames);
+    StagingSlot& Slot = m_Slots[m_NumReadFrames % m_Slots.size()];
+
+    Timer StallTimer;
+    bool  Stalled = false;
+    if (m_pFence->GetCompletedValue() < Slot.FenceValue)
+    {
+        VERIFY_EXPR(Wait);
+        // The signal may not have been submitted yet
+        pCtx->Flush();
+        m_pFence->Wait(Slot.FenceValue);
+        Stalled = true;
+    }
+
+    size_t BufferId = 0;
+    {
+        std::unique_lock<std::mutex> Lock{m_Mtx};
+        if (m_FreeBuffers.empty())
+        {
+            // The writer is behind by MaxQueuedFrames frames
+            m_FreeCV.wait(Lock, [this] { return !m_FreeBuffers.empty(); });
+            Stalled = true;
+        }
+        BufferId = m_FreeBuffers.back();
+        m_FreeBuffers.pop_back();
+    }
+    if (Stalled)
+    {
+        ++m_Stats.NumStalls;
+        m_Stats.StallTime += StallTimer.GetElapsedTime();
+    }
+
+    std::vector<Uint8>& Pixels  = m_Buffers[BufferId];
+    const size_t        RowSize = size_t{m_Width} * 4;
+
+    MappedTextureSubresource MappedData;
+    pCtx->MapTextureSubresource(Slot.pTexture, 0, 0, MAP_READ, MAP_FLAG_DO_NOT_WAIT, nullptr, MappedData);
+    if (MappedData.pData != nullptr)
+    {
+        // The render thread only copies the rows, all conversions are done by the writer
+        const Uint8* pSrc = static_cast<const Uint8*>(MappedData.pData);
+        if (!m_FlipY && MappedData.Stride == RowSize)
+        {
+            std::memcpy(Pixels.data(), pSrc, Pixels.size());
+        }
+        else
+        {
+            // OpenGL textures are stored bottom-up
+            for (Uint32 y = 0; y < m_Height; ++y)
+            {
+                const Uint32 SrcRow = m_FlipY ? m_Height - 1 - y : y;
+                std::memcpy(&Pixels[y * RowSize], pSrc + SrcRow * MappedData.Stride, RowSize);
+            }
+        }
+        pCtx->UnmapTextureSubresource(Slot.pTexture, 0, 0);
+    }
+    else
+    {
+        UNEXPECTED("Failed to map video capture staging texture");
+        std::fill(Pixels.begin(), Pixels.end(), Uint8{0});
+    }
+    ++m_NumReadFrames;
+
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        m_QueuedBuffers.push_back(BufferId);
+    }
+    m_QueueCV.notify_one();
+}
+
+bool VideoCapture::Finish(IDeviceContext* pCtx)
+{
+    while (m_NumReadFrames < m_NumCopiedFrames)
+        ReadBackFrame(pCtx, /*Wait = */ true);
+
+    StopWriter();
+
+    if (!m_WriteFailed)
+    {
+        LOG_INFO_MESSAGE("Recorded ", m_Stats.NumFrames, " video frames to '", m_CI.Path, "'. The render thread waited ", m_Stats.NumStalls,
+                         " times for ", m_Stats.StallTime * 1000.0, " ms in total.");
+    }
+    return !m_WriteFailed;
+}
+
+void VideoCapture::StopWriter()
+{
+    if (!m_WriterThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> Lock{m_Mtx};
+        m_Stop = true;
+    }
+    m_QueueCV.notify_one();
+    m_WriterThread.join();
+
+    if (m_pPipe != nullptr)
+    {
+        // Waits until ffmpeg has finished encoding
+        const int ExitCode = ClosePipe(m_pPipe);
+        m_pPipe            = nullptr;
+        if (ExitCode != 0 && !m_WriteFailed)
+        {
+            LOG_ERROR_MESSAGE("ffmpeg failed to encode video file '", m_CI.Path, "' (exit status ", ExitCode, ')');
+            m_WriteFailed = true;
+        }
+    }
+    m_pFile.reset();
+}
+
+void VideoCapture::WriterThreadFunc()
+{
+    for (;;)
+    {
+        size_t BufferId = 0;
+        {
+            std::unique_lock<std::mutex> Lock{m_Mtx};
+            m_QueueCV.wait(Lock, [this] { return m_Stop || !m_QueuedBuffers.empty(); });
+            // All queued frames are written before the thread exits
+            if (m_QueuedBuffers.empty())
+                break;
+            BufferId = m_QueuedBuffers.front();
+            m_QueuedBuffers.pop_front();
+        }
+
+        // After a failure, the frames are still consumed so that the render thread never waits for a free buffer forever
+        if (!m_WriteFailed && !WriteFrame(m_Buffers[BufferId]))
+        {
+            LOG_ERROR_MESSAGE("Failed to write video file '", m_CI.Path, "'. The remaining frames are dropped.");
+            m_WriteFailed = true;
+        }
+
+        {
+            std::lock_guard<std::mutex> Lock{m_Mtx};
+            m_FreeBuffers.push_back(BufferId);
+        }
+        m_FreeCV.notify_one();
+    }
+}
+
+bool VideoCapture::WriteFrame(const std::vector<Uint8>& Pixels)
+{
+    const size_t NumPixels = size_t{m_Width} * m_Height;
+    const size_t R         = m_BGRA ? 2 : 0;
+    const size_t B         = m_BGRA ? 0 : 2;
+
+    switch (m_Format)
+    {
+        case FORMAT::Y4M:
+        {
+            // Full-range BT.601 in 8.8 fixed point, chroma is averaged over 2x2 blocks
+            const Uint32 ChromaWidth  = (m_Width + 1) / 2;
+            const Uint32 ChromaHeight = (m_Height + 1) / 2;
+
+            Uint8* const pY = m_ConvertedFrame.data();
+            Uint8* const pU = pY + NumPixels;
+            Uint8* const pV = pU + size_t{ChromaWidth} * ChromaHeight;
+            for (Uint32 cy = 0; cy < ChromaHeight; ++cy)
+            {
+                for (Uint32 cx = 0; cx < ChromaWidth; ++cx)
+                {
+                    int SumU = 0;
+                    int SumV = 0;
+                    int Num  = 0;
+                    for (Uint32 y = cy * 2; y < std::min(cy * 2 + 2, m_Height); ++y)
+                    {
+                        for (Uint32 x = cx * 2; x < std::min(cx * 2 + 2, m_Width); ++x)
+                        {
+                            const size_t Idx = size_t{y} * m_Width + x;
+                            const int    r   = Pixels[Idx * 4 + R];
+                            const int    g   = Pixels[Idx * 4 + 1];
+                            const int    b   = Pixels[Idx * 4 + B];
+
+                            pY[Idx] = static_cast<Uint8>((77 * r + 150 * g + 29 * b + 128) >> 8);
+                            SumU += -43 * r - 85 * g + 128 * b;
+                            SumV += 128 * r - 107 * g - 21 * b;
+                            ++Num;
+                        }
+                    }
+                    // The offset keeps the sums positive, so that the division rounds to nearest
+                    const size_t ChromaIdx = size_t{cy} * ChromaWidth + cx;
+                    pU[ChromaIdx]          = static_cast<Uint8>(std::min((SumU + (128 * 256 + 128) * Num) / (256 * Num), 255));
+                    pV[ChromaIdx]          = static_cast<Uint8>(std::min((SumV + (128 * 256 + 128) * Num) / (256 * Num), 255));
+                }
+            }
+
+            static constexpr char FrameHeader[] = "FRAME\n";
+            return Write(FrameHeader, sizeof(FrameHeader) - 1) && Write(m_ConvertedFrame.data(), m_ConvertedFrame.size());
+        }
+
+        case FORMAT::RawRGBA:
+            if (!m_BGRA)
+                return Write(Pixels.data(), Pixels.size());
+
+            for (size_t i = 0; i < NumPixels; ++i)
+            {
+                m_ConvertedFrame[i * 4 + 0] = Pixels[i * 4 + 2];
+                m_ConvertedFrame[i * 4 + 1] = Pixels[i * 4 + 1];
+                m_ConvertedFrame[i * 4 + 2] = Pixels[i * 4 + 0];
+                m_ConvertedFrame[i * 4 + 3] = Pixels[i * 4 + 3];
+            }
+            return Write(m_ConvertedFrame.data(), m_ConvertedFrame.size());
+
+        case FORMAT::FFmpeg:
+            return Write(Pixels.data(), Pixels.size());
+
+        default:
+            UNEXPECTED("Unexpected video format");
+            return false;
+    }
+}
+
+bool VideoCapture::Write(const void* pData, size_t Size)
+{
+    if (m_pPipe != nullptr)
+        return std::fwrite(pData, 1, Size, m_pPipe) == Size;
+
+    return (*m_pFile)->Write(pData, Size);
+}
+
+} // namespace Diligent
@@ -180,6 +180,10 @@ public:
                 return Handled;
         }
 
+        // There is no sample after the golden image suite is finished
+        if (!m_TheSample)
+            return 0;
+
         struct WindowsMessageData
         {
             HWND   hWnd;
@@ -225,12 +225,8 @@ Asteroids::Asteroids(const Settings& settings, AsteroidsSimulation* asteroids, G
     if (m_BindingMode == BindingMode::Bindless && !mDevice->GetDeviceInfo().Features.BindlessResources)
         m_BindingMode = BindingMode::TextureMutable;
 
-    mCmdLists.resize(mDeferredCtxt.size());
-    mWorkerThreads.resize(mNumSubsets - 1);
-    for (auto& thread : mWorkerThreads)
-    {
-        thread = std::thread(WorkerThreadFunc, this, (Uint32)(&thread - mWorkerThreads.data()));
-    }
+    // Deferred contexts are only created for backends that support them
+    mRecorder.Start(mDeferredCtxt, static_cast<Uint32>(mDeferredCtxt.size()));
 
     const char* spriteFile = nullptr;
     switch (DevType)
@@ -651,12 +647,8 @@ Asteroids::~Asteroids()
     mDeviceCtxt->Flush();
     mDeviceCtxt->FinishFrame();
 
-    mUpdateSubsetsSignal.Trigger(true, -1);
-
-    for (auto& thread : mWorkerThreads)
-    {
-        thread.join();
-    }
+    // Workers finish the frames of their deferred contexts before they exit
+    mRecorder.Stop();
 }
 
 
@@ -821,48 +813,12 @@ void Asteroids::CreateGUIResources()
 
 static_assert(sizeof(IndexType) == 2, "Expecting 16-bit index buffer");
 
-void Asteroids::WorkerThreadFunc(Asteroids* pThis, Uint32 ThreadNum)
-{
-    for (;;)
-    {
-        // Wait for UpdateSubsets signal
-        auto SignalledValue = pThis->mUpdateSubsetsSignal.Wait();
-        if (SignalledValue < 0)
-            return;
-
-        auto  SubsetSize   = NUM_ASTEROIDS / pThis->mNumSubsets;
-        auto  SubsetStart  = SubsetSize * (ThreadNum + 1);
-        auto& FrameAttribs = pThis->mFrameAttribs;
-
-        pThis->mAsteroids->Update(FrameAttribs.frameTime, FrameAttribs.camera->Eye(), *FrameAttribs.settings, SubsetStart, SubsetSize);
-
-        // Increment number of completed threads
-        ++pThis->m_NumThreadsCompleted;
-
-
-        // Wait for RenderSubsets signal
-        pThis->mRenderSubsetsSignal.Wait();
-
-        pThis->RenderSubset(1 + ThreadNum, pThis->mDeferredCtxt[ThreadNum], *FrameAttribs.camera, SubsetStart, SubsetSize);
-
-        RefCntAutoPtr<ICommandList> pCmdList;
-        pThis->mCmdLists[ThreadNum].Release();
-        pThis->mDeferredCtxt[ThreadNum]->FinishCommandList(&pThis->mCmdLists[ThreadNum]);
-
-        // Increment number of completed threads
-        ++pThis->m_NumThreadsCompleted;
-    }
-}
-
 void Asteroids::RenderSubset(Uint32             SubsetNum,
                              IDeviceContext*    pCtx,
                              const OrbitCamera& camera,
                              Uint32             startIdx,
                              Uint32             numAsteroids)
 {
-    if (pCtx->GetDesc().IsDeferred)
-        pCtx->Begin(0);
-
     auto* pRTV = mSwapChain->GetCurrentBackBufferRTV();
     auto* pDSV = mSwapChain->GetDepthBufferDSV();
     pCtx->SetRenderTargets(1, &pRTV, pDSV, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
@@ -954,10 +910,6 @@ void Asteroids::RenderSubset(Uint32             SubsetNum,
 
 void Asteroids::Render(float frameTime, const OrbitCamera& camera, const Settings& settings)
 {
-    mFrameAttribs.frameTime = frameTime;
-    mFrameAttribs.camera    = &camera;
-    mFrameAttribs.settings  = &settings;
-
     // Clear the render target
     float clearcol[4] = {0.0f, 0.0f, 0.0f, 0.0f};
     auto* pRTV        = mSwapChain->GetCurrentBackBufferRTV();
@@ -982,23 +934,20 @@ void Asteroids::Render(float frameTime, const OrbitCamera& camera, const Setting
         mDeviceCtxt->TransitionResourceStates(1, &Barrier);
     }
 
-    if (settings.multithreadedRendering)
+    // Fall back to the main thread if there are not enough deferred contexts
+    const bool multithreaded = settings.multithreadedRendering && mRecorder.GetNumSubsets() == mNumSubsets;
+
+    if (multithreaded)
     {
-        m_NumThreadsCompleted = 0;
-        mUpdateSubsetsSignal.Trigger(true);
+        mRecorder.ParallelFor([&](Uint32 subset) {
+            mAsteroids->Update(frameTime, camera.Eye(), settings, SubsetSize * subset, SubsetSize);
+        });
     }
-
-    // Update all subsets in this thread when multithreadedRendering is false
-    for (Uint32 i = 0; i < (!settings.multithreadedRendering ? mNumSubsets : 1); ++i)
-        mAsteroids->Update(frameTime, camera.Eye(), settings, SubsetSize * i, SubsetSize);
-
-    if (settings.multithreadedRendering)
+    else
     {
-        // Wait for worker threads to finish
-        while (m_NumThreadsCompleted < (int)mNumSubsets - 1)
-            std::this_thread::yield();
-        // Reset mUpdateSubsetsSignal while all threads are waiting for mRenderSubsetsSignal
-        mUpdateSubsetsSignal.Reset();
+        // Update all subsets in this thread
+        for (Uint32 i = 0; i < mNumSubsets; ++i)
+            mAsteroids->Update(frameTime, camera.Eye(), settings, SubsetSize * i, SubsetSize);
     }
 
     QueryPerformanceCounter((LARGE_INTEGER*)&currCounter);
@@ -1006,45 +955,20 @@ void Asteroids::Render(float frameTime, const OrbitCamera& camera, const Setting
 
     mRenderTicks = currCounter;
 
-    if (settings.multithreadedRendering)
+    if (multithreaded)
     {
-        // Signal RenderSubsets
-        m_NumThreadsCompleted = 0;
-        mRenderSubsetsSignal.Trigger(true);
+        // Subset 0 is rendered into the immediate context, the rest are recorded by the workers
+        mRecorder.RecordFrame(mDeviceCtxt, [&](IDeviceContext* pCtx, Uint32 subset) {
+            RenderSubset(subset, pCtx, camera, SubsetSize * subset, SubsetSize);
+        });
     }
-
-    // Render all subsets in this thread when multithreadedRendering is false
-    for (Uint32 i = 0; i < (!settings.multithreadedRendering ? mNumSubsets : 1); ++i)
-        RenderSubset(i, mDeviceCtxt, camera, SubsetSize * i, SubsetSize);
-
-    if (settings.multithreadedRendering)
+    else
     {
-        // Wait for worker threads to finish
-        while (m_NumThreadsCompleted < (int)mNumSubsets - 1)
-            std::this_thread::yield();
-        // Reset mRenderSubsetsSignal while all threads are waiting for mUpdateSubsetsSignal
-        mRenderSubsetsSignal.Reset();
-
-        mCmdListPtrs.resize(mCmdLists.size());
-        for (size_t i = 0; i < mCmdLists.size(); ++i)
-            mCmdListPtrs[i] = mCmdLists[i];
-        mDeviceCtxt->ExecuteCommandLists(static_cast<Uint32>(mCmdListPtrs.size()), mCmdListPtrs.data());
-
-        for (auto& cmdList : mCmdLists)
-        {
-            // Release command lists now to release all outstanding references
-            // In d3d11 mode, command lists hold references to the swap chain's back buffer
-            // that cause swap chain resize to fail
-            cmdList.Release();
-        }
+        // Render all subsets in this thread
+        for (Uint32 i = 0; i < mNumSubsets; ++i)
+            RenderSubset(i, mDeviceCtxt, camera, SubsetSize * i, SubsetSize);
     }
 
-    // Call FinishFrame() to release dynamic resources allocated by deferred contexts
-    // IMPORTANT: we must wait until the command lists are submitted for execution
-    // because FinishFrame() invalidates all dynamic resources
-    for (auto& ctx : mDeferredCtxt)
-        ctx->FinishFrame();
-
     QueryPerformanceCounter((LARGE_INTEGER*)&currCounter);
     mRenderTicks = currCounter - mRenderTicks;
 
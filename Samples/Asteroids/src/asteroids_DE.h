@@ -14,10 +14,8 @@
 #include "SwapChain.h"
 #include "DeviceContext.h"
 #include "RefCntAutoPtr.hpp"
-#include "ThreadSignal.hpp"
+#include "ParallelFrameRecorder.hpp"
 #include <map>
-#include <mutex>
-#include <atomic>
 
 #include "camera.h"
 #include "settings.h"
@@ -61,26 +59,12 @@ private:
     Diligent::RefCntAutoPtr<Diligent::IRenderDevice>  mDevice;
     Diligent::RefCntAutoPtr<Diligent::IDeviceContext>  mDeviceCtxt;
     std::vector< Diligent::RefCntAutoPtr<Diligent::IDeviceContext> > mDeferredCtxt;
-    std::vector< Diligent::RefCntAutoPtr<Diligent::ICommandList> > mCmdLists;
-    std::vector< Diligent::ICommandList* > mCmdListPtrs;
     
     Diligent::Uint32 mBackBufferWidth, mBackBufferHeight;
     Diligent::Uint32 mNumSubsets = 0;
-    std::vector<std::thread> mWorkerThreads;
-    
-    std::mutex mMutex;
-    std::condition_variable mCondVar;
-    Threading::Signal mUpdateSubsetsSignal;
-    Threading::Signal mRenderSubsetsSignal;
-    std::atomic_int m_NumThreadsCompleted;
-    static void WorkerThreadFunc(Asteroids *pThis, Diligent::Uint32 ThreadNum);
-
-    struct FrameAttribs
-    {
-        float frameTime;
-        const OrbitCamera* camera;
-        const Settings* settings;
-    }mFrameAttribs;
+
+    // Worker i updates and records subset 1 + i using mDeferredCtxt[i]
+    Diligent::ParallelFrameRecorder mRecorder;
 
     Diligent::RefCntAutoPtr<Diligent::IBuffer>  mIndexBuffer;
     Diligent::RefCntAutoPtr<Diligent::IBuffer>  mVertexBuffer;
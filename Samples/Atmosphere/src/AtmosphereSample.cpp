@@ -37,6 +37,7 @@
 #include "../imGuIZMO.quat/imGuIZMO.h"
 #include "PlatformMisc.hpp"
 #include "ImGuiUtils.hpp"
+#include "AsyncInitTaskGraph.hpp"
 
 namespace Diligent
 {
@@ -114,19 +115,33 @@ void AtmosphereSample::Initialize(const SampleInitInfo& InitInfo)
     m_strNormalMapTexPaths[3] = "Terrain\\Tiles\\Snow_NM.jpg";
     m_strNormalMapTexPaths[4] = "Terrain\\Tiles\\grass_NM.dds";
 
-    // Create data source
-    try
-    {
-        m_pElevDataSource.reset(new ElevationDataSource(m_strRawDEMDataFile.c_str()));
-        m_pElevDataSource->SetOffsets(m_TerrainRenderParams.m_iColOffset, m_TerrainRenderParams.m_iRowOffset);
-        m_fMinElevation = m_pElevDataSource->GetGlobalMinElevation() * m_TerrainRenderParams.m_TerrainAttribs.m_fElevationScale;
-        m_fMaxElevation = m_pElevDataSource->GetGlobalMaxElevation() * m_TerrainRenderParams.m_TerrainAttribs.m_fElevationScale;
-    }
-    catch (const std::exception&)
-    {
-        LOG_ERROR("Failed to create elevation data source");
+    CreateUniformBuffer(m_pDevice, sizeof(CameraAttribs), "Camera Attribs CB", &m_pcbCameraAttribs);
+    CreateUniformBuffer(m_pDevice, sizeof(LightAttribs), "Light Attribs CB", &m_pcbLightAttribs);
+}
+
+void AtmosphereSample::CreateInitializationTasks(AsyncInitTaskGraph& Tasks)
+{
+    // Loading the height map takes most of the initialization time and only needs the CPU
+    Tasks.AddTask("Elevation data", [this]() {
+        try
+        {
+            m_pElevDataSource.reset(new ElevationDataSource(m_strRawDEMDataFile.c_str()));
+            m_pElevDataSource->SetOffsets(m_TerrainRenderParams.m_iColOffset, m_TerrainRenderParams.m_iRowOffset);
+            m_fMinElevation = m_pElevDataSource->GetGlobalMinElevation() * m_TerrainRenderParams.m_TerrainAttribs.m_fElevationScale;
+            m_fMaxElevation = m_pElevDataSource->GetGlobalMaxElevation() * m_TerrainRenderParams.m_TerrainAttribs.m_fElevationScale;
+        }
+        catch (const std::exception&)
+        {
+            m_pElevDataSource.reset();
+            LOG_ERROR("Failed to create elevation data source");
+        }
+    });
+}
+
+void AtmosphereSample::FinishInitialization()
+{
+    if (!m_pElevDataSource)
         return;
-    }
 
     const Char *strTileTexPaths[EarthHemsiphere::NUM_TILE_TEXTURES], *strNormalMapPaths[EarthHemsiphere::NUM_TILE_TEXTURES];
     for (size_t iTile = 0; iTile < _countof(strTileTexPaths); ++iTile)
@@ -135,14 +150,12 @@ void AtmosphereSample::Initialize(const SampleInitInfo& InitInfo)
         strNormalMapPaths[iTile] = m_strNormalMapTexPaths[iTile].c_str();
     }
 
-    CreateUniformBuffer(m_pDevice, sizeof(CameraAttribs), "Camera Attribs CB", &m_pcbCameraAttribs);
-    CreateUniformBuffer(m_pDevice, sizeof(LightAttribs), "Light Attribs CB", &m_pcbLightAttribs);
-
     const SwapChainDesc& SCDesc = m_pSwapChain->GetDesc();
 
+    // Light scattering and the terrain use the immediate context, so they are created on the main thread
     m_pLightSctrPP = std::make_unique<EpipolarLightScattering>(EpipolarLightScattering::CreateInfo{
         m_pDevice,
-        nullptr,
+        m_pRenderStateCache,
         m_pImmediateContext,
         SCDesc.ColorBufferFormat,
         SCDesc.DepthBufferFormat,
@@ -495,7 +508,7 @@ void AtmosphereSample::CreateShadowMap()
     }
     SMMgrInitInfo.pComparisonSampler = m_pComparisonSampler;
 
-    m_ShadowMapMgr.Initialize(m_pDevice, nullptr, SMMgrInitInfo);
+    m_ShadowMapMgr.Initialize(m_pDevice, m_pRenderStateCache, SMMgrInitInfo);
 }
 
 void AtmosphereSample::RenderShadowMap(IDeviceContext* pContext,
@@ -595,7 +608,7 @@ void AtmosphereSample::Render()
     // The first time GetAmbientSkyLightSRV() is called, the ambient sky light texture
     // is computed and render target is set. So we need to query the texture before setting
     // render targets
-    ITextureView* pAmbientSkyLightSRV = m_pLightSctrPP->GetAmbientSkyLightSRV(m_pDevice, nullptr, m_pImmediateContext);
+    ITextureView* pAmbientSkyLightSRV = m_pLightSctrPP->GetAmbientSkyLightSRV(m_pDevice, m_pRenderStateCache, m_pImmediateContext);
 
     ITextureView* pRTV = m_pSwapChain->GetCurrentBackBufferRTV();
     ITextureView* pDSV = m_pSwapChain->GetDepthBufferDSV();
@@ -46,6 +46,8 @@ public:
     virtual void ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Attribs) override final;
 
     virtual void Initialize(const SampleInitInfo& InitInfo) override final;
+    virtual void CreateInitializationTasks(AsyncInitTaskGraph& Tasks) override final;
+    virtual void FinishInitialization() override final;
     virtual void Render() override final;
     virtual void Update(double CurrTime, double ElapsedTime, bool DoUpdateUI) override final;
     virtual void WindowResize(Uint32 Width, Uint32 Height) override final;
@@ -554,7 +554,7 @@ void GLTFViewer::CreateGLTFRenderer()
         GLTF_PBR_Renderer::CreateInfo::TEX_COLOR_CONVERSION_MODE_NONE :
         GLTF_PBR_Renderer::CreateInfo::TEX_COLOR_CONVERSION_MODE_SRGB_TO_LINEAR;
 
-    m_GLTFRenderer = std::make_unique<GLTF_PBR_Renderer>(m_pDevice, nullptr, m_pImmediateContext, RendererCI);
+    m_GLTFRenderer = std::make_unique<GLTF_PBR_Renderer>(m_pDevice, m_pRenderStateCache, m_pImmediateContext, RendererCI);
 
     if (m_bUseResourceCache)
     {
@@ -582,6 +582,7 @@ void GLTFViewer::CrateEnvMapRenderer()
 {
     EnvMapRenderer::CreateInfo EnvMapRendererCI;
     EnvMapRendererCI.pDevice            = m_pDevice;
+    EnvMapRendererCI.pStateCache        = m_pRenderStateCache;
     EnvMapRendererCI.pCameraAttribsCB   = m_FrameAttribsCB;
     EnvMapRendererCI.PackMatrixRowMajor = true;
     if (m_bEnablePostProcessing)
@@ -627,6 +628,7 @@ void GLTFViewer::CrateBoundBoxRenderer()
 {
     BoundBoxRenderer::CreateInfo BoundBoxRendererCI;
     BoundBoxRendererCI.pDevice            = m_pDevice;
+    BoundBoxRendererCI.pStateCache        = m_pRenderStateCache;
     BoundBoxRendererCI.pCameraAttribsCB   = m_FrameAttribsCB;
     BoundBoxRendererCI.PackMatrixRowMajor = true;
     if (m_bEnablePostProcessing)
@@ -653,6 +655,7 @@ void GLTFViewer::CreateVectorFieldRenderer()
 {
     VectorFieldRenderer::CreateInfo CI;
     CI.pDevice          = m_pDevice;
+    CI.pStateCache      = m_pRenderStateCache;
     CI.NumRenderTargets = 1;
     CI.RTVFormats[0]    = m_pSwapChain->GetDesc().ColorBufferFormat;
 
@@ -1339,6 +1342,7 @@ void GLTFViewer::Render()
         {
             PostFXContext::RenderAttributes PostFXAttibs;
             PostFXAttibs.pDevice             = m_pDevice;
+            PostFXAttibs.pStateCache         = m_pRenderStateCache;
             PostFXAttibs.pDeviceContext      = m_pImmediateContext;
             PostFXAttibs.pCameraAttribsCB    = m_FrameAttribsCB;
             PostFXAttibs.pCurrDepthBufferSRV = pCurrDepthSRV;
@@ -1354,6 +1358,7 @@ void GLTFViewer::Render()
 
             ScreenSpaceReflection::RenderAttributes SSRRenderAttribs{};
             SSRRenderAttribs.pDevice            = m_pDevice;
+            SSRRenderAttribs.pStateCache        = m_pRenderStateCache;
             SSRRenderAttribs.pDeviceContext     = m_pImmediateContext;
             SSRRenderAttribs.pPostFXContext     = m_PostFXContext.get();
             SSRRenderAttribs.pColorBufferSRV    = m_GBuffer->GetBuffer(GBUFFER_RT_RADIANCE)->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
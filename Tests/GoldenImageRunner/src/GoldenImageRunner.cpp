@@ -0,0 +1,51 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "SampleBase.hpp"
+
+namespace Diligent
+{
+
+// The golden image runner builds all samples into a single executable and processes them one
+// after another with the same engine instance (see SampleApp::CreateNextSuiteSample()).
+// This sample is only a placeholder that the app replaces with the first registered sample.
+class GoldenImageRunner final : public SampleBase
+{
+public:
+    virtual void Initialize(const SampleInitInfo& InitInfo) override final {}
+    virtual void Render() override final {}
+    virtual void Update(double CurrTime, double ElapsedTime, bool DoUpdateUI) override final {}
+
+    virtual const Char* GetSampleName() const override final { return "Golden Image Runner"; }
+};
+
+SampleBase* CreateSample()
+{
+    return new GoldenImageRunner();
+}
+
+} // namespace Diligent
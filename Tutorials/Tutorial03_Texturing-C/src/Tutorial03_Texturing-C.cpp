@@ -43,27 +43,27 @@ namespace Diligent
 
 SampleBase* CreateSample()
 {
-    return new Tutorial03_Texturing();
+    return new Tutorial03_Texturing_C();
 }
 
-void Tutorial03_Texturing::Initialize(const SampleInitInfo& InitInfo)
+void Tutorial03_Texturing_C::Initialize(const SampleInitInfo& InitInfo)
 {
     SampleBase::Initialize(InitInfo);
 
     ::CreateResources(InitInfo.pDevice, InitInfo.pSwapChain);
 }
 
-Tutorial03_Texturing::~Tutorial03_Texturing()
+Tutorial03_Texturing_C::~Tutorial03_Texturing_C()
 {
     ::ReleaseResources();
 }
 
-void Tutorial03_Texturing::Render()
+void Tutorial03_Texturing_C::Render()
 {
     ::Render(m_pImmediateContext.RawPtr());
 }
 
-void Tutorial03_Texturing::Update(double CurrTime, double ElapsedTime, bool DoUpdateUI)
+void Tutorial03_Texturing_C::Update(double CurrTime, double ElapsedTime, bool DoUpdateUI)
 {
     SampleBase::Update(CurrTime, ElapsedTime, DoUpdateUI);
 
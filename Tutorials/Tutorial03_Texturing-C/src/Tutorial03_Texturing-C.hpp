@@ -33,12 +33,12 @@
 namespace Diligent
 {
 
-class Tutorial03_Texturing final : public SampleBase
+class Tutorial03_Texturing_C final : public SampleBase
 {
 public:
     virtual void Initialize(const SampleInitInfo& InitInfo) override final;
 
-    ~Tutorial03_Texturing();
+    ~Tutorial03_Texturing_C();
 
     virtual void Render() override final;
     virtual void Update(double CurrTime, double ElapsedTime, bool DoUpdateUI) override final;
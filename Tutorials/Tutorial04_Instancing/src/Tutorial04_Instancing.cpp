@@ -25,10 +25,14 @@
  *  of the possibility of such damages.
  */
 
+#include <algorithm>
 #include <random>
+#include <thread>
 
 #include "Tutorial04_Instancing.hpp"
+#include "InstanceGrid.hpp"
 #include "MapHelper.hpp"
+#include "Timer.hpp"
 #include "GraphicsUtilities.h"
 #include "TextureUtilities.h"
 #include "ColorConversion.h"
@@ -121,6 +125,14 @@ void Tutorial04_Instancing::UpdateUI()
         {
             PopulateInstanceBuffer();
         }
+        if (ImGui::Checkbox("Parallel grid", &m_ParallelGrid))
+        {
+            PopulateInstanceBuffer();
+        }
+        if (m_ParallelGrid)
+            ImGui::Text("Instance data: %.3f ms (%s, %u threads)", m_PopulateTime * 1000.0, GetInstanceGridISA(), m_NumGridThreads);
+        else
+            ImGui::Text("Instance data: %.3f ms", m_PopulateTime * 1000.0);
     }
     ImGui::End();
 }
@@ -141,13 +153,9 @@ void Tutorial04_Instancing::Initialize(const SampleInitInfo& InitInfo)
     CreateInstanceBuffer();
 }
 
-void Tutorial04_Instancing::PopulateInstanceBuffer()
+void Tutorial04_Instancing::GenerateDefaultGrid(float4x4* pMatrices) const
 {
-    // Populate instance data buffer
-    const size_t          zGridSize = static_cast<size_t>(m_GridSize);
-    std::vector<float4x4> InstanceData(zGridSize * zGridSize * zGridSize);
-
-    float fGridSize = static_cast<float>(m_GridSize);
+    const float fGridSize = static_cast<float>(m_GridSize);
 
     std::mt19937 gen; // Standard mersenne_twister_engine. Use default seed
                       // to generate consistent distribution.
@@ -175,14 +183,67 @@ void Tutorial04_Instancing::PopulateInstanceBuffer()
                 rotation *= float4x4::RotationY(rot_distr(gen));
                 rotation *= float4x4::RotationZ(rot_distr(gen));
                 // Combine rotation, scale and translation
-                float4x4 matrix        = rotation * float4x4::Scale(scale, scale, scale) * float4x4::Translation(xOffset, yOffset, zOffset);
-                InstanceData[instId++] = matrix;
+                pMatrices[instId++] = rotation * float4x4::Scale(scale, scale, scale) * float4x4::Translation(xOffset, yOffset, zOffset);
             }
         }
     }
-    // Update instance data buffer
-    Uint32 DataSize = static_cast<Uint32>(sizeof(InstanceData[0]) * InstanceData.size());
-    m_pImmediateContext->UpdateBuffer(m_InstanceBuffer, 0, DataSize, InstanceData.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+}
+
+void Tutorial04_Instancing::PopulateInstanceBuffer()
+{
+    Timer PopulateTimer;
+
+    const Uint32 NumInstances = static_cast<Uint32>(m_GridSize * m_GridSize * m_GridSize);
+    const Uint64 DataSize     = sizeof(float4x4) * NumInstances;
+
+    // Instance matrices are written directly to the mapped staging buffer and then copied
+    // to the instance buffer by the GPU. The staging buffer may be released right after the
+    // copy command is recorded as the engine keeps it alive until the GPU is done with it.
+    BufferDesc UploadBuffDesc;
+    UploadBuffDesc.Name           = "Instance data upload buffer";
+    UploadBuffDesc.Usage          = USAGE_STAGING;
+    UploadBuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+    UploadBuffDesc.Size           = DataSize;
+    RefCntAutoPtr<IBuffer> pUploadBuffer;
+    m_pDevice->CreateBuffer(UploadBuffDesc, nullptr, &pUploadBuffer);
+    {
+        MapHelper<float4x4> InstanceData{m_pImmediateContext, pUploadBuffer, MAP_WRITE, MAP_FLAG_NONE};
+        float4x4*           pMatrices = InstanceData;
+
+        if (m_ParallelGrid)
+        {
+            InstanceGridAttribs GridAttribs;
+            GridAttribs.GridSize  = static_cast<Uint32>(m_GridSize);
+            GridAttribs.BaseScale = 0.6f;
+
+            // The grid is only rebuilt when its size changes, so the worker threads are started
+            // for the rebuild and joined right after it.
+#if PLATFORM_EMSCRIPTEN
+            m_GridWorkers.Start(0);
+#else
+            m_GridWorkers.Start(std::max(std::thread::hardware_concurrency(), 2u) - 1u);
+#endif
+            m_NumGridThreads = m_GridWorkers.GetNumSubsets();
+
+            // Every matrix only depends on its cell index, so the threads may take the
+            // cells in any order and still produce the same grid.
+            m_GridWorkers.SetWorkItems(NumInstances, 256);
+            m_GridWorkers.ParallelFor([&](Uint32 Subset) {
+                Uint32 StartInst = 0, EndInst = 0;
+                while (m_GridWorkers.NextChunk(Subset, StartInst, EndInst))
+                    GenerateInstanceGrid(GridAttribs, StartInst, EndInst, pMatrices + StartInst, sizeof(float4x4));
+            });
+            m_GridWorkers.Stop();
+        }
+        else
+        {
+            GenerateDefaultGrid(pMatrices);
+        }
+    }
+    m_pImmediateContext->CopyBuffer(pUploadBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                    m_InstanceBuffer, 0, DataSize, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+    m_PopulateTime = PopulateTimer.GetElapsedTime();
 }
 
 
@@ -29,6 +29,7 @@
 
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
+#include "ParallelFrameRecorder.hpp"
 
 namespace Diligent
 {
@@ -50,6 +51,17 @@ private:
     void CreatePipelineState();
     void CreateInstanceBuffer();
     void PopulateInstanceBuffer();
+    void GenerateDefaultGrid(float4x4* pMatrices) const;
+
+    // Generate the grid with GenerateInstanceGrid() on the worker threads. The default grid is generated
+    // from a single random sequence and can only be built on one thread, but it keeps the original layout.
+    bool m_ParallelGrid = false;
+
+    // Worker threads that generate the instance matrices. They do not record any commands and
+    // only run while the grid is rebuilt.
+    ParallelTaskPool m_GridWorkers;
+    Uint32           m_NumGridThreads = 1;
+    double           m_PopulateTime   = 0;
 
     RefCntAutoPtr<IPipelineState>         m_pPSO;
     RefCntAutoPtr<IBuffer>                m_CubeVertexBuffer;
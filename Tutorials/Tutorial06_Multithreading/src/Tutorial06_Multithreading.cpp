@@ -48,7 +48,7 @@ SampleBase* CreateSample()
 
 Tutorial06_Multithreading::~Tutorial06_Multithreading()
 {
-    StopWorkerThreads();
+    m_Recorder.Stop();
 }
 
 void Tutorial06_Multithreading::ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Attribs)
@@ -143,10 +143,23 @@ void Tutorial06_Multithreading::UpdateUI()
             ImGui::ScopedDisabler Disable(m_MaxThreads == 0);
             if (ImGui::SliderInt("Worker Threads", &m_NumWorkerThreads, 0, m_MaxThreads))
             {
-                StopWorkerThreads();
-                StartWorkerThreads(m_NumWorkerThreads);
+                m_Recorder.Stop();
+                m_Recorder.Start(m_pDeferredContexts, static_cast<Uint32>(m_NumWorkerThreads));
             }
         }
+        ImGui::Checkbox("Load balancing", &m_LoadBalancing);
+        {
+            ImGui::ScopedDisabler Disable(!m_LoadBalancing);
+            if (ImGui::InputInt("Chunk Size", &m_ChunkSize, 1, 16))
+                m_ChunkSize = clamp(m_ChunkSize, 1, 1024);
+        }
+
+        // Recording time of every thread shows how evenly the work is distributed
+        for (Uint32 i = 0; i < m_Recorder.GetNumSubsets(); ++i)
+        {
+            const ParallelFrameRecorder::SubsetStatistics& Stats = m_Recorder.GetSubsetStatistics(i);
+            ImGui::Text("Thread %u: %.3f ms, %u draws", i, Stats.JobTime * 1000.0, Stats.NumItems);
+        }
     }
 
     ImGui::End();
@@ -176,7 +189,7 @@ void Tutorial06_Multithreading::Initialize(const SampleInitInfo& InitInfo)
 
     PopulateInstanceData();
 
-    StartWorkerThreads(m_NumWorkerThreads);
+    m_Recorder.Start(m_pDeferredContexts, static_cast<Uint32>(m_NumWorkerThreads));
 }
 
 void Tutorial06_Multithreading::PopulateInstanceData()
@@ -224,78 +237,6 @@ void Tutorial06_Multithreading::PopulateInstanceData()
     }
 }
 
-void Tutorial06_Multithreading::StartWorkerThreads(size_t NumThreads)
-{
-    m_WorkerThreads.resize(NumThreads);
-    for (Uint32 t = 0; t < m_WorkerThreads.size(); ++t)
-    {
-        m_WorkerThreads[t] = std::thread(WorkerThreadFunc, this, t);
-    }
-    m_CmdLists.resize(NumThreads);
-}
-
-void Tutorial06_Multithreading::StopWorkerThreads()
-{
-    m_RenderSubsetSignal.Trigger(true, -1);
-
-    for (std::thread& thread : m_WorkerThreads)
-    {
-        thread.join();
-    }
-    m_RenderSubsetSignal.Reset();
-    m_WorkerThreads.clear();
-    m_CmdLists.clear();
-}
-
-void Tutorial06_Multithreading::WorkerThreadFunc(Tutorial06_Multithreading* pThis, Uint32 ThreadNum)
-{
-    // Every thread should use its own deferred context
-    IDeviceContext* pDeferredCtx     = pThis->m_pDeferredContexts[ThreadNum];
-    const int       NumWorkerThreads = static_cast<int>(pThis->m_WorkerThreads.size());
-    for (;;)
-    {
-        // Wait for the signal
-        int SignaledValue = pThis->m_RenderSubsetSignal.Wait(true, NumWorkerThreads);
-        if (SignaledValue < 0)
-            return;
-
-        pDeferredCtx->Begin(0);
-
-        // Render current subset using the deferred context
-        pThis->RenderSubset(pDeferredCtx, 1 + ThreadNum);
-
-        // Finish command list
-        RefCntAutoPtr<ICommandList> pCmdList;
-        pDeferredCtx->FinishCommandList(&pCmdList);
-        pThis->m_CmdLists[ThreadNum] = pCmdList;
-
-        {
-            // Atomically increment the number of completed threads
-            const int NumThreadsCompleted = pThis->m_NumThreadsCompleted.fetch_add(1) + 1;
-            if (NumThreadsCompleted == NumWorkerThreads)
-                pThis->m_ExecuteCommandListsSignal.Trigger();
-        }
-
-        pThis->m_GotoNextFrameSignal.Wait(true, NumWorkerThreads);
-
-        // Call FinishFrame() to release dynamic resources allocated by deferred contexts
-        // IMPORTANT: we must wait until the command lists are submitted for execution
-        //            because FinishFrame() invalidates all dynamic resources.
-        // IMPORTANT: In Metal backend FinishFrame must be called from the same
-        //            thread that issued rendering commands.
-        pDeferredCtx->FinishFrame();
-
-        pThis->m_NumThreadsReady.fetch_add(1);
-        // We must wait until all threads reach this point, because
-        // m_GotoNextFrameSignal must be unsignaled before we proceed to
-        // RenderSubsetSignal to avoid one thread going through the loop twice in
-        // a row.
-        while (pThis->m_NumThreadsReady.load() < NumWorkerThreads)
-            std::this_thread::yield();
-        VERIFY_EXPR(!pThis->m_GotoNextFrameSignal.IsTriggered());
-    }
-}
-
 void Tutorial06_Multithreading::RenderSubset(IDeviceContext* pCtx, Uint32 Subset)
 {
     // Deferred contexts start in default state. We must bind everything to the context.
@@ -325,33 +266,34 @@ void Tutorial06_Multithreading::RenderSubset(IDeviceContext* pCtx, Uint32 Subset
 
     // Set the pipeline state
     pCtx->SetPipelineState(m_pPSO);
-    Uint32 NumSubsets   = Uint32{1} + static_cast<Uint32>(m_WorkerThreads.size());
-    Uint32 NumInstances = static_cast<Uint32>(m_Instances.size());
-    Uint32 SusbsetSize  = NumInstances / NumSubsets;
-    Uint32 StartInst    = SusbsetSize * Subset;
-    Uint32 EndInst      = (Subset < NumSubsets - 1) ? SusbsetSize * (Subset + 1) : NumInstances;
-    for (size_t inst = StartInst; inst < EndInst; ++inst)
+    // Keep taking chunks of instances until none remain
+    Uint32 StartInst = 0;
+    Uint32 EndInst   = 0;
+    while (m_Recorder.NextChunk(Subset, StartInst, EndInst))
     {
-        const InstanceData& CurrInstData = m_Instances[inst];
-        // Shader resources have been explicitly transitioned to correct states, so
-        // RESOURCE_STATE_TRANSITION_MODE_TRANSITION mode is not needed.
-        // Instead, we use RESOURCE_STATE_TRANSITION_MODE_VERIFY mode to
-        // verify that all resources are in correct states. This mode only has effect
-        // in debug and development builds.
-        pCtx->CommitShaderResources(m_SRB[CurrInstData.TextureInd], RESOURCE_STATE_TRANSITION_MODE_VERIFY);
-
+        for (Uint32 inst = StartInst; inst < EndInst; ++inst)
         {
-            // Map the buffer and write current world-view-projection matrix
-            MapHelper<float4x4> InstData(pCtx, m_InstanceConstants, MAP_WRITE, MAP_FLAG_DISCARD);
-            if (InstData == nullptr)
+            const InstanceData& CurrInstData = m_Instances[inst];
+            // Shader resources have been explicitly transitioned to correct states, so
+            // RESOURCE_STATE_TRANSITION_MODE_TRANSITION mode is not needed.
+            // Instead, we use RESOURCE_STATE_TRANSITION_MODE_VERIFY mode to
+            // verify that all resources are in correct states. This mode only has effect
+            // in debug and development builds.
+            pCtx->CommitShaderResources(m_SRB[CurrInstData.TextureInd], RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+
             {
-                LOG_ERROR_MESSAGE("Failed to map instance data buffer");
-                break;
+                // Map the buffer and write current world-view-projection matrix
+                MapHelper<float4x4> InstData(pCtx, m_InstanceConstants, MAP_WRITE, MAP_FLAG_DISCARD);
+                if (InstData == nullptr)
+                {
+                    LOG_ERROR_MESSAGE("Failed to map instance data buffer");
+                    return;
+                }
+                *InstData = CurrInstData.Matrix;
             }
-            *InstData = CurrInstData.Matrix;
-        }
 
-        pCtx->DrawIndexed(DrawAttrs);
+            pCtx->DrawIndexed(DrawAttrs);
+        }
     }
 }
 
@@ -370,35 +312,14 @@ void Tutorial06_Multithreading::Render()
     m_pImmediateContext->ClearRenderTarget(pRTV, ClearColor.Data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
     m_pImmediateContext->ClearDepthStencil(pDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-    if (!m_WorkerThreads.empty())
-    {
-        m_NumThreadsCompleted.store(0);
-        m_RenderSubsetSignal.Trigger(true);
-    }
-
-    RenderSubset(m_pImmediateContext, 0);
-
-    if (!m_WorkerThreads.empty())
-    {
-        m_ExecuteCommandListsSignal.Wait(true, 1);
-
-        m_CmdListPtrs.resize(m_CmdLists.size());
-        for (Uint32 i = 0; i < m_CmdLists.size(); ++i)
-            m_CmdListPtrs[i] = m_CmdLists[i];
+    // With load balancing disabled, every thread renders one fixed subset of instances
+    m_Recorder.SetWorkItems(static_cast<Uint32>(m_Instances.size()), m_LoadBalancing ? static_cast<Uint32>(m_ChunkSize) : 0);
 
-        m_pImmediateContext->ExecuteCommandLists(static_cast<Uint32>(m_CmdListPtrs.size()), m_CmdListPtrs.data());
-
-        for (auto& cmdList : m_CmdLists)
-        {
-            // Release command lists now to release all outstanding references.
-            // In d3d11 mode, command lists hold references to the swap chain's back buffer
-            // that cause swap chain resize to fail.
-            cmdList.Release();
-        }
-
-        m_NumThreadsReady.store(0);
-        m_GotoNextFrameSignal.Trigger(true);
-    }
+    // Worker threads record subsets 1 .. N into their deferred contexts while
+    // this thread records subset 0 directly into the immediate context.
+    m_Recorder.RecordFrame(m_pImmediateContext, [this](IDeviceContext* pCtx, Uint32 Subset) {
+        RenderSubset(pCtx, Subset);
+    });
 }
 
 void Tutorial06_Multithreading::Update(double CurrTime, double ElapsedTime, bool DoUpdateUI)
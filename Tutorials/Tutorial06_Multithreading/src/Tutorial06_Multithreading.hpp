@@ -27,13 +27,10 @@
 
 #pragma once
 
-#include <atomic>
 #include <vector>
-#include <thread>
-#include <mutex>
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
-#include "ThreadSignal.hpp"
+#include "ParallelFrameRecorder.hpp"
 
 namespace Diligent
 {
@@ -58,22 +55,9 @@ private:
     void LoadTextures(std::vector<StateTransitionDesc>& Barriers);
     void PopulateInstanceData();
 
-    void StartWorkerThreads(size_t NumThreads);
-    void StopWorkerThreads();
-
     void RenderSubset(IDeviceContext* pCtx, Uint32 Subset);
 
-    static void WorkerThreadFunc(Tutorial06_Multithreading* pThis, Uint32 ThreadNum);
-
-    Threading::Signal        m_RenderSubsetSignal;
-    Threading::Signal        m_ExecuteCommandListsSignal;
-    Threading::Signal        m_GotoNextFrameSignal;
-    std::atomic_int          m_NumThreadsCompleted;
-    std::atomic_int          m_NumThreadsReady;
-    std::vector<std::thread> m_WorkerThreads;
-
-    std::vector<RefCntAutoPtr<ICommandList>> m_CmdLists;
-    std::vector<ICommandList*>               m_CmdListPtrs;
+    ParallelFrameRecorder m_Recorder;
 
     RefCntAutoPtr<IPipelineState> m_pPSO;
     RefCntAutoPtr<IBuffer>        m_CubeVertexBuffer;
@@ -93,6 +77,10 @@ private:
     int m_MaxThreads       = 8;
     int m_NumWorkerThreads = 4;
 
+    // Threads take chunks of instances from a shared counter instead of rendering fixed subsets
+    bool m_LoadBalancing = true;
+    int  m_ChunkSize     = 16;
+
     struct InstanceData
     {
         float4x4 Matrix;
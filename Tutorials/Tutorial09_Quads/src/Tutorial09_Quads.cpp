@@ -40,6 +40,7 @@
 #include "imgui.h"
 #include "ImGuiUtils.hpp"
 #include "CommandLineParser.hpp"
+#include "Timer.hpp"
 
 namespace Diligent
 {
@@ -51,7 +52,7 @@ SampleBase* CreateSample()
 
 Tutorial09_Quads::~Tutorial09_Quads()
 {
-    StopWorkerThreads();
+    m_Recorder.Stop();
 }
 
 Tutorial09_Quads::CommandLineStatus Tutorial09_Quads::ProcessCommandLine(int argc, const char* const* argv)
@@ -69,6 +70,8 @@ Tutorial09_Quads::CommandLineStatus Tutorial09_Quads::ProcessCommandLine(int arg
     {
         m_NumWorkerThreads = clamp(m_NumWorkerThreads, 0, 128);
     }
+    ArgsParser.Parse("fused", m_FusedUpdate);
+    ArgsParser.Parse("load_balancing", m_LoadBalancing);
 
     return CommandLineStatus::OK;
 }
@@ -244,14 +247,16 @@ void Tutorial09_Quads::CreatePipelineStates(std::vector<StateTransitionDesc>& Ba
     // clang-format off
     // Define vertex shader input layout
     // This tutorial only uses per-instance data.
+    // Instance data is padded to 32 bytes, so the stride must be given explicitly.
+    constexpr Uint32 InstStride = sizeof(InstanceData);
     LayoutElement LayoutElems[] =
     {
         // Attribute 0 - QuadRotationAndScale
-        LayoutElement{0, 0, 4, VT_FLOAT32, False, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+        LayoutElement{0, 0, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
         // Attribute 1 - QuadCenter
-        LayoutElement{1, 0, 2, VT_FLOAT32, False, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+        LayoutElement{1, 0, 2, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
         // Attribute 2 - TexArrInd
-        LayoutElement{2, 0, 1, VT_FLOAT32, False, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE}
+        LayoutElement{2, 0, 1, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE}
     };
     // clang-format on
     PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = LayoutElems;
@@ -348,19 +353,51 @@ void Tutorial09_Quads::UpdateUI()
             m_NumQuads = clamp(m_NumQuads, 1, MaxQuads);
             InitializeQuads();
         }
-        if (ImGui::InputInt("Batch Size", &m_BatchSize, 1, 5))
+        if (ImGui::Checkbox("Fused update", &m_FusedUpdate) && m_FusedUpdate && !m_QuadsSortedByState)
+            SortQuadsByState();
         {
-            m_BatchSize = clamp(m_BatchSize, 1, MaxBatchSize);
-            CreateInstanceBuffer();
+            ImGui::ScopedDisabler Disable(m_FusedUpdate);
+            if (ImGui::InputInt("Batch Size", &m_BatchSize, 1, 5))
+            {
+                m_BatchSize = clamp(m_BatchSize, 1, MaxBatchSize);
+                CreateInstanceBuffer();
+            }
         }
         {
             ImGui::ScopedDisabler Disable(m_MaxThreads == 0);
             if (ImGui::SliderInt("Worker Threads", &m_NumWorkerThreads, 0, m_MaxThreads))
             {
-                StopWorkerThreads();
-                StartWorkerThreads(m_NumWorkerThreads);
+                m_Recorder.Stop();
+                m_Recorder.Start(m_pDeferredContexts, static_cast<Uint32>(m_NumWorkerThreads));
             }
         }
+
+        {
+            // Fused mode always splits the quads evenly between the threads
+            ImGui::ScopedDisabler Disable(m_FusedUpdate);
+            ImGui::Checkbox("Load balancing", &m_LoadBalancing);
+            ImGui::ScopedDisabler DisableChunkSize(!m_LoadBalancing);
+            if (ImGui::InputInt("Chunk Size", &m_ChunkSize, 1, 16))
+                m_ChunkSize = clamp(m_ChunkSize, 1, 1024);
+        }
+
+        // Threads update their quads in parallel, so the slowest one defines the update time
+        double UpdateTime = 0;
+        for (size_t i = 0; i < m_Recorder.GetNumSubsets(); ++i)
+            UpdateTime = std::max(UpdateTime, m_SubsetUpdateTime[i]);
+        // In fused mode, this also includes writing the instance data
+        ImGui::Text("Update time: %.3f ms (%s)", UpdateTime * 1000.0, GetSpriteMotionISA());
+
+        // Recording time of every thread shows how evenly the work is distributed
+        for (Uint32 i = 0; i < m_Recorder.GetNumSubsets(); ++i)
+        {
+            const ParallelFrameRecorder::SubsetStatistics& Stats = m_Recorder.GetSubsetStatistics(i);
+            // Fused mode does not take batches from the recorder and issues one draw call per state
+            if (m_FusedUpdate)
+                ImGui::Text("Thread %u: %.3f ms, %u draws", i, Stats.JobTime * 1000.0, m_SubsetNumDraws[i]);
+            else
+                ImGui::Text("Thread %u: %.3f ms, %u batches", i, Stats.JobTime * 1000.0, Stats.NumItems);
+        }
     }
     ImGui::End();
 }
@@ -372,6 +409,8 @@ void Tutorial09_Quads::Initialize(const SampleInitInfo& InitInfo)
 
     m_MaxThreads       = static_cast<int>(m_pDeferredContexts.size());
     m_NumWorkerThreads = std::min(m_NumWorkerThreads, m_MaxThreads);
+    m_SubsetUpdateTime.resize(1 + m_pDeferredContexts.size());
+    m_SubsetNumDraws.resize(1 + m_pDeferredContexts.size());
 
     std::vector<StateTransitionDesc> Barriers;
     CreatePipelineStates(Barriers);
@@ -383,12 +422,13 @@ void Tutorial09_Quads::Initialize(const SampleInitInfo& InitInfo)
     if (m_BatchSize > 1)
         CreateInstanceBuffer();
 
-    StartWorkerThreads(m_NumWorkerThreads);
+    m_Recorder.Start(m_pDeferredContexts, static_cast<Uint32>(m_NumWorkerThreads));
 }
 
 void Tutorial09_Quads::InitializeQuads()
 {
     m_Quads.resize(m_NumQuads);
+    m_QuadMotion.Resize(m_NumQuads);
 
     std::mt19937 gen; // Standard mersenne_twister_engine. Use default seed
                       // to generate consistent distribution.
@@ -405,118 +445,63 @@ void Tutorial09_Quads::InitializeQuads()
     {
         QuadData& CurrInst = m_Quads[quad];
         CurrInst.Size      = scale_distr(gen);
-        CurrInst.Angle     = angle_distr(gen);
-        CurrInst.Pos.x     = pos_distr(gen);
-        CurrInst.Pos.y     = pos_distr(gen);
-        CurrInst.MoveDir.x = move_dir_distr(gen);
-        CurrInst.MoveDir.y = move_dir_distr(gen);
-        CurrInst.RotSpeed  = rot_distr(gen);
+
+        m_QuadMotion.Angle[quad]      = angle_distr(gen);
+        m_QuadMotion.PosX[quad]       = pos_distr(gen);
+        m_QuadMotion.PosY[quad]       = pos_distr(gen);
+        m_QuadMotion.MoveDirX[quad]   = move_dir_distr(gen);
+        m_QuadMotion.MoveDirY[quad]   = move_dir_distr(gen);
+        m_QuadMotion.RotSpeed[quad]   = rot_distr(gen);
+        m_QuadMotion.NumBounces[quad] = 0;
+
         // Texture array index
         CurrInst.TextureInd = tex_distr(gen);
         CurrInst.StateInd   = state_distr(gen);
-    }
-}
-
-void Tutorial09_Quads::UpdateQuads(float elapsedTime)
-{
-    std::mt19937 gen; // Standard mersenne_twister_engine. Use default seed
-                      // to generate consistent distribution.
-
-    std::uniform_real_distribution<float> rot_distr(-PI_F * 0.5f, +PI_F * 0.5f);
-    for (int quad = 0; quad < m_NumQuads; ++quad)
-    {
-        QuadData& CurrInst = m_Quads[quad];
-        CurrInst.Angle += CurrInst.RotSpeed * elapsedTime;
-        if (std::abs(CurrInst.Pos.x + CurrInst.MoveDir.x * elapsedTime) > 0.95)
-        {
-            CurrInst.MoveDir.x *= -1.f;
-            CurrInst.RotSpeed = rot_distr(gen);
-        }
-        CurrInst.Pos.x += CurrInst.MoveDir.x * elapsedTime;
-        if (std::abs(CurrInst.Pos.y + CurrInst.MoveDir.y * elapsedTime) > 0.95)
-        {
-            CurrInst.MoveDir.y *= -1.f;
-            CurrInst.RotSpeed = rot_distr(gen);
-        }
-        CurrInst.Pos.y += CurrInst.MoveDir.y * elapsedTime;
-    }
-}
 
-void Tutorial09_Quads::StartWorkerThreads(size_t NumThreads)
-{
-    m_WorkerThreads.resize(NumThreads);
-    for (Uint32 t = 0; t < m_WorkerThreads.size(); ++t)
-    {
-        m_WorkerThreads[t] = std::thread(WorkerThreadFunc, this, t);
+        m_QuadMotion.Size[quad]      = CurrInst.Size;
+        m_QuadMotion.TexArrInd[quad] = static_cast<float>(CurrInst.TextureInd);
     }
-    m_CmdLists.resize(NumThreads);
-}
 
-void Tutorial09_Quads::StopWorkerThreads()
-{
-    m_RenderSubsetSignal.Trigger(true, -1);
-
-    for (std::thread& thread : m_WorkerThreads)
-    {
-        thread.join();
-    }
-    m_RenderSubsetSignal.Reset();
-    m_WorkerThreads.clear();
-    m_CmdLists.clear();
+    m_QuadsSortedByState = false;
+    if (m_FusedUpdate)
+        SortQuadsByState();
 }
 
-void Tutorial09_Quads::WorkerThreadFunc(Tutorial09_Quads* pThis, Uint32 ThreadNum)
+void Tutorial09_Quads::SortQuadsByState()
 {
-    // Every thread should use its own deferred context
-    IDeviceContext* pDeferredCtx = pThis->m_pDeferredContexts[ThreadNum];
+    // Sort the quads by state so that all quads with the same state can be drawn together
+    std::fill(std::begin(m_StateOffsets), std::end(m_StateOffsets), 0);
+    for (const QuadData& Quad : m_Quads)
+        ++m_StateOffsets[Quad.StateInd + 1];
+    for (int state = 0; state < NumStates; ++state)
+        m_StateOffsets[state + 1] += m_StateOffsets[state];
 
-    const int NumWorkerThreads = static_cast<int>(pThis->m_WorkerThreads.size());
-    VERIFY_EXPR(NumWorkerThreads > 0);
-    for (;;)
-    {
-        // Wait for the signal
-        int SignaledValue = pThis->m_RenderSubsetSignal.Wait(true, NumWorkerThreads);
-        if (SignaledValue < 0)
-            return;
+    std::vector<Uint32> Order(m_NumQuads);
+    Uint32              NextQuad[NumStates];
+    std::copy(m_StateOffsets, m_StateOffsets + NumStates, NextQuad);
+    for (Uint32 quad = 0; quad < m_Quads.size(); ++quad)
+        Order[NextQuad[m_Quads[quad].StateInd]++] = quad;
 
-        pDeferredCtx->Begin(0);
+    std::vector<QuadData> SortedQuads(m_Quads.size());
+    for (size_t i = 0; i < Order.size(); ++i)
+        SortedQuads[i] = m_Quads[Order[i]];
+    m_Quads.swap(SortedQuads);
+    m_QuadMotion.Reorder(Order);
 
-        // Render current subset using the deferred context
-        if (pThis->m_BatchSize > 1)
-            pThis->RenderSubset<true>(pDeferredCtx, 1 + ThreadNum);
-        else
-            pThis->RenderSubset<false>(pDeferredCtx, 1 + ThreadNum);
+    m_QuadsSortedByState = true;
+}
 
-        // Finish command list
-        RefCntAutoPtr<ICommandList> pCmdList;
-        pDeferredCtx->FinishCommandList(&pCmdList);
-        pThis->m_CmdLists[ThreadNum] = pCmdList;
+void Tutorial09_Quads::UpdateQuads(Uint32 Subset, Uint32 StartQuad, Uint32 EndQuad)
+{
+    Timer UpdateTimer;
 
-        {
-            // Atomically increment the number of completed threads
-            const int NumThreadsCompleted = pThis->m_NumThreadsCompleted.fetch_add(1) + 1;
-            if (NumThreadsCompleted == NumWorkerThreads)
-                pThis->m_ExecuteCommandListsSignal.Trigger();
-        }
+    SpriteMotionUpdateAttribs Attribs;
+    Attribs.ElapsedTime = m_ElapsedTime;
+    Attribs.Bounds      = 0.95f;
+    Attribs.MaxRotSpeed = PI_F * 0.5f;
+    UpdateSpriteMotion(m_QuadMotion, StartQuad, EndQuad, Attribs);
 
-        pThis->m_GotoNextFrameSignal.Wait(true, NumWorkerThreads);
-
-        // Call FinishFrame() to release dynamic resources allocated by deferred contexts
-        // IMPORTANT: we must wait until the command lists are submitted for execution
-        //            because FinishFrame() invalidates all dynamic resources.
-        // IMPORTANT: In Metal backend FinishFrame must be called from the same
-        //            thread that issued rendering commands.
-        pDeferredCtx->FinishFrame();
-
-        pThis->m_NumThreadsReady.fetch_add(1);
-        // We must wait until all threads reach this point, because
-        // m_GotoNextFrameSignal must be unsignaled before we proceed to
-        // RenderSubsetSignal to avoid one thread go through the loop twice in
-        // a row
-        while (pThis->m_NumThreadsReady.load() < NumWorkerThreads)
-            std::this_thread::yield();
-        VERIFY_EXPR(!pThis->m_GotoNextFrameSignal.IsTriggered());
-    }
+    m_SubsetUpdateTime[Subset] += UpdateTimer.GetElapsedTime();
 }
 
 template <bool UseBatch>
@@ -536,88 +521,159 @@ void Tutorial09_Quads::RenderSubset(IDeviceContext* pCtx, Uint32 Subset)
     DrawAttrs.Flags       = DRAW_FLAG_VERIFY_ALL;
     DrawAttrs.NumVertices = 4;
 
-    Uint32       NumSubsets   = Uint32{1} + static_cast<Uint32>(m_WorkerThreads.size());
-    const Uint32 TotalQuads   = static_cast<Uint32>(m_Quads.size());
-    const Uint32 TotalBatches = (TotalQuads + m_BatchSize - 1) / m_BatchSize;
-    const Uint32 SusbsetSize  = TotalBatches / NumSubsets;
-    const Uint32 StartBatch   = SusbsetSize * Subset;
-    const Uint32 EndBatch     = (Subset < NumSubsets - 1) ? SusbsetSize * (Subset + 1) : TotalBatches;
-    for (Uint32 batch = StartBatch; batch < EndBatch; ++batch)
-    {
-        const Uint32 StartInst = batch * m_BatchSize;
-        const Uint32 EndInst   = std::min(StartInst + static_cast<Uint32>(m_BatchSize), static_cast<Uint32>(m_NumQuads));
+    const Uint32 TotalQuads = static_cast<Uint32>(m_Quads.size());
 
-        // Set the pipeline state
-        int StateInd = m_Quads[StartInst].StateInd;
-        pCtx->SetPipelineState(m_pPSO[UseBatch ? 1 : 0][StateInd]);
+    // Keep taking chunks of batches until none remain
+    m_SubsetUpdateTime[Subset] = 0;
+    Uint32 StartBatch          = 0;
+    Uint32 EndBatch            = 0;
+    while (m_Recorder.NextChunk(Subset, StartBatch, EndBatch))
+    {
+        // Every thread advances the quads it is about to render, so no synchronization is needed
+        UpdateQuads(Subset, StartBatch * m_BatchSize, std::min(EndBatch * m_BatchSize, TotalQuads));
 
-        MapHelper<InstanceData> BatchData;
-        if (UseBatch)
+        for (Uint32 batch = StartBatch; batch < EndBatch; ++batch)
         {
-            pCtx->CommitShaderResources(m_BatchSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
-            BatchData.Map(pCtx, m_BatchDataBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
-        }
+            const Uint32 StartInst = batch * m_BatchSize;
+            const Uint32 EndInst   = std::min(StartInst + static_cast<Uint32>(m_BatchSize), static_cast<Uint32>(m_NumQuads));
 
-        for (Uint32 inst = StartInst; inst < EndInst; ++inst)
-        {
-            const QuadData& CurrInstData = m_Quads[inst];
-            // Shader resources have been explicitly transitioned to correct states, so
-            // RESOURCE_STATE_TRANSITION_MODE_TRANSITION mode is not needed.
-            // Instead, we use RESOURCE_STATE_TRANSITION_MODE_VERIFY mode to
-            // verify that all resources are in correct states. This mode only has effect
-            // in debug and development builds
-            if (!UseBatch)
-                pCtx->CommitShaderResources(m_SRB[CurrInstData.TextureInd], RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+            // Set the pipeline state
+            int StateInd = m_Quads[StartInst].StateInd;
+            pCtx->SetPipelineState(m_pPSO[UseBatch ? 1 : 0][StateInd]);
 
+            MapHelper<InstanceData> BatchData;
+            if (UseBatch)
             {
-                // clang-format off
-                float2x2 ScaleMatr
-                {
-                    CurrInstData.Size,               0.f,
-                    0.f,               CurrInstData.Size
-                };
-                // clang-format on
-                float    sinAngle = sinf(CurrInstData.Angle);
-                float    cosAngle = cosf(CurrInstData.Angle);
-                float2x2 RotMatr(cosAngle, -sinAngle,
-                                 sinAngle, cosAngle);
-                float2x2 Matr = ScaleMatr * RotMatr;
-
-                float4 QuadRotationAndScale(Matr.m00, Matr.m10, Matr.m01, Matr.m11);
-
-                if (UseBatch)
-                {
-                    InstanceData& CurrQuad        = BatchData[inst - StartInst];
-                    CurrQuad.QuadRotationAndScale = QuadRotationAndScale;
-                    CurrQuad.QuadCenter           = CurrInstData.Pos;
-                    CurrQuad.TexArrInd            = static_cast<float>(CurrInstData.TextureInd);
-                }
-                else
+                pCtx->CommitShaderResources(m_BatchSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+                BatchData.Map(pCtx, m_BatchDataBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
+            }
+
+            for (Uint32 inst = StartInst; inst < EndInst; ++inst)
+            {
+                const QuadData& CurrInstData = m_Quads[inst];
+                // Shader resources have been explicitly transitioned to correct states, so
+                // RESOURCE_STATE_TRANSITION_MODE_TRANSITION mode is not needed.
+                // Instead, we use RESOURCE_STATE_TRANSITION_MODE_VERIFY mode to
+                // verify that all resources are in correct states. This mode only has effect
+                // in debug and development builds
+                if (!UseBatch)
+                    pCtx->CommitShaderResources(m_SRB[CurrInstData.TextureInd], RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+
                 {
-                    struct QuadAttribs
+                    // clang-format off
+                    float2x2 ScaleMatr
                     {
-                        float4 g_QuadRotationAndScale;
-                        float4 g_QuadCenter;
+                        CurrInstData.Size,               0.f,
+                        0.f,               CurrInstData.Size
                     };
+                    // clang-format on
+                    float    sinAngle = sinf(m_QuadMotion.Angle[inst]);
+                    float    cosAngle = cosf(m_QuadMotion.Angle[inst]);
+                    float2x2 RotMatr(cosAngle, -sinAngle,
+                                     sinAngle, cosAngle);
+                    float2x2 Matr = ScaleMatr * RotMatr;
 
-                    // Map the buffer and write current world-view-projection matrix
-                    MapHelper<QuadAttribs> InstData(pCtx, m_QuadAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD);
+                    float4 QuadRotationAndScale(Matr.m00, Matr.m10, Matr.m01, Matr.m11);
 
-                    InstData->g_QuadRotationAndScale = QuadRotationAndScale;
-                    InstData->g_QuadCenter.x         = CurrInstData.Pos.x;
-                    InstData->g_QuadCenter.y         = CurrInstData.Pos.y;
+                    if (UseBatch)
+                    {
+                        InstanceData& CurrQuad        = BatchData[inst - StartInst];
+                        CurrQuad.QuadRotationAndScale = QuadRotationAndScale;
+                        CurrQuad.QuadCenter           = float2{m_QuadMotion.PosX[inst], m_QuadMotion.PosY[inst]};
+                        CurrQuad.TexArrInd            = static_cast<float>(CurrInstData.TextureInd);
+                    }
+                    else
+                    {
+                        struct QuadAttribs
+                        {
+                            float4 g_QuadRotationAndScale;
+                            float4 g_QuadCenter;
+                        };
+
+                        // Map the buffer and write current world-view-projection matrix
+                        MapHelper<QuadAttribs> InstData(pCtx, m_QuadAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD);
+
+                        InstData->g_QuadRotationAndScale = QuadRotationAndScale;
+                        InstData->g_QuadCenter.x         = m_QuadMotion.PosX[inst];
+                        InstData->g_QuadCenter.y         = m_QuadMotion.PosY[inst];
+                    }
                 }
             }
+
+            if (UseBatch)
+                BatchData.Unmap();
+
+            DrawAttrs.NumInstances = EndInst - StartInst;
+            pCtx->Draw(DrawAttrs);
         }
+    }
+}
+
+void Tutorial09_Quads::RenderSubsetFused(IDeviceContext* pCtx, Uint32 Subset)
+{
+    ITextureView* pRTV = m_pSwapChain->GetCurrentBackBufferRTV();
+    pCtx->SetRenderTargets(1, &pRTV, m_pSwapChain->GetDepthBufferDSV(), RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+
+    // Quads are evenly split between the subsets regardless of the batch size
+    const Uint32 NumSubsets = m_Recorder.GetNumSubsets();
+    const Uint32 TotalQuads = static_cast<Uint32>(m_Quads.size());
+    const Uint32 StartQuad  = static_cast<Uint32>(Uint64{TotalQuads} * Subset / NumSubsets);
+    const Uint32 EndQuad    = static_cast<Uint32>(Uint64{TotalQuads} * (Subset + 1) / NumSubsets);
+
+    m_SubsetNumDraws[Subset] = 0;
+    if (StartQuad == EndQuad)
+        return;
+
+    IBuffer* pInstBuffer = m_SubsetInstanceBuffers[Subset];
+    {
+        Timer UpdateTimer;
+
+        SpriteMotionUpdateAttribs Attribs;
+        Attribs.ElapsedTime = m_ElapsedTime;
+        Attribs.Bounds      = 0.95f;
+        Attribs.MaxRotSpeed = PI_F * 0.5f;
+
+        // Map the buffer once and stream the instance data of all quads in the subset into it.
+        // Instance data is written with non-temporal stores that bypass the cache.
+        MapHelper<InstanceData> InstData{pCtx, pInstBuffer, MAP_WRITE, MAP_FLAG_DISCARD};
+        UpdateSpriteInstances(m_QuadMotion, StartQuad, EndQuad, Attribs, reinterpret_cast<SpriteInstanceData*>(static_cast<InstanceData*>(InstData)));
+
+        m_SubsetUpdateTime[Subset] = UpdateTimer.GetElapsedTime();
+    }
+
+    DrawAttribs DrawAttrs;
+    DrawAttrs.Flags       = DRAW_FLAG_VERIFY_ALL;
+    DrawAttrs.NumVertices = 4;
 
-        if (UseBatch)
-            BatchData.Unmap();
+    // Draw all quads of every state with a single instanced draw call
+    for (int state = 0; state < NumStates; ++state)
+    {
+        const Uint32 FirstQuad = std::max(m_StateOffsets[state], StartQuad);
+        const Uint32 LastQuad  = std::min(m_StateOffsets[state + 1], EndQuad);
+        if (FirstQuad >= LastQuad)
+            continue;
 
-        DrawAttrs.NumInstances = EndInst - StartInst;
+        const Uint64 Offset = Uint64{FirstQuad - StartQuad} * sizeof(InstanceData);
+        pCtx->SetVertexBuffers(0, 1, &pInstBuffer, &Offset, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_RESET);
+        pCtx->SetPipelineState(m_pPSO[1][state]);
+        pCtx->CommitShaderResources(m_BatchSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+
+        DrawAttrs.NumInstances = LastQuad - FirstQuad;
         pCtx->Draw(DrawAttrs);
+        ++m_SubsetNumDraws[Subset];
     }
 }
 
+void Tutorial09_Quads::RenderCurrentSubset(IDeviceContext* pCtx, Uint32 Subset)
+{
+    if (m_FusedUpdate)
+        RenderSubsetFused(pCtx, Subset);
+    else if (m_BatchSize > 1)
+        RenderSubset<true>(pCtx, Subset);
+    else
+        RenderSubset<false>(pCtx, Subset);
+}
+
 // Render a frame
 void Tutorial09_Quads::Render()
 {
@@ -633,38 +689,18 @@ void Tutorial09_Quads::Render()
     m_pImmediateContext->ClearRenderTarget(pRTV, ClearColor.Data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
     m_pImmediateContext->ClearDepthStencil(pDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-    if (!m_WorkerThreads.empty())
-    {
-        m_NumThreadsCompleted.store(0);
-        m_RenderSubsetSignal.Trigger(true);
-    }
-
-    if (m_BatchSize > 1)
-        RenderSubset<true>(m_pImmediateContext, 0);
-    else
-        RenderSubset<false>(m_pImmediateContext, 0);
+    // Instance buffers must be created and transitioned before the worker threads start recording
+    if (m_FusedUpdate)
+        CreateSubsetInstanceBuffers();
 
-    if (!m_WorkerThreads.empty())
-    {
-        m_ExecuteCommandListsSignal.Wait(true, 1);
+    // With load balancing disabled, every thread renders one fixed subset of batches.
+    // Fused mode always splits the quads evenly, see RenderSubsetFused().
+    const Uint32 NumBatches = (static_cast<Uint32>(m_Quads.size()) + m_BatchSize - 1) / m_BatchSize;
+    m_Recorder.SetWorkItems(NumBatches, m_LoadBalancing ? static_cast<Uint32>(m_ChunkSize) : 0);
 
-        m_CmdListPtrs.resize(m_CmdLists.size());
-        for (Uint32 i = 0; i < m_CmdLists.size(); ++i)
-            m_CmdListPtrs[i] = m_CmdLists[i];
-
-        m_pImmediateContext->ExecuteCommandLists(static_cast<Uint32>(m_CmdListPtrs.size()), m_CmdListPtrs.data());
-
-        for (auto& cmdList : m_CmdLists)
-        {
-            // Release command lists now to release all outstanding references
-            // In d3d11 mode, command lists hold references to the swap chain's back buffer
-            // that cause swap chain resize to fail
-            cmdList.Release();
-        }
-
-        m_NumThreadsReady.store(0);
-        m_GotoNextFrameSignal.Trigger(true);
-    }
+    m_Recorder.RecordFrame(m_pImmediateContext, [this](IDeviceContext* pCtx, Uint32 Subset) {
+        RenderCurrentSubset(pCtx, Subset);
+    });
 }
 
 void Tutorial09_Quads::CreateInstanceBuffer()
@@ -683,11 +719,37 @@ void Tutorial09_Quads::CreateInstanceBuffer()
     m_pImmediateContext->TransitionResourceStates(1, &Barrier);
 }
 
+void Tutorial09_Quads::CreateSubsetInstanceBuffers()
+{
+    const Uint32 NumSubsets = m_Recorder.GetNumSubsets();
+    const Uint32 SubsetSize = (static_cast<Uint32>(m_Quads.size()) + NumSubsets - 1) / NumSubsets;
+
+    m_SubsetInstanceBuffers.resize(NumSubsets);
+    for (RefCntAutoPtr<IBuffer>& pBuffer : m_SubsetInstanceBuffers)
+    {
+        // Dynamic buffer memory is allocated when the buffer is mapped, so keep the size tight
+        if (pBuffer && pBuffer->GetDesc().Size == sizeof(InstanceData) * SubsetSize)
+            continue;
+
+        BufferDesc InstBuffDesc;
+        InstBuffDesc.Name           = "Subset instance buffer";
+        InstBuffDesc.Usage          = USAGE_DYNAMIC;
+        InstBuffDesc.BindFlags      = BIND_VERTEX_BUFFER;
+        InstBuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+        InstBuffDesc.Size           = sizeof(InstanceData) * SubsetSize;
+        pBuffer.Release();
+        m_pDevice->CreateBuffer(InstBuffDesc, nullptr, &pBuffer);
+        StateTransitionDesc Barrier(pBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE);
+        m_pImmediateContext->TransitionResourceStates(1, &Barrier);
+    }
+}
+
 void Tutorial09_Quads::Update(double CurrTime, double ElapsedTime, bool DoUpdateUI)
 {
     SampleBase::Update(CurrTime, ElapsedTime, DoUpdateUI);
 
-    UpdateQuads(static_cast<float>(std::min(ElapsedTime, 0.25)));
+    // Quads are advanced by the threads that render them
+    m_ElapsedTime = static_cast<float>(std::min(ElapsedTime, 0.25));
 }
 
 } // namespace Diligent
@@ -27,13 +27,11 @@
 
 #pragma once
 
-#include <atomic>
 #include <vector>
-#include <thread>
-#include <mutex>
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
-#include "ThreadSignal.hpp"
+#include "ParallelFrameRecorder.hpp"
+#include "SpriteMotion.hpp"
 
 namespace Diligent
 {
@@ -62,31 +60,25 @@ private:
     void LoadTextures(std::vector<StateTransitionDesc>& Barriers);
 
     void InitializeQuads();
+    void SortQuadsByState();
     void CreateInstanceBuffer();
-    void UpdateQuads(float elapsedTime);
-    void StartWorkerThreads(size_t NumThreads);
-    void StopWorkerThreads();
+    void CreateSubsetInstanceBuffers();
+    void UpdateQuads(Uint32 Subset, Uint32 StartQuad, Uint32 EndQuad);
     template <bool UseBatch>
     void RenderSubset(IDeviceContext* pCtx, Uint32 Subset);
+    void RenderSubsetFused(IDeviceContext* pCtx, Uint32 Subset);
+    void RenderCurrentSubset(IDeviceContext* pCtx, Uint32 Subset);
 
-    static void WorkerThreadFunc(Tutorial09_Quads* pThis, Uint32 ThreadNum);
-
-    Threading::Signal m_RenderSubsetSignal;
-    Threading::Signal m_ExecuteCommandListsSignal;
-    Threading::Signal m_GotoNextFrameSignal;
-
-    std::atomic_int m_NumThreadsCompleted;
-    std::atomic_int m_NumThreadsReady;
-
-    std::vector<std::thread>                 m_WorkerThreads;
-    std::vector<RefCntAutoPtr<ICommandList>> m_CmdLists;
-    std::vector<ICommandList*>               m_CmdListPtrs;
+    ParallelFrameRecorder m_Recorder;
 
     static constexpr int          NumStates = 5;
     RefCntAutoPtr<IPipelineState> m_pPSO[2][NumStates];
     RefCntAutoPtr<IBuffer>        m_QuadAttribsCB;
     RefCntAutoPtr<IBuffer>        m_BatchDataBuffer;
 
+    // In fused mode, every subset writes the instance data of all its quads into its own buffer
+    std::vector<RefCntAutoPtr<IBuffer>> m_SubsetInstanceBuffers;
+
     static constexpr int                  NumTextures = 4;
     RefCntAutoPtr<IShaderResourceBinding> m_SRB[NumTextures];
     RefCntAutoPtr<IShaderResourceBinding> m_BatchSRB;
@@ -102,24 +94,42 @@ private:
     int m_MaxThreads       = 8;
     int m_NumWorkerThreads = 4;
 
+    // Threads take chunks of batches from a shared counter instead of rendering fixed subsets
+    bool m_LoadBalancing = false;
+    int  m_ChunkSize     = 16;
+
+    // Update the quads and write their instance data in a single pass, then draw
+    // every state with one instanced draw call per thread
+    bool m_FusedUpdate = false;
+
     struct QuadData
     {
-        float2 Pos;
-        float2 MoveDir;
-        float  Size       = 0;
-        float  Angle      = 0;
-        float  RotSpeed   = 0;
-        int    TextureInd = 0;
-        int    StateInd   = 0;
+        float Size       = 0;
+        int   TextureInd = 0;
+        int   StateInd   = 0;
     };
     std::vector<QuadData> m_Quads;
 
+    // In fused mode, quads are sorted by state, quads [m_StateOffsets[s], m_StateOffsets[s+1]) use state s.
+    // Other modes keep the original order, so that their output does not change.
+    Uint32 m_StateOffsets[NumStates + 1] = {};
+    bool   m_QuadsSortedByState          = false;
+
+    // Quad positions, directions and rotations are stored separately in SoA layout and
+    // updated by every thread for the quads it renders, right before recording commands.
+    SpriteMotionSoA     m_QuadMotion;
+    float               m_ElapsedTime = 0;
+    std::vector<double> m_SubsetUpdateTime;
+    std::vector<Uint32> m_SubsetNumDraws; // Only counted in fused mode
+
     struct InstanceData
     {
         float4 QuadRotationAndScale;
         float2 QuadCenter;
         float  TexArrInd;
+        float  Padding;
     };
+    static_assert(sizeof(InstanceData) == sizeof(SpriteInstanceData), "Instance data must match the layout written by UpdateSpriteInstances()");
 };
 
 } // namespace Diligent
@@ -0,0 +1,219 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "StreamingRingBuffer.hpp"
+
+#include <algorithm>
+
+#include "Align.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+// Chunk offsets and sizes are multiples of this value, so that any allocation
+// with smaller alignment only needs to be aligned within its chunk.
+constexpr Uint64 ChunkAlignment = 256;
+
+Uint64 NextPowerOfTwo(Uint64 Value)
+{
+    Uint64 Pow2 = ChunkAlignment;
+    while (Pow2 < Value)
+        Pow2 <<= 1;
+    return Pow2;
+}
+
+} // namespace
+
+StreamingRingBuffer::StreamingRingBuffer(IRenderDevice* pDevice, IDeviceContext* pImmediateCtx, const CreateInfo& CI) :
+    m_pDevice{pDevice},
+    m_pImmediateCtx{pImmediateCtx},
+    m_CI{CI},
+    m_ThreadChunks(std::max(CI.NumThreads, size_t{1}))
+{
+    VERIFY(IsSupported(pDevice), "The device does not support CPU-writable unified memory");
+    m_CurrPage = CreatePage(NextPowerOfTwo(std::max(CI.InitialSize, Uint64{CI.ChunkSize} * m_ThreadChunks.size())));
+}
+
+bool StreamingRingBuffer::IsSupported(IRenderDevice* pDevice)
+{
+    const AdapterMemoryInfo& MemInfo = pDevice->GetAdapterInfo().Memory;
+    return MemInfo.UnifiedMemory != 0 && (MemInfo.UnifiedMemoryCPUAccess & CPU_ACCESS_WRITE) != 0;
+}
+
+std::unique_ptr<StreamingRingBuffer::Page> StreamingRingBuffer::CreatePage(Uint64 Capacity)
+{
+    std::unique_ptr<Page> pPage = std::make_unique<Page>();
+    pPage->Capacity             = Capacity;
+
+    BufferDesc BuffDesc;
+    BuffDesc.Name           = m_CI.Name;
+    BuffDesc.Usage          = USAGE_UNIFIED;
+    BuffDesc.BindFlags      = m_CI.BindFlags;
+    BuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+    BuffDesc.Size           = Capacity;
+    m_pDevice->CreateBuffer(BuffDesc, nullptr, &pPage->pBuffer);
+    VERIFY_EXPR(pPage->pBuffer);
+
+    // Unified memory stays mapped for the lifetime of the buffer. It is never written
+    // by the GPU, so no synchronization other than the frame fences is required.
+    pPage->MappedData.Map(m_pImmediateCtx, pPage->pBuffer, MAP_WRITE, MAP_FLAG_NO_OVERWRITE);
+
+    StateTransitionDesc Barrier{pPage->pBuffer, RESOURCE_STATE_UNKNOWN, m_CI.DefaultState, STATE_TRANSITION_FLAG_UPDATE_STATE};
+    m_pImmediateCtx->TransitionResourceStates(1, &Barrier);
+
+    return pPage;
+}
+
+void StreamingRingBuffer::BeginFrame(Uint64 CompletedFenceValue, Uint64 FrameSizeHint)
+{
+    // Reclaim the space used by the frames the GPU has finished
+    auto ReleaseCompletedFrames = [CompletedFenceValue](Page& Pg) {
+        while (!Pg.Frames.empty() && Pg.Frames.front().FenceValue <= CompletedFenceValue)
+        {
+            Pg.Tail = Pg.Frames.front().Head;
+            Pg.Frames.pop_front();
+        }
+    };
+
+    ReleaseCompletedFrames(*m_CurrPage);
+    for (std::unique_ptr<Page>& pPage : m_RetiredPages)
+    {
+        ReleaseCompletedFrames(*pPage);
+        if (pPage->Frames.empty())
+            pPage.reset();
+    }
+    m_RetiredPages.erase(std::remove(m_RetiredPages.begin(), m_RetiredPages.end(), nullptr), m_RetiredPages.end());
+
+    // Every thread may abandon the end of its last chunk, and one chunk may be skipped at the ring end
+    const Uint64 Slack    = Uint64{m_CI.ChunkSize} * (m_ThreadChunks.size() + 1);
+    const Uint64 Required = std::max(FrameSizeHint, m_LastFrameDemand) + Slack;
+
+    Page&        Pg        = *m_CurrPage;
+    const Uint64 FreeSpace = Pg.Capacity - (Pg.Head.load() - Pg.Tail);
+    if (FreeSpace < Required)
+    {
+        // Make the new buffer large enough to hold all frames that are currently in flight
+        // plus the new one, so that it does not have to grow again while the load is stable.
+        const Uint64 NewCapacity = NextPowerOfTwo(std::max(Pg.Capacity * 2, Required * (Pg.Frames.size() + 1)));
+        if (!Pg.Frames.empty())
+            m_RetiredPages.emplace_back(std::move(m_CurrPage));
+        m_CurrPage = CreatePage(NewCapacity);
+        ++m_NumGrows;
+    }
+
+    m_FrameDemand.store(0);
+    m_NumFailedAllocs.store(0);
+}
+
+void StreamingRingBuffer::EndFrame(Uint64 FenceValue)
+{
+    Page& Pg = *m_CurrPage;
+    VERIFY(Pg.Frames.empty() || Pg.Frames.back().FenceValue < FenceValue, "Fence values must increase monotonically");
+    Pg.Frames.push_back({FenceValue, Pg.Head.load()});
+
+    // The remaining space in thread chunks belongs to the frame that has just ended
+    // and must not be reused by the next one.
+    for (ThreadChunk& Chunk : m_ThreadChunks)
+        Chunk = {};
+
+    m_LastFrameDemand     = m_FrameDemand.load();
+    m_LastNumFailedAllocs = m_NumFailedAllocs.load();
+}
+
+bool StreamingRingBuffer::ReserveChunk(Page& Pg, Uint64 Size, Uint64& Start)
+{
+    Uint64 Head = Pg.Head.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        Start = Head;
+
+        // Chunks never wrap around the buffer end
+        const Uint64 PhysOffset = Start & (Pg.Capacity - 1);
+        if (PhysOffset + Size > Pg.Capacity)
+            Start += Pg.Capacity - PhysOffset;
+
+        // Never overwrite the data the GPU may still read
+        if (Start + Size - Pg.Tail > Pg.Capacity)
+            return false;
+
+        if (Pg.Head.compare_exchange_weak(Head, Start + Size, std::memory_order_relaxed))
+            return true;
+    }
+}
+
+StreamingRingBuffer::Allocation StreamingRingBuffer::Allocate(Uint32 Size, Uint32 Alignment, size_t ThreadId)
+{
+    VERIFY_EXPR(ThreadId < m_ThreadChunks.size());
+    VERIFY(IsPowerOfTwo(Alignment) && Alignment <= ChunkAlignment, "Alignment must be a power of two not greater than ", ChunkAlignment);
+
+    Page&        Pg    = *m_CurrPage;
+    ThreadChunk& Chunk = m_ThreadChunks[ThreadId];
+
+    Uint64 Offset = AlignUp(Chunk.Curr, Uint64{Alignment});
+    if (Offset + Size > Chunk.End)
+    {
+        const Uint64 ChunkSize  = std::max(Uint64{m_CI.ChunkSize}, AlignUp(Uint64{Size}, ChunkAlignment));
+        Uint64       ChunkStart = 0;
+        if (!ReserveChunk(Pg, ChunkSize, ChunkStart))
+        {
+            m_FrameDemand.fetch_add(Size, std::memory_order_relaxed);
+            m_NumFailedAllocs.fetch_add(1, std::memory_order_relaxed);
+            return {};
+        }
+        m_FrameDemand.fetch_add(ChunkSize, std::memory_order_relaxed);
+        Chunk.End = ChunkStart + ChunkSize;
+        Offset    = ChunkStart;
+    }
+    Chunk.Curr = Offset + Size;
+
+    const Uint64 PhysOffset = Offset & (Pg.Capacity - 1);
+    return {Pg.pBuffer, PhysOffset, static_cast<Uint8*>(Pg.MappedData) + PhysOffset};
+}
+
+StreamingRingBuffer::Statistics StreamingRingBuffer::GetStatistics() const
+{
+    Statistics Stats;
+    auto       AddPage = [&Stats](const Page& Pg) {
+        Stats.Capacity += Pg.Capacity;
+        Stats.InFlightSize += Pg.Head.load() - Pg.Tail;
+        ++Stats.NumBuffers;
+    };
+    AddPage(*m_CurrPage);
+    for (const std::unique_ptr<Page>& pPage : m_RetiredPages)
+        AddPage(*pPage);
+
+    Stats.FrameSize       = m_LastFrameDemand;
+    Stats.NumGrows        = m_NumGrows;
+    Stats.NumFailedAllocs = m_LastNumFailedAllocs;
+    return Stats;
+}
+
+} // namespace Diligent
@@ -0,0 +1,169 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <deque>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "Buffer.h"
+#include "RefCntAutoPtr.hpp"
+#include "MapHelper.hpp"
+
+namespace Diligent
+{
+
+// Multi-frame ring allocator that streams data through a persistently mapped buffer
+// in unified memory.
+//
+// Every frame, the main thread calls BeginFrame() with the last fence value completed by the GPU
+// to reclaim the space used by finished frames, and EndFrame() with the fence value that will be
+// signaled after the frame's commands. Between the two calls, any number of threads may call
+// Allocate() concurrently: every thread reserves chunks of the ring with an atomic
+// compare-exchange and sub-allocates from its chunk without synchronization.
+//
+// The buffer is never discarded: when the free space is not enough for the expected frame
+// size, a larger buffer is created and the old one is kept alive until the GPU is done with it.
+class StreamingRingBuffer
+{
+public:
+    struct CreateInfo
+    {
+        const Char*    Name         = nullptr;
+        BIND_FLAGS     BindFlags    = BIND_NONE;
+        RESOURCE_STATE DefaultState = RESOURCE_STATE_UNKNOWN;
+
+        // Initial buffer size, rounded up to the power of two.
+        Uint64 InitialSize = 1 << 20;
+
+        // The size of the chunk every thread reserves at once.
+        Uint32 ChunkSize = 64 << 10;
+
+        // The number of threads that may allocate concurrently.
+        size_t NumThreads = 1;
+    };
+
+    StreamingRingBuffer(IRenderDevice* pDevice, IDeviceContext* pImmediateCtx, const CreateInfo& CI);
+
+    // clang-format off
+    StreamingRingBuffer           (const StreamingRingBuffer&) = delete;
+    StreamingRingBuffer& operator=(const StreamingRingBuffer&) = delete;
+    // clang-format on
+
+    // Returns true if the device supports CPU-writable unified memory required by the ring buffer.
+    static bool IsSupported(IRenderDevice* pDevice);
+
+    // Releases the space used by the frames whose fence values do not exceed CompletedFenceValue.
+    // If the remaining free space is less than FrameSizeHint (or the amount of data requested
+    // during the previous frame), the ring is grown. Must be called by the thread that owns
+    // the immediate context while no other thread allocates from the ring.
+    void BeginFrame(Uint64 CompletedFenceValue, Uint64 FrameSizeHint);
+
+    // Records the fence value that will be signaled when the GPU finishes reading
+    // the data allocated since the last BeginFrame().
+    void EndFrame(Uint64 FenceValue);
+
+    struct Allocation
+    {
+        IBuffer* pBuffer     = nullptr;
+        Uint64   Offset      = 0;
+        void*    pCPUAddress = nullptr;
+
+        explicit operator bool() const { return pBuffer != nullptr; }
+    };
+
+    // Allocates Size bytes aligned by Alignment (which must be a power of two not greater than 256).
+    // Thread-safe as long as every thread uses its own ThreadId. Returns an empty allocation if the ring
+    // is full, in which case the caller must stream the data through another buffer. The missing space
+    // is added when the ring grows in the next BeginFrame().
+    Allocation Allocate(Uint32 Size, Uint32 Alignment, size_t ThreadId);
+
+    struct Statistics
+    {
+        Uint64 Capacity        = 0; // Total size of all live buffers
+        Uint64 InFlightSize    = 0; // Size of data that may still be read by the GPU
+        Uint64 FrameSize       = 0; // Size of data allocated during the last frame
+        Uint32 NumBuffers      = 0; // Number of live buffers, including retired ones
+        Uint32 NumGrows        = 0;
+        Uint32 NumFailedAllocs = 0; // Allocations that did not fit during the last frame and were streamed by the caller
+    };
+    Statistics GetStatistics() const;
+
+private:
+    struct Page
+    {
+        RefCntAutoPtr<IBuffer> pBuffer;
+        MapHelper<Uint8>       MappedData;
+
+        Uint64 Capacity = 0; // Power of two
+
+        // Virtual offsets that grow monotonically. The physical offset is Offset & (Capacity - 1).
+        std::atomic<Uint64> Head{0};
+        Uint64              Tail = 0; // Only modified by BeginFrame()
+
+        struct FrameMarker
+        {
+            Uint64 FenceValue;
+            Uint64 Head;
+        };
+        std::deque<FrameMarker> Frames;
+    };
+
+    std::unique_ptr<Page> CreatePage(Uint64 Capacity);
+
+    bool ReserveChunk(Page& Pg, Uint64 Size, Uint64& Start);
+
+    RefCntAutoPtr<IRenderDevice>  m_pDevice;
+    RefCntAutoPtr<IDeviceContext> m_pImmediateCtx;
+
+    const CreateInfo m_CI;
+
+    std::unique_ptr<Page>              m_CurrPage;
+    std::vector<std::unique_ptr<Page>> m_RetiredPages;
+
+    struct alignas(64) ThreadChunk
+    {
+        Uint64 Curr = 0;
+        Uint64 End  = 0;
+    };
+    std::vector<ThreadChunk> m_ThreadChunks;
+
+    // Total size requested by all threads during the current frame, including failed allocations
+    std::atomic<Uint64> m_FrameDemand{0};
+    std::atomic<Uint32> m_NumFailedAllocs{0};
+
+    Uint64 m_LastFrameDemand     = 0;
+    Uint32 m_LastNumFailedAllocs = 0;
+    Uint32 m_NumGrows            = 0;
+};
+
+} // namespace Diligent
@@ -33,6 +33,7 @@
 #include <cstdlib>
 
 #include "Tutorial10_DataStreaming.hpp"
+#include "StreamingRingBuffer.hpp"
 #include "MapHelper.hpp"
 #include "GraphicsUtilities.h"
 #include "TextureUtilities.h"
@@ -40,6 +41,8 @@
 #include "imgui.h"
 #include "ImGuiUtils.hpp"
 #include "CommandLineParser.hpp"
+#include "Align.hpp"
+#include "Timer.hpp"
 
 namespace Diligent
 {
@@ -131,7 +134,7 @@ SampleBase* CreateSample()
 
 Tutorial10_DataStreaming::~Tutorial10_DataStreaming()
 {
-    StopWorkerThreads();
+    m_Recorder.Stop();
 }
 
 Tutorial10_DataStreaming::CommandLineStatus Tutorial10_DataStreaming::ProcessCommandLine(int argc, const char* const* argv)
@@ -149,6 +152,9 @@ Tutorial10_DataStreaming::CommandLineStatus Tutorial10_DataStreaming::ProcessCom
     {
         m_NumWorkerThreads = clamp(m_NumWorkerThreads, 0, 128);
     }
+    ArgsParser.Parse("fused", m_bFusedUpdate);
+    ArgsParser.Parse("sort", m_bSortPolygons);
+    ArgsParser.Parse("load_balancing", m_LoadBalancing);
 
     return CommandLineStatus::OK;
 }
@@ -330,17 +336,19 @@ void Tutorial10_DataStreaming::CreatePipelineStates(std::vector<StateTransitionD
     PSOCreateInfo.PSODesc.Name = "Batched Polygon PSO";
     // Define vertex shader input layout
     // This tutorial uses two types of input: per-vertex data and per-instance data.
+    // Instance data is padded to 32 bytes, so its stride must be given explicitly.
+    constexpr Uint32 InstStride = sizeof(InstanceData);
     // clang-format off
     LayoutElement BatchLayoutElems[] =
     {
         // Attribute 0 - PolygonXY
         LayoutElement{0, 0, 2, VT_FLOAT32, False, INPUT_ELEMENT_FREQUENCY_PER_VERTEX},
         // Attribute 1 - PolygonRotationAndScale
-        LayoutElement{1, 1, 4, VT_FLOAT32, False, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+        LayoutElement{1, 1, 4, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
         // Attribute 2 - PolygonCenter
-        LayoutElement{2, 1, 2, VT_FLOAT32, False, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
+        LayoutElement{2, 1, 2, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE},
         // Attribute 3 - TexArrInd
-        LayoutElement{3, 1, 1, VT_FLOAT32, False, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE}
+        LayoutElement{3, 1, 1, VT_FLOAT32, False, LAYOUT_ELEMENT_AUTO_OFFSET, InstStride, INPUT_ELEMENT_FREQUENCY_PER_INSTANCE}
     };
     // clang-format on
     PSOCreateInfo.GraphicsPipeline.InputLayout.LayoutElements = BatchLayoutElems;
@@ -437,23 +445,97 @@ void Tutorial10_DataStreaming::UpdateUI()
             m_NumPolygons = clamp(m_NumPolygons, 1, MaxPolygons);
             InitializePolygons();
         }
-        if (ImGui::InputInt("Batch Size", &m_BatchSize, 1, 5))
+        if (ImGui::Checkbox("Sort polygons", &m_bSortPolygons))
         {
-            m_BatchSize = clamp(m_BatchSize, 1, MaxBatchSize);
-            CreateInstanceBuffer();
+            // Polygons are recreated to restore the original order
+            InitializePolygons();
+        }
+        if (ImGui::Checkbox("Fused update", &m_bFusedUpdate) && m_bFusedUpdate && !m_bPolygonsSorted)
+        {
+            SortPolygons();
+            BuildBatches();
+        }
+        {
+            ImGui::ScopedDisabler Disable(m_bFusedUpdate);
+            if (ImGui::InputInt("Batch Size", &m_BatchSize, 1, 5))
+            {
+                m_BatchSize = clamp(m_BatchSize, 1, MaxBatchSize);
+                CreateInstanceBuffer();
+                BuildBatches();
+            }
         }
         {
             ImGui::ScopedDisabler Disable(m_MaxThreads == 0);
             if (ImGui::SliderInt("Worker Threads", &m_NumWorkerThreads, 0, m_MaxThreads))
             {
-                StopWorkerThreads();
-                StartWorkerThreads(m_NumWorkerThreads);
+                m_Recorder.Stop();
+                m_Recorder.Start(m_pDeferredContexts, static_cast<Uint32>(m_NumWorkerThreads));
             }
         }
-        if (m_pDevice->GetDeviceInfo().Type == RENDER_DEVICE_TYPE_D3D12 ||
-            m_pDevice->GetDeviceInfo().Type == RENDER_DEVICE_TYPE_VULKAN)
+
+        {
+            // Fused mode always splits the polygons evenly between the threads
+            ImGui::ScopedDisabler Disable(m_bFusedUpdate);
+            ImGui::Checkbox("Load balancing", &m_LoadBalancing);
+            ImGui::ScopedDisabler DisableChunkSize(!m_LoadBalancing);
+            if (ImGui::InputInt("Chunk Size", &m_ChunkSize, 1, 16))
+                m_ChunkSize = clamp(m_ChunkSize, 1, 1024);
+        }
+
+        ImGui::Text("Draw calls: %u", m_FrameStats.NumDrawCalls);
+        ImGui::Text("PSO changes: %u", m_FrameStats.NumPSOChanges);
+        ImGui::Text("Geometry uploads: %u (%.1f KB)", m_FrameStats.NumGeometryUploads, static_cast<double>(m_FrameStats.GeometryBytes) / 1024.0);
+        ImGui::Text("Instance data: %.1f KB", static_cast<double>(m_FrameStats.InstanceBytes) / 1024.0);
+
+        // Threads update their polygons in parallel, so the slowest one defines the update time
+        double UpdateTime = 0;
+        for (size_t i = 0; i < m_Recorder.GetNumSubsets(); ++i)
+            UpdateTime = std::max(UpdateTime, m_SubsetUpdateTime[i]);
+        // In fused mode, this also includes writing the instance data
+        ImGui::Text("Update time: %.3f ms (%s)", UpdateTime * 1000.0, GetSpriteMotionISA());
+
+        // Recording time of every thread shows how evenly the work is distributed
+        for (Uint32 i = 0; i < m_Recorder.GetNumSubsets(); ++i)
+        {
+            const ParallelFrameRecorder::SubsetStatistics& Stats = m_Recorder.GetSubsetStatistics(i);
+            // Fused mode does not take batches from the recorder, so only the draw calls are reported
+            if (m_bFusedUpdate)
+                ImGui::Text("Thread %u: %.3f ms, %u draws", i, Stats.JobTime * 1000.0, m_SubsetStats[i].NumDrawCalls);
+            else
+                ImGui::Text("Thread %u: %.3f ms, %u batches, %u draws", i, Stats.JobTime * 1000.0, Stats.NumItems, m_SubsetStats[i].NumDrawCalls);
+        }
+
+        if (m_RingVB)
+        {
+            if (ImGui::Checkbox("Ring buffer", &m_bUseRingBuffer))
+                LOG_INFO_MESSAGE("Streaming geometry through ", (m_bUseRingBuffer ? "the multi-frame ring buffer" : "dynamic buffers"));
+        }
+        if (m_bUseRingBuffer)
+        {
+            const StreamingRingBuffer::Statistics VBStats = m_RingVB->GetStatistics();
+            const StreamingRingBuffer::Statistics IBStats = m_RingIB->GetStatistics();
+
+            // Allocations that do not fit into the ring are streamed through the dynamic buffers
+            const Uint32 NumFailedAllocs = VBStats.NumFailedAllocs + IBStats.NumFailedAllocs;
+            if (NumFailedAllocs > 0)
+                ImGui::Text("Streaming: ring buffer, %u allocations via dynamic buffers", NumFailedAllocs);
+            else
+                ImGui::Text("Streaming: ring buffer");
+
+            constexpr double MB = 1.0 / (1 << 20);
+            ImGui::Text("Ring usage per frame: %.2f MB", static_cast<double>(VBStats.FrameSize + IBStats.FrameSize) * MB);
+            ImGui::Text("In flight: %.2f MB", static_cast<double>(VBStats.InFlightSize + IBStats.InFlightSize) * MB);
+            ImGui::Text("Capacity: %.2f MB (%u buffers)", static_cast<double>(VBStats.Capacity + IBStats.Capacity) * MB, VBStats.NumBuffers + IBStats.NumBuffers);
+            ImGui::Text("Grows: %u", VBStats.NumGrows + IBStats.NumGrows);
+        }
+        else
         {
-            ImGui::Checkbox("Persistent map", &m_bAllowPersistentMap);
+            ImGui::Text("Streaming: dynamic buffers");
+            if (m_pDevice->GetDeviceInfo().Type == RENDER_DEVICE_TYPE_D3D12 ||
+                m_pDevice->GetDeviceInfo().Type == RENDER_DEVICE_TYPE_VULKAN)
+            {
+                ImGui::Checkbox("Persistent map", &m_bAllowPersistentMap);
+            }
         }
     }
     ImGui::End();
@@ -466,6 +548,8 @@ void Tutorial10_DataStreaming::Initialize(const SampleInitInfo& InitInfo)
 
     m_MaxThreads       = static_cast<int>(m_pDeferredContexts.size());
     m_NumWorkerThreads = std::min(m_NumWorkerThreads, m_MaxThreads);
+    m_SubsetStats.resize(1 + m_pDeferredContexts.size());
+    m_SubsetUpdateTime.resize(1 + m_pDeferredContexts.size());
 
     std::vector<StateTransitionDesc> Barriers;
     CreatePipelineStates(Barriers);
@@ -478,6 +562,35 @@ void Tutorial10_DataStreaming::Initialize(const SampleInitInfo& InitInfo)
     Barriers.emplace_back(m_StreamingVB->GetBuffer(), RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE);
     Barriers.emplace_back(m_StreamingIB->GetBuffer(), RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_INDEX_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE);
 
+    if (StreamingRingBuffer::IsSupported(m_pDevice))
+    {
+        StreamingRingBuffer::CreateInfo RingCI;
+        RingCI.NumThreads = 1u + InitInfo.NumDeferredCtx;
+
+        RingCI.Name         = "Streaming vertex ring buffer";
+        RingCI.BindFlags    = BIND_VERTEX_BUFFER;
+        RingCI.DefaultState = RESOURCE_STATE_VERTEX_BUFFER;
+        m_RingVB            = std::make_unique<StreamingRingBuffer>(m_pDevice, m_pImmediateContext, RingCI);
+
+        RingCI.Name         = "Streaming index ring buffer";
+        RingCI.BindFlags    = BIND_INDEX_BUFFER;
+        RingCI.DefaultState = RESOURCE_STATE_INDEX_BUFFER;
+        m_RingIB            = std::make_unique<StreamingRingBuffer>(m_pDevice, m_pImmediateContext, RingCI);
+
+        // The fence is signaled after every frame to let the ring buffers know
+        // when the GPU has finished reading the frame data.
+        FenceDesc FDesc;
+        FDesc.Name = "Frame fence";
+        m_pDevice->CreateFence(FDesc, &m_pFrameFence);
+
+        m_bUseRingBuffer = true;
+        LOG_INFO_MESSAGE("Streaming geometry through the multi-frame ring buffer");
+    }
+    else
+    {
+        LOG_INFO_MESSAGE("The device does not support CPU-writable unified memory. Streaming geometry through dynamic buffers");
+    }
+
     InitializePolygonGeometry();
     InitializePolygons();
 
@@ -486,7 +599,7 @@ void Tutorial10_DataStreaming::Initialize(const SampleInitInfo& InitInfo)
     if (m_BatchSize > 1)
         CreateInstanceBuffer();
 
-    StartWorkerThreads(m_NumWorkerThreads);
+    m_Recorder.Start(m_pDeferredContexts, static_cast<Uint32>(m_NumWorkerThreads));
 }
 
 void Tutorial10_DataStreaming::InitializePolygonGeometry()
@@ -516,6 +629,7 @@ void Tutorial10_DataStreaming::InitializePolygonGeometry()
 void Tutorial10_DataStreaming::InitializePolygons()
 {
     m_Polygons.resize(m_NumPolygons);
+    m_PolygonMotion.Resize(m_NumPolygons);
 
     std::mt19937 gen; // Standard mersenne_twister_engine. Use default seed
                       // to generate consistent distribution.
@@ -533,135 +647,188 @@ void Tutorial10_DataStreaming::InitializePolygons()
     {
         PolygonData& CurrInst = m_Polygons[Polygon];
 
-        CurrInst.Size      = scale_distr(gen);
-        CurrInst.Angle     = angle_distr(gen);
-        CurrInst.Pos.x     = pos_distr(gen);
-        CurrInst.Pos.y     = pos_distr(gen);
-        CurrInst.MoveDir.x = move_dir_distr(gen);
-        CurrInst.MoveDir.y = move_dir_distr(gen);
-        CurrInst.RotSpeed  = rot_distr(gen);
+        CurrInst.Size = scale_distr(gen);
+
+        m_PolygonMotion.Angle[Polygon]      = angle_distr(gen);
+        m_PolygonMotion.PosX[Polygon]       = pos_distr(gen);
+        m_PolygonMotion.PosY[Polygon]       = pos_distr(gen);
+        m_PolygonMotion.MoveDirX[Polygon]   = move_dir_distr(gen);
+        m_PolygonMotion.MoveDirY[Polygon]   = move_dir_distr(gen);
+        m_PolygonMotion.RotSpeed[Polygon]   = rot_distr(gen);
+        m_PolygonMotion.NumBounces[Polygon] = 0;
+
         // Texture array index
         CurrInst.TextureInd = tex_distr(gen);
         CurrInst.StateInd   = state_distr(gen);
         CurrInst.NumVerts   = num_verts_distr(gen);
+
+        m_PolygonMotion.Size[Polygon]      = CurrInst.Size;
+        m_PolygonMotion.TexArrInd[Polygon] = static_cast<float>(CurrInst.TextureInd);
     }
+
+    m_bPolygonsSorted = false;
+    if (m_bSortPolygons || m_bFusedUpdate)
+        SortPolygons();
+    BuildBatches();
 }
 
-std::pair<Diligent::Uint32, Diligent::Uint32> Tutorial10_DataStreaming::WritePolygon(const PolygonGeometry& PolygonGeo, IDeviceContext* pCtx, size_t CtxNum)
+void Tutorial10_DataStreaming::SortPolygons()
 {
-    // Request memory for vertices and indices
-    Uint32  VBOffset   = m_StreamingVB->Allocate(pCtx, static_cast<Uint32>(PolygonGeo.Verts.size()) * sizeof(float2), CtxNum);
-    Uint32  IBOffset   = m_StreamingIB->Allocate(pCtx, static_cast<Uint32>(PolygonGeo.Inds.size()) * sizeof(Uint32), CtxNum);
-    float2* VertexData = reinterpret_cast<float2*>(reinterpret_cast<Uint8*>(m_StreamingVB->GetMappedCPUAddress(CtxNum)) + VBOffset);
-    Uint32* IndexData  = reinterpret_cast<Uint32*>(reinterpret_cast<Uint8*>(m_StreamingIB->GetMappedCPUAddress(CtxNum)) + IBOffset);
-    memcpy(VertexData, PolygonGeo.Verts.data(), PolygonGeo.Verts.size() * sizeof(float2));
-    memcpy(IndexData, PolygonGeo.Inds.data(), PolygonGeo.Inds.size() * sizeof(Uint32));
+    // Sort polygons by state, shape and texture with a counting sort, so that polygons that
+    // can be drawn together are adjacent. Since these attributes never change, polygons
+    // only need to be sorted once.
+    constexpr int NumShapes = MaxPolygonVerts + 1;
+    auto          GetBin    = [](const PolygonData& Polygon) {
+        return (Polygon.StateInd * NumShapes + Polygon.NumVerts) * NumTextures + Polygon.TextureInd;
+    };
 
-    m_StreamingVB->Release(CtxNum);
-    m_StreamingIB->Release(CtxNum);
+    std::vector<Uint32> BinOffsets(NumStates * NumShapes * NumTextures + 1);
+    for (const PolygonData& Polygon : m_Polygons)
+        ++BinOffsets[GetBin(Polygon) + 1];
+    for (size_t i = 1; i < BinOffsets.size(); ++i)
+        BinOffsets[i] += BinOffsets[i - 1];
+
+    std::vector<PolygonData> SortedPolygons(m_Polygons.size());
+    std::vector<Uint32>      Order(m_Polygons.size());
+    for (Uint32 i = 0; i < m_Polygons.size(); ++i)
+    {
+        const Uint32 Dst    = BinOffsets[GetBin(m_Polygons[i])]++;
+        SortedPolygons[Dst] = m_Polygons[i];
+        Order[Dst]          = i;
+    }
+    m_Polygons.swap(SortedPolygons);
+    m_PolygonMotion.Reorder(Order);
 
-    return {VBOffset, IBOffset};
+    m_bPolygonsSorted = true;
 }
 
-void Tutorial10_DataStreaming::UpdatePolygons(float elapsedTime)
+void Tutorial10_DataStreaming::BuildBatches()
 {
-    std::mt19937 gen; // Standard mersenne_twister_engine. Use default seed
-                      // to generate consistent distribution.
+    // Polygons with different textures are drawn together in batched modes, so runs only break on state or shape
+    m_PolygonRuns.clear();
+    for (Uint32 Polygon = 0; Polygon < m_Polygons.size(); ++Polygon)
+    {
+        const PolygonData& CurrPolygon = m_Polygons[Polygon];
+        if (m_PolygonRuns.empty() || m_PolygonRuns.back().StateInd != CurrPolygon.StateInd || m_PolygonRuns.back().NumVerts != CurrPolygon.NumVerts)
+        {
+            PolygonBatch Run;
+            Run.FirstPolygon = Polygon;
+            Run.StateInd     = CurrPolygon.StateInd;
+            Run.NumVerts     = CurrPolygon.NumVerts;
+            m_PolygonRuns.push_back(Run);
+        }
+        ++m_PolygonRuns.back().NumPolygons;
+    }
 
-    std::uniform_real_distribution<float> rot_distr(-PI_F * 0.5f, +PI_F * 0.5f);
-    for (int Polygon = 0; Polygon < m_NumPolygons; ++Polygon)
+    // When the polygons are sorted, every run of polygons with the same state and shape is split into batches
+    // of at most m_BatchSize polygons. Otherwise runs are too short to be worth splitting by, so the polygons
+    // are split into batches of m_BatchSize polygons that are all drawn with the state and shape of the first one.
+    m_Batches.clear();
+    const Uint32 NumPolygons = static_cast<Uint32>(m_Polygons.size());
+    for (Uint32 Polygon = 0; Polygon < NumPolygons;)
     {
-        PolygonData& CurrInst = m_Polygons[Polygon];
-        CurrInst.Angle += CurrInst.RotSpeed * elapsedTime;
-        if (std::abs(CurrInst.Pos.x + CurrInst.MoveDir.x * elapsedTime) > 0.95)
+        PolygonBatch Batch;
+        Batch.FirstPolygon = Polygon;
+        Batch.StateInd     = m_Polygons[Polygon].StateInd;
+        Batch.NumVerts     = m_Polygons[Polygon].NumVerts;
+
+        const Uint32 EndPolygon = std::min(Polygon + static_cast<Uint32>(m_BatchSize), NumPolygons);
+        if (m_bPolygonsSorted)
         {
-            CurrInst.MoveDir.x *= -1.f;
-            CurrInst.RotSpeed = rot_distr(gen);
+            while (Polygon < EndPolygon && m_Polygons[Polygon].StateInd == Batch.StateInd && m_Polygons[Polygon].NumVerts == Batch.NumVerts)
+                ++Polygon;
         }
-        CurrInst.Pos.x += CurrInst.MoveDir.x * elapsedTime;
-        if (std::abs(CurrInst.Pos.y + CurrInst.MoveDir.y * elapsedTime) > 0.95)
+        else
         {
-            CurrInst.MoveDir.y *= -1.f;
-            CurrInst.RotSpeed = rot_distr(gen);
+            Polygon = EndPolygon;
         }
-        CurrInst.Pos.y += CurrInst.MoveDir.y * elapsedTime;
+        Batch.NumPolygons = Polygon - Batch.FirstPolygon;
+
+        m_Batches.push_back(Batch);
     }
 }
 
-void Tutorial10_DataStreaming::StartWorkerThreads(size_t NumThreads)
+Tutorial10_DataStreaming::StreamedGeometry Tutorial10_DataStreaming::WritePolygon(const PolygonGeometry& PolygonGeo, IDeviceContext* pCtx, size_t CtxNum)
 {
-    m_WorkerThreads.resize(NumThreads);
-    for (Uint32 t = 0; t < m_WorkerThreads.size(); ++t)
+    const Uint32 VBSize = static_cast<Uint32>(PolygonGeo.Verts.size() * sizeof(float2));
+    const Uint32 IBSize = static_cast<Uint32>(PolygonGeo.Inds.size() * sizeof(Uint32));
+
+    if (m_bUseRingBuffer)
     {
-        m_WorkerThreads[t] = std::thread(WorkerThreadFunc, this, t);
+        // Ring buffers are persistently mapped, so there is nothing to map or unmap.
+        // Every context uses its own chunk, so no synchronization is required.
+        const StreamingRingBuffer::Allocation VBAlloc = m_RingVB->Allocate(VBSize, 16, CtxNum);
+        const StreamingRingBuffer::Allocation IBAlloc = m_RingIB->Allocate(IBSize, 16, CtxNum);
+        if (VBAlloc && IBAlloc)
+        {
+            memcpy(VBAlloc.pCPUAddress, PolygonGeo.Verts.data(), VBSize);
+            memcpy(IBAlloc.pCPUAddress, PolygonGeo.Inds.data(), IBSize);
+
+            return {VBAlloc.pBuffer, VBAlloc.Offset, IBAlloc.pBuffer, IBAlloc.Offset};
+        }
+        // The ring buffer is full. The rings can only grow between the frames, so the geometry
+        // is streamed through the dynamic buffers below, and the rings grow in the next frame.
     }
-    m_CmdLists.resize(NumThreads);
+
+    // Request memory for vertices and indices
+    Uint32  VBOffset   = m_StreamingVB->Allocate(pCtx, VBSize, CtxNum);
+    Uint32  IBOffset   = m_StreamingIB->Allocate(pCtx, IBSize, CtxNum);
+    float2* VertexData = reinterpret_cast<float2*>(reinterpret_cast<Uint8*>(m_StreamingVB->GetMappedCPUAddress(CtxNum)) + VBOffset);
+    Uint32* IndexData  = reinterpret_cast<Uint32*>(reinterpret_cast<Uint8*>(m_StreamingIB->GetMappedCPUAddress(CtxNum)) + IBOffset);
+    memcpy(VertexData, PolygonGeo.Verts.data(), VBSize);
+    memcpy(IndexData, PolygonGeo.Inds.data(), IBSize);
+
+    m_StreamingVB->Release(CtxNum);
+    m_StreamingIB->Release(CtxNum);
+
+    return {m_StreamingVB->GetBuffer(), VBOffset, m_StreamingIB->GetBuffer(), IBOffset};
 }
 
-void Tutorial10_DataStreaming::StopWorkerThreads()
+void Tutorial10_DataStreaming::BeginRingBufferFrame()
 {
-    m_RenderSubsetSignal.Trigger(true, -1);
-
-    for (std::thread& thread : m_WorkerThreads)
+    // Every context streams the geometry of every shape at most once. Use this to
+    // estimate the frame size, so that the rings grow before the threads start writing.
+    Uint64 VBHint = 0;
+    Uint64 IBHint = 0;
+    for (Uint32 NumVerts = MinPolygonVerts; NumVerts <= MaxPolygonVerts; ++NumVerts)
+    {
+        VBHint += AlignUp(Uint64{m_PolygonGeo[NumVerts].Verts.size() * sizeof(float2)}, Uint64{16});
+        IBHint += AlignUp(Uint64{m_PolygonGeo[NumVerts].Inds.size() * sizeof(Uint32)}, Uint64{16});
+    }
+    const Uint64 NumContexts = m_Recorder.GetNumSubsets();
+    VBHint *= NumContexts;
+    IBHint *= NumContexts;
+    if (m_bFusedUpdate)
     {
-        thread.join();
+        // Instance data of every subset is allocated from the vertex ring as well
+        const Uint64 MaxSubsetSize = (m_Polygons.size() + NumContexts - 1) / NumContexts;
+        VBHint += NumContexts * AlignUp(MaxSubsetSize * sizeof(InstanceData), Uint64{256});
     }
-    m_RenderSubsetSignal.Reset();
-    m_WorkerThreads.clear();
-    m_CmdLists.clear();
+
+    // Space used by the frames the GPU has finished is reclaimed
+    const Uint64 CompletedFenceValue = m_pFrameFence->GetCompletedValue();
+    m_RingVB->BeginFrame(CompletedFenceValue, VBHint);
+    m_RingIB->BeginFrame(CompletedFenceValue, IBHint);
 }
 
-void Tutorial10_DataStreaming::WorkerThreadFunc(Tutorial10_DataStreaming* pThis, Uint32 ThreadNum)
+void Tutorial10_DataStreaming::EndRingBufferFrame()
 {
-    // Every thread should use its own deferred context
-    IDeviceContext* pDeferredCtx     = pThis->m_pDeferredContexts[ThreadNum];
-    const int       NumWorkerThreads = static_cast<int>(pThis->m_WorkerThreads.size());
-    VERIFY_EXPR(NumWorkerThreads > 0);
-    for (;;)
-    {
-        // Wait for the signal
-        int SignaledValue = pThis->m_RenderSubsetSignal.Wait(true, NumWorkerThreads);
-        if (SignaledValue < 0)
-            return;
-
-        pDeferredCtx->Begin(0);
-
-        // Render current subset using the deferred context
-        if (pThis->m_BatchSize > 1)
-            pThis->RenderSubset<true>(pDeferredCtx, 1 + ThreadNum);
-        else
-            pThis->RenderSubset<false>(pDeferredCtx, 1 + ThreadNum);
-
-        // Finish command list
-        RefCntAutoPtr<ICommandList> pCmdList;
-        pDeferredCtx->FinishCommandList(&pCmdList);
-        pThis->m_CmdLists[ThreadNum] = pCmdList;
-
-        {
-            // Atomically increment the number of completed threads
-            const int NumThreadsCompleted = pThis->m_NumThreadsCompleted.fetch_add(1) + 1;
-            if (NumThreadsCompleted == NumWorkerThreads)
-                pThis->m_ExecuteCommandListsSignal.Trigger();
-        }
+    m_pImmediateContext->EnqueueSignal(m_pFrameFence, ++m_FrameFenceValue);
+    m_RingVB->EndFrame(m_FrameFenceValue);
+    m_RingIB->EndFrame(m_FrameFenceValue);
+}
 
-        pThis->m_GotoNextFrameSignal.Wait(true, NumWorkerThreads);
+void Tutorial10_DataStreaming::UpdatePolygons(Uint32 Subset, Uint32 StartPolygon, Uint32 EndPolygon)
+{
+    Timer UpdateTimer;
 
-        // Call FinishFrame() to release dynamic resources allocated by deferred contexts
-        // IMPORTANT: we must wait until the command lists are submitted for execution
-        //            because FinishFrame() invalidates all dynamic resources.
-        // IMPORTANT: In Metal backend FinishFrame must be called from the same
-        //            thread that issued rendering commands.
-        pDeferredCtx->FinishFrame();
+    SpriteMotionUpdateAttribs Attribs;
+    Attribs.ElapsedTime = m_ElapsedTime;
+    Attribs.Bounds      = 0.95f;
+    Attribs.MaxRotSpeed = PI_F * 0.5f;
+    UpdateSpriteMotion(m_PolygonMotion, StartPolygon, EndPolygon, Attribs);
 
-        pThis->m_NumThreadsReady.fetch_add(1);
-        // We must wait until all threads reach this point, because
-        // m_GotoNextFrameSignal must be unsignaled before we proceed to
-        // RenderSubsetSignal to avoid one thread go through the loop twice in
-        // a row
-        while (pThis->m_NumThreadsReady.load() < NumWorkerThreads)
-            std::this_thread::yield();
-        VERIFY_EXPR(!pThis->m_GotoNextFrameSignal.IsTriggered());
-    }
+    m_SubsetUpdateTime[Subset] += UpdateTimer.GetElapsedTime();
 }
 
 template <bool UseBatch>
@@ -676,100 +843,256 @@ void Tutorial10_DataStreaming::RenderSubset(IDeviceContext* pCtx, Uint32 Subset)
     DrawAttrs.IndexType = VT_UINT32;
     DrawAttrs.Flags     = DRAW_FLAG_VERIFY_ALL;
 
-    Uint32       NumSubsets    = Uint32{1} + static_cast<Uint32>(m_WorkerThreads.size());
-    const Uint32 TotalPolygons = static_cast<Uint32>(m_Polygons.size());
-    const Uint32 TotalBatches  = (TotalPolygons + m_BatchSize - 1) / m_BatchSize;
-    const Uint32 SusbsetSize   = TotalBatches / NumSubsets;
-    const Uint32 StartBatch    = SusbsetSize * Subset;
-    const Uint32 EndBatch      = (Subset < NumSubsets - 1) ? SusbsetSize * (Subset + 1) : TotalBatches;
-    for (Uint32 batch = StartBatch; batch < EndBatch; ++batch)
-    {
-        const Uint32 StartInst = batch * m_BatchSize;
-        const Uint32 EndInst   = std::min(StartInst + static_cast<Uint32>(m_BatchSize), static_cast<Uint32>(m_NumPolygons));
+    RenderStatistics& Stats = m_SubsetStats[Subset];
+    Stats                   = {};
 
-        // Set pipeline state
-        int StateInd = m_Polygons[StartInst].StateInd;
-        pCtx->SetPipelineState(m_pPSO[UseBatch ? 1 : 0][StateInd]);
+    // Geometry of every shape is streamed once per frame per context, when it is first used
+    StreamedGeometry ShapeGeo[MaxPolygonVerts + 1];
 
-        const PolygonGeometry& PolygonGeo = m_PolygonGeo[m_Polygons[StartInst].NumVerts];
-        auto                   Offsets    = WritePolygon(PolygonGeo, pCtx, Subset);
-        const Uint64           offsets[]  = {Offsets.first, 0};
-        IBuffer*               pBuffs[]   = {m_StreamingVB->GetBuffer(), m_BatchDataBuffer};
-        pCtx->SetVertexBuffers(0, UseBatch ? 2 : 1, pBuffs, offsets, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_RESET);
+    const Uint32 TotalBatches = static_cast<Uint32>(m_Batches.size());
+    const Uint32 NumPolygons  = static_cast<Uint32>(m_Polygons.size());
 
-        pCtx->SetIndexBuffer(m_StreamingIB->GetBuffer(), Offsets.second, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+    // The pipeline state and buffers only need to be set when they change, which is
+    // rare when the polygons are sorted by state and shape
+    int CurrStateInd   = -1;
+    int CurrNumVerts   = -1;
+    int CurrTextureInd = -1;
 
-        MapHelper<InstanceData> BatchData;
-        if (UseBatch)
+    // Keep taking chunks of batches until none remain
+    m_SubsetUpdateTime[Subset] = 0;
+    Uint32 StartBatch          = 0;
+    Uint32 EndBatch            = 0;
+    while (m_Recorder.NextChunk(Subset, StartBatch, EndBatch))
+    {
+        // Every thread advances the polygons it is about to render, so no synchronization is needed
         {
-            pCtx->CommitShaderResources(m_BatchSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
-            BatchData.Map(pCtx, m_BatchDataBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
+            const Uint32 StartPolygon = m_Batches[StartBatch].FirstPolygon;
+            const Uint32 EndPolygon   = EndBatch < TotalBatches ? m_Batches[EndBatch].FirstPolygon : NumPolygons;
+            UpdatePolygons(Subset, StartPolygon, EndPolygon);
         }
 
-        for (Uint32 inst = StartInst; inst < EndInst; ++inst)
+        for (Uint32 batch = StartBatch; batch < EndBatch; ++batch)
         {
-            const PolygonData& CurrInstData = m_Polygons[inst];
-            // Shader resources have been explicitly transitioned to correct states, so
-            // RESOURCE_STATE_TRANSITION_MODE_TRANSITION mode is not needed.
-            // Instead, we use RESOURCE_STATE_TRANSITION_MODE_VERIFY mode to
-            // verify that all resources are in correct states. This mode only has effect
-            // in debug and development builds
-            if (!UseBatch)
-                pCtx->CommitShaderResources(m_SRB[CurrInstData.TextureInd], RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+            const PolygonBatch& Batch     = m_Batches[batch];
+            const Uint32        StartInst = Batch.FirstPolygon;
+            const Uint32        EndInst   = Batch.FirstPolygon + Batch.NumPolygons;
 
+            if (Batch.StateInd != CurrStateInd)
             {
-                // clang-format off
-                float2x2 ScaleMatr
-                {   
-                    CurrInstData.Size, 0.f,
-                    0.f,               CurrInstData.Size
-                };
-                // clang-format on
-                float    sinAngle = sinf(CurrInstData.Angle);
-                float    cosAngle = cosf(CurrInstData.Angle);
-                float2x2 RotMatr(cosAngle, -sinAngle,
-                                 sinAngle, cosAngle);
-                float2x2 Matr = ScaleMatr * RotMatr;
-
-                float4 PolygonRotationAndScale(Matr.m00, Matr.m10, Matr.m01, Matr.m11);
-
+                // Set pipeline state
+                pCtx->SetPipelineState(m_pPSO[UseBatch ? 1 : 0][Batch.StateInd]);
                 if (UseBatch)
+                    pCtx->CommitShaderResources(m_BatchSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+                CurrStateInd   = Batch.StateInd;
+                CurrTextureInd = -1;
+                ++Stats.NumPSOChanges;
+            }
+
+            const PolygonGeometry& PolygonGeo = m_PolygonGeo[Batch.NumVerts];
+            if (Batch.NumVerts != CurrNumVerts)
+            {
+                StreamedGeometry& Geo = ShapeGeo[Batch.NumVerts];
+                if (Geo.pVB == nullptr)
+                {
+                    Geo = WritePolygon(PolygonGeo, pCtx, Subset);
+                    ++Stats.NumGeometryUploads;
+                    Stats.GeometryBytes += PolygonGeo.Verts.size() * sizeof(float2) + PolygonGeo.Inds.size() * sizeof(Uint32);
+                }
+
+                const Uint64 offsets[] = {Geo.VBOffset, 0};
+                IBuffer*     pBuffs[]  = {Geo.pVB, m_BatchDataBuffer};
+                pCtx->SetVertexBuffers(0, UseBatch ? 2 : 1, pBuffs, offsets, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_RESET);
+                pCtx->SetIndexBuffer(Geo.pIB, Geo.IBOffset, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+                CurrNumVerts = Batch.NumVerts;
+            }
+
+            MapHelper<InstanceData> BatchData;
+            if (UseBatch)
+            {
+                BatchData.Map(pCtx, m_BatchDataBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
+            }
+
+            for (Uint32 inst = StartInst; inst < EndInst; ++inst)
+            {
+                const PolygonData& CurrInstData = m_Polygons[inst];
+                // Shader resources have been explicitly transitioned to correct states, so
+                // RESOURCE_STATE_TRANSITION_MODE_TRANSITION mode is not needed.
+                // Instead, we use RESOURCE_STATE_TRANSITION_MODE_VERIFY mode to
+                // verify that all resources are in correct states. This mode only has effect
+                // in debug and development builds
+                if (!UseBatch && CurrInstData.TextureInd != CurrTextureInd)
                 {
-                    InstanceData& CurrPolygon           = BatchData[inst - StartInst];
-                    CurrPolygon.PolygonRotationAndScale = PolygonRotationAndScale;
-                    CurrPolygon.PolygonCenter           = CurrInstData.Pos;
-                    CurrPolygon.TexArrInd               = static_cast<float>(CurrInstData.TextureInd);
+                    pCtx->CommitShaderResources(m_SRB[CurrInstData.TextureInd], RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+                    CurrTextureInd = CurrInstData.TextureInd;
                 }
-                else
                 {
-                    struct PolygonAttribs
-                    {
-                        float4 g_PolygonRotationAndScale;
-                        float4 g_PolygonCenter;
+                    // clang-format off
+                    float2x2 ScaleMatr
+                    {   
+                        CurrInstData.Size, 0.f,
+                        0.f,               CurrInstData.Size
                     };
+                    // clang-format on
+                    float    sinAngle = sinf(m_PolygonMotion.Angle[inst]);
+                    float    cosAngle = cosf(m_PolygonMotion.Angle[inst]);
+                    float2x2 RotMatr(cosAngle, -sinAngle,
+                                     sinAngle, cosAngle);
+                    float2x2 Matr = ScaleMatr * RotMatr;
 
-                    // Map the buffer and write current world-view-projection matrix
-                    MapHelper<PolygonAttribs> InstData(pCtx, m_PolygonAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD);
+                    float4 PolygonRotationAndScale(Matr.m00, Matr.m10, Matr.m01, Matr.m11);
 
-                    InstData->g_PolygonRotationAndScale = PolygonRotationAndScale;
-                    InstData->g_PolygonCenter.x         = CurrInstData.Pos.x;
-                    InstData->g_PolygonCenter.y         = CurrInstData.Pos.y;
+                    if (UseBatch)
+                    {
+                        InstanceData& CurrPolygon           = BatchData[inst - StartInst];
+                        CurrPolygon.PolygonRotationAndScale = PolygonRotationAndScale;
+                        CurrPolygon.PolygonCenter           = float2{m_PolygonMotion.PosX[inst], m_PolygonMotion.PosY[inst]};
+                        CurrPolygon.TexArrInd               = static_cast<float>(CurrInstData.TextureInd);
+                    }
+                    else
+                    {
+                        struct PolygonAttribs
+                        {
+                            float4 g_PolygonRotationAndScale;
+                            float4 g_PolygonCenter;
+                        };
+
+                        // Map the buffer and write current world-view-projection matrix
+                        MapHelper<PolygonAttribs> InstData(pCtx, m_PolygonAttribsCB, MAP_WRITE, MAP_FLAG_DISCARD);
+
+                        InstData->g_PolygonRotationAndScale = PolygonRotationAndScale;
+                        InstData->g_PolygonCenter.x         = m_PolygonMotion.PosX[inst];
+                        InstData->g_PolygonCenter.y         = m_PolygonMotion.PosY[inst];
+                        Stats.InstanceBytes += sizeof(PolygonAttribs);
+                    }
                 }
             }
+
+            if (UseBatch)
+            {
+                BatchData.Unmap();
+                Stats.InstanceBytes += sizeof(InstanceData) * Batch.NumPolygons;
+            }
+
+            DrawAttrs.NumIndices   = static_cast<Uint32>(PolygonGeo.Inds.size());
+            DrawAttrs.NumInstances = EndInst - StartInst;
+            pCtx->DrawIndexed(DrawAttrs);
+            ++Stats.NumDrawCalls;
         }
+    }
+
+    // Dynamic buffers are also used when the ring buffers overflow
+    m_StreamingVB->Flush(Subset);
+    m_StreamingIB->Flush(Subset);
+}
+
+void Tutorial10_DataStreaming::RenderSubsetFused(IDeviceContext* pCtx, Uint32 Subset)
+{
+    ITextureView* pRTV = m_pSwapChain->GetCurrentBackBufferRTV();
+    pCtx->SetRenderTargets(1, &pRTV, m_pSwapChain->GetDepthBufferDSV(), RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+
+    RenderStatistics& Stats = m_SubsetStats[Subset];
+    Stats                   = {};
+
+    // Polygons are evenly split between the subsets regardless of the batch size
+    const Uint32 NumSubsets    = m_Recorder.GetNumSubsets();
+    const Uint32 TotalPolygons = static_cast<Uint32>(m_Polygons.size());
+    const Uint32 StartPolygon  = static_cast<Uint32>(Uint64{TotalPolygons} * Subset / NumSubsets);
+    const Uint32 EndPolygon    = static_cast<Uint32>(Uint64{TotalPolygons} * (Subset + 1) / NumSubsets);
+    if (StartPolygon == EndPolygon)
+        return;
+
+    // Update the polygons and stream their instance data into the buffer in a single pass.
+    // Instance data is written with non-temporal stores that bypass the cache.
+    const Uint32 InstDataSize = (EndPolygon - StartPolygon) * Uint32{sizeof(InstanceData)};
+    IBuffer*     pInstBuffer  = nullptr;
+    Uint64       InstOffset   = 0;
+    {
+        Timer UpdateTimer;
 
-        if (UseBatch)
-            BatchData.Unmap();
+        SpriteMotionUpdateAttribs Attribs;
+        Attribs.ElapsedTime = m_ElapsedTime;
+        Attribs.Bounds      = 0.95f;
+        Attribs.MaxRotSpeed = PI_F * 0.5f;
+
+        // The ring buffer is persistently mapped, so the data is written directly to the memory the GPU reads.
+        // If the ring is full, the data is written to the dynamic buffer of the subset, and the ring grows in the next frame.
+        const StreamingRingBuffer::Allocation InstAlloc = m_bUseRingBuffer ? m_RingVB->Allocate(InstDataSize, 16, Subset) : StreamingRingBuffer::Allocation{};
+        if (InstAlloc)
+        {
+            UpdateSpriteInstances(m_PolygonMotion, StartPolygon, EndPolygon, Attribs, static_cast<SpriteInstanceData*>(InstAlloc.pCPUAddress));
+            pInstBuffer = InstAlloc.pBuffer;
+            InstOffset  = InstAlloc.Offset;
+        }
+        else
+        {
+            pInstBuffer = m_SubsetInstanceBuffers[Subset];
+            MapHelper<InstanceData> InstData{pCtx, pInstBuffer, MAP_WRITE, MAP_FLAG_DISCARD};
+            UpdateSpriteInstances(m_PolygonMotion, StartPolygon, EndPolygon, Attribs, reinterpret_cast<SpriteInstanceData*>(static_cast<InstanceData*>(InstData)));
+        }
+        Stats.InstanceBytes += InstDataSize;
+
+        m_SubsetUpdateTime[Subset] = UpdateTimer.GetElapsedTime();
+    }
+
+    DrawIndexedAttribs DrawAttrs;
+    DrawAttrs.IndexType = VT_UINT32;
+    DrawAttrs.Flags     = DRAW_FLAG_VERIFY_ALL;
+
+    // Geometry of every shape is streamed once per frame per context, when it is first used
+    StreamedGeometry ShapeGeo[MaxPolygonVerts + 1];
+
+    int CurrStateInd = -1;
+    for (const PolygonBatch& Run : m_PolygonRuns)
+    {
+        const Uint32 FirstPolygon = std::max(Run.FirstPolygon, StartPolygon);
+        const Uint32 LastPolygon  = std::min(Run.FirstPolygon + Run.NumPolygons, EndPolygon);
+        if (FirstPolygon >= LastPolygon)
+            continue;
+
+        if (Run.StateInd != CurrStateInd)
+        {
+            pCtx->SetPipelineState(m_pPSO[1][Run.StateInd]);
+            pCtx->CommitShaderResources(m_BatchSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+            CurrStateInd = Run.StateInd;
+            ++Stats.NumPSOChanges;
+        }
+
+        const PolygonGeometry& PolygonGeo = m_PolygonGeo[Run.NumVerts];
+        StreamedGeometry&      Geo        = ShapeGeo[Run.NumVerts];
+        if (Geo.pVB == nullptr)
+        {
+            Geo = WritePolygon(PolygonGeo, pCtx, Subset);
+            ++Stats.NumGeometryUploads;
+            Stats.GeometryBytes += PolygonGeo.Verts.size() * sizeof(float2) + PolygonGeo.Inds.size() * sizeof(Uint32);
+        }
+
+        // Every run reads its range of the instance data
+        const Uint64 offsets[] = {Geo.VBOffset, InstOffset + Uint64{FirstPolygon - StartPolygon} * sizeof(InstanceData)};
+        IBuffer*     pBuffs[]  = {Geo.pVB, pInstBuffer};
+        pCtx->SetVertexBuffers(0, _countof(pBuffs), pBuffs, offsets, RESOURCE_STATE_TRANSITION_MODE_VERIFY, SET_VERTEX_BUFFERS_FLAG_RESET);
+        pCtx->SetIndexBuffer(Geo.pIB, Geo.IBOffset, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
 
         DrawAttrs.NumIndices   = static_cast<Uint32>(PolygonGeo.Inds.size());
-        DrawAttrs.NumInstances = EndInst - StartInst;
+        DrawAttrs.NumInstances = LastPolygon - FirstPolygon;
         pCtx->DrawIndexed(DrawAttrs);
+        ++Stats.NumDrawCalls;
     }
 
+    // Dynamic buffers are also used when the ring buffers overflow
     m_StreamingVB->Flush(Subset);
     m_StreamingIB->Flush(Subset);
 }
 
+void Tutorial10_DataStreaming::RenderCurrentSubset(IDeviceContext* pCtx, Uint32 Subset)
+{
+    if (m_bFusedUpdate)
+        RenderSubsetFused(pCtx, Subset);
+    else if (m_BatchSize > 1)
+        RenderSubset<true>(pCtx, Subset);
+    else
+        RenderSubset<false>(pCtx, Subset);
+}
+
 // Render a frame
 void Tutorial10_DataStreaming::Render()
 {
@@ -788,37 +1111,34 @@ void Tutorial10_DataStreaming::Render()
     m_StreamingIB->AllowPersistentMapping(m_bAllowPersistentMap);
     m_StreamingVB->AllowPersistentMapping(m_bAllowPersistentMap);
 
-    if (!m_WorkerThreads.empty())
-    {
-        m_NumThreadsCompleted.store(0);
-        m_RenderSubsetSignal.Trigger(true);
-    }
-
-    if (m_BatchSize > 1)
-        RenderSubset<true>(m_pImmediateContext, 0);
-    else
-        RenderSubset<false>(m_pImmediateContext, 0);
+    // Ring buffers must be prepared before the worker threads start allocating
+    if (m_bUseRingBuffer)
+        BeginRingBufferFrame();
+    // Subset instance buffers are also used when the ring buffer overflows.
+    // Dynamic buffers only take memory when they are mapped.
+    if (m_bFusedUpdate)
+        CreateSubsetInstanceBuffers();
 
-    if (!m_WorkerThreads.empty())
-    {
-        m_ExecuteCommandListsSignal.Wait(true, 1);
+    // With load balancing disabled, every thread renders one fixed subset of batches.
+    // Fused mode always splits the polygons evenly, see RenderSubsetFused().
+    m_Recorder.SetWorkItems(static_cast<Uint32>(m_Batches.size()), m_LoadBalancing ? static_cast<Uint32>(m_ChunkSize) : 0);
 
-        m_CmdListPtrs.resize(m_CmdLists.size());
-        for (Uint32 i = 0; i < m_CmdLists.size(); ++i)
-            m_CmdListPtrs[i] = m_CmdLists[i];
+    m_Recorder.RecordFrame(m_pImmediateContext, [this](IDeviceContext* pCtx, Uint32 Subset) {
+        RenderCurrentSubset(pCtx, Subset);
+    });
 
-        m_pImmediateContext->ExecuteCommandLists(static_cast<Uint32>(m_CmdListPtrs.size()), m_CmdListPtrs.data());
+    if (m_bUseRingBuffer)
+        EndRingBufferFrame();
 
-        for (auto& cmdList : m_CmdLists)
-        {
-            // Release command lists now to release all outstanding references
-            // In d3d11 mode, command lists hold references to the swap chain's back buffer
-            // that cause swap chain resize to fail
-            cmdList.Release();
-        }
-
-        m_NumThreadsReady.store(0);
-        m_GotoNextFrameSignal.Trigger(true);
+    m_FrameStats = {};
+    for (size_t i = 0; i < m_Recorder.GetNumSubsets(); ++i)
+    {
+        const RenderStatistics& SubsetStats = m_SubsetStats[i];
+        m_FrameStats.NumDrawCalls += SubsetStats.NumDrawCalls;
+        m_FrameStats.NumPSOChanges += SubsetStats.NumPSOChanges;
+        m_FrameStats.NumGeometryUploads += SubsetStats.NumGeometryUploads;
+        m_FrameStats.GeometryBytes += SubsetStats.GeometryBytes;
+        m_FrameStats.InstanceBytes += SubsetStats.InstanceBytes;
     }
 }
 
@@ -836,11 +1156,37 @@ void Tutorial10_DataStreaming::CreateInstanceBuffer()
     m_pDevice->CreateBuffer(InstBuffDesc, nullptr, &m_BatchDataBuffer);
 }
 
+void Tutorial10_DataStreaming::CreateSubsetInstanceBuffers()
+{
+    const Uint32 NumSubsets = m_Recorder.GetNumSubsets();
+    const Uint32 SubsetSize = (static_cast<Uint32>(m_Polygons.size()) + NumSubsets - 1) / NumSubsets;
+
+    m_SubsetInstanceBuffers.resize(NumSubsets);
+    for (RefCntAutoPtr<IBuffer>& pBuffer : m_SubsetInstanceBuffers)
+    {
+        // Dynamic buffer memory is allocated when the buffer is mapped, so keep the size tight
+        if (pBuffer && pBuffer->GetDesc().Size == sizeof(InstanceData) * SubsetSize)
+            continue;
+
+        BufferDesc InstBuffDesc;
+        InstBuffDesc.Name           = "Subset instance buffer";
+        InstBuffDesc.Usage          = USAGE_DYNAMIC;
+        InstBuffDesc.BindFlags      = BIND_VERTEX_BUFFER;
+        InstBuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+        InstBuffDesc.Size           = sizeof(InstanceData) * SubsetSize;
+        pBuffer.Release();
+        m_pDevice->CreateBuffer(InstBuffDesc, nullptr, &pBuffer);
+        StateTransitionDesc Barrier(pBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE);
+        m_pImmediateContext->TransitionResourceStates(1, &Barrier);
+    }
+}
+
 void Tutorial10_DataStreaming::Update(double CurrTime, double ElapsedTime, bool DoUpdateUI)
 {
     SampleBase::Update(CurrTime, ElapsedTime, DoUpdateUI);
 
-    UpdatePolygons(static_cast<float>(std::min(ElapsedTime, 0.25)));
+    // Polygons are advanced by the threads that render them
+    m_ElapsedTime = static_cast<float>(std::min(ElapsedTime, 0.25));
 }
 
 } // namespace Diligent
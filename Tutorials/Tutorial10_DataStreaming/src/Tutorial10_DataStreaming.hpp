@@ -27,14 +27,12 @@
 
 #pragma once
 
-#include <atomic>
 #include <memory>
 #include <vector>
-#include <thread>
-#include <mutex>
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
-#include "ThreadSignal.hpp"
+#include "ParallelFrameRecorder.hpp"
+#include "SpriteMotion.hpp"
 
 namespace Diligent
 {
@@ -64,37 +62,38 @@ private:
 
     void InitializePolygons();
     void InitializePolygonGeometry();
+    void SortPolygons();
+    void BuildBatches();
     void CreateInstanceBuffer();
-    void UpdatePolygons(float elapsedTime);
-    void StartWorkerThreads(size_t NumThreads);
-    void StopWorkerThreads();
+    void CreateSubsetInstanceBuffers();
+    void UpdatePolygons(Uint32 Subset, Uint32 StartPolygon, Uint32 EndPolygon);
 
     template <bool UseBatch>
     void RenderSubset(IDeviceContext* pCtx, Uint32 Subset);
+    void RenderSubsetFused(IDeviceContext* pCtx, Uint32 Subset);
+    void RenderCurrentSubset(IDeviceContext* pCtx, Uint32 Subset);
 
-    static void WorkerThreadFunc(Tutorial10_DataStreaming* pThis, Uint32 ThreadNum);
-
-    Threading::Signal m_RenderSubsetSignal;
-    Threading::Signal m_ExecuteCommandListsSignal;
-    Threading::Signal m_GotoNextFrameSignal;
-
-    std::atomic_int m_NumThreadsCompleted;
-    std::atomic_int m_NumThreadsReady;
-
-    std::vector<std::thread> m_WorkerThreads;
-
-    std::vector<RefCntAutoPtr<ICommandList>> m_CmdLists;
-    std::vector<ICommandList*>               m_CmdListPtrs;
+    ParallelFrameRecorder m_Recorder;
 
     static constexpr const int    NumStates = 5;
     RefCntAutoPtr<IPipelineState> m_pPSO[2][NumStates];
     RefCntAutoPtr<IBuffer>        m_PolygonAttribsCB;
     RefCntAutoPtr<IBuffer>        m_BatchDataBuffer;
 
+    // In fused mode without the ring buffer, every subset writes the instance data of all its polygons into its own buffer
+    std::vector<RefCntAutoPtr<IBuffer>> m_SubsetInstanceBuffers;
+
     static constexpr const int             MaxVertsInStreamingBuffer = 1024;
     std::unique_ptr<class StreamingBuffer> m_StreamingVB;
     std::unique_ptr<class StreamingBuffer> m_StreamingIB;
 
+    // Persistently mapped ring buffers that are used instead of the streaming buffers
+    // when the device supports CPU-writable unified memory.
+    std::unique_ptr<class StreamingRingBuffer> m_RingVB;
+    std::unique_ptr<class StreamingRingBuffer> m_RingIB;
+    RefCntAutoPtr<IFence>                      m_pFrameFence;
+    Uint64                                     m_FrameFenceValue = 0;
+
     static constexpr int                  NumTextures = 4;
     RefCntAutoPtr<IShaderResourceBinding> m_SRB[NumTextures];
     RefCntAutoPtr<IShaderResourceBinding> m_BatchSRB;
@@ -110,25 +109,66 @@ private:
     int m_MaxThreads       = 8;
     int m_NumWorkerThreads = 4;
 
+    // Threads take chunks of batches from a shared counter instead of rendering fixed subsets
+    bool m_LoadBalancing = false;
+    int  m_ChunkSize     = 16;
+
+    // Update the polygons and write their instance data in a single pass, then draw every
+    // run of polygons with the same state and shape with one instanced draw call
+    bool m_bFusedUpdate = false;
+
+    // Sort the polygons by state, shape and texture, so that batches and runs are long. Fused mode always
+    // sorts the polygons. Otherwise they are drawn in the order they were created, same as originally.
+    bool m_bSortPolygons   = false;
+    bool m_bPolygonsSorted = false;
+
     struct PolygonData
     {
-        float2 Pos;
-        float2 MoveDir;
-        float  Size       = 0;
-        float  Angle      = 0;
-        float  RotSpeed   = 0;
-        int    TextureInd = 0;
-        int    StateInd   = 0;
-        int    NumVerts   = 0;
+        float Size       = 0;
+        int   TextureInd = 0;
+        int   StateInd   = 0;
+        int   NumVerts   = 0;
     };
     std::vector<PolygonData> m_Polygons;
 
+    // Polygon positions, directions and rotations are stored separately in SoA layout and
+    // updated by every thread for the polygons it renders, right before recording commands.
+    SpriteMotionSoA     m_PolygonMotion;
+    float               m_ElapsedTime = 0;
+    std::vector<double> m_SubsetUpdateTime;
+
+    // Range of polygons with the same state and shape that are drawn with a single draw call
+    struct PolygonBatch
+    {
+        Uint32 FirstPolygon = 0;
+        Uint32 NumPolygons  = 0;
+        int    StateInd     = 0;
+        int    NumVerts     = 0;
+    };
+    std::vector<PolygonBatch> m_Batches;
+    // Runs of polygons with the same state and shape that are not limited by the batch size
+    std::vector<PolygonBatch> m_PolygonRuns;
+
+    // Every subset writes its own statistics, aligned to avoid false sharing
+    struct alignas(64) RenderStatistics
+    {
+        Uint32 NumDrawCalls       = 0;
+        Uint32 NumPSOChanges      = 0;
+        Uint32 NumGeometryUploads = 0;
+        Uint64 GeometryBytes      = 0;
+        Uint64 InstanceBytes      = 0;
+    };
+    std::vector<RenderStatistics> m_SubsetStats;
+    RenderStatistics              m_FrameStats;
+
     struct InstanceData
     {
         float4 PolygonRotationAndScale;
         float2 PolygonCenter;
         float  TexArrInd;
+        float  Padding;
     };
+    static_assert(sizeof(InstanceData) == sizeof(SpriteInstanceData), "Instance data must match the layout written by UpdateSpriteInstances()");
 
     static constexpr const Uint32 MinPolygonVerts = 3;
     static constexpr const Uint32 MaxPolygonVerts = 10;
@@ -139,7 +179,19 @@ private:
     };
     std::vector<PolygonGeometry> m_PolygonGeo;
     bool                         m_bAllowPersistentMap = false;
-    std::pair<Uint32, Uint32>    WritePolygon(const PolygonGeometry& PolygonGeo, IDeviceContext* pCtx, size_t CtxNum);
+    bool                         m_bUseRingBuffer      = false;
+
+    struct StreamedGeometry
+    {
+        IBuffer* pVB      = nullptr;
+        Uint64   VBOffset = 0;
+        IBuffer* pIB      = nullptr;
+        Uint64   IBOffset = 0;
+    };
+    StreamedGeometry WritePolygon(const PolygonGeometry& PolygonGeo, IDeviceContext* pCtx, size_t CtxNum);
+
+    void BeginRingBufferFrame();
+    void EndRingBufferFrame();
 };
 
 } // namespace Diligent
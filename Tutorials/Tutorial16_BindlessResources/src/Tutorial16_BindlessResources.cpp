@@ -25,11 +25,15 @@
  *  of the possibility of such damages.
  */
 
+#include <algorithm>
 #include <random>
 #include <string>
+#include <thread>
 
 #include "Tutorial16_BindlessResources.hpp"
+#include "InstanceGrid.hpp"
 #include "MapHelper.hpp"
+#include "Timer.hpp"
 #include "GraphicsUtilities.h"
 #include "TextureUtilities.h"
 #include "ColorConversion.h"
@@ -463,10 +467,21 @@ void Tutorial16_BindlessResources::UpdateUI()
         {
             PopulateInstanceBuffer();
         }
+        if (ImGui::Checkbox("Parallel grid", &m_ParallelGrid))
+        {
+            PopulateInstanceBuffer();
+        }
+        if (m_ParallelGrid)
+            ImGui::Text("Instance data: %.3f ms (%s, %u threads)", m_PopulateTime * 1000.0, GetInstanceGridISA(), m_NumGridThreads);
+        else
+            ImGui::Text("Instance data: %.3f ms", m_PopulateTime * 1000.0);
         {
             ImGui::ScopedDisabler Disable(!m_pBindlessPSO);
             ImGui::Checkbox("Bindless mode", &m_BindlessMode);
         }
+        ImGui::Checkbox("Group instances", &m_GroupInstances);
+        ImGui::Text("Draw calls: %u, SRB commits: %u", m_NumDrawCalls, m_NumSRBCommits);
+        ImGui::Text("Draw CPU time: %.3f ms", m_DrawTime * 1000.0);
     }
     ImGui::End();
 }
@@ -488,14 +503,9 @@ void Tutorial16_BindlessResources::Initialize(const SampleInitInfo& InitInfo)
     LoadTextures();
 }
 
-void Tutorial16_BindlessResources::PopulateInstanceBuffer()
+void Tutorial16_BindlessResources::GenerateDefaultGrid(float4x4* pMatrices, Uint32* pTextureInd, Uint32* pGeometryType) const
 {
-    // Populate instance data buffer
-    const size_t zGridSize = static_cast<size_t>(m_GridSize);
-    m_Instances.resize(zGridSize * zGridSize * zGridSize);
-    m_GeometryType.resize(zGridSize * zGridSize * zGridSize);
-
-    float fGridSize = static_cast<float>(m_GridSize);
+    const float fGridSize = static_cast<float>(m_GridSize);
 
     std::mt19937 gen; // Standard mersenne_twister_engine. Use default seed
                       // to generate consistent distribution.
@@ -525,21 +535,162 @@ void Tutorial16_BindlessResources::PopulateInstanceBuffer()
                 rotation *= float4x4::RotationY(rot_distr(gen));
                 rotation *= float4x4::RotationZ(rot_distr(gen));
                 // Combine rotation, scale and translation
-                float4x4      matrix   = rotation * float4x4::Scale(scale, scale, scale) * float4x4::Translation(xOffset, yOffset, zOffset);
-                InstanceData& CurrInst = m_Instances[instId];
-                CurrInst.Matrix        = matrix;
+                pMatrices[instId] = rotation * float4x4::Scale(scale, scale, scale) * float4x4::Translation(xOffset, yOffset, zOffset);
                 // Texture array index
-                CurrInst.TextureInd = tex_distr(gen);
+                pTextureInd[instId] = tex_distr(gen);
+
+                pGeometryType[instId++] = geom_type_distr(gen);
+            }
+        }
+    }
+}
+
+void Tutorial16_BindlessResources::PopulateInstanceBuffer()
+{
+    Timer PopulateTimer;
+
+    const Uint32 NumInstances = static_cast<Uint32>(m_GridSize * m_GridSize * m_GridSize);
+    const Uint64 DataSize     = sizeof(InstanceData) * NumInstances;
+
+    InstanceGridAttribs GridAttribs;
+    GridAttribs.GridSize  = static_cast<Uint32>(m_GridSize);
+    GridAttribs.BaseScale = 0.6f;
+
+    // In the parallel grid, texture and geometry are selected with the random streams
+    // that follow the ones used for the matrices
+    const Uint32 TextureStream  = InstanceGridNumStreams;
+    const Uint32 GeometryStream = InstanceGridNumStreams + 1;
+    const Uint32 NumGeometries  = static_cast<Uint32>(m_Geometries.size());
+    const Uint32 NumKeys        = NumGeometries * NumTextures;
+
+    // The default grid is generated up front on this thread and then scattered to the sorted slots
+    std::vector<float4x4> CellMatrices;
+    std::vector<Uint32>   CellTextureInd;
+    std::vector<Uint32>   CellGeometryType;
+    if (!m_ParallelGrid)
+    {
+        CellMatrices.resize(NumInstances);
+        CellTextureInd.resize(NumInstances);
+        CellGeometryType.resize(NumInstances);
+        GenerateDefaultGrid(CellMatrices.data(), CellTextureInd.data(), CellGeometryType.data());
+    }
+
+    // Sort the instances by geometry type and texture with a counting sort, so that all instances
+    // with the same geometry, and with the same geometry and texture, occupy contiguous ranges.
+    std::vector<Uint32> CellKeys(NumInstances);
+    std::vector<Uint32> KeyOffsets(NumKeys + 1, 0);
+    for (Uint32 Cell = 0; Cell < NumInstances; ++Cell)
+    {
+        Uint32 TexInd   = 0;
+        Uint32 GeomType = 0;
+        if (m_ParallelGrid)
+        {
+            TexInd   = std::min(static_cast<Uint32>(GetInstanceGridRandom(GridAttribs.Seed, Cell, TextureStream) * NumTextures), Uint32{NumTextures - 1});
+            GeomType = std::min(static_cast<Uint32>(GetInstanceGridRandom(GridAttribs.Seed, Cell, GeometryStream) * NumGeometries), NumGeometries - 1);
+        }
+        else
+        {
+            TexInd   = CellTextureInd[Cell];
+            GeomType = CellGeometryType[Cell];
+        }
+
+        CellKeys[Cell] = GeomType * NumTextures + TexInd;
+        ++KeyOffsets[CellKeys[Cell] + 1];
+    }
+    for (Uint32 Key = 0; Key < NumKeys; ++Key)
+        KeyOffsets[Key + 1] += KeyOffsets[Key];
+
+    m_TextureGroups.clear();
+    m_GeometryGroups.clear();
+    for (Uint32 Key = 0; Key < NumKeys; ++Key)
+    {
+        InstanceGroup Group;
+        Group.FirstInstance = KeyOffsets[Key];
+        Group.NumInstances  = KeyOffsets[Key + 1] - KeyOffsets[Key];
+        Group.GeometryType  = Key / NumTextures;
+        Group.TextureInd    = Key % NumTextures;
+        if (Group.NumInstances == 0)
+            continue;
+
+        m_TextureGroups.push_back(Group);
+        if (!m_GeometryGroups.empty() && m_GeometryGroups.back().GeometryType == Group.GeometryType)
+            m_GeometryGroups.back().NumInstances += Group.NumInstances;
+        else
+            m_GeometryGroups.push_back(Group);
+    }
+
+    // Position of every cell in the sorted order. Cells with the same key keep their relative order.
+    std::vector<Uint32> CellSlots(NumInstances);
+    m_TextureInd.resize(NumInstances);
+    m_GeometryType.resize(NumInstances);
+    for (Uint32 Cell = 0; Cell < NumInstances; ++Cell)
+    {
+        const Uint32 Key  = CellKeys[Cell];
+        const Uint32 Slot = KeyOffsets[Key]++;
+
+        CellSlots[Cell]      = Slot;
+        m_TextureInd[Slot]   = Key % NumTextures;
+        m_GeometryType[Slot] = Key / NumTextures;
+    }
 
-                m_GeometryType[instId++] = geom_type_distr(gen);
+    // Instance data is written directly to the mapped staging buffer and then copied
+    // to the instance buffer by the GPU. The staging buffer may be released right after the
+    // copy command is recorded as the engine keeps it alive until the GPU is done with it.
+    BufferDesc UploadBuffDesc;
+    UploadBuffDesc.Name           = "Instance data upload buffer";
+    UploadBuffDesc.Usage          = USAGE_STAGING;
+    UploadBuffDesc.CPUAccessFlags = CPU_ACCESS_WRITE;
+    UploadBuffDesc.Size           = DataSize;
+    RefCntAutoPtr<IBuffer> pUploadBuffer;
+    m_pDevice->CreateBuffer(UploadBuffDesc, nullptr, &pUploadBuffer);
+    {
+        MapHelper<InstanceData> MappedData{m_pImmediateContext, pUploadBuffer, MAP_WRITE, MAP_FLAG_NONE};
+        InstanceData*           pInstances = MappedData;
+
+        if (m_ParallelGrid)
+        {
+            // The grid is only rebuilt when its size changes, so the worker threads are started
+            // for the rebuild and joined right after it.
+#if PLATFORM_EMSCRIPTEN
+            m_GridWorkers.Start(0);
+#else
+            m_GridWorkers.Start(std::max(std::thread::hardware_concurrency(), 2u) - 1u);
+#endif
+            m_NumGridThreads = m_GridWorkers.GetNumSubsets();
+
+            // Every instance only depends on its cell index, so the threads may take the
+            // cells in any order and still produce the same grid.
+            m_GridWorkers.SetWorkItems(NumInstances, 256);
+            m_GridWorkers.ParallelFor([&](Uint32 Subset) {
+                Uint32 StartInst = 0, EndInst = 0;
+                while (m_GridWorkers.NextChunk(Subset, StartInst, EndInst))
+                {
+                    GenerateInstanceGrid(GridAttribs, StartInst, EndInst, &pInstances[0].Matrix, sizeof(InstanceData), CellSlots.data());
+                    for (Uint32 Cell = StartInst; Cell < EndInst; ++Cell)
+                    {
+                        const Uint32 Slot           = CellSlots[Cell];
+                        pInstances[Slot].TextureInd = m_TextureInd[Slot];
+                    }
+                }
+            });
+            m_GridWorkers.Stop();
+        }
+        else
+        {
+            for (Uint32 Cell = 0; Cell < NumInstances; ++Cell)
+            {
+                const Uint32 Slot           = CellSlots[Cell];
+                pInstances[Slot].Matrix     = CellMatrices[Cell];
+                pInstances[Slot].TextureInd = m_TextureInd[Slot];
             }
         }
     }
-    // Update instance data buffer
-    Uint32 DataSize = static_cast<Uint32>(sizeof(InstanceData) * m_Instances.size());
-    m_pImmediateContext->UpdateBuffer(m_InstanceBuffer, 0, DataSize, m_Instances.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->CopyBuffer(pUploadBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                    m_InstanceBuffer, 0, DataSize, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
     StateTransitionDesc Barrier(m_InstanceBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_VERTEX_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE);
     m_pImmediateContext->TransitionResourceStates(1, &Barrier);
+
+    m_PopulateTime = PopulateTimer.GetElapsedTime();
 }
 
 
@@ -577,28 +728,59 @@ void Tutorial16_BindlessResources::Render()
     if (m_BindlessMode)
         m_pImmediateContext->CommitShaderResources(m_BindlessSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
 
-    int NumObjects = m_GridSize * m_GridSize * m_GridSize;
-    for (int i = 0; i < NumObjects; ++i)
-    {
-        if (!m_BindlessMode)
-        {
-            uint TexId = m_Instances[i].TextureInd;
-            m_pImmediateContext->CommitShaderResources(m_SRB[TexId], RESOURCE_STATE_TRANSITION_MODE_VERIFY);
-        }
+    Timer  DrawTimer;
+    Uint32 NumDrawCalls  = 0;
+    Uint32 NumSRBCommits = 0;
 
-        const ObjectGeometry& Geometry = m_Geometries[m_GeometryType[i]];
+    auto DrawInstances = [&](Uint32 GeometryType, Uint32 FirstInstance, Uint32 NumInstances) {
+        const ObjectGeometry& Geometry = m_Geometries[GeometryType];
 
         DrawIndexedAttribs DrawAttrs;
         DrawAttrs.IndexType             = VT_UINT32;
         DrawAttrs.NumIndices            = Geometry.NumIndices;
+        DrawAttrs.NumInstances          = NumInstances;
         DrawAttrs.FirstIndexLocation    = Geometry.FirstIndex;
-        DrawAttrs.FirstInstanceLocation = static_cast<Uint32>(i);
+        DrawAttrs.FirstInstanceLocation = FirstInstance;
         // Verify the state of vertex and index buffers
         // Also use DRAW_FLAG_DYNAMIC_RESOURCE_BUFFERS_INTACT flag to inform the engine that
         // none of the dynamic buffers have changed since the last draw command.
         DrawAttrs.Flags = DRAW_FLAG_VERIFY_ALL | DRAW_FLAG_DYNAMIC_RESOURCE_BUFFERS_INTACT;
         m_pImmediateContext->DrawIndexed(DrawAttrs);
+        ++NumDrawCalls;
+    };
+
+    if (m_GroupInstances)
+    {
+        // In bindless mode, the texture index is read from the instance data, so all instances
+        // with the same geometry are drawn together. Otherwise, every texture requires its own SRB.
+        for (const InstanceGroup& Group : m_BindlessMode ? m_GeometryGroups : m_TextureGroups)
+        {
+            if (!m_BindlessMode)
+            {
+                m_pImmediateContext->CommitShaderResources(m_SRB[Group.TextureInd], RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+                ++NumSRBCommits;
+            }
+            DrawInstances(Group.GeometryType, Group.FirstInstance, Group.NumInstances);
+        }
     }
+    else
+    {
+        const Uint32 NumObjects = static_cast<Uint32>(m_GridSize * m_GridSize * m_GridSize);
+        for (Uint32 i = 0; i < NumObjects; ++i)
+        {
+            if (!m_BindlessMode)
+            {
+                Uint32 TexId = m_TextureInd[i];
+                m_pImmediateContext->CommitShaderResources(m_SRB[TexId], RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+                ++NumSRBCommits;
+            }
+            DrawInstances(m_GeometryType[i], i, 1);
+        }
+    }
+
+    m_NumDrawCalls  = NumDrawCalls;
+    m_NumSRBCommits = NumSRBCommits;
+    m_DrawTime      = DrawTimer.GetElapsedTime();
 }
 
 void Tutorial16_BindlessResources::Update(double CurrTime, double ElapsedTime, bool DoUpdateUI)
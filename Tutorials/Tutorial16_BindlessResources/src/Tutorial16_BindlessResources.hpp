@@ -30,6 +30,7 @@
 #include <vector>
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
+#include "ParallelFrameRecorder.hpp"
 
 namespace Diligent
 {
@@ -62,6 +63,7 @@ private:
     void CreateInstanceBuffer();
     void LoadTextures();
     void PopulateInstanceBuffer();
+    void GenerateDefaultGrid(float4x4* pMatrices, Uint32* pTextureInd, Uint32* pGeometryType) const;
 
     static constexpr int        NumTextures = 4;
     std::vector<ObjectGeometry> m_Geometries;
@@ -82,8 +84,40 @@ private:
         float4x4 Matrix;
         uint     TextureInd = 0;
     };
-    std::vector<InstanceData> m_Instances;
-    std::vector<Uint32>       m_GeometryType;
+    // Instances are sorted by geometry type and texture. Texture and geometry of every
+    // instance are also kept on the CPU to set up the draw calls.
+    std::vector<Uint32> m_TextureInd;
+    std::vector<Uint32> m_GeometryType;
+
+    // Contiguous range of instances that are drawn with a single instanced draw call
+    struct InstanceGroup
+    {
+        Uint32 FirstInstance = 0;
+        Uint32 NumInstances  = 0;
+        Uint32 GeometryType  = 0;
+        Uint32 TextureInd    = 0;
+    };
+    // Instances with the same geometry and texture, used when textures are bound through the SRBs
+    std::vector<InstanceGroup> m_TextureGroups;
+    // Instances with the same geometry, used in bindless mode where textures are selected by the instance data
+    std::vector<InstanceGroup> m_GeometryGroups;
+
+    // Draw every group of instances with one call instead of drawing every object separately
+    bool m_GroupInstances = true;
+
+    Uint32 m_NumDrawCalls  = 0;
+    Uint32 m_NumSRBCommits = 0;
+    double m_DrawTime      = 0;
+
+    // Generate the grid with GenerateInstanceGrid() on the worker threads, see Tutorial04.
+    // The default grid keeps the original layout.
+    bool m_ParallelGrid = false;
+
+    // Worker threads that generate the instance data. They do not record any commands and
+    // only run while the grid is rebuilt.
+    ParallelTaskPool m_GridWorkers;
+    Uint32           m_NumGridThreads = 1;
+    double           m_PopulateTime   = 0;
 
     float4x4 m_ViewProjMatrix;
     float4x4 m_RotationMatrix;
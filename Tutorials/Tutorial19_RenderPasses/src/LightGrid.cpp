@@ -0,0 +1,272 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "LightGrid.hpp"
+
+#include <algorithm>
+#include <cfloat>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define LIGHT_KERNELS_SSE2 1
+#    include <emmintrin.h>
+#endif
+
+namespace Diligent
+{
+
+void LightSoA::Resize(Uint32 NewCount)
+{
+    const size_t PaddedCount = (size_t{NewCount} + Alignment - 1) / Alignment * Alignment;
+    for (std::vector<float>* pArray : {&PosX, &PosY, &PosZ, &DirX, &DirY, &DirZ, &Size, &ColorR, &ColorG, &ColorB})
+    {
+        // Padding elements are zero, so padded lights never move
+        pArray->assign(PaddedCount, 0.f);
+    }
+    Count = NewCount;
+}
+
+const char* GetLightKernelsISA()
+{
+#if LIGHT_KERNELS_SSE2
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
+
+namespace
+{
+
+inline void MoveCoordinate(float& Coord, float& Dir, float ElapsedTime, float Min, float Max)
+{
+    Coord += Dir * ElapsedTime;
+    if (Coord < Min)
+    {
+        Coord = Min * 2.f - Coord;
+        Dir   = -Dir;
+    }
+    else if (Coord > Max)
+    {
+        Coord = Max * 2.f - Coord;
+        Dir   = -Dir;
+    }
+}
+
+#if LIGHT_KERNELS_SSE2
+inline __m128 Select(__m128 a, __m128 b, __m128 Mask)
+{
+    return _mm_or_ps(_mm_andnot_ps(Mask, a), _mm_and_ps(Mask, b));
+}
+
+inline void MoveCoordinates(float* pCoord, float* pDir, size_t Count, float ElapsedTime, float Min, float Max)
+{
+    const __m128 dt      = _mm_set1_ps(ElapsedTime);
+    const __m128 MinV    = _mm_set1_ps(Min);
+    const __m128 MaxV    = _mm_set1_ps(Max);
+    const __m128 Min2    = _mm_set1_ps(Min * 2.f);
+    const __m128 Max2    = _mm_set1_ps(Max * 2.f);
+    const __m128 SignBit = _mm_set1_ps(-0.f);
+    for (size_t i = 0; i < Count; i += 4)
+    {
+        __m128 Dir   = _mm_loadu_ps(pDir + i);
+        __m128 Coord = _mm_add_ps(_mm_loadu_ps(pCoord + i), _mm_mul_ps(Dir, dt));
+
+        const __m128 Below = _mm_cmplt_ps(Coord, MinV);
+        const __m128 Above = _mm_cmpgt_ps(Coord, MaxV);
+
+        Coord = Select(Coord, _mm_sub_ps(Min2, Coord), Below);
+        Coord = Select(Coord, _mm_sub_ps(Max2, Coord), Above);
+        Dir   = _mm_xor_ps(Dir, _mm_and_ps(_mm_or_ps(Below, Above), SignBit));
+
+        _mm_storeu_ps(pCoord + i, Coord);
+        _mm_storeu_ps(pDir + i, Dir);
+    }
+}
+#else
+inline void MoveCoordinates(float* pCoord, float* pDir, size_t Count, float ElapsedTime, float Min, float Max)
+{
+    for (size_t i = 0; i < Count; ++i)
+        MoveCoordinate(pCoord[i], pDir[i], ElapsedTime, Min, Max);
+}
+#endif
+
+} // namespace
+
+void MoveLights(LightSoA& Lights, float ElapsedTime, float VolumeMin, float VolumeMax)
+{
+    const size_t PaddedCount = Lights.PosX.size();
+
+    MoveCoordinates(Lights.PosX.data(), Lights.DirX.data(), PaddedCount, ElapsedTime, VolumeMin, VolumeMax);
+    MoveCoordinates(Lights.PosY.data(), Lights.DirY.data(), PaddedCount, ElapsedTime, VolumeMin, VolumeMax);
+    MoveCoordinates(Lights.PosZ.data(), Lights.DirZ.data(), PaddedCount, ElapsedTime, VolumeMin, VolumeMax);
+}
+
+namespace
+{
+
+// Converts the coordinate in cluster units to the cluster index
+inline Uint8 ClampToGrid(float Coord, Uint32 Dim)
+{
+    return static_cast<Uint8>(std::min(std::max(static_cast<int>(Coord), 0), static_cast<int>(Dim) - 1));
+}
+
+} // namespace
+
+void LightClusterGrid::Build(const LightSoA& Lights, const float4x4& View, const float4x4& Proj, float ZNear)
+{
+    const Uint32 NumLights = Lights.Count;
+    m_Bounds.resize(NumLights);
+
+    float MinDepth = +FLT_MAX;
+    float MaxDepth = -FLT_MAX;
+
+    // Compute conservative screen-space bounds of every light
+    for (Uint32 i = 0; i < NumLights; ++i)
+    {
+        LightBounds& Bounds = m_Bounds[i];
+
+        const float x = Lights.PosX[i];
+        const float y = Lights.PosY[i];
+        const float z = Lights.PosZ[i];
+        const float r = Lights.Size[i];
+
+        const float vx = x * View.m00 + y * View.m10 + z * View.m20 + View.m30;
+        const float vy = x * View.m01 + y * View.m11 + z * View.m21 + View.m31;
+        const float vz = x * View.m02 + y * View.m12 + z * View.m22 + View.m32;
+
+        Bounds.MinDepth = vz - r;
+        Bounds.MaxDepth = vz + r;
+        Bounds.Visible  = Bounds.MaxDepth > ZNear;
+        if (!Bounds.Visible)
+            continue;
+
+        float2 MinUV{0, 0};
+        float2 MaxUV{1, 1};
+        if (Bounds.MinDepth > ZNear)
+        {
+            // The sphere is contained in the [vx - r, vx + r] x [vz - r, vz + r] box, so
+            // x / z ranges between the extreme values at the box corners.
+            const auto ProjectRange = [&Bounds, r](float Center, float& MinT, float& MaxT) //
+            {
+                const float Min = Center - r;
+                const float Max = Center + r;
+                MinT            = Min / (Min >= 0 ? Bounds.MaxDepth : Bounds.MinDepth);
+                MaxT            = Max / (Max >= 0 ? Bounds.MinDepth : Bounds.MaxDepth);
+            };
+            float MinTx, MaxTx, MinTy, MaxTy;
+            ProjectRange(vx, MinTx, MaxTx);
+            ProjectRange(vy, MinTy, MaxTy);
+
+            // NDC -> UV, y axis points down in UV space
+            MinUV.x = (MinTx * Proj.m00 + Proj.m20) * 0.5f + 0.5f;
+            MaxUV.x = (MaxTx * Proj.m00 + Proj.m20) * 0.5f + 0.5f;
+            MinUV.y = 0.5f - (MaxTy * Proj.m11 + Proj.m21) * 0.5f;
+            MaxUV.y = 0.5f - (MinTy * Proj.m11 + Proj.m21) * 0.5f;
+
+            if (MaxUV.x < 0 || MinUV.x > 1 || MaxUV.y < 0 || MinUV.y > 1)
+            {
+                Bounds.Visible = false;
+                continue;
+            }
+        }
+
+        Bounds.MinX = ClampToGrid(MinUV.x * static_cast<float>(DimX), DimX);
+        Bounds.MaxX = ClampToGrid(MaxUV.x * static_cast<float>(DimX), DimX);
+        Bounds.MinY = ClampToGrid(MinUV.y * static_cast<float>(DimY), DimY);
+        Bounds.MaxY = ClampToGrid(MaxUV.y * static_cast<float>(DimY), DimY);
+
+        MinDepth = std::min(MinDepth, std::max(Bounds.MinDepth, ZNear));
+        MaxDepth = std::max(MaxDepth, Bounds.MaxDepth);
+    }
+
+    if (MinDepth < MaxDepth)
+    {
+        m_DepthStart = MinDepth;
+        m_DepthScale = static_cast<float>(DimZ) / (MaxDepth - MinDepth);
+    }
+    else
+    {
+        m_DepthStart = ZNear;
+        m_DepthScale = 0;
+    }
+
+    // Count lights in every cluster
+    m_LightRanges.assign(NumClusters, uint2{0, 0});
+    for (Uint32 i = 0; i < NumLights; ++i)
+    {
+        LightBounds& Bounds = m_Bounds[i];
+        if (!Bounds.Visible)
+            continue;
+
+        Bounds.MinZ = ClampToGrid((Bounds.MinDepth - m_DepthStart) * m_DepthScale, DimZ);
+        Bounds.MaxZ = ClampToGrid((Bounds.MaxDepth - m_DepthStart) * m_DepthScale, DimZ);
+        for (Uint32 cz = Bounds.MinZ; cz <= Bounds.MaxZ; ++cz)
+        {
+            for (Uint32 cy = Bounds.MinY; cy <= Bounds.MaxY; ++cy)
+            {
+                uint2* pRow = &m_LightRanges[(cz * DimY + cy) * DimX];
+                for (Uint32 cx = Bounds.MinX; cx <= Bounds.MaxX; ++cx)
+                    ++pRow[cx].y;
+            }
+        }
+    }
+
+    // Compute offsets
+    Uint32 NumIndices     = 0;
+    m_MaxLightsPerCluster = 0;
+    for (uint2& Range : m_LightRanges)
+    {
+        Range.x = NumIndices;
+        NumIndices += Range.y;
+        m_MaxLightsPerCluster = std::max(m_MaxLightsPerCluster, Range.y);
+        // Count is restored when the indices are written
+        Range.y = 0;
+    }
+
+    // Write light indices
+    m_LightIndices.resize(std::max(NumIndices, 1u));
+    for (Uint32 i = 0; i < NumLights; ++i)
+    {
+        const LightBounds& Bounds = m_Bounds[i];
+        if (!Bounds.Visible)
+            continue;
+
+        for (Uint32 cz = Bounds.MinZ; cz <= Bounds.MaxZ; ++cz)
+        {
+            for (Uint32 cy = Bounds.MinY; cy <= Bounds.MaxY; ++cy)
+            {
+                uint2* pRow = &m_LightRanges[(cz * DimY + cy) * DimX];
+                for (Uint32 cx = Bounds.MinX; cx <= Bounds.MaxX; ++cx)
+                {
+                    uint2& Range = pRow[cx];
+                    m_LightIndices[Range.x + Range.y++] = i;
+                }
+            }
+        }
+    }
+}
+
+} // namespace Diligent
@@ -0,0 +1,102 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+// Structure-of-arrays light storage. Every array is padded to a multiple of
+// LightSoA::Alignment elements so that kernels can always process full SIMD vectors.
+struct LightSoA
+{
+    static constexpr Uint32 Alignment = 4;
+
+    std::vector<float> PosX, PosY, PosZ;
+    std::vector<float> DirX, DirY, DirZ;
+    std::vector<float> Size;
+    std::vector<float> ColorR, ColorG, ColorB;
+
+    Uint32 Count = 0;
+
+    void Resize(Uint32 NewCount);
+};
+
+// Returns the name of the instruction set the light kernels were compiled for.
+const char* GetLightKernelsISA();
+
+// Moves all lights along their directions and reflects them off the walls of the [VolumeMin, VolumeMax] cube.
+void MoveLights(LightSoA& Lights, float ElapsedTime, float VolumeMin, float VolumeMax);
+
+// Screen-space tiles subdivided into depth slices. Every cluster references
+// the range of light indices in the shared index list of the lights that may affect it.
+class LightClusterGrid
+{
+public:
+    static constexpr Uint32 DimX = 16;
+    static constexpr Uint32 DimY = 16;
+    static constexpr Uint32 DimZ = 16;
+
+    static constexpr Uint32 NumClusters = DimX * DimY * DimZ;
+
+    // Assigns lights to clusters. View matrix must include the surface pretransform.
+    // Depth slices are distributed linearly between the nearest and farthest visible light.
+    void Build(const LightSoA& Lights, const float4x4& View, const float4x4& Proj, float ZNear);
+
+    // Offset in the light index list and the number of lights for every cluster.
+    const std::vector<uint2>&  GetLightRanges() const { return m_LightRanges; }
+    const std::vector<Uint32>& GetLightIndices() const { return m_LightIndices; }
+
+    // View-space depth of the first slice and the number of slices per unit of depth.
+    float GetDepthStart() const { return m_DepthStart; }
+    float GetDepthScale() const { return m_DepthScale; }
+
+    Uint32 GetMaxLightsPerCluster() const { return m_MaxLightsPerCluster; }
+
+private:
+    struct LightBounds
+    {
+        Uint8 MinX, MaxX;
+        Uint8 MinY, MaxY;
+        Uint8 MinZ, MaxZ;
+        bool  Visible;
+        float MinDepth, MaxDepth;
+    };
+    std::vector<LightBounds> m_Bounds;
+
+    std::vector<uint2>  m_LightRanges;
+    std::vector<Uint32> m_LightIndices;
+
+    float  m_DepthStart          = 0;
+    float  m_DepthScale          = 0;
+    Uint32 m_MaxLightsPerCluster = 0;
+};
+
+} // namespace Diligent
@@ -36,6 +36,7 @@
 #include "imgui.h"
 #include "ImGuiUtils.hpp"
 #include "FastRand.hpp"
+#include "Timer.hpp"
 
 namespace Diligent
 {
@@ -48,6 +49,9 @@ namespace HLSL
 #include "../assets/shader_structs.fxh"
 }
 
+// Light counts swept by the benchmark
+static constexpr int BenchmarkLightCounts[] = {500, 1000, 2500, 5000, 10000, 25000, 50000};
+
 } // namespace
 
 SampleBase* CreateSample()
@@ -62,6 +66,9 @@ void Tutorial19_RenderPasses::ModifyEngineInitInfo(const ModifyEngineInitInfoAtt
     // We do not need the depth buffer from the swap chain in this sample
     Attribs.SCDesc.DepthBufferFormat = TEX_FORMAT_UNKNOWN;
 
+    // Timestamp queries are used to measure the render pass GPU time
+    Attribs.EngineCI.Features.TimestampQueries = DEVICE_FEATURE_STATE_OPTIONAL;
+
 #if PLATFORM_WEB
     if (Attribs.DeviceType == RENDER_DEVICE_TYPE_GLES)
     {
@@ -353,6 +360,93 @@ void Tutorial19_RenderPasses::CreateAmbientLightPSO(IShaderSourceInputStreamFact
     VERIFY_EXPR(m_pAmbientLightPSO != nullptr);
 }
 
+void Tutorial19_RenderPasses::CreateClusteredLightPSO(IShaderSourceInputStreamFactory* pShaderSourceFactory)
+{
+    GraphicsPipelineStateCreateInfo PSOCreateInfo;
+    PipelineStateDesc&              PSODesc = PSOCreateInfo.PSODesc;
+
+    PSODesc.Name = "Clustered lighting PSO";
+
+    PSOCreateInfo.GraphicsPipeline.pRenderPass  = m_pRenderPass;
+    PSOCreateInfo.GraphicsPipeline.SubpassIndex = 1; // This PSO will be used within the second subpass
+
+    PSOCreateInfo.GraphicsPipeline.PrimitiveTopology            = PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP;
+    PSOCreateInfo.GraphicsPipeline.RasterizerDesc.CullMode      = CULL_MODE_NONE;
+    PSOCreateInfo.GraphicsPipeline.DepthStencilDesc.DepthEnable = False; // Disable depth
+
+    // Add lighting to the ambient light
+    RenderTargetBlendDesc& RT0Blend{PSOCreateInfo.GraphicsPipeline.BlendDesc.RenderTargets[0]};
+    RT0Blend.BlendEnable    = True;
+    RT0Blend.BlendOp        = BLEND_OPERATION_ADD;
+    RT0Blend.SrcBlend       = BLEND_FACTOR_ONE;
+    RT0Blend.DestBlend      = BLEND_FACTOR_ONE;
+    RT0Blend.SrcBlendAlpha  = BLEND_FACTOR_ZERO;
+    RT0Blend.DestBlendAlpha = BLEND_FACTOR_ONE;
+
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage = SHADER_SOURCE_LANGUAGE_HLSL;
+
+    ShaderCI.Desc.UseCombinedTextureSamplers = true;
+
+    ShaderCI.CompileFlags = SHADER_COMPILE_FLAG_PACK_MATRIX_ROW_MAJOR;
+
+    ShaderMacro Macros[] = {{"CONVERT_PS_OUTPUT_TO_GAMMA", m_ConvertPSOutputToGamma ? "1" : "0"}};
+    ShaderCI.Macros      = {Macros, _countof(Macros)};
+
+    ShaderCI.pShaderSourceStreamFactory = pShaderSourceFactory;
+    // Full-screen quad vertex shader is shared with the ambient light pass
+    RefCntAutoPtr<IShader> pVS;
+    {
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_VERTEX;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "Clustered light VS";
+        ShaderCI.FilePath        = "ambient_light.vsh";
+        m_pDevice->CreateShader(ShaderCI, &pVS);
+        VERIFY_EXPR(pVS != nullptr);
+    }
+
+    // Create a pixel shader
+    RefCntAutoPtr<IShader> pPS;
+    {
+        // For Vulkan and Metal, we will use a special GLSL shader that uses native input attachments
+        const bool UseGLSL =
+            m_pDevice->GetDeviceInfo().IsVulkanDevice() ||
+            m_pDevice->GetDeviceInfo().IsMetalDevice();
+
+        ShaderCI.SourceLanguage  = UseGLSL ? SHADER_SOURCE_LANGUAGE_GLSL : SHADER_SOURCE_LANGUAGE_HLSL;
+        ShaderCI.Desc.ShaderType = SHADER_TYPE_PIXEL;
+        ShaderCI.EntryPoint      = "main";
+        ShaderCI.Desc.Name       = "Clustered light PS";
+        ShaderCI.FilePath        = UseGLSL ? "clustered_light_glsl.psh" : "clustered_light_hlsl.psh";
+        ShaderCI.GLSLExtensions  = UseGLSL ? "#extension GL_ARB_shading_language_include : enable\n" : nullptr;
+        m_pDevice->CreateShader(ShaderCI, &pPS);
+        VERIFY_EXPR(pPS != nullptr);
+    }
+
+    PSOCreateInfo.pVS = pVS;
+    PSOCreateInfo.pPS = pPS;
+
+    PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_STATIC;
+
+    // clang-format off
+    ShaderResourceVariableDesc Vars[] = 
+    {
+        {SHADER_TYPE_PIXEL, "g_SubpassInputColor",   SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_PIXEL, "g_SubpassInputDepthZ",  SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_PIXEL, "g_ClusteredLights",     SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_PIXEL, "g_ClusterLightRanges",  SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE},
+        {SHADER_TYPE_PIXEL, "g_ClusterLightIndices", SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE}
+    };
+    // clang-format on
+    PSODesc.ResourceLayout.Variables    = Vars;
+    PSODesc.ResourceLayout.NumVariables = _countof(Vars);
+
+    m_pDevice->CreateGraphicsPipelineState(PSOCreateInfo, &m_pClusteredLightPSO);
+    VERIFY_EXPR(m_pClusteredLightPSO != nullptr);
+
+    m_pClusteredLightPSO->GetStaticVariableByName(SHADER_TYPE_PIXEL, "ShaderConstants")->Set(m_pShaderConstantsCB);
+}
+
 
 void Tutorial19_RenderPasses::CreateRenderPass()
 {
@@ -485,16 +579,64 @@ void Tutorial19_RenderPasses::UpdateUI()
     ImGui::SetNextWindowPos(ImVec2(10, 10), ImGuiCond_FirstUseEver);
     if (ImGui::Begin("Settings", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
     {
-        if (ImGui::InputInt("Lights count", &m_LightsCount, 100, 1000, ImGuiInputTextFlags_EnterReturnsTrue))
+        // Lights count and lighting mode are controlled by the benchmark while it is running
+        if (!m_Benchmark.Running)
         {
-            m_LightsCount = std::max(m_LightsCount, 100);
-            m_LightsCount = std::min(m_LightsCount, 50000);
-            InitLights();
-            CreateLightsBuffer();
+            if (ImGui::InputInt("Lights count", &m_LightsCount, 100, 1000, ImGuiInputTextFlags_EnterReturnsTrue))
+            {
+                m_LightsCount = std::max(m_LightsCount, 100);
+                m_LightsCount = std::min(m_LightsCount, 50000);
+                InitLights();
+                CreateLightsBuffer();
+            }
+
+            if (m_pClusteredLightPSO)
+            {
+                const char* LightingModes[] = {"Light volumes", "Clustered"};
+                static_assert(_countof(LightingModes) == LIGHTING_MODE_COUNT, "Please update the list of lighting modes");
+                ImGui::Combo("Lighting mode", &m_LightingMode, LightingModes, _countof(LightingModes));
+            }
         }
 
-        ImGui::Checkbox("Show light volumes", &m_ShowLightVolumes);
+        {
+            // The clustered mode does not draw light volumes
+            ImGui::ScopedDisabler Disable(m_LightingMode == LIGHTING_MODE_CLUSTERED);
+            ImGui::Checkbox("Show light volumes", &m_ShowLightVolumes);
+        }
         ImGui::Checkbox("Animate lights", &m_AnimateLights);
+
+        ImGui::Separator();
+        ImGui::Text("Light kernels: %s", GetLightKernelsISA());
+        ImGui::Text("Lights CPU time: %.2f ms", m_LightsCpuTime * 1000.0);
+        if (m_pRenderPassDuration)
+            ImGui::Text("Render pass GPU time: %.2f ms", m_RenderPassGpuTime * 1000.0);
+        if (m_LightingMode == LIGHTING_MODE_CLUSTERED)
+        {
+            ImGui::Text("Clusters: %ux%ux%u, max %u lights per cluster",
+                        LightClusterGrid::DimX, LightClusterGrid::DimY, LightClusterGrid::DimZ, m_LightGrid.GetMaxLightsPerCluster());
+        }
+
+        ImGui::Separator();
+        if (m_Benchmark.Running)
+        {
+            ImGui::Text("Benchmarking %d lights...", m_LightsCount);
+        }
+        else if (ImGui::Button("Run benchmark"))
+        {
+            StartBenchmark();
+        }
+
+        if (!m_Benchmark.Results.empty())
+        {
+            // CPU and GPU times in milliseconds for every lighting mode
+            ImGui::TextDisabled("Lights    Volumes CPU/GPU  Clustered CPU/GPU");
+            for (const Benchmark::Result& Res : m_Benchmark.Results)
+            {
+                ImGui::Text("%6d    %5.2f / %5.2f    %5.2f / %5.2f", Res.LightsCount,
+                            Res.CpuTime[LIGHTING_MODE_LIGHT_VOLUMES] * 1000.0, Res.GpuTime[LIGHTING_MODE_LIGHT_VOLUMES] * 1000.0,
+                            Res.CpuTime[LIGHTING_MODE_CLUSTERED] * 1000.0, Res.GpuTime[LIGHTING_MODE_CLUSTERED] * 1000.0);
+            }
+        }
     }
     ImGui::End();
 }
@@ -522,6 +664,15 @@ void Tutorial19_RenderPasses::Initialize(const SampleInitInfo& InitInfo)
     CreateLightVolumePSO(pShaderSourceFactory);
     CreateAmbientLightPSO(pShaderSourceFactory);
 
+    // Clustered lighting reads lights from structured buffers in the pixel shader, which
+    // are not available on WebGL and are not guaranteed to be supported by GLES fragment shaders.
+    const RenderDeviceInfo& DeviceInfo = m_pDevice->GetDeviceInfo();
+    if (DeviceInfo.Features.ComputeShaders && !DeviceInfo.IsGLDevice())
+        CreateClusteredLightPSO(pShaderSourceFactory);
+
+    if (DeviceInfo.Features.TimestampQueries)
+        m_pRenderPassDuration.reset(new DurationQueryHelper{m_pDevice, 4});
+
     // Transition all resources to required states as no transitions are allowed within the render pass.
     StateTransitionDesc Barriers[] = //
         {
@@ -541,6 +692,7 @@ void Tutorial19_RenderPasses::ReleaseWindowResources()
     m_FramebufferCache.clear();
     m_pLightVolumeSRB.Release();
     m_pAmbientLightSRB.Release();
+    m_pClusteredLightSRB.Release();
 }
 
 void Tutorial19_RenderPasses::ReleaseSwapChainBuffers()
@@ -702,6 +854,18 @@ IFramebuffer* Tutorial19_RenderPasses::GetCurrentFramebuffer()
     }
 }
 
+void Tutorial19_RenderPasses::CreateClusteredLightSRB()
+{
+    m_pClusteredLightPSO->CreateShaderResourceBinding(&m_pClusteredLightSRB, true);
+    if (IShaderResourceVariable* pInputColor = m_pClusteredLightSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_SubpassInputColor"))
+        pInputColor->Set(m_GBuffer.pColorBuffer->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+    if (IShaderResourceVariable* pInputDepthZ = m_pClusteredLightSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_SubpassInputDepthZ"))
+        pInputDepthZ->Set(m_GBuffer.pDepthZBuffer->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+    m_pClusteredLightSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ClusteredLights")->Set(m_pClusteredLightsBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pClusteredLightSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ClusterLightRanges")->Set(m_pClusterLightRangesBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pClusteredLightSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_ClusterLightIndices")->Set(m_pClusterLightIndicesBuffer->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+}
+
 void Tutorial19_RenderPasses::DrawScene()
 {
     // Bind vertex and index buffers
@@ -741,10 +905,33 @@ void Tutorial19_RenderPasses::ApplyLighting()
         m_pImmediateContext->Draw(DrawAttrs);
     }
 
+    if (m_LightingMode == LIGHTING_MODE_CLUSTERED)
     {
-        // Map the cube's constant buffer and fill it in with its view-projection matrix
+        // All lights are applied by a single full-screen pass
+        m_pImmediateContext->SetPipelineState(m_pClusteredLightPSO);
+        m_pImmediateContext->CommitShaderResources(m_pClusteredLightSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+
+        DrawAttribs DrawAttrs;
+        DrawAttrs.NumVertices = 4;
+        DrawAttrs.Flags       = DRAW_FLAG_VERIFY_ALL;
+        m_pImmediateContext->Draw(DrawAttrs);
+        return;
+    }
+
+    {
+        Timer CpuTimer;
+
+        // Map the lights buffer and write light attributes from the SoA storage
         MapHelper<LightAttribs> LightsData(m_pImmediateContext, m_pLightsBuffer, MAP_WRITE, MAP_FLAG_DISCARD);
-        memcpy(LightsData, m_Lights.data(), m_Lights.size() * sizeof(m_Lights[0]));
+        LightAttribs*           pLights = LightsData;
+        for (Uint32 i = 0; i < m_Lights.Count; ++i)
+        {
+            pLights[i].Location = float3{m_Lights.PosX[i], m_Lights.PosY[i], m_Lights.PosZ[i]};
+            pLights[i].Size     = m_Lights.Size[i];
+            pLights[i].Color    = float3{m_Lights.ColorR[i], m_Lights.ColorG[i], m_Lights.ColorB[i]};
+        }
+
+        m_LightsCpuTime += CpuTimer.GetElapsedTime();
     }
 
     // Bind vertex and index buffers
@@ -772,30 +959,55 @@ void Tutorial19_RenderPasses::ApplyLighting()
 
 void Tutorial19_RenderPasses::UpdateLights(float fElapsedTime)
 {
-    float3 VolumeMin{-static_cast<float>(GridDim), -static_cast<float>(GridDim), -static_cast<float>(GridDim)};
-    float3 VolumeMax{+static_cast<float>(GridDim), +static_cast<float>(GridDim), +static_cast<float>(GridDim)};
-    for (int light = 0; light < m_LightsCount; ++light)
-    {
-        LightAttribs& Light = m_Lights[light];
-        float3&       Dir   = m_LightMoveDirs[light];
-        Light.Location += Dir * fElapsedTime;
-        auto ClampCoordinate = [](float& Coord, float& Dir, float Min, float Max) //
+    MoveLights(m_Lights, fElapsedTime, -static_cast<float>(GridDim), +static_cast<float>(GridDim));
+}
+
+void Tutorial19_RenderPasses::UpdateClusteredLighting()
+{
+    m_LightGrid.Build(m_Lights, m_CameraViewMatrix, m_CameraProjMatrix, CameraZNear);
+
+    m_ClusteredLightsData.resize(size_t{m_Lights.Count} * 2);
+    for (Uint32 i = 0; i < m_Lights.Count; ++i)
+    {
+        m_ClusteredLightsData[i * 2 + 0] = float4{m_Lights.PosX[i], m_Lights.PosY[i], m_Lights.PosZ[i], m_Lights.Size[i]};
+        m_ClusteredLightsData[i * 2 + 1] = float4{m_Lights.ColorR[i], m_Lights.ColorG[i], m_Lights.ColorB[i], 0};
+    }
+
+    // Buffers grow when needed. The SRB is recreated when any buffer is replaced.
+    const auto PrepareBuffer = [this](RefCntAutoPtr<IBuffer>& pBuffer, const char* Name, Uint32 ElementSize, size_t NumElements, const void* pData) //
+    {
+        const Uint64 DataSize = Uint64{ElementSize} * NumElements;
+        if (!pBuffer || pBuffer->GetDesc().Size < DataSize)
         {
-            if (Coord < Min)
-            {
-                Coord += (Min - Coord) * 2.f;
-                Dir *= -1.f;
-            }
-            else if (Coord > Max)
-            {
-                Coord -= (Coord - Max) * 2.f;
-                Dir *= -1.f;
-            }
+            BufferDesc BuffDesc;
+            BuffDesc.Name              = Name;
+            BuffDesc.Usage             = USAGE_DEFAULT;
+            BuffDesc.BindFlags         = BIND_SHADER_RESOURCE;
+            BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+            BuffDesc.ElementByteStride = ElementSize;
+            BuffDesc.Size              = pBuffer ? std::max(DataSize, pBuffer->GetDesc().Size * 2) : DataSize;
+
+            pBuffer.Release();
+            m_pDevice->CreateBuffer(BuffDesc, nullptr, &pBuffer);
+            m_pClusteredLightSRB.Release();
+        }
+        m_pImmediateContext->UpdateBuffer(pBuffer, 0, DataSize, pData, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    };
+
+    const std::vector<uint2>&  LightRanges  = m_LightGrid.GetLightRanges();
+    const std::vector<Uint32>& LightIndices = m_LightGrid.GetLightIndices();
+    PrepareBuffer(m_pClusteredLightsBuffer, "Clustered lights buffer", sizeof(float4), m_ClusteredLightsData.size(), m_ClusteredLightsData.data());
+    PrepareBuffer(m_pClusterLightRangesBuffer, "Cluster light ranges buffer", sizeof(uint2), LightRanges.size(), LightRanges.data());
+    PrepareBuffer(m_pClusterLightIndicesBuffer, "Cluster light indices buffer", sizeof(Uint32), LightIndices.size(), LightIndices.data());
+
+    // No transitions are allowed within the render pass
+    StateTransitionDesc Barriers[] = //
+        {
+            {m_pClusteredLightsBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE},
+            {m_pClusterLightRangesBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE},
+            {m_pClusterLightIndicesBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE} //
         };
-        ClampCoordinate(Light.Location.x, Dir.x, VolumeMin.x, VolumeMax.x);
-        ClampCoordinate(Light.Location.y, Dir.y, VolumeMin.y, VolumeMax.y);
-        ClampCoordinate(Light.Location.z, Dir.z, VolumeMin.z, VolumeMax.z);
-    }
+    m_pImmediateContext->TransitionResourceStates(_countof(Barriers), Barriers);
 }
 
 void Tutorial19_RenderPasses::InitLights()
@@ -804,19 +1016,100 @@ void Tutorial19_RenderPasses::InitLights()
 
     FastRandReal<float> Rnd{0, 0, 1};
 
-    m_Lights.resize(m_LightsCount);
-    for (LightAttribs& Light : m_Lights)
+    m_Lights.Resize(static_cast<Uint32>(m_LightsCount));
+    for (Uint32 i = 0; i < m_Lights.Count; ++i)
+    {
+        m_Lights.PosX[i]   = (Rnd() - 0.5f) * 2.f * static_cast<float>(GridDim);
+        m_Lights.PosY[i]   = (Rnd() - 0.5f) * 2.f * static_cast<float>(GridDim);
+        m_Lights.PosZ[i]   = (Rnd() - 0.5f) * 2.f * static_cast<float>(GridDim);
+        m_Lights.Size[i]   = 0.25f + Rnd() * 0.25f;
+        m_Lights.ColorR[i] = Rnd();
+        m_Lights.ColorG[i] = Rnd();
+        m_Lights.ColorB[i] = Rnd();
+    }
+
+    for (Uint32 i = 0; i < m_Lights.Count; ++i)
     {
-        Light.Location = (float3{Rnd(), Rnd(), Rnd()} - float3{0.5f, 0.5f, 0.5f}) * 2.0 * static_cast<float>(GridDim);
-        Light.Size     = 0.25f + Rnd() * 0.25f;
-        Light.Color    = float3{Rnd(), Rnd(), Rnd()};
+        m_Lights.DirX[i] = Rnd() - 0.5f;
+        m_Lights.DirY[i] = Rnd() - 0.5f;
+        m_Lights.DirZ[i] = Rnd() - 0.5f;
+    }
+}
+
+void Tutorial19_RenderPasses::StartBenchmark()
+{
+    m_Benchmark.Results.clear();
+    m_Benchmark.Running           = true;
+    m_Benchmark.Step              = 0;
+    m_Benchmark.SavedLightsCount  = m_LightsCount;
+    m_Benchmark.SavedLightingMode = m_LightingMode;
+    m_Benchmark.Frame             = -1; // Apply the first step in UpdateBenchmark()
+}
+
+void Tutorial19_RenderPasses::UpdateBenchmark()
+{
+    Benchmark& B = m_Benchmark;
+
+    const size_t NumModes = m_pClusteredLightPSO ? LIGHTING_MODE_COUNT : 1;
+    const size_t NumSteps = _countof(BenchmarkLightCounts) * NumModes;
+
+    if (B.Frame >= 0)
+    {
+        // Collect CPU time of the previous frame
+        if (B.Frame > Benchmark::WarmupFrames)
+            B.CpuTime += m_LightsCpuTime;
+
+        if (B.Frame < Benchmark::WarmupFrames + Benchmark::MeasureFrames)
+        {
+            ++B.Frame;
+            return;
+        }
+
+        // The step is complete
+        const size_t Mode = B.Step % NumModes;
+        if (Mode == 0)
+        {
+            B.Results.emplace_back();
+            B.Results.back().LightsCount = m_LightsCount;
+        }
+        Benchmark::Result& Res = B.Results.back();
+
+        Res.CpuTime[Mode] = B.CpuTime / Benchmark::MeasureFrames;
+        Res.GpuTime[Mode] = B.NumGpuTimes > 0 ? B.GpuTime / B.NumGpuTimes : 0;
+        if (Mode + 1 == NumModes)
+        {
+            LOG_INFO_MESSAGE("Lights: ", Res.LightsCount,
+                             "; light volumes CPU: ", Res.CpuTime[LIGHTING_MODE_LIGHT_VOLUMES] * 1000.0, " ms, GPU: ", Res.GpuTime[LIGHTING_MODE_LIGHT_VOLUMES] * 1000.0,
+                             " ms; clustered CPU: ", Res.CpuTime[LIGHTING_MODE_CLUSTERED] * 1000.0, " ms, GPU: ", Res.GpuTime[LIGHTING_MODE_CLUSTERED] * 1000.0, " ms");
+        }
+
+        if (++B.Step == NumSteps)
+        {
+            // Restore original settings
+            B.Running      = false;
+            m_LightingMode = B.SavedLightingMode;
+            if (m_LightsCount != B.SavedLightsCount)
+            {
+                m_LightsCount = B.SavedLightsCount;
+                InitLights();
+                CreateLightsBuffer();
+            }
+            return;
+        }
     }
 
-    m_LightMoveDirs.resize(m_Lights.size());
-    for (float3& MoveDir : m_LightMoveDirs)
+    // Apply settings of the current step
+    m_LightingMode = static_cast<int>(B.Step % NumModes);
+    if (m_LightsCount != BenchmarkLightCounts[B.Step / NumModes])
     {
-        MoveDir = (float3{Rnd(), Rnd(), Rnd()} - float3{0.5f, 0.5f, 0.5f}) * 1.f;
+        m_LightsCount = BenchmarkLightCounts[B.Step / NumModes];
+        InitLights();
+        CreateLightsBuffer();
     }
+    B.Frame       = 0;
+    B.CpuTime     = 0;
+    B.GpuTime     = 0;
+    B.NumGpuTimes = 0;
 }
 
 // Render a frame
@@ -824,6 +1117,14 @@ void Tutorial19_RenderPasses::Render()
 {
     const SwapChainDesc& SCDesc = m_pSwapChain->GetDesc();
 
+    if (m_LightingMode == LIGHTING_MODE_CLUSTERED)
+    {
+        // Build the light grid and upload it before the render pass begins
+        Timer CpuTimer;
+        UpdateClusteredLighting();
+        m_LightsCpuTime += CpuTimer.GetElapsedTime();
+    }
+
     {
         // Update constant buffer
         MapHelper<HLSL::Constants> Constants(m_pImmediateContext, m_pShaderConstantsCB, MAP_WRITE, MAP_FLAG_DISCARD);
@@ -835,10 +1136,23 @@ void Tutorial19_RenderPasses::Render()
             1.f / static_cast<float>(SCDesc.Width),
             1.f / static_cast<float>(SCDesc.Height) //
         };
-        Constants->ShowLightVolumes = m_ShowLightVolumes ? 1 : 0;
+        Constants->ShowLightVolumes = (m_ShowLightVolumes && m_LightingMode != LIGHTING_MODE_CLUSTERED) ? 1 : 0;
+
+        Constants->ClusterGridSize = float4{
+            static_cast<float>(LightClusterGrid::DimX),
+            static_cast<float>(LightClusterGrid::DimY),
+            static_cast<float>(LightClusterGrid::DimZ),
+            0.f //
+        };
+        Constants->ClusterDepthRange = float4{m_LightGrid.GetDepthStart(), m_LightGrid.GetDepthScale(), 0.f, 0.f};
     }
 
     IFramebuffer* pFramebuffer = GetCurrentFramebuffer();
+    if (m_LightingMode == LIGHTING_MODE_CLUSTERED && !m_pClusteredLightSRB)
+        CreateClusteredLightSRB();
+
+    if (m_pRenderPassDuration)
+        m_pRenderPassDuration->Begin(m_pImmediateContext);
 
     BeginRenderPassAttribs RPBeginInfo;
     RPBeginInfo.pRenderPass  = m_pRenderPass;
@@ -884,6 +1198,17 @@ void Tutorial19_RenderPasses::Render()
 
     m_pImmediateContext->EndRenderPass();
 
+    if (m_pRenderPassDuration)
+    {
+        // Query results are available a few frames later
+        if (m_pRenderPassDuration->End(m_pImmediateContext, m_RenderPassGpuTime) &&
+            m_Benchmark.Running && m_Benchmark.Frame > Benchmark::WarmupFrames)
+        {
+            m_Benchmark.GpuTime += m_RenderPassGpuTime;
+            ++m_Benchmark.NumGpuTimes;
+        }
+    }
+
     if (m_pDevice->GetDeviceInfo().IsGLDevice())
     {
         // In OpenGL we now have to copy our off-screen buffer to the default framebuffer
@@ -900,8 +1225,16 @@ void Tutorial19_RenderPasses::Update(double CurrTime, double ElapsedTime, bool D
 {
     SampleBase::Update(CurrTime, ElapsedTime, DoUpdateUI);
 
+    if (m_Benchmark.Running)
+        UpdateBenchmark();
+
+    m_LightsCpuTime = 0;
     if (m_AnimateLights)
+    {
+        Timer CpuTimer;
         UpdateLights(static_cast<float>(ElapsedTime));
+        m_LightsCpuTime += CpuTimer.GetElapsedTime();
+    }
 
     float4x4 View = float4x4::Translation(0.0f, 0.0f, 25.0f);
 
@@ -909,10 +1242,12 @@ void Tutorial19_RenderPasses::Update(double CurrTime, double ElapsedTime, bool D
     float4x4 SrfPreTransform = GetSurfacePretransformMatrix(float3{0, 0, 1});
 
     // Get projection matrix adjusted to the current screen orientation
-    float4x4 Proj = GetAdjustedProjectionMatrix(PI_F / 4.0f, 0.1f, 100.f);
+    float4x4 Proj = GetAdjustedProjectionMatrix(PI_F / 4.0f, CameraZNear, CameraZFar);
 
     // Compute world-view-projection matrix
-    m_CameraViewProjMatrix    = View * SrfPreTransform * Proj;
+    m_CameraViewMatrix        = View * SrfPreTransform;
+    m_CameraProjMatrix        = Proj;
+    m_CameraViewProjMatrix    = m_CameraViewMatrix * Proj;
     m_CameraViewProjInvMatrix = m_CameraViewProjMatrix.Inverse();
 }
 
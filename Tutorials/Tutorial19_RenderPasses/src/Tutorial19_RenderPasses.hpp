@@ -27,11 +27,14 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
+#include "DurationQueryHelper.hpp"
+#include "LightGrid.hpp"
 
 namespace Diligent
 {
@@ -58,13 +61,18 @@ private:
     void CreateCubePSO(IShaderSourceInputStreamFactory* pShaderSourceFactory);
     void CreateLightVolumePSO(IShaderSourceInputStreamFactory* pShaderSourceFactory);
     void CreateAmbientLightPSO(IShaderSourceInputStreamFactory* pShaderSourceFactory);
+    void CreateClusteredLightPSO(IShaderSourceInputStreamFactory* pShaderSourceFactory);
+    void CreateClusteredLightSRB();
     void CreateRenderPass();
     void DrawScene();
     void ApplyLighting();
     void CreateLightsBuffer();
     void UpdateLights(float fElapsedTime);
+    void UpdateClusteredLighting();
     void InitLights();
     void ReleaseWindowResources();
+    void StartBenchmark();
+    void UpdateBenchmark();
 
     RefCntAutoPtr<IFramebuffer> CreateFramebuffer(ITextureView* pDstRenderTarget);
     IFramebuffer*               GetCurrentFramebuffer();
@@ -72,6 +80,20 @@ private:
     // Use 16-bit format to make sure it works on mobile devices
     static constexpr TEXTURE_FORMAT DepthBufferFormat = TEX_FORMAT_D16_UNORM;
 
+    static constexpr float CameraZNear = 0.1f;
+    static constexpr float CameraZFar  = 100.f;
+
+    enum LIGHTING_MODE : int
+    {
+        // Draw one light volume per light
+        LIGHTING_MODE_LIGHT_VOLUMES = 0,
+
+        // Single full-screen pass that reads lights from the CPU-built cluster grid
+        LIGHTING_MODE_CLUSTERED,
+
+        LIGHTING_MODE_COUNT
+    };
+
     struct LightAttribs
     {
         float3 Location;
@@ -94,6 +116,15 @@ private:
     RefCntAutoPtr<IPipelineState>         m_pAmbientLightPSO;
     RefCntAutoPtr<IShaderResourceBinding> m_pAmbientLightSRB;
 
+    // Clustered lighting resources
+    RefCntAutoPtr<IPipelineState>         m_pClusteredLightPSO;
+    RefCntAutoPtr<IShaderResourceBinding> m_pClusteredLightSRB;
+    RefCntAutoPtr<IBuffer>                m_pClusteredLightsBuffer;
+    RefCntAutoPtr<IBuffer>                m_pClusterLightRangesBuffer;
+    RefCntAutoPtr<IBuffer>                m_pClusterLightIndicesBuffer;
+    LightClusterGrid                      m_LightGrid;
+    std::vector<float4>                   m_ClusteredLightsData;
+
     struct GBuffer
     {
         RefCntAutoPtr<ITexture> pColorBuffer;
@@ -105,19 +136,53 @@ private:
 
     RefCntAutoPtr<IRenderPass> m_pRenderPass;
 
+    float4x4 m_CameraViewMatrix; // Includes surface pretransform
+    float4x4 m_CameraProjMatrix;
     float4x4 m_CameraViewProjMatrix;
     float4x4 m_CameraViewProjInvMatrix;
 
     int  m_LightsCount      = 10000;
+    int  m_LightingMode     = LIGHTING_MODE_LIGHT_VOLUMES;
     bool m_ShowLightVolumes = false;
     bool m_AnimateLights    = true;
 
+    // CPU time spent on animating lights and preparing lighting data in the last frame
+    double m_LightsCpuTime = 0;
+    // GPU time of the render pass
+    std::unique_ptr<DurationQueryHelper> m_pRenderPassDuration;
+    double                               m_RenderPassGpuTime = 0;
+
+    // Sweeps the light count and measures CPU and GPU time of every lighting mode
+    struct Benchmark
+    {
+        static constexpr int WarmupFrames  = 16;
+        static constexpr int MeasureFrames = 64;
+
+        struct Result
+        {
+            int    LightsCount                  = 0;
+            double CpuTime[LIGHTING_MODE_COUNT] = {};
+            double GpuTime[LIGHTING_MODE_COUNT] = {};
+        };
+        std::vector<Result> Results;
+
+        bool   Running     = false;
+        size_t Step        = 0; // Index of the light count and lighting mode combination
+        int    Frame       = 0;
+        double CpuTime     = 0;
+        double GpuTime     = 0;
+        int    NumGpuTimes = 0;
+
+        int SavedLightsCount  = 0;
+        int SavedLightingMode = 0;
+    };
+    Benchmark m_Benchmark;
+
     constexpr static int GridDim = 7;
 
     std::unordered_map<ITextureView*, RefCntAutoPtr<IFramebuffer>> m_FramebufferCache;
 
-    std::vector<LightAttribs> m_Lights;
-    std::vector<float3>       m_LightMoveDirs;
+    LightSoA m_Lights;
 };
 
 } // namespace Diligent
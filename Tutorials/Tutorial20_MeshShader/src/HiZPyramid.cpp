@@ -0,0 +1,164 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "HiZPyramid.hpp"
+
+#include <algorithm>
+
+#include "DebugUtilities.hpp"
+#include "GraphicsAccessories.hpp"
+#include "ShaderMacroHelper.hpp"
+
+namespace Diligent
+{
+
+HiZPyramid::HiZPyramid(IRenderDevice* pDevice, IShaderSourceInputStreamFactory* pShaderSourceFactory) :
+    m_pDevice{pDevice}
+{
+    ShaderCreateInfo ShaderCI;
+    ShaderCI.SourceLanguage             = SHADER_SOURCE_LANGUAGE_HLSL;
+    ShaderCI.ShaderCompiler             = SHADER_COMPILER_DXC;
+    ShaderCI.pShaderSourceStreamFactory = pShaderSourceFactory;
+    ShaderCI.Desc.ShaderType            = SHADER_TYPE_COMPUTE;
+    ShaderCI.Desc.Name                  = "Depth pyramid - CS";
+    ShaderCI.EntryPoint                 = "main";
+    ShaderCI.FilePath                   = "depth_pyramid.csh";
+
+    ShaderMacroHelper Macros;
+    Macros.AddShaderMacro("THREAD_GROUP_SIZE", ThreadGroupSize);
+    ShaderCI.Macros = Macros;
+
+    RefCntAutoPtr<IShader> pCS;
+    m_pDevice->CreateShader(ShaderCI, &pCS);
+    VERIFY_EXPR(pCS != nullptr);
+
+    ComputePipelineStateCreateInfo PSOCreateInfo;
+    PSOCreateInfo.PSODesc.Name                               = "Depth pyramid";
+    PSOCreateInfo.PSODesc.PipelineType                       = PIPELINE_TYPE_COMPUTE;
+    PSOCreateInfo.PSODesc.ResourceLayout.DefaultVariableType = SHADER_RESOURCE_VARIABLE_TYPE_MUTABLE;
+    PSOCreateInfo.pCS                                        = pCS;
+
+    m_pDevice->CreateComputePipelineState(PSOCreateInfo, &m_pPSO);
+    VERIFY_EXPR(m_pPSO != nullptr);
+}
+
+void HiZPyramid::SetDepthBuffer(ITexture* pDepthBuffer)
+{
+    m_Levels.clear();
+    m_pPyramidSRV.Release();
+    m_pPyramid.Release();
+    m_pDepthBuffer = pDepthBuffer;
+
+    const TextureDesc& DepthDesc = pDepthBuffer->GetDesc();
+
+    TextureDesc PyramidDesc;
+    PyramidDesc.Name      = "Depth pyramid";
+    PyramidDesc.Type      = RESOURCE_DIM_TEX_2D;
+    PyramidDesc.Width     = std::max(DepthDesc.Width / 2u, 1u);
+    PyramidDesc.Height    = std::max(DepthDesc.Height / 2u, 1u);
+    PyramidDesc.MipLevels = ComputeMipLevelsCount(PyramidDesc.Width, PyramidDesc.Height);
+    PyramidDesc.Format    = TEX_FORMAT_R32_FLOAT;
+    PyramidDesc.BindFlags = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
+
+    m_pDevice->CreateTexture(PyramidDesc, nullptr, &m_pPyramid);
+    VERIFY_EXPR(m_pPyramid != nullptr);
+    m_pPyramidSRV = m_pPyramid->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
+
+    m_Levels.resize(PyramidDesc.MipLevels);
+    for (Uint32 Mip = 0; Mip < PyramidDesc.MipLevels; ++Mip)
+    {
+        Level& Lvl = m_Levels[Mip];
+        Lvl.Width  = std::max(PyramidDesc.Width >> Mip, 1u);
+        Lvl.Height = std::max(PyramidDesc.Height >> Mip, 1u);
+
+        TextureViewDesc ViewDesc;
+        ViewDesc.TextureDim      = RESOURCE_DIM_TEX_2D;
+        ViewDesc.MostDetailedMip = Mip;
+        ViewDesc.NumMipLevels    = 1;
+
+        ViewDesc.ViewType    = TEXTURE_VIEW_UNORDERED_ACCESS;
+        ViewDesc.AccessFlags = UAV_ACCESS_FLAG_WRITE;
+        RefCntAutoPtr<ITextureView> pDstUAV;
+        m_pPyramid->CreateView(ViewDesc, &pDstUAV);
+        VERIFY_EXPR(pDstUAV != nullptr);
+
+        RefCntAutoPtr<ITextureView> pSrcSRV;
+        if (Mip == 0)
+        {
+            pSrcSRV = pDepthBuffer->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE);
+        }
+        else
+        {
+            ViewDesc.ViewType        = TEXTURE_VIEW_SHADER_RESOURCE;
+            ViewDesc.AccessFlags     = UAV_ACCESS_FLAG_UNSPECIFIED;
+            ViewDesc.MostDetailedMip = Mip - 1;
+            m_pPyramid->CreateView(ViewDesc, &pSrcSRV);
+        }
+        VERIFY_EXPR(pSrcSRV != nullptr);
+
+        m_pPSO->CreateShaderResourceBinding(&Lvl.pSRB, true);
+        Lvl.pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_SrcDepth")->Set(pSrcSRV);
+        Lvl.pSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_DstDepth")->Set(pDstUAV);
+    }
+}
+
+void HiZPyramid::Build(IDeviceContext* pCtx)
+{
+    VERIFY(!m_Levels.empty(), "Depth buffer is not set");
+
+    // Every level is written after the previous one has been read, so the states of the individual levels
+    // are transitioned explicitly, and the resources are committed without transitions.
+    const StateTransitionDesc Barriers[] = {
+        {m_pDepthBuffer, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_SHADER_RESOURCE, STATE_TRANSITION_FLAG_UPDATE_STATE},
+        {m_pPyramid, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS, STATE_TRANSITION_FLAG_UPDATE_STATE} //
+    };
+    pCtx->TransitionResourceStates(_countof(Barriers), Barriers);
+
+    pCtx->SetPipelineState(m_pPSO);
+    for (Uint32 Mip = 0; Mip < GetNumLevels(); ++Mip)
+    {
+        const Level& Lvl = m_Levels[Mip];
+        if (Mip > 0)
+        {
+            const StateTransitionDesc Barrier{m_pPyramid, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE, Mip - 1, 1};
+            pCtx->TransitionResourceStates(1, &Barrier);
+        }
+        pCtx->CommitShaderResources(Lvl.pSRB, RESOURCE_STATE_TRANSITION_MODE_NONE);
+
+        DispatchComputeAttribs DispatchAttribs;
+        DispatchAttribs.ThreadGroupCountX = (Lvl.Width + ThreadGroupSize - 1) / ThreadGroupSize;
+        DispatchAttribs.ThreadGroupCountY = (Lvl.Height + ThreadGroupSize - 1) / ThreadGroupSize;
+        pCtx->DispatchCompute(DispatchAttribs);
+    }
+
+    const StateTransitionDesc Barrier{m_pPyramid, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE, GetNumLevels() - 1, 1};
+    pCtx->TransitionResourceStates(1, &Barrier);
+    // All levels are now in the shader resource state
+    m_pPyramid->SetState(RESOURCE_STATE_SHADER_RESOURCE);
+}
+
+} // namespace Diligent
@@ -0,0 +1,89 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "RenderDevice.h"
+#include "DeviceContext.h"
+#include "RefCntAutoPtr.hpp"
+
+namespace Diligent
+{
+
+// Hierarchical depth buffer (Hi-Z) that the amplification shader uses to cull occluded objects.
+//
+// Every texel of level L holds the farthest depth of the 2^(L+1) x 2^(L+1) block of depth buffer pixels
+// it covers. Level sizes are halved and rounded down like regular mip levels, so the last texel in every
+// row and column of a level also covers the remaining odd pixels. Levels are built by a compute shader,
+// one dispatch per level, and the previous level is transitioned to the shader resource state before
+// the next one reads it.
+class HiZPyramid
+{
+public:
+    static constexpr Uint32 ThreadGroupSize = 8;
+
+    HiZPyramid(IRenderDevice* pDevice, IShaderSourceInputStreamFactory* pShaderSourceFactory);
+
+    // clang-format off
+    HiZPyramid           (const HiZPyramid&) = delete;
+    HiZPyramid& operator=(const HiZPyramid&) = delete;
+    // clang-format on
+
+    // Creates the pyramid for the depth buffer, which must have been created with the BIND_SHADER_RESOURCE flag
+    void SetDepthBuffer(ITexture* pDepthBuffer);
+
+    // Builds all levels from the current contents of the depth buffer. Leaves the depth buffer
+    // and all levels of the pyramid in the RESOURCE_STATE_SHADER_RESOURCE state.
+    void Build(IDeviceContext* pCtx);
+
+    // Shader resource view of all levels of the pyramid
+    ITextureView* GetSRV() const { return m_pPyramidSRV; }
+
+    Uint32 GetNumLevels() const { return static_cast<Uint32>(m_Levels.size()); }
+
+private:
+    RefCntAutoPtr<IRenderDevice>  m_pDevice;
+    RefCntAutoPtr<IPipelineState> m_pPSO;
+
+    RefCntAutoPtr<ITexture>     m_pDepthBuffer;
+    RefCntAutoPtr<ITexture>     m_pPyramid;
+    RefCntAutoPtr<ITextureView> m_pPyramidSRV;
+
+    struct Level
+    {
+        Uint32 Width  = 0;
+        Uint32 Height = 0;
+
+        // Reads the depth buffer or the previous level and writes this level
+        RefCntAutoPtr<IShaderResourceBinding> pSRB;
+    };
+    std::vector<Level> m_Levels;
+};
+
+} // namespace Diligent
@@ -0,0 +1,636 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "MeshletBuilder.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+#include "DebugUtilities.hpp"
+#include "FileWrapper.hpp"
+#include "DataBlobImpl.hpp"
+#include "GraphicsAccessories.hpp"
+#include "ParallelFrameRecorder.hpp"
+
+namespace Diligent
+{
+
+namespace
+{
+
+constexpr Uint8 InvalidLocalIndex = 0xFF;
+
+// Normals of the meshlet triangles that are spread wider than this can't be culled as a cone
+constexpr float MinConeNormalDot = 0.1f;
+
+// Score of a candidate triangle per unassigned triangle that shares its vertices
+constexpr float LiveTriangleWeight = 0.02f;
+
+constexpr char   MeshletCacheMagic[4] = {'D', 'G', 'M', 'L'};
+constexpr Uint32 MeshletCacheVersion  = 1;
+
+// Grows the sphere from the two most distant of the points found by two farthest-point searches
+template <typename GetPointType>
+void ComputeBoundingSphere(Uint32 NumPoints, GetPointType GetPoint, float3& Center, float& Radius)
+{
+    Center = float3{};
+    Radius = 0;
+    if (NumPoints == 0)
+        return;
+
+    auto FindFarthest = [&](const float3& From) {
+        float3 Farthest = GetPoint(0);
+        float  MaxDist2 = -1;
+        for (Uint32 i = 0; i < NumPoints; ++i)
+        {
+            const float3 Point = GetPoint(i);
+            const float  Dist2 = dot(Point - From, Point - From);
+            if (Dist2 > MaxDist2)
+            {
+                MaxDist2 = Dist2;
+                Farthest = Point;
+            }
+        }
+        return Farthest;
+    };
+    const float3 A = FindFarthest(GetPoint(0));
+    const float3 B = FindFarthest(A);
+
+    Center = (A + B) * 0.5f;
+    Radius = length(B - A) * 0.5f;
+    for (Uint32 i = 0; i < NumPoints; ++i)
+    {
+        const float3 Point = GetPoint(i);
+        const float  Dist  = length(Point - Center);
+        if (Dist > Radius)
+        {
+            const float NewRadius = (Radius + Dist) * 0.5f;
+            Center += (Point - Center) * ((NewRadius - Radius) / Dist);
+            Radius = NewRadius;
+        }
+    }
+}
+
+// 64-bit FNV-1a hash
+void HashBytes(Uint64& Hash, const void* pData, size_t Size)
+{
+    const Uint8* pBytes = static_cast<const Uint8*>(pData);
+    for (size_t i = 0; i < Size; ++i)
+    {
+        Hash ^= pBytes[i];
+        Hash *= 0x100000001B3ull;
+    }
+}
+
+template <typename T>
+void HashValue(Uint64& Hash, const T& Value)
+{
+    HashBytes(Hash, &Value, sizeof(Value));
+}
+
+template <typename T>
+void WriteValue(std::vector<Uint8>& Data, const T& Value)
+{
+    const size_t Offset = Data.size();
+    Data.resize(Offset + sizeof(Value));
+    std::memcpy(&Data[Offset], &Value, sizeof(Value));
+}
+
+template <typename T>
+void WriteArray(std::vector<Uint8>& Data, const std::vector<T>& Values)
+{
+    const size_t Offset = Data.size();
+    Data.resize(Offset + sizeof(T) * Values.size());
+    if (!Values.empty())
+        std::memcpy(&Data[Offset], Values.data(), sizeof(T) * Values.size());
+}
+
+class CacheReader
+{
+public:
+    CacheReader(const Uint8* pData, size_t Size) :
+        m_pCurr{pData},
+        m_pEnd{pData + Size}
+    {}
+
+    template <typename T>
+    bool Read(T& Value)
+    {
+        if (static_cast<size_t>(m_pEnd - m_pCurr) < sizeof(Value))
+            return false;
+        std::memcpy(&Value, m_pCurr, sizeof(Value));
+        m_pCurr += sizeof(Value);
+        return true;
+    }
+
+    template <typename T>
+    bool ReadArray(std::vector<T>& Values, size_t Count)
+    {
+        if (static_cast<size_t>(m_pEnd - m_pCurr) / sizeof(T) < Count)
+            return false;
+        Values.resize(Count);
+        if (Count > 0)
+            std::memcpy(Values.data(), m_pCurr, sizeof(T) * Count);
+        m_pCurr += sizeof(T) * Count;
+        return true;
+    }
+
+    bool IsEnd() const { return m_pCurr == m_pEnd; }
+
+private:
+    const Uint8*       m_pCurr;
+    const Uint8* const m_pEnd;
+};
+
+// Checks that all meshlets reference valid ranges, so that the shaders never read outside of the buffers
+bool ValidateMeshletMesh(const MeshletMesh& Mesh, const MeshletSourceMesh& SourceMesh)
+{
+    for (Uint32 v : Mesh.Vertices)
+    {
+        if (v >= SourceMesh.NumVertices)
+            return false;
+    }
+
+    const Uint32 NumTriangles = Mesh.GetNumTriangles();
+    for (const MeshletData& Meshlet : Mesh.Meshlets)
+    {
+        if (Meshlet.FirstVertex > Mesh.Vertices.size() || Meshlet.NumVertices > Mesh.Vertices.size() - Meshlet.FirstVertex ||
+            Meshlet.FirstTriangle > NumTriangles || Meshlet.NumTriangles > NumTriangles - Meshlet.FirstTriangle)
+            return false;
+
+        const Uint8* pIndices = &Mesh.Triangles[size_t{Meshlet.FirstTriangle} * 3];
+        for (size_t i = 0; i < size_t{Meshlet.NumTriangles} * 3; ++i)
+        {
+            if (pIndices[i] >= Meshlet.NumVertices)
+                return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+MeshletBuilder::MeshletBuilder(const Settings& BuilderSettings) :
+    m_Settings{BuilderSettings}
+{
+    VERIFY(m_Settings.MaxVertices >= 3 && m_Settings.MaxVertices < InvalidLocalIndex, "Meshlets must have between 3 and 254 vertices");
+    VERIFY(m_Settings.MaxTriangles >= 1, "Meshlets must have at least one triangle");
+}
+
+void MeshletBuilder::Build(const MeshletSourceMesh& Mesh, MeshletMesh& Result)
+{
+    const Uint32  NumVertices  = Mesh.NumVertices;
+    const Uint32  NumTriangles = Mesh.NumIndices / 3;
+    const Uint32* pIndices     = Mesh.pIndices;
+    const float3* pPositions   = Mesh.pPositions;
+
+    Result.Meshlets.clear();
+    Result.Vertices.clear();
+    Result.Triangles.clear();
+
+    // Triangles with indices out of range or with repeated indices are skipped
+    m_TriangleAssigned.assign(NumTriangles, 0);
+    Uint32 NumSkippedTriangles = 0;
+    for (Uint32 t = 0; t < NumTriangles; ++t)
+    {
+        const Uint32* Tri = &pIndices[t * 3];
+        if (Tri[0] >= NumVertices || Tri[1] >= NumVertices || Tri[2] >= NumVertices ||
+            Tri[0] == Tri[1] || Tri[1] == Tri[2] || Tri[0] == Tri[2])
+        {
+            m_TriangleAssigned[t] = 1;
+            ++NumSkippedTriangles;
+        }
+    }
+    if (NumSkippedTriangles > 0)
+        LOG_WARNING_MESSAGE(NumSkippedTriangles, " invalid or degenerate triangles of the mesh were skipped");
+
+    // Build vertex to triangle adjacency. m_NumLiveTriangles is used as the insertion counter.
+    m_AdjacencyOffsets.assign(size_t{NumVertices} + 1, 0);
+    m_NumLiveTriangles.assign(NumVertices, 0);
+    for (Uint32 t = 0; t < NumTriangles; ++t)
+    {
+        if (m_TriangleAssigned[t])
+            continue;
+        for (Uint32 k = 0; k < 3; ++k)
+            ++m_AdjacencyOffsets[pIndices[t * 3 + k] + 1];
+    }
+    for (Uint32 v = 0; v < NumVertices; ++v)
+        m_AdjacencyOffsets[v + 1] += m_AdjacencyOffsets[v];
+
+    m_AdjacentTriangles.resize(m_AdjacencyOffsets[NumVertices]);
+    m_TriangleNormals.resize(NumTriangles);
+    for (Uint32 t = 0; t < NumTriangles; ++t)
+    {
+        if (m_TriangleAssigned[t])
+            continue;
+
+        const Uint32* Tri = &pIndices[t * 3];
+        for (Uint32 k = 0; k < 3; ++k)
+            m_AdjacentTriangles[m_AdjacencyOffsets[Tri[k]] + m_NumLiveTriangles[Tri[k]]++] = t;
+
+        // Zero-area triangles get zero normals that don't affect the normal cone
+        const float3 Normal = cross(pPositions[Tri[1]] - pPositions[Tri[0]], pPositions[Tri[2]] - pPositions[Tri[0]]);
+        const float  Len    = length(Normal);
+        m_TriangleNormals[t] = Len > FLT_MIN ? Normal / Len : float3{};
+    }
+
+    m_LocalIndex.assign(NumVertices, InvalidLocalIndex);
+    m_CandidateStamp.assign(NumTriangles, ~0u);
+    m_Candidates.clear();
+    m_MeshletTriangles.clear();
+
+    MeshletData Meshlet;
+    float3      NormalSum;
+    Uint32      BorderSeed = ~0u;
+
+    auto GetNumLiveTriangles = [&](Uint32 t) {
+        return m_NumLiveTriangles[pIndices[t * 3]] + m_NumLiveTriangles[pIndices[t * 3 + 1]] + m_NumLiveTriangles[pIndices[t * 3 + 2]];
+    };
+
+    auto AddTriangle = [&](Uint32 t) {
+        const Uint32 MeshletIdx = static_cast<Uint32>(Result.Meshlets.size());
+
+        m_TriangleAssigned[t] = 1;
+        for (Uint32 k = 0; k < 3; ++k)
+        {
+            const Uint32 v = pIndices[t * 3 + k];
+            if (m_LocalIndex[v] == InvalidLocalIndex)
+            {
+                m_LocalIndex[v] = static_cast<Uint8>(Meshlet.NumVertices++);
+                Result.Vertices.push_back(v);
+
+                // Triangles that share the new vertex become candidates for the meshlet
+                for (Uint32 a = m_AdjacencyOffsets[v]; a < m_AdjacencyOffsets[v + 1]; ++a)
+                {
+                    const Uint32 AdjTri = m_AdjacentTriangles[a];
+                    if (!m_TriangleAssigned[AdjTri] && m_CandidateStamp[AdjTri] != MeshletIdx)
+                    {
+                        m_CandidateStamp[AdjTri] = MeshletIdx;
+                        m_Candidates.push_back(AdjTri);
+                    }
+                }
+            }
+            Result.Triangles.push_back(m_LocalIndex[v]);
+            --m_NumLiveTriangles[v];
+        }
+        ++Meshlet.NumTriangles;
+        NormalSum += m_TriangleNormals[t];
+        m_MeshletTriangles.push_back(t);
+    };
+
+    auto FinishMeshlet = [&]() {
+        ComputeBounds(Mesh, Result, Meshlet);
+        Result.Meshlets.push_back(Meshlet);
+
+        for (Uint32 i = 0; i < Meshlet.NumVertices; ++i)
+            m_LocalIndex[Result.Vertices[Meshlet.FirstVertex + i]] = InvalidLocalIndex;
+
+        Meshlet               = {};
+        Meshlet.FirstVertex   = static_cast<Uint32>(Result.Vertices.size());
+        Meshlet.FirstTriangle = Result.GetNumTriangles();
+        NormalSum             = float3{};
+
+        // The next meshlet starts from the border triangle that is surrounded by the most assigned triangles
+        BorderSeed              = ~0u;
+        Uint32 MinLiveTriangles = ~0u;
+        for (Uint32 t : m_Candidates)
+        {
+            const Uint32 NumLive = GetNumLiveTriangles(t);
+            if (!m_TriangleAssigned[t] && NumLive < MinLiveTriangles)
+            {
+                MinLiveTriangles = NumLive;
+                BorderSeed       = t;
+            }
+        }
+        m_Candidates.clear();
+        m_MeshletTriangles.clear();
+    };
+
+    auto CountNewVertices = [&](Uint32 t) {
+        Uint32 NumNewVertices = 0;
+        for (Uint32 k = 0; k < 3; ++k)
+            NumNewVertices += m_LocalIndex[pIndices[t * 3 + k]] == InvalidLocalIndex ? 1 : 0;
+        return NumNewVertices;
+    };
+
+    Uint32 NextSeed = 0;
+    for (;;)
+    {
+        Uint32 BestTri = ~0u;
+        if (Meshlet.NumTriangles > 0)
+        {
+            const float  NormalLen = length(NormalSum);
+            const float3 Axis      = NormalLen > FLT_MIN ? NormalSum / NormalLen : float3{};
+
+            float BestScore = FLT_MAX;
+            for (size_t i = 0; i < m_Candidates.size();)
+            {
+                const Uint32 t = m_Candidates[i];
+                if (m_TriangleAssigned[t])
+                {
+                    m_Candidates[i] = m_Candidates.back();
+                    m_Candidates.pop_back();
+                    continue;
+                }
+                ++i;
+
+                const Uint32 NumNewVertices = CountNewVertices(t);
+                if (Meshlet.NumVertices + NumNewVertices > m_Settings.MaxVertices)
+                    continue;
+
+                const float Score =
+                    static_cast<float>(NumNewVertices) +
+                    m_Settings.ConeWeight * (1.f - dot(m_TriangleNormals[t], Axis)) +
+                    LiveTriangleWeight * static_cast<float>(GetNumLiveTriangles(t));
+                if (Score < BestScore)
+                {
+                    BestScore = Score;
+                    BestTri   = t;
+                }
+            }
+        }
+
+        if (BestTri == ~0u && Meshlet.NumTriangles == 0 && BorderSeed != ~0u)
+        {
+            BestTri    = BorderSeed;
+            BorderSeed = ~0u;
+        }
+        else if (BestTri == ~0u)
+        {
+            while (NextSeed < NumTriangles && m_TriangleAssigned[NextSeed])
+                ++NextSeed;
+            if (NextSeed == NumTriangles)
+                break;
+
+            if (Meshlet.NumVertices + CountNewVertices(NextSeed) > m_Settings.MaxVertices)
+            {
+                FinishMeshlet();
+                continue;
+            }
+            BestTri = NextSeed;
+        }
+
+        AddTriangle(BestTri);
+        if (Meshlet.NumTriangles == m_Settings.MaxTriangles)
+            FinishMeshlet();
+    }
+    if (Meshlet.NumTriangles > 0)
+        FinishMeshlet();
+
+    ComputeBoundingSphere(
+        static_cast<Uint32>(Result.Vertices.size()),
+        [&](Uint32 i) { return pPositions[Result.Vertices[i]]; },
+        Result.Center, Result.Radius);
+}
+
+void MeshletBuilder::ComputeBounds(const MeshletSourceMesh& Mesh, const MeshletMesh& Result, MeshletData& Meshlet) const
+{
+    const Uint32* pMeshletVertices = &Result.Vertices[Meshlet.FirstVertex];
+    ComputeBoundingSphere(
+        Meshlet.NumVertices,
+        [&](Uint32 i) { return Mesh.pPositions[pMeshletVertices[i]]; },
+        Meshlet.Center, Meshlet.Radius);
+
+    Meshlet.ConeApex   = Meshlet.Center;
+    Meshlet.ConeAxis   = float3{0, 0, 1};
+    Meshlet.ConeCutoff = 2;
+
+    float3 Axis;
+    for (Uint32 t : m_MeshletTriangles)
+        Axis += m_TriangleNormals[t];
+    const float AxisLen = length(Axis);
+    if (AxisLen <= FLT_MIN)
+        return;
+    Axis /= AxisLen;
+
+    float MinDot = 1;
+    for (Uint32 t : m_MeshletTriangles)
+    {
+        const float3& Normal = m_TriangleNormals[t];
+        if (Normal != float3{})
+            MinDot = std::min(MinDot, dot(Normal, Axis));
+    }
+    if (MinDot <= MinConeNormalDot)
+        return;
+
+    // Move the apex back along the axis until it is behind the planes of all triangles,
+    // so that the cone test is conservative for cameras close to the meshlet.
+    float MaxOffset = 0;
+    for (Uint32 t : m_MeshletTriangles)
+    {
+        const float3& Normal = m_TriangleNormals[t];
+        if (Normal == float3{})
+            continue;
+        const float3& P0 = Mesh.pPositions[Mesh.pIndices[t * 3]];
+        MaxOffset        = std::max(MaxOffset, dot(Meshlet.Center - P0, Normal) / dot(Axis, Normal));
+    }
+
+    Meshlet.ConeApex   = Meshlet.Center - Axis * MaxOffset;
+    Meshlet.ConeAxis   = Axis;
+    Meshlet.ConeCutoff = std::sqrt(1.f - MinDot * MinDot);
+}
+
+void BuildMeshletsParallel(const std::vector<MeshletSourceMesh>& Meshes,
+                           const MeshletBuilder::Settings&       BuilderSettings,
+                           ParallelTaskPool&                     Workers,
+                           std::vector<MeshletMesh>&             Result)
+{
+    Result.resize(Meshes.size());
+
+    // Large meshes are built first so that the small ones fill the gaps at the end
+    std::vector<Uint32> Order(Meshes.size());
+    std::iota(Order.begin(), Order.end(), 0u);
+    std::stable_sort(Order.begin(), Order.end(), [&Meshes](Uint32 a, Uint32 b) { return Meshes[a].NumIndices > Meshes[b].NumIndices; });
+
+    std::vector<MeshletBuilder> Builders;
+    Builders.reserve(Workers.GetNumSubsets());
+    for (Uint32 i = 0; i < Workers.GetNumSubsets(); ++i)
+        Builders.emplace_back(BuilderSettings);
+
+    Workers.SetWorkItems(static_cast<Uint32>(Meshes.size()), 1);
+    Workers.ParallelFor([&](Uint32 Subset) {
+        Uint32 Start = 0, End = 0;
+        while (Workers.NextChunk(Subset, Start, End))
+        {
+            for (Uint32 i = Start; i < End; ++i)
+                Builders[Subset].Build(Meshes[Order[i]], Result[Order[i]]);
+        }
+    });
+}
+
+ConeCullingRate ComputeConeCullingRate(const MeshletMesh& Mesh, Uint32 NumViews, float DistanceScale)
+{
+    ConeCullingRate Rate;
+    if (Mesh.Meshlets.empty() || NumViews == 0)
+        return Rate;
+
+    Uint64 NumCulledMeshlets  = 0;
+    Uint64 NumCulledTriangles = 0;
+    for (Uint32 v = 0; v < NumViews; ++v)
+    {
+        // Fibonacci sphere
+        const float  y     = 1.f - 2.f * (static_cast<float>(v) + 0.5f) / static_cast<float>(NumViews);
+        const float  r     = std::sqrt(std::max(1.f - y * y, 0.f));
+        const float  Phi   = static_cast<float>(v) * PI_F * (3.f - std::sqrt(5.f));
+        const float3 Dir   = float3{std::cos(Phi) * r, y, std::sin(Phi) * r};
+        const float3 Eye   = Mesh.Center + Dir * (Mesh.Radius * DistanceScale);
+        for (const MeshletData& Meshlet : Mesh.Meshlets)
+        {
+            const float3 ViewDir = Meshlet.ConeApex - Eye;
+            const float  Dist    = length(ViewDir);
+            if (Dist > 0 && dot(ViewDir, Meshlet.ConeAxis) >= Meshlet.ConeCutoff * Dist)
+            {
+                ++NumCulledMeshlets;
+                NumCulledTriangles += Meshlet.NumTriangles;
+            }
+        }
+    }
+
+    Rate.Meshlets  = static_cast<double>(NumCulledMeshlets) / (static_cast<double>(Mesh.Meshlets.size()) * NumViews);
+    Rate.Triangles = static_cast<double>(NumCulledTriangles) / (static_cast<double>(Mesh.GetNumTriangles()) * NumViews);
+    return Rate;
+}
+
+Uint64 ComputeMeshletCacheKey(const std::vector<MeshletSourceMesh>& Meshes, const MeshletBuilder::Settings& BuilderSettings)
+{
+    Uint64 Key = 0xCBF29CE484222325ull;
+    HashValue(Key, MeshletCacheVersion);
+    HashValue(Key, BuilderSettings.MaxVertices);
+    HashValue(Key, BuilderSettings.MaxTriangles);
+    HashValue(Key, BuilderSettings.ConeWeight);
+    HashValue(Key, static_cast<Uint32>(Meshes.size()));
+    for (const MeshletSourceMesh& Mesh : Meshes)
+    {
+        HashValue(Key, Mesh.NumVertices);
+        HashValue(Key, Mesh.NumIndices);
+        HashBytes(Key, Mesh.pPositions, sizeof(float3) * Mesh.NumVertices);
+        HashBytes(Key, Mesh.pIndices, sizeof(Uint32) * Mesh.NumIndices);
+    }
+    return Key;
+}
+
+bool SaveMeshletCache(const char* Path, Uint64 Key, const std::vector<MeshletMesh>& Meshes)
+{
+    // All values are stored in the native byte order, which is little-endian on all supported platforms
+    std::vector<Uint8> Data;
+    for (char c : MeshletCacheMagic)
+        WriteValue(Data, c);
+    WriteValue(Data, MeshletCacheVersion);
+    WriteValue(Data, static_cast<Uint32>(sizeof(MeshletData)));
+    WriteValue(Data, Key);
+    WriteValue(Data, static_cast<Uint32>(Meshes.size()));
+    for (const MeshletMesh& Mesh : Meshes)
+    {
+        WriteValue(Data, Mesh.Center);
+        WriteValue(Data, Mesh.Radius);
+        WriteValue(Data, static_cast<Uint32>(Mesh.Meshlets.size()));
+        WriteValue(Data, static_cast<Uint32>(Mesh.Vertices.size()));
+        WriteValue(Data, Mesh.GetNumTriangles());
+        WriteArray(Data, Mesh.Meshlets);
+        WriteArray(Data, Mesh.Vertices);
+        WriteArray(Data, Mesh.Triangles);
+    }
+
+    FileWrapper pFile{Path, EFileAccessMode::Overwrite};
+    if (!pFile)
+    {
+        LOG_ERROR_MESSAGE("Failed to create meshlet cache file '", Path, "'.");
+        return false;
+    }
+
+    if (!pFile->Write(Data.data(), Data.size()))
+    {
+        LOG_ERROR_MESSAGE("Failed to write meshlet cache file '", Path, "'.");
+        return false;
+    }
+
+    LOG_INFO_MESSAGE("Saved meshlets of ", Meshes.size(), " meshes (", FormatMemorySize(Data.size()), ") to '", Path, "'.");
+    return true;
+}
+
+bool LoadMeshletCache(const char* Path, Uint64 Key, const std::vector<MeshletSourceMesh>& SourceMeshes, std::vector<MeshletMesh>& Meshes)
+{
+    FileWrapper                 pFile{Path};
+    RefCntAutoPtr<DataBlobImpl> pData = DataBlobImpl::Create();
+    if (!pFile || !pFile->Read(pData))
+        return false;
+
+    CacheReader Reader{static_cast<const Uint8*>(pData->GetConstDataPtr()), pData->GetSize()};
+
+    char   Magic[4]    = {};
+    Uint32 Version     = 0;
+    Uint32 MeshletSize = 0;
+    Uint64 FileKey     = 0;
+    Uint32 NumMeshes   = 0;
+    if (!Reader.Read(Magic) || std::memcmp(Magic, MeshletCacheMagic, sizeof(MeshletCacheMagic)) != 0)
+    {
+        LOG_WARNING_MESSAGE("'", Path, "' is not a meshlet cache file.");
+        return false;
+    }
+    if (!Reader.Read(Version) || !Reader.Read(MeshletSize) || !Reader.Read(FileKey) || !Reader.Read(NumMeshes))
+    {
+        LOG_WARNING_MESSAGE("Meshlet cache file '", Path, "' is corrupted.");
+        return false;
+    }
+    if (Version != MeshletCacheVersion || MeshletSize != sizeof(MeshletData) || FileKey != Key || NumMeshes != SourceMeshes.size())
+    {
+        LOG_INFO_MESSAGE("Meshlet cache file '", Path, "' was created for different meshes or settings.");
+        return false;
+    }
+
+    std::vector<MeshletMesh> LoadedMeshes(NumMeshes);
+    for (Uint32 m = 0; m < NumMeshes; ++m)
+    {
+        MeshletMesh& Mesh = LoadedMeshes[m];
+        Uint32 NumMeshlets  = 0;
+        Uint32 NumVertices  = 0;
+        Uint32 NumTriangles = 0;
+        if (!Reader.Read(Mesh.Center) || !Reader.Read(Mesh.Radius) ||
+            !Reader.Read(NumMeshlets) || !Reader.Read(NumVertices) || !Reader.Read(NumTriangles) ||
+            !Reader.ReadArray(Mesh.Meshlets, NumMeshlets) ||
+            !Reader.ReadArray(Mesh.Vertices, NumVertices) ||
+            !Reader.ReadArray(Mesh.Triangles, size_t{NumTriangles} * 3) ||
+            !ValidateMeshletMesh(Mesh, SourceMeshes[m]))
+        {
+            LOG_WARNING_MESSAGE("Meshlet cache file '", Path, "' is corrupted.");
+            return false;
+        }
+    }
+    if (!Reader.IsEnd())
+    {
+        LOG_WARNING_MESSAGE("Meshlet cache file '", Path, "' is corrupted.");
+        return false;
+    }
+
+    Meshes = std::move(LoadedMeshes);
+    return true;
+}
+
+} // namespace Diligent
@@ -0,0 +1,166 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *  Copyright 2015-2019 Egor Yusov
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "BasicMath.hpp"
+#include "ParallelFrameRecorder.hpp"
+
+namespace Diligent
+{
+
+// Indexed triangle list that is split into meshlets
+struct MeshletSourceMesh
+{
+    const float3* pPositions  = nullptr;
+    Uint32        NumVertices = 0;
+    const Uint32* pIndices    = nullptr;
+    Uint32        NumIndices  = 0;
+};
+
+struct MeshletData
+{
+    // Ranges of MeshletMesh::Vertices and MeshletMesh::Triangles used by the meshlet
+    Uint32 FirstVertex   = 0;
+    Uint32 NumVertices   = 0;
+    Uint32 FirstTriangle = 0;
+    Uint32 NumTriangles  = 0;
+
+    // Bounding sphere of the meshlet
+    float3 Center;
+    float  Radius = 0;
+
+    // Cone that contains the normals of all triangles. All triangles face away from
+    // a camera at position P if dot(normalize(ConeApex - P), ConeAxis) >= ConeCutoff.
+    // The cutoff is greater than 1 if the normals are spread too wide to cull the meshlet.
+    float3 ConeApex;
+    float  ConeCutoff = 2;
+    float3 ConeAxis;
+    float  Padding = 0;
+};
+
+// Meshlets of a single source mesh
+struct MeshletMesh
+{
+    std::vector<MeshletData> Meshlets;
+
+    // Source mesh indices of the vertices of every meshlet
+    std::vector<Uint32> Vertices;
+
+    // Three meshlet-local vertex indices per triangle
+    std::vector<Uint8> Triangles;
+
+    // Bounding sphere of the entire mesh
+    float3 Center;
+    float  Radius = 0;
+
+    Uint32 GetNumTriangles() const { return static_cast<Uint32>(Triangles.size() / 3); }
+};
+
+// Splits triangle meshes into meshlets for the mesh shader.
+//
+// Meshlets are grown greedily from adjacent triangles. The next triangle is the one with the lowest score, which
+// is mostly the number of vertices it adds to the meshlet, so that every vertex is shared by as many triangles as
+// possible. The score also grows with the deviation of the triangle normal from the average normal of the meshlet
+// to keep the normal cones narrow, and with the number of unassigned triangles around the triangle vertices, so
+// that the meshlet completes the fans of its vertices instead of leaving single triangles behind. A new meshlet
+// starts from the border triangle of the previous one that is surrounded by the most assigned triangles, or from
+// the first unassigned triangle in index order, which is usually close in a vertex-cache optimized mesh.
+//
+// The builder keeps its adjacency and scratch arrays between the meshes, so every thread should use its own builder.
+class MeshletBuilder
+{
+public:
+    struct Settings
+    {
+        Uint32 MaxVertices  = 64;
+        Uint32 MaxTriangles = 124;
+
+        // Score of the deviation of the triangle normal from the average meshlet normal,
+        // relative to the score of one vertex that the triangle adds to the meshlet
+        float ConeWeight = 0.5f;
+    };
+
+    explicit MeshletBuilder(const Settings& BuilderSettings);
+
+    const Settings& GetSettings() const { return m_Settings; }
+
+    void Build(const MeshletSourceMesh& Mesh, MeshletMesh& Result);
+
+private:
+    void ComputeBounds(const MeshletSourceMesh& Mesh, const MeshletMesh& Result, MeshletData& Meshlet) const;
+
+    const Settings m_Settings;
+
+    // Triangles that use every vertex, in compressed sparse row format
+    std::vector<Uint32> m_AdjacencyOffsets;
+    std::vector<Uint32> m_AdjacentTriangles;
+    // Number of unassigned triangles that use every vertex
+    std::vector<Uint32> m_NumLiveTriangles;
+
+    std::vector<float3> m_TriangleNormals;
+    std::vector<Uint8>  m_TriangleAssigned;
+    // Index of the last meshlet that added the triangle to its candidates
+    std::vector<Uint32> m_CandidateStamp;
+    std::vector<Uint32> m_Candidates;
+
+    // Local index of every vertex in the current meshlet, or 0xFF if it is not in the meshlet
+    std::vector<Uint8> m_LocalIndex;
+
+    // Triangles of the current meshlet
+    std::vector<Uint32> m_MeshletTriangles;
+};
+
+// Builds the meshlets of all meshes on the calling thread and the workers of the pool.
+// Every subset takes the next mesh from a shared counter, starting with the largest ones.
+void BuildMeshletsParallel(const std::vector<MeshletSourceMesh>& Meshes,
+                           const MeshletBuilder::Settings&       BuilderSettings,
+                           ParallelTaskPool&                     Workers,
+                           std::vector<MeshletMesh>&             Result);
+
+// Returns the fraction of meshlets and triangles of the mesh that cone culling rejects, averaged over
+// NumViews cameras evenly distributed on a sphere of radius Mesh.Radius * DistanceScale around the mesh.
+struct ConeCullingRate
+{
+    double Meshlets  = 0;
+    double Triangles = 0;
+};
+ConeCullingRate ComputeConeCullingRate(const MeshletMesh& Mesh, Uint32 NumViews, float DistanceScale);
+
+// Computes the key that identifies the source meshes and the settings in the meshlet cache
+Uint64 ComputeMeshletCacheKey(const std::vector<MeshletSourceMesh>& Meshes, const MeshletBuilder::Settings& BuilderSettings);
+
+// Writes the meshlets to the binary cache file
+bool SaveMeshletCache(const char* Path, Uint64 Key, const std::vector<MeshletMesh>& Meshes);
+
+// Reads the meshlets of SourceMeshes from the cache file. Returns false if the file does not exist,
+// is corrupted or was created for different source meshes or settings.
+bool LoadMeshletCache(const char* Path, Uint64 Key, const std::vector<MeshletSourceMesh>& SourceMeshes, std::vector<MeshletMesh>& Meshes);
+
+} // namespace Diligent
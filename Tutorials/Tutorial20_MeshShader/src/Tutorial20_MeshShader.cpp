@@ -25,6 +25,9 @@
  *  of the possibility of such damages.
  */
 
+#include <algorithm>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include "Tutorial20_MeshShader.hpp"
@@ -36,6 +39,11 @@
 #include "ImGuiUtils.hpp"
 #include "FastRand.hpp"
 #include "AdvancedMath.hpp"
+#include "CommandLineParser.hpp"
+#include "FileSystem.hpp"
+#include "Timer.hpp"
+#include "Align.hpp"
+#include "ParallelFrameRecorder.hpp"
 
 namespace Diligent
 {
@@ -44,21 +52,111 @@ namespace
 
 #include "../assets/structures.fxh"
 
-struct DrawStatistics
+static_assert(sizeof(DrawTask) % 16 == 0, "Structure must be 16-byte aligned");
+static_assert(sizeof(Meshlet) % 16 == 0, "Structure must be 16-byte aligned");
+
+using SourceMesh = Tutorial20_MeshShader::SourceMesh;
+
+// Creates a closed parametric surface from a (NumU + 1) x (NumV + 1) grid of vertices.
+// GetPosition maps (u, v) in [0, 1] x [0, 1] to the surface point.
+template <typename GetPositionType>
+SourceMesh CreateParametricMesh(Uint32 NumU, Uint32 NumV, GetPositionType GetPosition)
 {
-    Uint32 visibleCubes;
-};
+    SourceMesh Mesh;
+    // Repeat the texture along u so that its texels are roughly square
+    const float UScale = std::max(std::round(static_cast<float>(NumU) / static_cast<float>(NumV)), 1.f);
 
-static_assert(sizeof(DrawTask) % 16 == 0, "Structure must be 16-byte aligned");
+    Mesh.Positions.reserve(size_t{NumU + 1} * (NumV + 1));
+    Mesh.UVs.reserve(size_t{NumU + 1} * (NumV + 1));
+    for (Uint32 j = 0; j <= NumV; ++j)
+    {
+        for (Uint32 i = 0; i <= NumU; ++i)
+        {
+            const float u = static_cast<float>(i) / static_cast<float>(NumU);
+            const float v = static_cast<float>(j) / static_cast<float>(NumV);
+            Mesh.Positions.push_back(GetPosition(u, v));
+            Mesh.UVs.push_back(float2{u * UScale, v});
+        }
+    }
 
-} // namespace
+    Mesh.Indices.reserve(size_t{NumU} * NumV * 6);
+    auto AddTriangle = [&](Uint32 i0, Uint32 i1, Uint32 i2) {
+        // Skip the triangles that collapse at the poles
+        const float3& P0 = Mesh.Positions[i0];
+        if (length(cross(Mesh.Positions[i1] - P0, Mesh.Positions[i2] - P0)) > 1e-6f)
+        {
+            Mesh.Indices.push_back(i0);
+            Mesh.Indices.push_back(i1);
+            Mesh.Indices.push_back(i2);
+        }
+    };
+    for (Uint32 j = 0; j < NumV; ++j)
+    {
+        for (Uint32 i = 0; i < NumU; ++i)
+        {
+            const Uint32 i00 = j * (NumU + 1) + i;
+            const Uint32 i10 = i00 + 1;
+            const Uint32 i01 = i00 + NumU + 1;
+            const Uint32 i11 = i01 + 1;
+            AddTriangle(i00, i01, i10);
+            AddTriangle(i10, i01, i11);
+        }
+    }
 
-SampleBase* CreateSample()
+    // Triangles of the cube are front-facing when cross(P1 - P0, P2 - P0) points outside, so flip
+    // the surface if its signed volume is negative.
+    float Volume = 0;
+    for (size_t t = 0; t < Mesh.Indices.size(); t += 3)
+        Volume += dot(Mesh.Positions[Mesh.Indices[t]], cross(Mesh.Positions[Mesh.Indices[t + 1]], Mesh.Positions[Mesh.Indices[t + 2]]));
+    if (Volume < 0)
+    {
+        for (size_t t = 0; t < Mesh.Indices.size(); t += 3)
+            std::swap(Mesh.Indices[t + 1], Mesh.Indices[t + 2]);
+    }
+
+    return Mesh;
+}
+
+SourceMesh CreateSphere(float Radius, Uint32 NumU, Uint32 NumV)
 {
-    return new Tutorial20_MeshShader();
+    return CreateParametricMesh(NumU, NumV, [Radius](float u, float v) {
+        const float Theta = u * 2.f * PI_F;
+        const float Phi   = v * PI_F;
+        return float3{std::cos(Theta) * std::sin(Phi), std::cos(Phi), std::sin(Theta) * std::sin(Phi)} * Radius;
+    });
 }
 
-void Tutorial20_MeshShader::CreateCube()
+SourceMesh CreateTorus(float MajorRadius, float MinorRadius, Uint32 NumU, Uint32 NumV)
+{
+    return CreateParametricMesh(NumU, NumV, [=](float u, float v) {
+        const float Theta = u * 2.f * PI_F;
+        const float Phi   = v * 2.f * PI_F;
+        const float r     = MajorRadius + MinorRadius * std::cos(Phi);
+        return float3{std::cos(Theta) * r, MinorRadius * std::sin(Phi), std::sin(Theta) * r};
+    });
+}
+
+// (P, Q) torus knot swept by a circle of radius TubeRadius
+SourceMesh CreateTorusKnot(Uint32 P, Uint32 Q, float TubeRadius, Uint32 NumU, Uint32 NumV)
+{
+    auto GetCurvePoint = [=](float t) {
+        const float Angle = t * 2.f * PI_F;
+        const float r     = 1.f + 0.5f * std::cos(static_cast<float>(Q) * Angle);
+        return float3{r * std::cos(static_cast<float>(P) * Angle), 0.5f * std::sin(static_cast<float>(Q) * Angle), r * std::sin(static_cast<float>(P) * Angle)};
+    };
+    return CreateParametricMesh(NumU, NumV, [=](float u, float v) {
+        // Frame of the tube is built from the tangent and the direction to the next point along the curve
+        const float3 C0  = GetCurvePoint(u);
+        const float3 C1  = GetCurvePoint(u + 1e-3f);
+        const float3 T   = normalize(C1 - C0);
+        const float3 B   = normalize(cross(T, C1 + C0));
+        const float3 N   = cross(B, T);
+        const float  Phi = v * 2.f * PI_F;
+        return C0 + (N * std::cos(Phi) + B * std::sin(Phi)) * TubeRadius;
+    });
+}
+
+SourceMesh CreateCube()
 {
     RefCntAutoPtr<IDataBlob> pCubeVerts;
     RefCntAutoPtr<IDataBlob> pCubeIndices;
@@ -75,74 +173,303 @@ void Tutorial20_MeshShader::CreateCube()
     const CubeVertex* pVerts   = pCubeVerts->GetConstDataPtr<CubeVertex>();
     const Uint32*     pIndices = pCubeIndices->GetConstDataPtr<Uint32>();
 
-    // Pack float3 positions into float4 vectors
-    // Pack float2 texcoords into float4 vectors
-    std::vector<float4> CubePos(CubeGeoInfo.NumVertices);
-    std::vector<float4> CubeUV(CubeGeoInfo.NumVertices);
+    SourceMesh Mesh;
+    Mesh.Positions.resize(CubeGeoInfo.NumVertices);
+    Mesh.UVs.resize(CubeGeoInfo.NumVertices);
     for (Uint32 v = 0; v < CubeGeoInfo.NumVertices; ++v)
     {
-        CubePos[v] = float4{pVerts[v].Pos, 1};
-        CubeUV[v]  = float4{pVerts[v].UV, 0, 0};
+        Mesh.Positions[v] = pVerts[v].Pos;
+        Mesh.UVs[v]       = pVerts[v].UV;
+    }
+    Mesh.Indices.assign(pIndices, pIndices + CubeGeoInfo.NumIndices);
+
+    return Mesh;
+}
+
+} // namespace
+
+SampleBase* CreateSample()
+{
+    return new Tutorial20_MeshShader();
+}
+
+Tutorial20_MeshShader::CommandLineStatus Tutorial20_MeshShader::ProcessCommandLine(int argc, const char* const* argv)
+{
+    CommandLineParser ArgsParser{argc, argv};
+    ArgsParser.Parse("meshlet_cache", m_MeshletCachePath);
+    ArgsParser.Parse("rebuild_meshlets", m_RebuildMeshlets);
+    if (ArgsParser.Parse("meshlet_benchmark", m_MeshletBenchmarkRuns))
+    {
+        m_MeshletBenchmarkRuns = clamp(m_MeshletBenchmarkRuns, 0, 1000);
     }
+    ArgsParser.Parse("procedural_meshes", m_ProceduralMeshes);
 
-    // Pack each triangle indices into uint4
-    std::vector<uint4> Indices(CubeGeoInfo.NumIndices / 3);
-    for (size_t tri = 0; tri < Indices.size(); ++tri)
+    return CommandLineStatus::OK;
+}
+
+void Tutorial20_MeshShader::CreateMeshes()
+{
+    // Meshes with different sizes and curvatures. Flat faces of the cube make the best case for
+    // the cone culling, while the normals of the thin knot tubes turn quickly.
+    m_SourceMeshes.clear();
+    m_SourceMeshes.push_back(CreateCube());
+    if (m_ProceduralMeshes)
     {
-        const Uint32* src_ind{&pIndices[tri * 3]};
-        Indices[tri] = {src_ind[0], src_ind[1], src_ind[2], 0};
+        m_SourceMeshes.push_back(CreateSphere(1.4f, 24, 12));
+        m_SourceMeshes.push_back(CreateSphere(1.4f, 40, 20));
+        m_SourceMeshes.push_back(CreateTorus(1.1f, 0.45f, 48, 18));
+        m_SourceMeshes.push_back(CreateTorusKnot(2, 3, 0.2f, 160, 12));
+        m_SourceMeshes.push_back(CreateTorusKnot(3, 4, 0.15f, 160, 12));
     }
-    CubeData Data;
 
-    // radius of circumscribed sphere = (edge_length * sqrt(3) / 2)
-    Data.SphereRadius = float4{length(CubePos[0] - CubePos[1]) * std::sqrt(3.0f) * 0.5f, 0, 0, 0};
+    m_MeshletStats.NumMeshes = static_cast<Uint32>(m_SourceMeshes.size());
+}
 
-    std::memcpy(Data.Positions, CubePos.data(), CubePos.size() * sizeof(CubePos[0]));
-    std::memcpy(Data.UVs, CubeUV.data(), CubeUV.size() * sizeof(CubeUV[0]));
-    std::memcpy(Data.Indices, Indices.data(), Indices.size() * sizeof(Indices[0]));
+void Tutorial20_MeshShader::BuildMeshlets()
+{
+    std::vector<MeshletSourceMesh> SourceMeshes;
+    SourceMeshes.reserve(m_SourceMeshes.size());
+    for (const SourceMesh& Mesh : m_SourceMeshes)
+    {
+        MeshletSourceMesh& Src = SourceMeshes.emplace_back();
+        Src.pPositions         = Mesh.Positions.data();
+        Src.NumVertices        = static_cast<Uint32>(Mesh.Positions.size());
+        Src.pIndices           = Mesh.Indices.data();
+        Src.NumIndices         = static_cast<Uint32>(Mesh.Indices.size());
+    }
 
-    BufferDesc BuffDesc;
-    BuffDesc.Name      = "Cube vertex & index buffer";
-    BuffDesc.Usage     = USAGE_IMMUTABLE;
-    BuffDesc.BindFlags = BIND_UNIFORM_BUFFER;
-    BuffDesc.Size      = sizeof(Data);
+    // Meshlet size limits must match the output arrays of the mesh shader
+    MeshletBuilder::Settings BuilderSettings;
+    BuilderSettings.MaxVertices  = MAX_MESHLET_VERTICES;
+    BuilderSettings.MaxTriangles = MAX_MESHLET_TRIANGLES;
 
-    BufferData BufData;
-    BufData.pData    = &Data;
-    BufData.DataSize = sizeof(Data);
+    if (m_MeshletBenchmarkRuns > 0)
+        RunMeshletBenchmark(SourceMeshes, BuilderSettings);
+
+    if (m_MeshletCachePath.empty())
+    {
+        m_MeshletCachePath = FileSystem::GetLocalAppDataDirectory("DiligentEngine-Tutorial20");
+        if (!FileSystem::PathExists(m_MeshletCachePath.c_str()))
+            FileSystem::CreateDirectory(m_MeshletCachePath.c_str());
+        if (!m_MeshletCachePath.empty() && !FileSystem::IsSlash(m_MeshletCachePath.back()))
+            m_MeshletCachePath.push_back(FileSystem::SlashSymbol);
+        m_MeshletCachePath += "meshlets.bin";
+    }
 
-    m_pDevice->CreateBuffer(BuffDesc, &BufData, &m_CubeBuffer);
-    VERIFY_EXPR(m_CubeBuffer != nullptr);
+    // The key changes whenever the meshes or the settings change, which invalidates the cache
+    const Uint64 CacheKey = ComputeMeshletCacheKey(SourceMeshes, BuilderSettings);
+
+    Timer BuildTimer;
+    m_MeshletStats.FromCache = !m_RebuildMeshlets && LoadMeshletCache(m_MeshletCachePath.c_str(), CacheKey, SourceMeshes, m_MeshletMeshes);
+    if (!m_MeshletStats.FromCache)
+    {
+        ParallelTaskPool Workers;
+        Workers.Start(std::max(std::thread::hardware_concurrency(), 1u) - 1u);
+        BuildMeshletsParallel(SourceMeshes, BuilderSettings, Workers, m_MeshletMeshes);
+        m_MeshletStats.NumBuildThreads = Workers.GetNumSubsets();
+    }
+    m_MeshletStats.BuildTime = BuildTimer.GetElapsedTime();
+
+    if (!m_MeshletStats.FromCache && !SaveMeshletCache(m_MeshletCachePath.c_str(), CacheKey, m_MeshletMeshes))
+        LOG_WARNING_MESSAGE("Failed to write meshlet cache to ", m_MeshletCachePath);
+
+    // Cone culling rate over all meshlets for cameras around every mesh
+    double NumConeCulled = 0;
+    Uint32 NumMeshlets   = 0;
+    for (const MeshletMesh& Mesh : m_MeshletMeshes)
+    {
+        NumConeCulled += ComputeConeCullingRate(Mesh, 256, 4.f).Meshlets * static_cast<double>(Mesh.Meshlets.size());
+        NumMeshlets += static_cast<Uint32>(Mesh.Meshlets.size());
+    }
+    m_MeshletStats.ConeCullingRate = NumMeshlets > 0 ? NumConeCulled / NumMeshlets : 0;
+
+    LOG_INFO_MESSAGE(m_MeshletStats.FromCache ? "Loaded " : "Built ", NumMeshlets, " meshlets of ", m_MeshletMeshes.size(), " meshes ",
+                     m_MeshletStats.FromCache ? "from " : "and saved them to ", m_MeshletCachePath, " in ", m_MeshletStats.BuildTime * 1000.0,
+                     " ms. Cone culling rejects ", m_MeshletStats.ConeCullingRate * 100.0, "% of meshlets.");
+}
+
+void Tutorial20_MeshShader::RunMeshletBenchmark(const std::vector<MeshletSourceMesh>& SourceMeshes, const MeshletBuilder::Settings& BuilderSettings)
+{
+    Uint64 NumTriangles = 0;
+    for (const MeshletSourceMesh& Mesh : SourceMeshes)
+        NumTriangles += Mesh.NumIndices / 3;
+
+    ParallelTaskPool Workers;
+    Workers.Start(std::max(std::thread::hardware_concurrency(), 1u) - 1u);
+
+    MeshletBuilder           Builder{BuilderSettings};
+    std::vector<MeshletMesh> Meshes(SourceMeshes.size());
+
+    // The fastest run is the least affected by the other processes
+    double MinSingleThreadTime = 0;
+    double MinParallelTime     = 0;
+    for (int Run = 0; Run < m_MeshletBenchmarkRuns; ++Run)
+    {
+        {
+            Timer SingleThreadTimer;
+            for (size_t i = 0; i < SourceMeshes.size(); ++i)
+                Builder.Build(SourceMeshes[i], Meshes[i]);
+            const double Time   = SingleThreadTimer.GetElapsedTime();
+            MinSingleThreadTime = Run == 0 ? Time : std::min(MinSingleThreadTime, Time);
+        }
+        {
+            Timer ParallelTimer;
+            BuildMeshletsParallel(SourceMeshes, BuilderSettings, Workers, Meshes);
+            const double Time = ParallelTimer.GetElapsedTime();
+            MinParallelTime   = Run == 0 ? Time : std::min(MinParallelTime, Time);
+        }
+    }
+
+    m_MeshletStats.SingleThreadThroughput = static_cast<double>(NumTriangles) / std::max(MinSingleThreadTime, 1e-9);
+    m_MeshletStats.ParallelThroughput     = static_cast<double>(NumTriangles) / std::max(MinParallelTime, 1e-9);
+    m_MeshletStats.NumBuildThreads        = Workers.GetNumSubsets();
+
+    LOG_INFO_MESSAGE("Meshlet build benchmark (", m_MeshletBenchmarkRuns, " runs, ", NumTriangles, " triangles): ",
+                     m_MeshletStats.SingleThreadThroughput / 1e6, " M triangles/s on 1 thread, ",
+                     m_MeshletStats.ParallelThroughput / 1e6, " M triangles/s on ", m_MeshletStats.NumBuildThreads, " threads");
+    for (size_t i = 0; i < Meshes.size(); ++i)
+    {
+        const ConeCullingRate Rate = ComputeConeCullingRate(Meshes[i], 256, 4.f);
+        LOG_INFO_MESSAGE("  Mesh ", i, ": ", Meshes[i].GetNumTriangles(), " triangles, ", Meshes[i].Meshlets.size(), " meshlets, ",
+                         Meshes[i].Vertices.size(), " meshlet vertices, cone culling rejects ", Rate.Meshlets * 100.0, "% of meshlets and ",
+                         Rate.Triangles * 100.0, "% of triangles");
+    }
+}
+
+void Tutorial20_MeshShader::CreateMeshletBuffers()
+{
+    std::vector<MeshInfo>   Meshes;
+    std::vector<Meshlet>    Meshlets;
+    std::vector<Uint32>     MeshletVertices;
+    std::vector<Uint32>     MeshletTriangles;
+    std::vector<MeshVertex> Vertices;
+    for (size_t m = 0; m < m_SourceMeshes.size(); ++m)
+    {
+        const SourceMesh&  Src   = m_SourceMeshes[m];
+        const MeshletMesh& Built = m_MeshletMeshes[m];
+
+        MeshInfo& Info      = Meshes.emplace_back();
+        Info.BoundingSphere = float4{Built.Center, Built.Radius};
+        Info.FirstMeshlet   = static_cast<Uint32>(Meshlets.size());
+        Info.NumMeshlets    = static_cast<Uint32>(Built.Meshlets.size());
+
+        // Meshlet ranges of all meshes are merged into global arrays
+        const Uint32 BaseVertex        = static_cast<Uint32>(Vertices.size());
+        const Uint32 BaseMeshletVertex = static_cast<Uint32>(MeshletVertices.size());
+        const Uint32 BaseTriangle      = static_cast<Uint32>(MeshletTriangles.size());
+
+        for (size_t v = 0; v < Src.Positions.size(); ++v)
+            Vertices.push_back({float4{Src.Positions[v], 1}, float4{Src.UVs[v], 0, 0}});
+
+        for (Uint32 v : Built.Vertices)
+            MeshletVertices.push_back(BaseVertex + v);
+
+        // Pack three local vertex indices of every triangle into one uint
+        for (size_t t = 0; t < Built.Triangles.size(); t += 3)
+            MeshletTriangles.push_back(Uint32{Built.Triangles[t]} | (Uint32{Built.Triangles[t + 1]} << 8u) | (Uint32{Built.Triangles[t + 2]} << 16u));
+
+        for (const MeshletData& Data : Built.Meshlets)
+        {
+            Meshlet& Dst       = Meshlets.emplace_back();
+            Dst.BoundingSphere = float4{Data.Center, Data.Radius};
+            Dst.ConeApex       = float4{Data.ConeApex, Data.ConeCutoff};
+            Dst.ConeAxis       = float4{Data.ConeAxis, 0};
+            Dst.FirstVertex    = BaseMeshletVertex + Data.FirstVertex;
+            Dst.NumVertices    = Data.NumVertices;
+            Dst.FirstTriangle  = BaseTriangle + Data.FirstTriangle;
+            Dst.NumTriangles   = Data.NumTriangles;
+        }
+    }
+    // The payload stores the meshlet index in the upper 24 bits
+    if (Meshlets.size() >= (size_t{1} << 24u))
+        LOG_ERROR_AND_THROW("Too many meshlets: ", Meshlets.size());
+
+    auto CreateStructuredBuffer = [this](const char* Name, const void* pData, Uint32 Stride, size_t Count, IBuffer** ppBuffer) {
+        BufferDesc BuffDesc;
+        BuffDesc.Name              = Name;
+        BuffDesc.Usage             = USAGE_IMMUTABLE;
+        BuffDesc.BindFlags         = BIND_SHADER_RESOURCE;
+        BuffDesc.Mode              = BUFFER_MODE_STRUCTURED;
+        BuffDesc.ElementByteStride = Stride;
+        BuffDesc.Size              = Uint64{Stride} * Count;
+
+        BufferData BufData;
+        BufData.pData    = pData;
+        BufData.DataSize = BuffDesc.Size;
+
+        m_pDevice->CreateBuffer(BuffDesc, &BufData, ppBuffer);
+        VERIFY_EXPR(*ppBuffer != nullptr);
+    };
+    CreateStructuredBuffer("Meshes buffer", Meshes.data(), sizeof(Meshes[0]), Meshes.size(), &m_pMeshes);
+    CreateStructuredBuffer("Meshlets buffer", Meshlets.data(), sizeof(Meshlets[0]), Meshlets.size(), &m_pMeshlets);
+    CreateStructuredBuffer("Meshlet vertices buffer", MeshletVertices.data(), sizeof(MeshletVertices[0]), MeshletVertices.size(), &m_pMeshletVertices);
+    CreateStructuredBuffer("Meshlet triangles buffer", MeshletTriangles.data(), sizeof(MeshletTriangles[0]), MeshletTriangles.size(), &m_pMeshletTriangles);
+    CreateStructuredBuffer("Vertices buffer", Vertices.data(), sizeof(Vertices[0]), Vertices.size(), &m_pVertices);
+
+    m_MeshNumMeshlets.resize(Meshes.size());
+    for (size_t m = 0; m < Meshes.size(); ++m)
+        m_MeshNumMeshlets[m] = Meshes[m].NumMeshlets;
+
+    m_MeshletStats.NumMeshlets  = static_cast<Uint32>(Meshlets.size());
+    m_MeshletStats.NumTriangles = static_cast<Uint32>(MeshletTriangles.size());
+    m_MeshletStats.NumVertices  = static_cast<Uint32>(MeshletVertices.size());
+
+    // The data is now on the GPU
+    m_SourceMeshes.clear();
+    m_SourceMeshes.shrink_to_fit();
+    m_MeshletMeshes.clear();
+    m_MeshletMeshes.shrink_to_fit();
 }
 
 void Tutorial20_MeshShader::CreateDrawTasks()
 {
     // In this tutorial draw tasks contain:
-    //  * cube position in the grid
-    //  * cube scale factor
-    //  * time that is used for animation and will be updated in the shader.
-    // Additionally you can store model transformation matrix, mesh and material IDs, etc.
+    //  * object position in the grid
+    //  * object scale factor
+    //  * time that is used for animation and will be updated in the shader
+    //  * index of the mesh
+    //  * range of the meshlets of the mesh.
+    // Additionally you can store model transformation matrix, material IDs, etc.
+
+    // One amplification shader group dispatches the meshlets of up to ASGroupSize tasks, so every task
+    // covers at most MaxMeshletsPerTask meshlets, and objects with more meshlets are drawn by several tasks.
+    constexpr Uint32 MaxMeshletsPerTask = MAX_PAYLOAD_MESHLETS / ASGroupSize;
 
     const int2          GridDim{128, 128};
     FastRandReal<float> Rnd{0, 0.f, 1.f};
 
+    const Uint32 NumMeshes = m_MeshletStats.NumMeshes;
+    VERIFY_EXPR(NumMeshes > 0 && m_MeshNumMeshlets.size() == NumMeshes);
+
     std::vector<DrawTask> DrawTasks;
-    DrawTasks.resize(static_cast<size_t>(GridDim.x) * static_cast<size_t>(GridDim.y));
+    DrawTasks.reserve(static_cast<size_t>(GridDim.x) * static_cast<size_t>(GridDim.y));
 
     for (int y = 0; y < GridDim.y; ++y)
     {
         for (int x = 0; x < GridDim.x; ++x)
         {
-            int       idx = x + y * GridDim.x;
-            DrawTask& dst = DrawTasks[idx];
-
-            dst.BasePos.x  = (x - GridDim.x / 2) * 4.f + (Rnd() * 2.f - 1.f);
-            dst.BasePos.y  = (y - GridDim.y / 2) * 4.f + (Rnd() * 2.f - 1.f);
-            dst.Scale      = Rnd() * 0.5f + 0.5f; // 0.5 .. 1
-            dst.TimeOffset = Rnd() * PI_F;
+            DrawTask Object{};
+            Object.BasePos.x  = (x - GridDim.x / 2) * 4.f + (Rnd() * 2.f - 1.f);
+            Object.BasePos.y  = (y - GridDim.y / 2) * 4.f + (Rnd() * 2.f - 1.f);
+            Object.Scale      = Rnd() * 0.5f + 0.5f; // 0.5 .. 1
+            Object.TimeOffset = Rnd() * PI_F;
+            // The random sequence of the cube-only scene is not changed
+            if (NumMeshes > 1)
+                Object.MeshId = std::min(static_cast<Uint32>(Rnd() * static_cast<float>(NumMeshes)), NumMeshes - 1);
+
+            const Uint32 NumMeshlets = m_MeshNumMeshlets[Object.MeshId];
+            for (Uint32 FirstMeshlet = 0; FirstMeshlet < NumMeshlets; FirstMeshlet += MaxMeshletsPerTask)
+            {
+                DrawTask& dst    = DrawTasks.emplace_back(Object);
+                dst.FirstMeshlet = FirstMeshlet;
+                dst.NumMeshlets  = std::min(NumMeshlets - FirstMeshlet, MaxMeshletsPerTask);
+            }
         }
     }
 
+    // Amplification shader groups process ASGroupSize tasks each, the remaining tasks draw nothing
+    DrawTasks.resize(AlignUp(DrawTasks.size(), size_t{ASGroupSize}));
+
     BufferDesc BuffDesc;
     BuffDesc.Name              = "Draw tasks buffer";
     BuffDesc.Usage             = USAGE_DEFAULT;
@@ -163,8 +490,8 @@ void Tutorial20_MeshShader::CreateDrawTasks()
 
 void Tutorial20_MeshShader::CreateStatisticsBuffer()
 {
-    // This buffer is used as an atomic counter in the amplification shader to show
-    // how many cubes are rendered with and without frustum culling.
+    // This buffer is used as a set of atomic counters in the amplification shader to show
+    // how many objects and meshlets are rendered and how many meshlets are culled.
 
     BufferDesc BuffDesc;
     BuffDesc.Name      = "Statistics buffer";
@@ -192,7 +519,6 @@ void Tutorial20_MeshShader::CreateStatisticsBuffer()
     FDesc.Name = "Statistics available";
     m_pDevice->CreateFence(FDesc, &m_pStatisticsAvailable);
 }
-
 void Tutorial20_MeshShader::CreateConstantsBuffer()
 {
     BufferDesc BuffDesc;
@@ -258,6 +584,9 @@ void Tutorial20_MeshShader::CreatePipelineState()
 
     ShaderMacroHelper Macros;
     Macros.AddShaderMacro("GROUP_SIZE", ASGroupSize);
+    Macros.AddShaderMacro("MAX_MESHLET_VERTICES", MAX_MESHLET_VERTICES);
+    Macros.AddShaderMacro("MAX_MESHLET_TRIANGLES", MAX_MESHLET_TRIANGLES);
+    Macros.AddShaderMacro("MAX_PAYLOAD_MESHLETS", MAX_PAYLOAD_MESHLETS);
 
     ShaderCI.Macros = Macros;
 
@@ -319,13 +648,39 @@ void Tutorial20_MeshShader::CreatePipelineState()
     m_pPSO->CreateShaderResourceBinding(&m_pSRB, true);
     VERIFY_EXPR(m_pSRB != nullptr);
 
+    // Mesh data is bound in FinishInitialization() once the meshlets are built
     m_pSRB->GetVariableByName(SHADER_TYPE_AMPLIFICATION, "Statistics")->Set(m_pStatisticsBuffer->GetDefaultView(BUFFER_VIEW_UNORDERED_ACCESS));
-    m_pSRB->GetVariableByName(SHADER_TYPE_AMPLIFICATION, "DrawTasks")->Set(m_pDrawTasks->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
-    m_pSRB->GetVariableByName(SHADER_TYPE_AMPLIFICATION, "cbCubeData")->Set(m_CubeBuffer);
     m_pSRB->GetVariableByName(SHADER_TYPE_AMPLIFICATION, "cbConstants")->Set(m_pConstants);
-    m_pSRB->GetVariableByName(SHADER_TYPE_MESH, "cbCubeData")->Set(m_CubeBuffer);
     m_pSRB->GetVariableByName(SHADER_TYPE_MESH, "cbConstants")->Set(m_pConstants);
     m_pSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_Texture")->Set(m_CubeTextureSRV);
+
+    m_HiZ = std::make_unique<HiZPyramid>(m_pDevice, pShaderSourceFactory);
+}
+
+void Tutorial20_MeshShader::CreateDepthBuffer()
+{
+    const SwapChainDesc& SCDesc = m_pSwapChain->GetDesc();
+
+    // The depth buffer of the swap chain may not be bound as a shader resource
+    TextureDesc DepthDesc;
+    DepthDesc.Name                          = "Depth buffer";
+    DepthDesc.Type                          = RESOURCE_DIM_TEX_2D;
+    DepthDesc.Width                         = SCDesc.Width;
+    DepthDesc.Height                        = SCDesc.Height;
+    DepthDesc.Format                        = SCDesc.DepthBufferFormat;
+    DepthDesc.BindFlags                     = BIND_DEPTH_STENCIL | BIND_SHADER_RESOURCE;
+    DepthDesc.ClearValue.Format             = DepthDesc.Format;
+    DepthDesc.ClearValue.DepthStencil.Depth = 1;
+
+    m_pDepthBuffer.Release();
+    m_pDevice->CreateTexture(DepthDesc, nullptr, &m_pDepthBuffer);
+    VERIFY_EXPR(m_pDepthBuffer != nullptr);
+
+    m_HiZ->SetDepthBuffer(m_pDepthBuffer);
+    m_pSRB->GetVariableByName(SHADER_TYPE_AMPLIFICATION, "g_HiZ")->Set(m_HiZ->GetSRV());
+
+    // The new depth buffer does not contain the previous frame
+    m_PrevDepthValid = false;
 }
 
 void Tutorial20_MeshShader::UpdateUI()
@@ -335,9 +690,46 @@ void Tutorial20_MeshShader::UpdateUI()
     {
         ImGui::Checkbox("Animate", &m_Animate);
         ImGui::Checkbox("Frustum culling", &m_FrustumCulling);
+        ImGui::Checkbox("Cone culling", &m_ConeCulling);
+        ImGui::Checkbox("Occlusion culling", &m_OcclusionCulling);
         ImGui::SliderFloat("LOD scale", &m_LodScale, 1.f, 8.f);
         ImGui::SliderFloat("Camera height", &m_CameraHeight, 5.0f, 100.0f);
-        ImGui::Text("Visible cubes: %d", m_VisibleCubes);
+        ImGui::Text("Visible objects: %d", m_Stats.VisibleObjects);
+        ImGui::Text("Frustum-culled objects: %d", m_Stats.FrustumCulledObjects);
+        ImGui::Text("Occlusion-culled objects: %d", m_Stats.OcclusionCulledObjects);
+        ImGui::Text("Visible meshlets: %d", m_Stats.VisibleMeshlets);
+        ImGui::Text("Frustum-culled meshlets: %d", m_Stats.FrustumCulledMeshlets);
+        ImGui::Text("Cone-culled meshlets: %d", m_Stats.ConeCulledMeshlets);
+        {
+            // Fraction of the meshlets in the frustum that the normal cones reject
+            const Uint32 NumTested = m_Stats.VisibleMeshlets + m_Stats.ConeCulledMeshlets;
+            ImGui::Text("Cone rejection: %.1f%%", NumTested > 0 ? 100.0 * m_Stats.ConeCulledMeshlets / NumTested : 0.0);
+        }
+
+        if (ImGui::TreeNode("Meshlets"))
+        {
+            const MeshletStatistics& MS = m_MeshletStats;
+            ImGui::Text("Meshes: %d", MS.NumMeshes);
+            ImGui::Text("Meshlets: %d", MS.NumMeshlets);
+            ImGui::Text("Triangles: %d", MS.NumTriangles);
+            ImGui::Text("Meshlet vertices: %d", MS.NumVertices);
+            if (MS.FromCache)
+            {
+                ImGui::Text("Loaded from cache in %.1f ms", MS.BuildTime * 1000.0);
+            }
+            else
+            {
+                ImGui::Text("Built on %d threads in %.1f ms (%.2f M tri/s)", MS.NumBuildThreads, MS.BuildTime * 1000.0,
+                            MS.BuildTime > 0 ? MS.NumTriangles / MS.BuildTime / 1e6 : 0.0);
+            }
+            if (MS.SingleThreadThroughput > 0)
+            {
+                ImGui::Text("Benchmark: %.2f M tri/s on 1 thread", MS.SingleThreadThroughput / 1e6);
+                ImGui::Text("           %.2f M tri/s on %d threads", MS.ParallelThroughput / 1e6, MS.NumBuildThreads);
+            }
+            ImGui::Text("Expected cone rejection: %.1f%%", MS.ConeCullingRate * 100.0);
+            ImGui::TreePop();
+        }
     }
     ImGui::End();
 }
@@ -354,18 +746,53 @@ void Tutorial20_MeshShader::Initialize(const SampleInitInfo& InitInfo)
     SampleBase::Initialize(InitInfo);
 
     LoadTexture();
-    CreateCube();
-    CreateDrawTasks();
     CreateStatisticsBuffer();
     CreateConstantsBuffer();
     CreatePipelineState();
 }
 
+void Tutorial20_MeshShader::WindowResize(Uint32 Width, Uint32 Height)
+{
+    CreateDepthBuffer();
+}
+
+void Tutorial20_MeshShader::CreateInitializationTasks(AsyncInitTaskGraph& Tasks)
+{
+    // Meshlets are built on the CPU while the app keeps presenting frames
+    const AsyncInitTaskGraph::TaskId MeshletsTask = Tasks.AddTask(
+        "Meshlets", [this]() {
+            CreateMeshes();
+            BuildMeshlets();
+            CreateMeshletBuffers();
+        },
+        {}, 4);
+    Tasks.AddTask("Draw tasks", [this]() { CreateDrawTasks(); }, {MeshletsTask});
+}
+
+void Tutorial20_MeshShader::FinishInitialization()
+{
+    m_pSRB->GetVariableByName(SHADER_TYPE_AMPLIFICATION, "DrawTasks")->Set(m_pDrawTasks->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pSRB->GetVariableByName(SHADER_TYPE_AMPLIFICATION, "Meshes")->Set(m_pMeshes->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pSRB->GetVariableByName(SHADER_TYPE_AMPLIFICATION, "Meshlets")->Set(m_pMeshlets->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pSRB->GetVariableByName(SHADER_TYPE_MESH, "Meshlets")->Set(m_pMeshlets->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pSRB->GetVariableByName(SHADER_TYPE_MESH, "MeshletVertices")->Set(m_pMeshletVertices->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pSRB->GetVariableByName(SHADER_TYPE_MESH, "MeshletTriangles")->Set(m_pMeshletTriangles->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+    m_pSRB->GetVariableByName(SHADER_TYPE_MESH, "Vertices")->Set(m_pVertices->GetDefaultView(BUFFER_VIEW_SHADER_RESOURCE));
+}
+
 // Render a frame
 void Tutorial20_MeshShader::Render()
 {
     ITextureView* pRTV = m_pSwapChain->GetCurrentBackBufferRTV();
-    ITextureView* pDSV = m_pSwapChain->GetDepthBufferDSV();
+    ITextureView* pDSV = m_pDepthBuffer->GetDefaultView(TEXTURE_VIEW_DEPTH_STENCIL);
+
+    // Build the depth pyramid from the depth buffer of the previous frame before it is cleared
+    const bool OcclusionCulling = m_OcclusionCulling && m_PrevDepthValid;
+    if (OcclusionCulling)
+        m_HiZ->Build(m_pImmediateContext);
+
+    m_pImmediateContext->SetRenderTargets(1, &pRTV, pDSV, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
     // Clear the back buffer
     const float ClearColor[] = {0.350f, 0.350f, 0.350f, 1.0f};
     m_pImmediateContext->ClearRenderTarget(pRTV, ClearColor, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
@@ -373,7 +800,6 @@ void Tutorial20_MeshShader::Render()
 
     // Reset statistics
     DrawStatistics stats;
-    std::memset(&stats, 0, sizeof(stats));
     m_pImmediateContext->UpdateBuffer(m_pStatisticsBuffer, 0, sizeof(stats), &stats, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
     m_pImmediateContext->SetPipelineState(m_pPSO);
@@ -382,11 +808,19 @@ void Tutorial20_MeshShader::Render()
     {
         // Map the buffer and write current view, view-projection matrix and other constants.
         MapHelper<Constants> CBConstants(m_pImmediateContext, m_pConstants, MAP_WRITE, MAP_FLAG_DISCARD);
-        CBConstants->ViewMat        = m_ViewMatrix;
-        CBConstants->ViewProjMat    = m_ViewProjMatrix;
-        CBConstants->CoTanHalfFov   = m_LodScale * m_CoTanHalfFov;
-        CBConstants->FrustumCulling = m_FrustumCulling ? 1 : 0;
-        CBConstants->CurrTime       = static_cast<float>(m_CurrTime);
+        CBConstants->ViewMat          = m_ViewMatrix;
+        CBConstants->ViewProjMat      = m_ViewProjMatrix;
+        CBConstants->PrevViewProjMat  = m_PrevViewProjMatrix;
+        CBConstants->CoTanHalfFov     = m_LodScale * m_CoTanHalfFov;
+        CBConstants->FrustumCulling   = m_FrustumCulling ? 1 : 0;
+        CBConstants->ConeCulling      = m_ConeCulling ? 1 : 0;
+        CBConstants->OcclusionCulling = OcclusionCulling ? 1 : 0;
+        CBConstants->CurrTime         = static_cast<float>(m_CurrTime);
+        CBConstants->PrevTime         = m_PrevTime;
+        CBConstants->CameraPos        = float4{m_CameraPos, 1};
+
+        const TextureDesc& DepthDesc = m_pDepthBuffer->GetDesc();
+        CBConstants->DepthBufferSize = float2{static_cast<float>(DepthDesc.Width), static_cast<float>(DepthDesc.Height)};
 
         // Calculate frustum planes from view-projection matrix.
         ViewFrustum Frustum;
@@ -413,7 +847,7 @@ void Tutorial20_MeshShader::Render()
 
     // Copy statistics to staging buffer
     {
-        m_VisibleCubes = 0;
+        m_Stats = DrawStatistics{};
 
         m_pImmediateContext->CopyBuffer(m_pStatisticsBuffer, 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
                                         m_pStatisticsStaging, static_cast<Uint32>(m_FrameId % m_StatisticsHistorySize) * sizeof(DrawStatistics), sizeof(DrawStatistics),
@@ -439,11 +873,16 @@ void Tutorial20_MeshShader::Render()
         {
             MapHelper<DrawStatistics> StagingData(m_pImmediateContext, m_pStatisticsStaging, MAP_READ, MAP_FLAG_DO_NOT_WAIT);
             if (StagingData)
-                m_VisibleCubes = StagingData[AvailableFrameId % m_StatisticsHistorySize].visibleCubes;
+                m_Stats = StagingData[AvailableFrameId % m_StatisticsHistorySize];
         }
 
         ++m_FrameId;
     }
+
+    // The depth buffer now contains this frame
+    m_PrevViewProjMatrix = m_ViewProjMatrix;
+    m_PrevTime           = m_CurrTime;
+    m_PrevDepthValid     = true;
 }
 
 void Tutorial20_MeshShader::Update(double CurrTime, double ElapsedTime, bool DoUpdateUI)
@@ -473,6 +912,10 @@ void Tutorial20_MeshShader::Update(double CurrTime, double ElapsedTime, bool DoU
     // Compute view and view-projection matrices
     m_ViewMatrix     = RotationMatrix * View * SrfPreTransform;
     m_ViewProjMatrix = m_ViewMatrix * Proj;
+
+    // Camera position in world space is the origin of the view space
+    const float4x4 InvView = m_ViewMatrix.Inverse();
+    m_CameraPos            = float3{InvView._41, InvView._42, InvView._43};
 }
 
 } // namespace Diligent
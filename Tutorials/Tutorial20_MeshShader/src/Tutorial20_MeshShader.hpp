@@ -27,8 +27,14 @@
 
 #pragma once
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
+#include "MeshletBuilder.hpp"
+#include "HiZPyramid.hpp"
 
 namespace Diligent
 {
@@ -36,28 +42,84 @@ namespace Diligent
 class Tutorial20_MeshShader final : public SampleBase
 {
 public:
+    virtual CommandLineStatus ProcessCommandLine(int argc, const char* const* argv) override final;
+
     virtual void ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Attribs) override final;
     virtual void Initialize(const SampleInitInfo& InitInfo) override final;
+    virtual void CreateInitializationTasks(AsyncInitTaskGraph& Tasks) override final;
+    virtual void FinishInitialization() override final;
 
     virtual void Render() override final;
     virtual void Update(double CurrTime, double ElapsedTime, bool DoUpdateUI) override final;
+    virtual void WindowResize(Uint32 Width, Uint32 Height) override final;
 
     virtual const Char* GetSampleName() const override final { return "Tutorial20: Mesh shader"; }
 
+    // Indexed triangle list with texture coordinates
+    struct SourceMesh
+    {
+        std::vector<float3> Positions;
+        std::vector<float2> UVs;
+        std::vector<Uint32> Indices;
+    };
+
 protected:
     virtual void UpdateUI() override final;
 
 private:
     void CreatePipelineState();
-    void CreateCube();
+    void CreateMeshes();
+    void BuildMeshlets();
+    void RunMeshletBenchmark(const std::vector<MeshletSourceMesh>& SourceMeshes, const MeshletBuilder::Settings& BuilderSettings);
+    void CreateMeshletBuffers();
     void CreateDrawTasks();
     void CreateStatisticsBuffer();
     void CreateConstantsBuffer();
+    void CreateDepthBuffer();
     void LoadTexture();
 
-    RefCntAutoPtr<IBuffer>      m_CubeBuffer;
+    // Source meshes and their meshlets are released once the buffers are created
+    std::vector<SourceMesh>  m_SourceMeshes;
+    std::vector<MeshletMesh> m_MeshletMeshes;
+
+    RefCntAutoPtr<IBuffer> m_pMeshes;
+    RefCntAutoPtr<IBuffer> m_pMeshlets;
+    RefCntAutoPtr<IBuffer> m_pMeshletVertices;
+    RefCntAutoPtr<IBuffer> m_pMeshletTriangles;
+    RefCntAutoPtr<IBuffer> m_pVertices;
+
     RefCntAutoPtr<ITextureView> m_CubeTextureSRV;
 
+    // Meshlets are loaded from the cache file unless it is outdated or m_RebuildMeshlets is true
+    std::string m_MeshletCachePath;
+    bool        m_RebuildMeshlets = false;
+
+    // Number of times the meshlets are built to measure the build throughput, or 0 to skip the benchmark
+    int m_MeshletBenchmarkRuns = 0;
+
+    // Draw procedural spheres, tori and torus knots along with the cube. By default, the scene only
+    // contains cubes and is the same as the scene without meshlets.
+    bool m_ProceduralMeshes = false;
+
+    struct MeshletStatistics
+    {
+        Uint32 NumMeshes    = 0;
+        Uint32 NumMeshlets  = 0;
+        Uint32 NumTriangles = 0;
+        Uint32 NumVertices  = 0;
+        bool   FromCache    = false;
+        double BuildTime    = 0;
+
+        // Triangles per second built by one thread and by all threads, measured by the benchmark
+        double SingleThreadThroughput = 0;
+        double ParallelThroughput     = 0;
+        Uint32 NumBuildThreads        = 0;
+
+        // Fraction of meshlets that cone culling rejects for cameras around the meshes
+        double ConeCullingRate = 0;
+    };
+    MeshletStatistics m_MeshletStats;
+
     RefCntAutoPtr<IBuffer> m_pStatisticsBuffer;
     RefCntAutoPtr<IBuffer> m_pStatisticsStaging;
     RefCntAutoPtr<IFence>  m_pStatisticsAvailable;
@@ -66,6 +128,9 @@ private:
 
     static constexpr Int32 ASGroupSize = 32;
 
+    // The number of meshlets of every mesh, see CreateDrawTasks()
+    std::vector<Uint32> m_MeshNumMeshlets;
+
     Uint32                 m_DrawTaskCount = 0;
     RefCntAutoPtr<IBuffer> m_pDrawTasks;
     RefCntAutoPtr<IBuffer> m_pConstants;
@@ -73,17 +138,39 @@ private:
     RefCntAutoPtr<IPipelineState>         m_pPSO;
     RefCntAutoPtr<IShaderResourceBinding> m_pSRB;
 
+    // The scene is rendered into its own depth buffer, which the depth pyramid of the next frame is built from
+    RefCntAutoPtr<ITexture>     m_pDepthBuffer;
+    std::unique_ptr<HiZPyramid> m_HiZ;
+
+    // View-projection matrix and time of the frame that the depth buffer contains
+    float4x4 m_PrevViewProjMatrix;
+    float    m_PrevTime       = 0;
+    bool     m_PrevDepthValid = false;
+
     float4x4    m_ViewProjMatrix;
     float4x4    m_ViewMatrix;
-    float       m_RotationAngle  = 0;
-    bool        m_Animate        = true;
-    bool        m_FrustumCulling = true;
-    const float m_FOV            = PI_F / 4.0f;
-    const float m_CoTanHalfFov   = 1.0f / std::tan(m_FOV * 0.5f);
-    float       m_LodScale       = 4.0f;
-    float       m_CameraHeight   = 10.0f;
-    float       m_CurrTime       = 0.0f;
-    Uint32      m_VisibleCubes   = 0;
+    float3      m_CameraPos;
+    float       m_RotationAngle    = 0;
+    bool        m_Animate          = true;
+    bool        m_FrustumCulling   = true;
+    bool        m_ConeCulling      = true;
+    bool        m_OcclusionCulling = true;
+    const float m_FOV              = PI_F / 4.0f;
+    const float m_CoTanHalfFov     = 1.0f / std::tan(m_FOV * 0.5f);
+    float       m_LodScale         = 4.0f;
+    float       m_CameraHeight     = 10.0f;
+    float       m_CurrTime         = 0.0f;
+
+    struct DrawStatistics
+    {
+        Uint32 VisibleObjects         = 0;
+        Uint32 FrustumCulledObjects   = 0;
+        Uint32 OcclusionCulledObjects = 0;
+        Uint32 VisibleMeshlets        = 0;
+        Uint32 FrustumCulledMeshlets  = 0;
+        Uint32 ConeCulledMeshlets     = 0;
+    };
+    DrawStatistics m_Stats;
 };
 
 } // namespace Diligent
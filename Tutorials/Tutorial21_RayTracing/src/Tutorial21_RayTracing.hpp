@@ -34,10 +34,13 @@
 namespace Diligent
 {
 
+namespace
+{
 namespace HLSL
 {
 #include "../assets/structures.fxh"
 }
+} // namespace
 
 class Tutorial21_RayTracing final : public SampleBase
 {
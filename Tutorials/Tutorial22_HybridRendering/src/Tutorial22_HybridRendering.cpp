@@ -24,6 +24,9 @@
  *  of the possibility of such damages.
  */
 
+#include <algorithm>
+#include <cstring>
+
 #include "Tutorial22_HybridRendering.hpp"
 
 #include "MapHelper.hpp"
@@ -307,6 +310,9 @@ void Tutorial22_HybridRendering::CreateSceneObjects(const uint2 CubeMaterialRang
     }
     InstObj.NumObjects = static_cast<Uint32>(m_Scene.Objects.size()) - InstObj.ObjectAttribsOffset;
     m_Scene.ObjectInstances.push_back(InstObj);
+
+    // Every dynamic object is added at most once per frame, so moved objects never reallocate
+    m_Scene.MovedObjects.reserve(m_Scene.DynamicObjects.size());
 }
 
 void Tutorial22_HybridRendering::CreateSceneAccelStructs()
@@ -393,6 +399,14 @@ void Tutorial22_HybridRendering::CreateSceneAccelStructs()
     }
 }
 
+// ModelMat is stored transposed for shaders, so its first three rows are exactly
+// the 3x4 row-major matrix expected by the TLAS instance.
+static void SetInstanceTransform(InstanceMatrix& Transform, const float4x4& TransposedModelMat)
+{
+    static_assert(sizeof(Transform.data) == sizeof(float) * 12, "Unexpected instance matrix size");
+    std::memcpy(Transform.data, TransposedModelMat.Data(), sizeof(Transform.data));
+}
+
 void Tutorial22_HybridRendering::UpdateTLAS()
 {
     const Uint32 NumInstances = static_cast<Uint32>(m_Scene.Objects.size());
@@ -422,28 +436,42 @@ void Tutorial22_HybridRendering::UpdateTLAS()
     }
 
     // Setup instances
-    std::vector<TLASBuildInstanceData> Instances(NumInstances);
-    std::vector<String>                InstanceNames(NumInstances);
-    for (Uint32 i = 0; i < NumInstances; ++i)
+    if (m_Scene.TLASInstances.empty())
     {
-        const HLSL::ObjectAttribs& Obj      = m_Scene.Objects[i];
-        TLASBuildInstanceData&     Inst     = Instances[i];
-        std::string&               Name     = InstanceNames[i];
-        const Mesh&                mesh     = m_Scene.Meshes[Obj.MeshId];
-        const float4x4             ModelMat = Obj.ModelMat.Transpose();
+        m_Scene.TLASInstances.resize(NumInstances);
+        m_Scene.TLASInstanceNames.resize(NumInstances);
+        for (Uint32 i = 0; i < NumInstances; ++i)
+        {
+            const HLSL::ObjectAttribs& Obj  = m_Scene.Objects[i];
+            TLASBuildInstanceData&     Inst = m_Scene.TLASInstances[i];
+            String&                    Name = m_Scene.TLASInstanceNames[i];
+            const Mesh&                mesh = m_Scene.Meshes[Obj.MeshId];
 
-        Name = mesh.Name + " Instance (" + std::to_string(i) + ")";
+            Name = mesh.Name + " Instance (" + std::to_string(i) + ")";
 
-        Inst.InstanceName = Name.c_str();
-        Inst.pBLAS        = mesh.BLAS;
-        Inst.Mask         = 0xFF;
+            Inst.InstanceName = Name.c_str();
+            Inst.pBLAS        = mesh.BLAS;
+            Inst.Mask         = 0xFF;
 
-        // CustomId will be read in shader by RayQuery::CommittedInstanceID()
-        Inst.CustomId = i;
+            // CustomId will be read in shader by RayQuery::CommittedInstanceID()
+            Inst.CustomId = i;
 
-        Inst.Transform.SetRotation(ModelMat.Data(), 4);
-        Inst.Transform.SetTranslation(ModelMat.m30, ModelMat.m31, ModelMat.m32);
+            SetInstanceTransform(Inst.Transform, Obj.ModelMat);
+        }
+    }
+    else if (m_Scene.MovedObjects.empty())
+    {
+        // Nothing changed since the last build or update
+        return;
     }
+    else
+    {
+        for (Uint32 i : m_Scene.MovedObjects)
+            SetInstanceTransform(m_Scene.TLASInstances[i].Transform, m_Scene.Objects[i].ModelMat);
+    }
+    m_Scene.MovedObjects.clear();
+    for (DynamicObject& DynObj : m_Scene.DynamicObjects)
+        DynObj.Moved = false;
 
     // Build  TLAS
     BuildTLASAttribs Attribs;
@@ -459,7 +487,7 @@ void Tutorial22_HybridRendering::UpdateTLAS()
     Attribs.pInstanceBuffer = m_Scene.TLASInstancesBuffer;
 
     // Instances will be converted to the format that is required by the graphics driver and copied to the instance buffer.
-    Attribs.pInstances    = Instances.data();
+    Attribs.pInstances    = m_Scene.TLASInstances.data();
     Attribs.InstanceCount = NumInstances;
 
     // Allow engine to change resource states.
@@ -849,9 +877,24 @@ void Tutorial22_HybridRendering::Render()
         GConst.AmbientLight = 0.1f;
         m_pImmediateContext->UpdateBuffer(m_Constants, 0, static_cast<Uint32>(sizeof(GConst)), &GConst, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-        // Update transformation for scene objects
-        m_pImmediateContext->UpdateBuffer(m_Scene.ObjectAttribsBuffer, 0, static_cast<Uint32>(sizeof(HLSL::ObjectAttribs) * m_Scene.Objects.size()),
-                                          m_Scene.Objects.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        // Update transformation for scene objects.
+        // All objects are uploaded before the first TLAS build, after that only objects that moved.
+        if (m_Scene.TLASInstances.empty())
+        {
+            m_pImmediateContext->UpdateBuffer(m_Scene.ObjectAttribsBuffer, 0, static_cast<Uint32>(sizeof(HLSL::ObjectAttribs) * m_Scene.Objects.size()),
+                                              m_Scene.Objects.data(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        }
+        else if (!m_Scene.MovedObjects.empty())
+        {
+            // Dynamic objects are stored next to each other, so a single update of the range that covers
+            // all moved objects is cheaper than one update per object. Objects in the range that did
+            // not move are rewritten with the same data.
+            const auto   MinMax      = std::minmax_element(m_Scene.MovedObjects.begin(), m_Scene.MovedObjects.end());
+            const Uint32 FirstObject = *MinMax.first;
+            const Uint32 NumObjects  = *MinMax.second - FirstObject + 1;
+            m_pImmediateContext->UpdateBuffer(m_Scene.ObjectAttribsBuffer, sizeof(HLSL::ObjectAttribs) * FirstObject, static_cast<Uint32>(sizeof(HLSL::ObjectAttribs) * NumObjects),
+                                              &m_Scene.Objects[FirstObject], RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+        }
     }
 
     UpdateTLAS();
@@ -954,6 +997,9 @@ void Tutorial22_HybridRendering::Update(double CurrTime, double ElapsedTime, boo
     }
 
     // Update dynamic objects
+    if (dt == 0.f)
+        return;
+
     float RotationSpeed = 0.15f;
     for (DynamicObject& DynObj : m_Scene.DynamicObjects)
     {
@@ -963,6 +1009,12 @@ void Tutorial22_HybridRendering::Update(double CurrTime, double ElapsedTime, boo
         Obj.ModelMat  = (float4x4::RotationY(PI_F * dt * RotationSpeed) * ModelMat).Transpose();
         Obj.NormalMat = float4x3{Obj.ModelMat};
 
+        if (!DynObj.Moved)
+        {
+            m_Scene.MovedObjects.push_back(DynObj.ObjectAttribsIndex);
+            DynObj.Moved = true;
+        }
+
         RotationSpeed *= 1.5f;
     }
 }
@@ -143,14 +143,16 @@ private:
 
     struct DynamicObject
     {
-        Uint32 ObjectAttribsIndex = 0; // Index in m_Scene.ObjectAttribsBuffer
+        Uint32 ObjectAttribsIndex = 0;     // Index in m_Scene.ObjectAttribsBuffer
+        bool   Moved              = false; // True if the object is in m_Scene.MovedObjects
     };
 
     struct Scene
     {
         std::vector<InstancedObjects>    ObjectInstances;
         std::vector<DynamicObject>       DynamicObjects;
-        std::vector<HLSL::ObjectAttribs> Objects; // CPU-visible array of HLSL::ObjectAttribs
+        std::vector<HLSL::ObjectAttribs> Objects;      // CPU-visible array of HLSL::ObjectAttribs
+        std::vector<Uint32>              MovedObjects; // Indices in Objects that changed transformation since the last frame
 
         // Resources used by shaders
         std::vector<Mesh>                    Meshes;
@@ -164,6 +166,10 @@ private:
         RefCntAutoPtr<ITopLevelAS> TLAS;
         RefCntAutoPtr<IBuffer>     TLASInstancesBuffer; // Used to update TLAS
         RefCntAutoPtr<IBuffer>     TLASScratchBuffer;   // Used to update TLAS
+
+        // Persistent TLAS instances, only transformations of moved objects are updated every frame
+        std::vector<TLASBuildInstanceData> TLASInstances;
+        std::vector<String>                TLASInstanceNames; // Instance names are created once as TLAS keeps name to instance mapping
     };
     Scene m_Scene;
 
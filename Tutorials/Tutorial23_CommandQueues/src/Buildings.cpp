@@ -27,19 +27,20 @@
 #include <random>
 
 #include "Buildings.hpp"
+#include "TextureKernels.hpp"
 #include "MapHelper.hpp"
 #include "PlatformMisc.hpp"
+#include "Timer.hpp"
 
 namespace Diligent
 {
+namespace
+{
 namespace HLSL
 {
 #include "../assets/Structures.fxh"
 }
 
-namespace
-{
-
 float2 Hash22(const float2 p)
 {
     float3 p3 = float3{Frac(p.x * 0.1031f), Frac(p.y * 0.1030f), Frac(p.x * 0.0973f)};
@@ -856,49 +857,49 @@ static constexpr Uint32 NeonLineWithBorder = NeonLineBorder1 + NeonLineSize + Ne
 
 static void GenWallTexture(Uint32* Pixels, const Uint32 W, const Uint32 H, const Uint32 Hash)
 {
-    for (Uint32 y = 0; y < H; ++y)
-    {
-        for (Uint32 x = 0; x < W; ++x)
-        {
-            Pixels[x + y * W] = WallColor;
-        }
-    }
+    FillPixelsRGBA8(Pixels, size_t{W} * size_t{H}, WallColor);
 }
 
-static void GenWallAndRightNeonLineTexture(Uint32* Pixels, const Uint32 W, const Uint32 H, const Uint32 Hash, const Uint32 Hash2)
+static Uint32 GetNeonColor(const Uint32 Hash2)
 {
-    GenWallTexture(Pixels, W, H, Hash);
-
     Uint32 ColIndex = Hash2 ^ (Hash2 >> 4);
     ColIndex        = ColIndex % _countof(NeonColors);
+    return NeonColors[ColIndex];
+}
+
+// Overwrites the right NeonLineWithBorder columns of every row with the neon line.
+static void AddRightNeonLine(Uint32* Pixels, const Uint32 W, const Uint32 H, const Uint32 Hash2)
+{
+    const Uint32 NeonColor = GetNeonColor(Hash2);
 
     for (Uint32 y = 0; y < H; ++y)
     {
-        for (Uint32 x = W - NeonLineWithBorder; x < W; ++x)
-        {
-            const Uint32 lx   = x - (W - NeonLineWithBorder);
-            const Uint32 col  = (lx >= NeonLineBorder1 && lx < NeonLineBorder1 + NeonLineSize) ? NeonColors[ColIndex] : WallColor;
-            Pixels[x + y * W] = col;
-        }
+        Uint32* Row = &Pixels[(W - NeonLineWithBorder) + y * W];
+        FillPixelsRGBA8(Row, NeonLineBorder1, WallColor);
+        FillPixelsRGBA8(Row + NeonLineBorder1, NeonLineSize, NeonColor);
+        FillPixelsRGBA8(Row + NeonLineBorder1 + NeonLineSize, NeonLineBorder2, WallColor);
     }
 }
 
-static void GenWallAndTopNeonLineTexture(Uint32* Pixels, const Uint32 W, const Uint32 H, const Uint32 Hash, const Uint32 Hash2)
+// Overwrites the top NeonLineWithBorder rows with the neon line.
+static void AddTopNeonLine(Uint32* Pixels, const Uint32 W, const Uint32 H, const Uint32 Hash2)
 {
-    GenWallTexture(Pixels, W, H, Hash);
+    Uint32* Rows = &Pixels[(H - NeonLineWithBorder) * W];
+    FillPixelsRGBA8(Rows, size_t{W} * NeonLineBorder1, WallColor);
+    FillPixelsRGBA8(Rows + W * NeonLineBorder1, size_t{W} * NeonLineSize, GetNeonColor(Hash2));
+    FillPixelsRGBA8(Rows + W * (NeonLineBorder1 + NeonLineSize), size_t{W} * NeonLineBorder2, WallColor);
+}
 
-    Uint32 ColIndex = Hash2 ^ (Hash2 >> 4);
-    ColIndex        = ColIndex % _countof(NeonColors);
+static void GenWallAndRightNeonLineTexture(Uint32* Pixels, const Uint32 W, const Uint32 H, const Uint32 Hash, const Uint32 Hash2)
+{
+    GenWallTexture(Pixels, W, H, Hash);
+    AddRightNeonLine(Pixels, W, H, Hash2);
+}
 
-    for (Uint32 y = H - NeonLineWithBorder; y < H; ++y)
-    {
-        for (Uint32 x = 0; x < W; ++x)
-        {
-            const Uint32 ly   = y - (H - NeonLineWithBorder);
-            const Uint32 col  = (ly >= NeonLineBorder1 && ly < NeonLineBorder1 + NeonLineSize) ? NeonColors[ColIndex] : WallColor;
-            Pixels[x + y * W] = col;
-        }
-    }
+static void GenWallAndTopNeonLineTexture(Uint32* Pixels, const Uint32 W, const Uint32 H, const Uint32 Hash, const Uint32 Hash2)
+{
+    GenWallTexture(Pixels, W, H, Hash);
+    AddTopNeonLine(Pixels, W, H, Hash2);
 }
 
 inline Uint32 Combine(Uint32 Lhs, Uint32 Rhs)
@@ -908,29 +909,43 @@ inline Uint32 Combine(Uint32 Lhs, Uint32 Rhs)
 
 static void GenWindowsTexture(Uint32* Pixels, const Uint32 W, const Uint32 H, const Uint32 Hash)
 {
-    const Uint32 WndOffsetX = (WindowWithBorderSizePx - WindowSizePxX) / 2;
+    // FillBlockRowRGBA8() writes 16-pixel blocks with 8-pixel window in the middle.
+    static_assert(WindowWithBorderSizePx == 16 && WindowSizePxX == 8, "Window size does not match FillBlockRowRGBA8()");
+    VERIFY_EXPR(W % WindowWithBorderSizePx == 0);
+
     const Uint32 WndOffsetY = (WindowWithBorderSizePx - WindowSizePxY) / 2;
+    const Uint32 NumBlocks  = W / WindowWithBorderSizePx;
 
     for (Uint32 y = 0; y < H; ++y)
     {
-        for (Uint32 x = 0; x < W; ++x)
-        {
-            Uint32 col = WallColor;
+        Uint32*      Row = &Pixels[y * W];
+        const Uint32 ly  = y % WindowWithBorderSizePx;
 
-            Uint32 lx = x % WindowWithBorderSizePx;
-            Uint32 ly = y % WindowWithBorderSizePx;
-
-            if ((lx >= WndOffsetX && lx < WindowSizePxX + WndOffsetX) &&
-                (ly >= WndOffsetY && ly < WindowSizePxY + WndOffsetY))
+        if (ly < WndOffsetY || ly >= WindowSizePxY + WndOffsetY)
+        {
+            FillPixelsRGBA8(Row, W, WallColor);
+        }
+        else if (ly == WndOffsetY)
+        {
+            Uint32 BlockColors[64];
+            for (Uint32 FirstBlock = 0; FirstBlock < NumBlocks; FirstBlock += _countof(BlockColors))
             {
-                Uint32 ColIndex = Combine(0u, (x / WindowWithBorderSizePx) * 0x5a2);
-                ColIndex        = Combine(ColIndex, (y / WindowWithBorderSizePx) * 0x9e3);
-                ColIndex        = Combine(ColIndex, Hash * 0x681);
+                const Uint32 Count = std::min(NumBlocks - FirstBlock, static_cast<Uint32>(_countof(BlockColors)));
+                for (Uint32 b = 0; b < Count; ++b)
+                {
+                    Uint32 ColIndex = Combine(0u, (FirstBlock + b) * 0x5a2);
+                    ColIndex        = Combine(ColIndex, (y / WindowWithBorderSizePx) * 0x9e3);
+                    ColIndex        = Combine(ColIndex, Hash * 0x681);
 
-                col = WindowColors[ColIndex % _countof(WindowColors)];
+                    BlockColors[b] = WindowColors[ColIndex % _countof(WindowColors)];
+                }
+                FillBlockRowRGBA8(Row + FirstBlock * WindowWithBorderSizePx, Count, BlockColors, WallColor);
             }
-
-            Pixels[x + y * W] = col;
+        }
+        else
+        {
+            // All rows of the window are identical
+            memcpy(Row, Row - W, size_t{W} * 4);
         }
     }
 }
@@ -938,37 +953,13 @@ static void GenWindowsTexture(Uint32* Pixels, const Uint32 W, const Uint32 H, co
 static void GenWindowsAndRightNeonLineTexture(Uint32* Pixels, const Uint32 W, const Uint32 H, const Uint32 Hash, const Uint32 Hash2)
 {
     GenWindowsTexture(Pixels, W, H, Hash);
-
-    Uint32 ColIndex = Hash2 ^ (Hash2 >> 4);
-    ColIndex        = ColIndex % _countof(NeonColors);
-
-    for (Uint32 y = 0; y < H; ++y)
-    {
-        for (Uint32 x = W - NeonLineWithBorder; x < W; ++x)
-        {
-            const Uint32 lx   = x - (W - NeonLineWithBorder);
-            const Uint32 col  = (lx >= NeonLineBorder1 && lx < NeonLineBorder1 + NeonLineSize) ? NeonColors[ColIndex] : WallColor;
-            Pixels[x + y * W] = col;
-        }
-    }
+    AddRightNeonLine(Pixels, W, H, Hash2);
 }
 
 static void GenWindowsAndTopNeonLineTexture(Uint32* Pixels, const Uint32 W, const Uint32 H, const Uint32 Hash, const Uint32 Hash2)
 {
     GenWindowsTexture(Pixels, W, H, Hash);
-
-    Uint32 ColIndex = Hash2 ^ (Hash2 >> 4);
-    ColIndex        = ColIndex % _countof(NeonColors);
-
-    for (Uint32 y = H - NeonLineWithBorder; y < H; ++y)
-    {
-        for (Uint32 x = 0; x < W; ++x)
-        {
-            const Uint32 ly   = y - (H - NeonLineWithBorder);
-            const Uint32 col  = (ly >= NeonLineBorder1 && ly < NeonLineBorder1 + NeonLineSize) ? NeonColors[ColIndex] : WallColor;
-            Pixels[x + y * W] = col;
-        }
-    }
+    AddTopNeonLine(Pixels, W, H, Hash2);
 }
 
 static void GenMipmap(const Uint32* SrcPixels, const Uint32 SrcW, const Uint32 SrcH, Uint32* DstPixels, const Uint32 DstW, const Uint32 DstH)
@@ -977,21 +968,7 @@ static void GenMipmap(const Uint32* SrcPixels, const Uint32 SrcW, const Uint32 S
 
     for (Uint32 y = 0; y < DstH; ++y)
     {
-        for (Uint32 x = 0; x < DstW; ++x)
-        {
-            float4 c0  = RGBA8Unorm_To_F4Color(SrcPixels[(x * 2 + 0) + (y * 2 + 0) * SrcW]);
-            float4 c1  = RGBA8Unorm_To_F4Color(SrcPixels[(x * 2 + 1) + (y * 2 + 0) * SrcW]);
-            float4 c2  = RGBA8Unorm_To_F4Color(SrcPixels[(x * 2 + 0) + (y * 2 + 1) * SrcW]);
-            float4 c3  = RGBA8Unorm_To_F4Color(SrcPixels[(x * 2 + 1) + (y * 2 + 1) * SrcW]);
-            float4 col = (c0 + c1 + c2 + c3) * 0.25f;
-
-            // disable self-emission
-            Uint32 NumEmissionPix = (c0.a > 0.f) + (c1.a > 0.f) + (c2.a > 0.f) + (c3.a > 0.f);
-            if (NumEmissionPix <= 2)
-                col.a = 0.f;
-
-            DstPixels[x + y * DstW] = F4Color_To_RGBA8Unorm(col);
-        }
+        DownsampleRowRGBA8(&SrcPixels[(y * 2 + 0) * SrcW], &SrcPixels[(y * 2 + 1) * SrcW], &DstPixels[y * DstW], DstW);
     }
 }
 
@@ -1019,6 +996,27 @@ static void GenTexture(Uint32* Pixels, Uint32 Width, Uint32 Height, Uint32 Slice
     }
 }
 
+// Generates the slice with the full mip chain, mip levels are tightly packed one after another.
+static void GenTextureWithMipmaps(Uint32* Pixels, const TextureDesc& TexDesc, Uint32 Slice, Uint32 CurrTime)
+{
+    GenTexture(Pixels, TexDesc.Width, TexDesc.Height, Slice, CurrTime);
+
+    Uint32 SrcOffset = 0;
+    for (Uint32 Mipmap = 1; Mipmap < TexDesc.MipLevels; ++Mipmap)
+    {
+        const Uint32* SrcPixels = &Pixels[SrcOffset];
+        const Uint32  SrcW      = std::max(1u, TexDesc.Width >> (Mipmap - 1));
+        const Uint32  SrcH      = std::max(1u, TexDesc.Height >> (Mipmap - 1));
+        const Uint32  DstOffset = SrcOffset + SrcW * SrcH;
+        Uint32*       DstPixels = &Pixels[DstOffset];
+        const Uint32  DstW      = std::max(1u, TexDesc.Width >> Mipmap);
+        const Uint32  DstH      = std::max(1u, TexDesc.Height >> Mipmap);
+
+        GenMipmap(SrcPixels, SrcW, SrcH, DstPixels, DstW, DstH);
+        SrcOffset = DstOffset;
+    }
+}
+
 
 void Buildings::UpdateAtlas(IDeviceContext* pContext, Uint32 RequiredTransferRateMb, Uint32& ActualTransferRateMb)
 {
@@ -1146,24 +1144,11 @@ void Buildings::ThreadProc()
             TaskStatus Expected = TaskStatus::NewTask;
             if (m_GenTexTask.Status.compare_exchange_weak(Expected, TaskStatus::GenTex, std::memory_order_acquire, std::memory_order_relaxed))
             {
-                const TextureDesc& TexDesc   = m_OpaqueTexAtlas->GetDesc();
-                const Uint32       Slice     = m_GenTexTask.ArraySlice;
-                Uint32             SrcOffset = 0;
-                GenTexture(&m_GenTexTask.Pixels[SrcOffset], TexDesc.Width, TexDesc.Height, Slice, m_GenTexTask.Time);
+                const TextureDesc& TexDesc = m_OpaqueTexAtlas->GetDesc();
 
-                for (Uint32 Mipmap = 1; Mipmap < TexDesc.MipLevels; ++Mipmap)
-                {
-                    const Uint32* SrcPixels = &m_GenTexTask.Pixels[SrcOffset];
-                    const Uint32  SrcW      = std::max(1u, TexDesc.Width >> (Mipmap - 1));
-                    const Uint32  SrcH      = std::max(1u, TexDesc.Height >> (Mipmap - 1));
-                    const Uint32  DstOffset = SrcOffset + SrcW * SrcH;
-                    Uint32*       DstPixels = &m_GenTexTask.Pixels[DstOffset];
-                    const Uint32  DstW      = std::max(1u, TexDesc.Width >> Mipmap);
-                    const Uint32  DstH      = std::max(1u, TexDesc.Height >> Mipmap);
-
-                    GenMipmap(SrcPixels, SrcW, SrcH, DstPixels, DstW, DstH);
-                    SrcOffset = DstOffset;
-                }
+                Timer GenTimer;
+                GenTextureWithMipmaps(m_GenTexTask.Pixels.data(), TexDesc, m_GenTexTask.ArraySlice, m_GenTexTask.Time);
+                m_GenTexTime.store(GenTimer.GetElapsedTime(), std::memory_order_relaxed);
 
                 // Change status to 'TexReady' and flush CPU cache to make local changes visible for other threads.
                 const TaskStatus OldStatus = m_GenTexTask.Status.exchange(TaskStatus::TexReady, std::memory_order_release);
@@ -1182,23 +1167,31 @@ void Buildings::GenerateOpaqueTexture()
 
     for (Uint32 Slice = 0; Slice < TexDesc.ArraySize; ++Slice)
     {
-        Uint32 SrcOffset = (m_OpaqueTexAtlasSliceSize / 4) * Slice;
-        GenTexture(&m_OpaqueTexAtlasPixels[SrcOffset], TexDesc.Width, TexDesc.Height, Slice, 0u);
+        GenTextureWithMipmaps(&m_OpaqueTexAtlasPixels[(m_OpaqueTexAtlasSliceSize / 4) * Slice], TexDesc, Slice, 0u);
+    }
+}
 
-        for (Uint32 Mipmap = 1; Mipmap < TexDesc.MipLevels; ++Mipmap)
-        {
-            const Uint32* SrcPixels = &m_OpaqueTexAtlasPixels[SrcOffset];
-            const Uint32  SrcW      = std::max(1u, TexDesc.Width >> (Mipmap - 1));
-            const Uint32  SrcH      = std::max(1u, TexDesc.Height >> (Mipmap - 1));
-            const Uint32  DstOffset = SrcOffset + SrcW * SrcH;
-            Uint32*       DstPixels = &m_OpaqueTexAtlasPixels[DstOffset];
-            const Uint32  DstW      = std::max(1u, TexDesc.Width >> Mipmap);
-            const Uint32  DstH      = std::max(1u, TexDesc.Height >> Mipmap);
-
-            GenMipmap(SrcPixels, SrcW, SrcH, DstPixels, DstW, DstH);
-            SrcOffset = DstOffset;
-        }
+double Buildings::BenchmarkTextureGeneration(Uint32 NumSlices) const
+{
+    const TextureDesc& TexDesc = m_OpaqueTexAtlas->GetDesc();
+
+    std::vector<Uint32> Pixels(m_OpaqueTexAtlasSliceSize / 4);
+
+    Timer BenchTimer;
+    for (Uint32 i = 0; i < NumSlices; ++i)
+    {
+        GenTextureWithMipmaps(Pixels.data(), TexDesc, i % TexDesc.ArraySize, i);
     }
+    const double Elapsed = BenchTimer.GetElapsedTime();
+
+    const double GeneratedMb = static_cast<double>(NumSlices) * m_OpaqueTexAtlasSliceSize / double{1 << 20};
+    return Elapsed > 0.0 ? GeneratedMb / Elapsed : 0.0;
+}
+
+double Buildings::GetTextureGenerationRateMb() const
+{
+    const double GenTime = m_GenTexTime.load(std::memory_order_relaxed);
+    return GenTime > 0.0 ? m_OpaqueTexAtlasSliceSize / double{1 << 20} / GenTime : 0.0;
 }
 
 } // namespace Diligent
@@ -60,6 +60,12 @@ public:
         return TexDesc.Width * TexDesc.Height * TexDesc.ArraySize * 4;
     }
 
+    // Generates NumSlices atlas slices with mipmaps on the calling thread and returns the throughput in Mb/s.
+    double BenchmarkTextureGeneration(Uint32 NumSlices) const;
+
+    // Returns the throughput of the async texture generation thread in Mb/s.
+    double GetTextureGenerationRateMb() const;
+
 private:
     void GenerateOpaqueTexture();
     void ThreadProc();
@@ -100,9 +106,10 @@ private:
         Uint32                  ArraySlice = 0;
         Uint32                  Time       = 0;
     };
-    GenTexTask        m_GenTexTask;
-    std::thread       m_GenTexThread;
-    std::atomic<bool> m_GenTexThreadLooping{false};
+    GenTexTask          m_GenTexTask;
+    std::thread         m_GenTexThread;
+    std::atomic<bool>   m_GenTexThreadLooping{false};
+    std::atomic<double> m_GenTexTime{0.0}; // time in seconds to generate the last slice
 
 #if USE_STAGING_TEXTURE
     RefCntAutoPtr<ITexture> m_OpaqueTexAtlasStaging;
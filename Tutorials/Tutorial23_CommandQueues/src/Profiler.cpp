@@ -33,6 +33,23 @@ namespace Diligent
 static constexpr float GraphWidth  = 500.f;
 static constexpr float GraphHeight = 100.f;
 
+static const char* GetPassName(Profiler::PASS_TYPE PassType)
+{
+    switch (PassType)
+    {
+        // clang-format off
+        case Profiler::FRAME:      return "Frame";
+        case Profiler::GRAPHICS_1: return "Graphics pass 1";
+        case Profiler::GRAPHICS_2: return "Graphics pass 2";
+        case Profiler::COMPUTE:    return "Compute pass";
+        case Profiler::TRANSFER:   return "Transfer pass";
+        // clang-format on
+        default:
+            UNEXPECTED("Unknown pass type");
+            return "";
+    }
+}
+
 void Profiler::Initialize(IRenderDevice* pDevice)
 {
     m_Device  = pDevice;
@@ -58,6 +75,28 @@ void Profiler::Initialize(IRenderDevice* pDevice)
         m_Device->CreateQuery(queryDesc, &frame.Transfer.GpuTimeQueryBegin);
         m_Device->CreateQuery(queryDesc, &frame.Transfer.GpuTimeQueryEnd);
     }
+
+    m_Timeline.Initialize(pDevice);
+}
+
+void Profiler::AddContext(IDeviceContext* pContext, const char* Name)
+{
+    m_Timeline.AddContext(pContext, Name);
+}
+
+void Profiler::CalibrateClocks()
+{
+    m_Timeline.Calibrate();
+}
+
+void Profiler::BeginScope(IDeviceContext* pContext, const char* Name)
+{
+    m_Timeline.BeginScope(pContext, Name);
+}
+
+void Profiler::EndScope(IDeviceContext* pContext)
+{
+    m_Timeline.EndScope(pContext);
 }
 
 void Profiler::Begin(IDeviceContext* pContext, PASS_TYPE PassType)
@@ -75,6 +114,8 @@ void Profiler::Begin(IDeviceContext* pContext, PASS_TYPE PassType)
         Pass.CpuTImeBegin = TimePoint::clock::now();
     };
 
+    m_Timeline.BeginScope(pContext, GetPassName(PassType));
+
     Frame& frame = m_FrameHistory[m_FrameId];
     switch (PassType)
     {
@@ -134,6 +175,8 @@ void Profiler::End(IDeviceContext* pContext, PASS_TYPE PassType)
         default:
             UNEXPECTED("Unknown pass type");
     }
+
+    m_Timeline.EndScope(pContext);
 }
 
 void Profiler::SetCpuToGpuTransferRate(Uint32 RateInMb)
@@ -148,6 +191,8 @@ void Profiler::Update(double ElapsedTime)
 
     ++m_FrameId;
 
+    m_Timeline.BeginFrame();
+
     // Read query data
     {
         Frame& frame = m_FrameHistory[m_FrameId];
@@ -260,6 +305,22 @@ void Profiler::Update(double ElapsedTime)
         const double CompTime   = Curr.Compute.GpuTimeEnd - Curr.Compute.GpuTimeBegin;
         const double TransfTime = Curr.Transfer.GpuTimeEnd - Curr.Transfer.GpuTimeBegin;
 
+        // Fraction of the compute pass that overlaps with graphics passes of any frame in the history.
+        // With multiple terrain resource sets, the compute pass may overlap with graphics passes of previous frames.
+        double CompOverlap = 0.0;
+        if (Curr.Compute.Queried && CompTime > 0.0)
+        {
+            const auto Intersect = [&Curr](const PassCounters& p) //
+            {
+                if (!p.Queried)
+                    return 0.0;
+                return std::max(0.0, std::min(Curr.Compute.GpuTimeEnd, p.GpuTimeEnd) - std::max(Curr.Compute.GpuTimeBegin, p.GpuTimeBegin));
+            };
+            for (const Frame& f : m_FrameHistory)
+                CompOverlap += Intersect(f.Graphics1) + Intersect(f.Graphics2);
+            CompOverlap = std::min(CompOverlap / CompTime, 1.0);
+        }
+
         std::stringstream values1_ss;
         values1_ss.precision(1);
         values1_ss.flags(std::ios_base::fixed);
@@ -268,6 +329,7 @@ void Profiler::Update(double ElapsedTime)
         TimeToStr(values1_ss, Curr.Graphics1.GpuTimeBegin - Prev.Graphics1.GpuTimeBegin);
         TimeToStr(values1_ss, Gfx1Time + Gfx2Time);
         TimeToStr(values1_ss, CompTime);
+        values1_ss << (CompOverlap * 100.0) << " %" << std::endl;
         TimeToStr(values1_ss, TransfTime);
         ByteSizeToStr(values1_ss, m_TempCpuToGpuTransferRateMb / ElapsedTime);
         m_GpuCountersStr = values1_ss.str();
@@ -286,6 +348,7 @@ void Profiler::Update(double ElapsedTime)
         values2_ss << "-" << std::endl;
         TimeToStr(values2_ss, CpuGfx1Time + CpuGfx2Time);
         TimeToStr(values2_ss, CpuCompTime);
+        values2_ss << "-" << std::endl;
         TimeToStr(values2_ss, CpuTransfTime);
         m_CpuCountersStr = values2_ss.str();
     }
@@ -392,6 +455,7 @@ void Profiler::UpdateUI()
             params_ss << "Between frames:" << std::endl;
             params_ss << "Graphics pass:" << std::endl;
             params_ss << "Compute pass:" << std::endl;
+            params_ss << "Compute overlap:" << std::endl;
             params_ss << "Upload pass:" << std::endl;
             params_ss << "Transfer rate:" << std::endl;
 
@@ -401,6 +465,22 @@ void Profiler::UpdateUI()
             ImGui::SameLine(0.f, 20.f);
             ImGui::TextDisabled("%s", m_CpuCountersStr.c_str());
         }
+
+        ImGui::Separator();
+        {
+            ImGui::Checkbox("Record timeline", &m_Timeline.Enabled);
+            ImGui::SameLine();
+            ImGui::TextDisabled("%u frames, %u events", static_cast<Uint32>(m_Timeline.GetNumFrames()), m_Timeline.GetNumEvents());
+
+            if (ImGui::Button("Export trace"))
+                m_Timeline.ExportChromeTrace("Tutorial23_Timeline.json");
+            ImGui::SameLine();
+            if (ImGui::Button("Clear"))
+                m_Timeline.Reset();
+            ImGui::SameLine();
+            if (ImGui::Button("Calibrate clocks"))
+                m_Timeline.Calibrate();
+        }
     }
     ImGui::End();
 }
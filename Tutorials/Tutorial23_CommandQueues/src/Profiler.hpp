@@ -29,6 +29,7 @@
 #include <array>
 #include <chrono>
 #include "SampleBase.hpp"
+#include "TimelineRecorder.hpp"
 
 namespace Diligent
 {
@@ -51,8 +52,17 @@ public:
 
     void Initialize(IRenderDevice* pDevice);
 
+    // Adds the context to the timeline. All contexts must be added before they are profiled.
+    void AddContext(IDeviceContext* pContext, const char* Name);
+    // Measures GPU clock offsets of all contexts relative to the CPU clock. Idles the GPU.
+    void CalibrateClocks();
+
     void Begin(IDeviceContext* pContext, PASS_TYPE Pass);
     void End(IDeviceContext* pContext, PASS_TYPE Pass);
+
+    // Named scopes that are only recorded in the timeline.
+    void BeginScope(IDeviceContext* pContext, const char* Name);
+    void EndScope(IDeviceContext* pContext);
     void SetCpuToGpuTransferRate(Uint32 RateInMb);
 
     void UpdateUI();
@@ -113,6 +123,8 @@ private:
     String m_GpuCountersStr;
     String m_CpuCountersStr;
     double m_AccumTime = 0.0;
+
+    TimelineRecorder m_Timeline;
 };
 
 } // namespace Diligent
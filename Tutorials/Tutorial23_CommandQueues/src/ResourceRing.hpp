@@ -0,0 +1,125 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "BasicTypes.h"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+// Ring of resource sets shared between a producer and a consumer that may run in different queues.
+// Every slot remembers the producer fence value that is signaled when the slot has been written
+// and the consumer fence value that is signaled when the slot has been read.
+//
+// The consumer reads the slot that was written Latency writes ago, so the producer may run
+// up to Latency frames ahead of the consumer. The ring must contain at least Latency + 1 slots.
+template <typename SlotDataType>
+class ResourceRing
+{
+public:
+    struct Slot
+    {
+        SlotDataType Data;
+
+        Uint64 WrittenFenceValue = 0; // producer fence value signaled after the slot has been written
+        Uint64 ReadFenceValue    = 0; // consumer fence value signaled after the slot has been read
+        Uint64 WriteIndex        = 0; // sequence number of the last write, 0 if the slot has never been written
+    };
+
+    void Reset(Uint32 Size)
+    {
+        VERIFY_EXPR(Size > 0);
+        m_Slots.clear();
+        m_Slots.resize(Size);
+        m_NumWrites = 0;
+    }
+
+    Uint32 GetSize() const { return static_cast<Uint32>(m_Slots.size()); }
+    Uint32 GetMaxLatency() const { return GetSize() - 1; }
+
+    Slot&       operator[](Uint32 i) { return m_Slots[i]; }
+    const Slot& operator[](Uint32 i) const { return m_Slots[i]; }
+
+    // Returns the slot that the consumer finished reading the longest time ago.
+    // The last Latency written slots are still going to be read and are never returned.
+    // The producer must wait for the ReadFenceValue of the slot before writing to it.
+    Uint32 GetWriteSlot(Uint32 Latency) const
+    {
+        VERIFY(Latency <= GetMaxLatency(), "Not enough slots for the requested latency");
+
+        Uint32 Oldest = ~0u;
+        for (Uint32 i = 0; i < m_Slots.size(); ++i)
+        {
+            const Slot& S = m_Slots[i];
+            if (S.WriteIndex != 0 && S.WriteIndex + Latency > m_NumWrites)
+                continue; // Slot will be read by the consumer
+
+            if (Oldest == ~0u ||
+                S.ReadFenceValue < m_Slots[Oldest].ReadFenceValue ||
+                (S.ReadFenceValue == m_Slots[Oldest].ReadFenceValue && S.WriteIndex < m_Slots[Oldest].WriteIndex))
+                Oldest = i;
+        }
+        VERIFY_EXPR(Oldest != ~0u);
+        return Oldest;
+    }
+
+    void EndWrite(Uint32 SlotInd, Uint64 WrittenFenceValue)
+    {
+        Slot& S             = m_Slots[SlotInd];
+        S.WriteIndex        = ++m_NumWrites;
+        S.WrittenFenceValue = WrittenFenceValue;
+    }
+
+    // Returns the slot written Latency writes ago, or the first written slot if there were not enough writes yet.
+    // The consumer must wait for the WrittenFenceValue of the slot before reading it.
+    Uint32 GetReadSlot(Uint32 Latency) const
+    {
+        VERIFY(m_NumWrites > 0, "No slots have been written");
+        const Uint64 WriteIndex = m_NumWrites > Latency ? m_NumWrites - Latency : 1;
+        for (Uint32 i = 0; i < m_Slots.size(); ++i)
+        {
+            if (m_Slots[i].WriteIndex == WriteIndex)
+                return i;
+        }
+        UNEXPECTED("Slot has been overwritten");
+        return 0;
+    }
+
+    void EndRead(Uint32 SlotInd, Uint64 ReadFenceValue)
+    {
+        m_Slots[SlotInd].ReadFenceValue = ReadFenceValue;
+    }
+
+private:
+    std::vector<Slot> m_Slots;
+    Uint64            m_NumWrites = 0;
+};
+
+} // namespace Diligent
@@ -24,6 +24,8 @@
  *  of the possibility of such damages.
  */
 
+#include <algorithm>
+
 #include "Terrain.hpp"
 #include "TextureUtilities.h"
 #include "ShaderMacroHelper.hpp"
@@ -32,16 +34,18 @@
 
 namespace Diligent
 {
+namespace
+{
 namespace HLSL
 {
 #include "../assets/Structures.fxh"
 }
+} // namespace
 
 using IndexType = Uint32;
 
 void Terrain::Initialize(IRenderDevice* pDevice, IBuffer* pDrawConstants, Uint64 ImmediateContextMask)
 {
-    m_FrameId              = 0;
     m_Device               = pDevice;
     m_DrawConstants        = pDrawConstants;
     m_ImmediateContextMask = ImmediateContextMask;
@@ -119,8 +123,15 @@ void Terrain::CreateResources(IDeviceContext* pContext)
         pContext->TransitionResourceStates(_countof(Barriers), Barriers);
     }
 
+    m_ResourceSets.Reset(static_cast<Uint32>(std::max(NumResourceSets, 1)));
+    m_UpdateSetId = 0;
+    m_DrawSetId   = 0;
+
     // Create height & normal maps
+    for (Uint32 i = 0; i < m_ResourceSets.GetSize(); ++i)
     {
+        ResourceSet& Set = m_ResourceSets[i].Data;
+
         TextureDesc TexDesc;
         TexDesc.Name                 = "Terrain height map";
         TexDesc.Type                 = RESOURCE_DIM_TEX_2D;
@@ -129,27 +140,21 @@ void Terrain::CreateResources(IDeviceContext* pContext)
         TexDesc.Height               = GridSize;
         TexDesc.BindFlags            = BIND_SHADER_RESOURCE | BIND_UNORDERED_ACCESS;
         TexDesc.ImmediateContextMask = m_ImmediateContextMask;
-        m_Device->CreateTexture(TexDesc, nullptr, &m_HeightMap[0]);
-        m_Device->CreateTexture(TexDesc, nullptr, &m_HeightMap[1]);
+        m_Device->CreateTexture(TexDesc, nullptr, &Set.HeightMap);
 
         TexDesc.Name   = "Terrain normal map";
         TexDesc.Format = TEX_FORMAT_RGBA16_FLOAT; //TEX_FORMAT_RGBA8_UNORM;
-        m_Device->CreateTexture(TexDesc, nullptr, &m_NormalMap[0]);
-        m_Device->CreateTexture(TexDesc, nullptr, &m_NormalMap[1]);
+        m_Device->CreateTexture(TexDesc, nullptr, &Set.NormalMap);
 
         const StateTransitionDesc Barriers[] = {
-            {m_HeightMap[0], RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS},
-            {m_HeightMap[1], RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS},
-            {m_NormalMap[0], RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS},
-            {m_NormalMap[1], RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS} //
+            {Set.HeightMap, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS},
+            {Set.NormalMap, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_UNORDERED_ACCESS} //
         };
         pContext->TransitionResourceStates(_countof(Barriers), Barriers);
 
         // Resources are used in multiple contexts, so disable automatic resource transitions.
-        m_HeightMap[0]->SetState(RESOURCE_STATE_UNKNOWN);
-        m_HeightMap[1]->SetState(RESOURCE_STATE_UNKNOWN);
-        m_NormalMap[0]->SetState(RESOURCE_STATE_UNKNOWN);
-        m_NormalMap[1]->SetState(RESOURCE_STATE_UNKNOWN);
+        Set.HeightMap->SetState(RESOURCE_STATE_UNKNOWN);
+        Set.NormalMap->SetState(RESOURCE_STATE_UNKNOWN);
     }
 
     if (m_DiffuseMap == nullptr)
@@ -179,28 +184,25 @@ void Terrain::CreateResources(IDeviceContext* pContext)
         m_Device->CreateBuffer(BuffDesc, nullptr, &m_TerrainConstants[1]);
     }
 
-    // Set terrain generator shader resources
-    for (Uint32 i = 0; i < _countof(m_GenSRB); ++i)
-    {
-        RefCntAutoPtr<IShaderResourceBinding>& SRB = m_GenSRB[i];
-        m_GenPSO->CreateShaderResourceBinding(&SRB);
-        SRB->GetVariableByName(SHADER_TYPE_COMPUTE, "TerrainConstantsCB")->Set(m_TerrainConstants[0]);
-        SRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_HeightMapUAV")->Set(m_HeightMap[i]->GetDefaultView(TEXTURE_VIEW_UNORDERED_ACCESS));
-        SRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_NormalMapUAV")->Set(m_NormalMap[i]->GetDefaultView(TEXTURE_VIEW_UNORDERED_ACCESS));
-    }
-
-    // Set draw terrain shader resources
-    for (Uint32 i = 0; i < _countof(m_DrawSRB); ++i)
+    for (Uint32 i = 0; i < m_ResourceSets.GetSize(); ++i)
     {
-        RefCntAutoPtr<IShaderResourceBinding>& SRB = m_DrawSRB[i];
-        m_DrawPSO->CreateShaderResourceBinding(&SRB);
-        SRB->GetVariableByName(SHADER_TYPE_VERTEX, "DrawConstantsCB")->Set(m_DrawConstants);
-        SRB->GetVariableByName(SHADER_TYPE_VERTEX, "TerrainConstantsCB")->Set(m_TerrainConstants[1]);
-        SRB->GetVariableByName(SHADER_TYPE_VERTEX, "g_TerrainHeightMap")->Set(m_HeightMap[1 - i]->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
-        SRB->GetVariableByName(SHADER_TYPE_PIXEL, "DrawConstantsCB")->Set(m_DrawConstants);
-        SRB->GetVariableByName(SHADER_TYPE_PIXEL, "TerrainConstantsCB")->Set(m_TerrainConstants[1]);
-        SRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_TerrainNormalMap")->Set(m_NormalMap[1 - i]->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
-        SRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_TerrainDiffuseMap")->Set(m_DiffuseMap->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+        ResourceSet& Set = m_ResourceSets[i].Data;
+
+        // Set terrain generator shader resources
+        m_GenPSO->CreateShaderResourceBinding(&Set.GenSRB);
+        Set.GenSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "TerrainConstantsCB")->Set(m_TerrainConstants[0]);
+        Set.GenSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_HeightMapUAV")->Set(Set.HeightMap->GetDefaultView(TEXTURE_VIEW_UNORDERED_ACCESS));
+        Set.GenSRB->GetVariableByName(SHADER_TYPE_COMPUTE, "g_NormalMapUAV")->Set(Set.NormalMap->GetDefaultView(TEXTURE_VIEW_UNORDERED_ACCESS));
+
+        // Set draw terrain shader resources
+        m_DrawPSO->CreateShaderResourceBinding(&Set.DrawSRB);
+        Set.DrawSRB->GetVariableByName(SHADER_TYPE_VERTEX, "DrawConstantsCB")->Set(m_DrawConstants);
+        Set.DrawSRB->GetVariableByName(SHADER_TYPE_VERTEX, "TerrainConstantsCB")->Set(m_TerrainConstants[1]);
+        Set.DrawSRB->GetVariableByName(SHADER_TYPE_VERTEX, "g_TerrainHeightMap")->Set(Set.HeightMap->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+        Set.DrawSRB->GetVariableByName(SHADER_TYPE_PIXEL, "DrawConstantsCB")->Set(m_DrawConstants);
+        Set.DrawSRB->GetVariableByName(SHADER_TYPE_PIXEL, "TerrainConstantsCB")->Set(m_TerrainConstants[1]);
+        Set.DrawSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_TerrainNormalMap")->Set(Set.NormalMap->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
+        Set.DrawSRB->GetVariableByName(SHADER_TYPE_PIXEL, "g_TerrainDiffuseMap")->Set(m_DiffuseMap->GetDefaultView(TEXTURE_VIEW_SHADER_RESOURCE));
     }
 }
 
@@ -328,11 +330,34 @@ void Terrain::CreatePSO(const ScenePSOCreateAttribs& Attr)
     }
 }
 
+Uint64 Terrain::SelectUpdateSet()
+{
+    m_UpdateSetId = m_ResourceSets.GetWriteSlot(GetLatency());
+    return m_ResourceSets[m_UpdateSetId].ReadFenceValue;
+}
+
+void Terrain::SubmitUpdate(Uint64 ComputeFenceValue)
+{
+    m_ResourceSets.EndWrite(m_UpdateSetId, ComputeFenceValue);
+}
+
+Uint64 Terrain::SelectDrawSet()
+{
+    m_DrawSetId = m_ResourceSets.GetReadSlot(GetLatency());
+    return m_ResourceSets[m_DrawSetId].WrittenFenceValue;
+}
+
+void Terrain::SubmitDraw(Uint64 GraphicsFenceValue)
+{
+    m_ResourceSets.EndRead(m_DrawSetId, GraphicsFenceValue);
+}
+
 void Terrain::Update(IDeviceContext* pContext)
 {
     pContext->BeginDebugGroup("Update terrain");
 
-    const TextureDesc& TexDesc = m_HeightMap[0]->GetDesc();
+    const ResourceSet& Set     = m_ResourceSets[m_UpdateSetId].Data;
+    const TextureDesc& TexDesc = Set.HeightMap->GetDesc();
 
     // Update constants
     {
@@ -349,8 +374,7 @@ void Terrain::Update(IDeviceContext* pContext)
     pContext->SetPipelineState(m_GenPSO);
 
     // Terrain height and normal maps can not be transitioned here because has UNKNOWN state.
-    const Uint32 Id = DoubleBuffering ? m_FrameId : 0;
-    pContext->CommitShaderResources(m_GenSRB[Id], RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    pContext->CommitShaderResources(Set.GenSRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
     DispatchComputeAttribs dispatchAttrs;
     dispatchAttrs.ThreadGroupCountX = TexDesc.Width / m_ComputeGroupSize;
@@ -372,8 +396,7 @@ void Terrain::Draw(IDeviceContext* pContext)
 
     // Terrain height and normal maps can not be transitioned here because has UNKNOWN state.
     // Other resources has constant state and does not require transitions.
-    const Uint32 Id = DoubleBuffering ? m_FrameId : 1;
-    pContext->CommitShaderResources(m_DrawSRB[Id], RESOURCE_STATE_TRANSITION_MODE_VERIFY);
+    pContext->CommitShaderResources(m_ResourceSets[m_DrawSetId].Data.DrawSRB, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
 
     // Vertex and index buffers are immutable and does not require transitions.
     IBuffer* VBs[] = {m_VB};
@@ -416,10 +439,10 @@ void Terrain::BeforeDraw(IDeviceContext* pContext, const SceneDrawAttribs& Attr)
     // Vulkan:     the correct pipeline barrier must contains vertex and pixel shader stages which is not supported in compute context.
     // DirectX 12: height map used as non-pixel shader resource and can be transitioned in compute context,
     //             but normal map used as pixel shader resource and must be transitioned in graphics context.
-    const Uint32              Id         = DoubleBuffering ? 1 - m_FrameId : 0;
+    const ResourceSet&        Set        = m_ResourceSets[m_DrawSetId].Data;
     const StateTransitionDesc Barriers[] = {
-        {m_HeightMap[Id], RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE},
-        {m_NormalMap[Id], RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE},
+        {Set.HeightMap, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE},
+        {Set.NormalMap, RESOURCE_STATE_UNORDERED_ACCESS, RESOURCE_STATE_SHADER_RESOURCE},
         {m_TerrainConstants[1], RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE},
         {m_DrawConstants, RESOURCE_STATE_UNKNOWN, RESOURCE_STATE_CONSTANT_BUFFER, STATE_TRANSITION_FLAG_UPDATE_STATE} //
     };
@@ -429,29 +452,20 @@ void Terrain::BeforeDraw(IDeviceContext* pContext, const SceneDrawAttribs& Attr)
 void Terrain::AfterDraw(IDeviceContext* pContext)
 {
     // Resources must be manually transitioned to required state.
-    const Uint32              Id         = DoubleBuffering ? 1 - m_FrameId : 0;
+    const ResourceSet&        Set        = m_ResourceSets[m_DrawSetId].Data;
     const StateTransitionDesc Barriers[] = {
-        {m_HeightMap[Id], RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_UNORDERED_ACCESS},
-        {m_NormalMap[Id], RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_UNORDERED_ACCESS} //
+        {Set.HeightMap, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_UNORDERED_ACCESS},
+        {Set.NormalMap, RESOURCE_STATE_SHADER_RESOURCE, RESOURCE_STATE_UNORDERED_ACCESS} //
     };
     pContext->TransitionResourceStates(_countof(Barriers), Barriers);
-
-    ++m_FrameId;
 }
 
 void Terrain::Recreate(IDeviceContext* pContext)
 {
     // Recreate terrain buffers
-    m_VB           = nullptr;
-    m_IB           = nullptr;
-    m_HeightMap[0] = nullptr;
-    m_HeightMap[1] = nullptr;
-    m_NormalMap[0] = nullptr;
-    m_NormalMap[1] = nullptr;
-    m_GenSRB[0]    = nullptr;
-    m_GenSRB[1]    = nullptr;
-    m_DrawSRB[0]   = nullptr;
-    m_DrawSRB[1]   = nullptr;
+    m_VB = nullptr;
+    m_IB = nullptr;
+    m_ResourceSets.Reset(1);
 
     m_Device->IdleGPU();
 
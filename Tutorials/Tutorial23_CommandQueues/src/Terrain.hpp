@@ -27,6 +27,7 @@
 #pragma once
 
 #include "SampleBase.hpp"
+#include "ResourceRing.hpp"
 
 namespace Diligent
 {
@@ -52,19 +53,30 @@ struct ScenePSOCreateAttribs
 class Terrain
 {
 public:
-    Terrain() noexcept :
-        m_FrameId{0}
-    {}
+    static constexpr int MaxResourceSets = 4;
 
     void Initialize(IRenderDevice* pDevice, IBuffer* pDrawConstants, Uint64 ImmediateContextMask);
     void CreateResources(IDeviceContext* pContext);
     void CreatePSO(const ScenePSOCreateAttribs& Attr);
 
-    void Update(IDeviceContext* pContext);
-
-    void BeforeDraw(IDeviceContext* pContext, const SceneDrawAttribs& Attr);
-    void Draw(IDeviceContext* pContext);
-    void AfterDraw(IDeviceContext* pContext);
+    // Selects the oldest resource set for the compute pass.
+    // Returns the graphics fence value that must be reached before the set can be written.
+    Uint64 SelectUpdateSet();
+    void   Update(IDeviceContext* pContext);
+    // ComputeFenceValue is signaled when the compute pass is complete.
+    void SubmitUpdate(Uint64 ComputeFenceValue);
+
+    // Selects the resource set that was updated GetLatency() frames ago for drawing.
+    // Returns the compute fence value that must be reached before the set can be read.
+    Uint64 SelectDrawSet();
+    void   BeforeDraw(IDeviceContext* pContext, const SceneDrawAttribs& Attr);
+    void   Draw(IDeviceContext* pContext);
+    void   AfterDraw(IDeviceContext* pContext);
+    // GraphicsFenceValue is signaled when the graphics pass is complete.
+    void SubmitDraw(Uint64 GraphicsFenceValue);
+
+    // Number of frames the compute pass runs ahead of the graphics pass.
+    Uint32 GetLatency() const { return m_ResourceSets.GetMaxLatency(); }
 
     void Recreate(IDeviceContext* pContext);
 
@@ -76,17 +88,26 @@ private:
     RefCntAutoPtr<IBuffer> m_TerrainConstants[2]; // 0 - compute pass, 1 - graphics pass
 
     // Terrain drawing
-    RefCntAutoPtr<IPipelineState>         m_DrawPSO;
-    RefCntAutoPtr<IShaderResourceBinding> m_DrawSRB[2];
-    RefCntAutoPtr<ITexture>               m_DiffuseMap;
-    RefCntAutoPtr<IBuffer>                m_VB;
-    RefCntAutoPtr<IBuffer>                m_IB;
+    RefCntAutoPtr<IPipelineState> m_DrawPSO;
+    RefCntAutoPtr<ITexture>       m_DiffuseMap;
+    RefCntAutoPtr<IBuffer>        m_VB;
+    RefCntAutoPtr<IBuffer>        m_IB;
 
     // Terrain height and normal map generator
-    RefCntAutoPtr<IPipelineState>         m_GenPSO;
-    RefCntAutoPtr<IShaderResourceBinding> m_GenSRB[2];
-    RefCntAutoPtr<ITexture>               m_HeightMap[2];
-    RefCntAutoPtr<ITexture>               m_NormalMap[2];
+    RefCntAutoPtr<IPipelineState> m_GenPSO;
+
+    // Compute pass writes to one resource set while the graphics pass reads from another.
+    struct ResourceSet
+    {
+        RefCntAutoPtr<ITexture>               HeightMap;
+        RefCntAutoPtr<ITexture>               NormalMap;
+        RefCntAutoPtr<IShaderResourceBinding> GenSRB;
+        RefCntAutoPtr<IShaderResourceBinding> DrawSRB;
+    };
+    ResourceRing<ResourceSet> m_ResourceSets;
+
+    Uint32 m_UpdateSetId = 0;
+    Uint32 m_DrawSetId   = 0;
 
     // Terrain parameters
     const float m_XZScale            = 400.0f;
@@ -96,14 +117,11 @@ private:
     const int   m_GroupBorderSize    = 1; // added 1 pixel border for left-top sides to calculate normals using only groupshared memory
     const float m_TerrainHeightScale = 3.0f;
 
-    Uint32 m_FrameId : 1;
-
 public:
-    int   TerrainSize = 10; // size of mesh as power of 2
-    float XOffset     = 0.f;
-    float Animation   = 0.f;
-
-    bool DoubleBuffering = false;
+    int   TerrainSize     = 10; // size of mesh as power of 2
+    float XOffset         = 0.f;
+    float Animation       = 0.f;
+    int   NumResourceSets = 1; // compute pass may run up to NumResourceSets - 1 frames ahead
 };
 
 } // namespace Diligent
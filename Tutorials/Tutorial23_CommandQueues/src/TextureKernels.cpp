@@ -0,0 +1,157 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "TextureKernels.hpp"
+
+// SSE2 is part of the x86-64 baseline, so the kernels need no extra compiler flags
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define TEXTURE_KERNELS_SSE2 1
+#    include <emmintrin.h>
+#endif
+
+namespace Diligent
+{
+
+namespace
+{
+
+inline Uint32 Downsample2x2(Uint32 c0, Uint32 c1, Uint32 c2, Uint32 c3)
+{
+    // Each 32-bit sum holds two 16-bit channel sums, which can not overflow (4 * 255 + 2 < 0x10000).
+    const Uint32 RB = (c0 & 0x00FF00FFu) + (c1 & 0x00FF00FFu) + (c2 & 0x00FF00FFu) + (c3 & 0x00FF00FFu) + 0x00020002u;
+    const Uint32 GA = ((c0 >> 8) & 0x00FF00FFu) + ((c1 >> 8) & 0x00FF00FFu) + ((c2 >> 8) & 0x00FF00FFu) + ((c3 >> 8) & 0x00FF00FFu) + 0x00020002u;
+
+    Uint32 Col = ((RB >> 2) & 0x00FF00FFu) | (((GA >> 2) & 0x00FF00FFu) << 8);
+
+    // disable self-emission
+    const Uint32 NumEmissionPix = ((c0 >> 24) != 0) + ((c1 >> 24) != 0) + ((c2 >> 24) != 0) + ((c3 >> 24) != 0);
+    if (NumEmissionPix <= 2)
+        Col &= 0x00FFFFFFu;
+
+    return Col;
+}
+
+#if TEXTURE_KERNELS_SSE2
+// Sums 2x2 quads of 4 pixels from two rows and returns two 16-bit per channel sums.
+inline __m128i SumQuads(__m128i Row0, __m128i Row1)
+{
+    const __m128i Zero = _mm_setzero_si128();
+
+    const __m128i Lo = _mm_add_epi16(_mm_unpacklo_epi8(Row0, Zero), _mm_unpacklo_epi8(Row1, Zero)); // columns 0, 1
+    const __m128i Hi = _mm_add_epi16(_mm_unpackhi_epi8(Row0, Zero), _mm_unpackhi_epi8(Row1, Zero)); // columns 2, 3
+    return _mm_add_epi16(_mm_unpacklo_epi64(Lo, Hi), _mm_unpackhi_epi64(Lo, Hi));
+}
+
+// Returns -1 for every pixel with zero alpha and 0 otherwise.
+inline __m128i ZeroAlphaMask(__m128i Pixels)
+{
+    return _mm_cmpeq_epi32(_mm_srli_epi32(Pixels, 24), _mm_setzero_si128());
+}
+#endif
+
+} // namespace
+
+const char* GetTextureKernelsISA()
+{
+#if TEXTURE_KERNELS_SSE2
+    return "SSE2";
+#else
+    return "Scalar";
+#endif
+}
+
+void FillPixelsRGBA8(Uint32* pDst, size_t Count, Uint32 Color)
+{
+    size_t i = 0;
+#if TEXTURE_KERNELS_SSE2
+    const __m128i Col = _mm_set1_epi32(static_cast<int>(Color));
+    for (; i + 4 <= Count; i += 4)
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), Col);
+#endif
+    for (; i < Count; ++i)
+        pDst[i] = Color;
+}
+
+void FillBlockRowRGBA8(Uint32* pDst, Uint32 NumBlocks, const Uint32* BlockColors, Uint32 BorderColor)
+{
+#if TEXTURE_KERNELS_SSE2
+    const __m128i Border = _mm_set1_epi32(static_cast<int>(BorderColor));
+    for (Uint32 b = 0; b < NumBlocks; ++b, pDst += 16)
+    {
+        const __m128i Col = _mm_set1_epi32(static_cast<int>(BlockColors[b]));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 0), Border);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 4), Col);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 8), Col);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 12), Border);
+    }
+#else
+    for (Uint32 b = 0; b < NumBlocks; ++b, pDst += 16)
+    {
+        FillPixelsRGBA8(pDst + 0, 4, BorderColor);
+        FillPixelsRGBA8(pDst + 4, 8, BlockColors[b]);
+        FillPixelsRGBA8(pDst + 12, 4, BorderColor);
+    }
+#endif
+}
+
+void DownsampleRowRGBA8(const Uint32* pSrcRow0, const Uint32* pSrcRow1, Uint32* pDstRow, Uint32 DstWidth)
+{
+    Uint32 x = 0;
+#if TEXTURE_KERNELS_SSE2
+    {
+        const __m128i Round     = _mm_set1_epi16(2);
+        const __m128i MinZeroes = _mm_set1_epi32(-2);
+        const __m128i ColorMask = _mm_set1_epi32(0x00FFFFFF);
+        for (; x + 4 <= DstWidth; x += 4)
+        {
+            const __m128i A0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcRow0 + x * 2 + 0));
+            const __m128i A1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcRow0 + x * 2 + 4));
+            const __m128i B0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcRow1 + x * 2 + 0));
+            const __m128i B1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcRow1 + x * 2 + 4));
+
+            const __m128i Sum0 = _mm_srli_epi16(_mm_add_epi16(SumQuads(A0, B0), Round), 2);
+            const __m128i Sum1 = _mm_srli_epi16(_mm_add_epi16(SumQuads(A1, B1), Round), 2);
+            __m128i       Col  = _mm_packus_epi16(Sum0, Sum1);
+
+            const __m128  Zero0 = _mm_castsi128_ps(_mm_add_epi32(ZeroAlphaMask(A0), ZeroAlphaMask(B0)));
+            const __m128  Zero1 = _mm_castsi128_ps(_mm_add_epi32(ZeroAlphaMask(A1), ZeroAlphaMask(B1)));
+            const __m128i Zeros = _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(Zero0, Zero1, _MM_SHUFFLE(2, 0, 2, 0))),
+                                                _mm_castps_si128(_mm_shuffle_ps(Zero0, Zero1, _MM_SHUFFLE(3, 1, 3, 1))));
+
+            // disable self-emission
+            Col = _mm_and_si128(Col, _mm_or_si128(_mm_cmpgt_epi32(Zeros, MinZeroes), ColorMask));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstRow + x), Col);
+        }
+    }
+#endif
+    for (; x < DstWidth; ++x)
+    {
+        pDstRow[x] = Downsample2x2(pSrcRow0[x * 2 + 0], pSrcRow0[x * 2 + 1],
+                                   pSrcRow1[x * 2 + 0], pSrcRow1[x * 2 + 1]);
+    }
+}
+
+} // namespace Diligent
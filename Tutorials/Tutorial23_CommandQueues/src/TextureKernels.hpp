@@ -0,0 +1,55 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include "BasicTypes.h"
+
+namespace Diligent
+{
+
+// Row kernels used to procedurally generate the building texture atlas.
+// All kernels operate on packed RGBA8 pixels and produce identical results
+// regardless of the instruction set selected at compile time.
+
+// Returns the name of the instruction set the kernels were compiled for.
+const char* GetTextureKernelsISA();
+
+// Writes Count pixels of the given color.
+void FillPixelsRGBA8(Uint32* pDst, size_t Count, Uint32 Color);
+
+// Writes NumBlocks 16-pixel blocks. Each block consists of 4 border pixels,
+// 8 pixels of the corresponding color from BlockColors and 4 border pixels.
+void FillBlockRowRGBA8(Uint32* pDst, Uint32 NumBlocks, const Uint32* BlockColors, Uint32 BorderColor);
+
+// Computes one row of the next mip level by averaging 2x2 pixel quads of two source rows.
+// Channel averages are rounded half up in integer arithmetic, so they may differ by one
+// from the averages computed with floating point conversion.
+// Alpha channel contains self-emission brightness and is set to zero
+// if less than three source pixels of a quad are emissive.
+void DownsampleRowRGBA8(const Uint32* pSrcRow0, const Uint32* pSrcRow1, Uint32* pDstRow, Uint32 DstWidth);
+
+} // namespace Diligent
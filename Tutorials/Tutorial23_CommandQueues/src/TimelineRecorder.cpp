@@ -0,0 +1,365 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "TimelineRecorder.hpp"
+
+#include <sstream>
+#include <thread>
+
+#include "FileWrapper.hpp"
+
+namespace Diligent
+{
+
+void TimelineRecorder::Initialize(IRenderDevice* pDevice, Uint32 EventCapacity)
+{
+    m_Device    = pDevice;
+    m_StartTime = Clock::now();
+
+    m_Events.resize(EventCapacity);
+    Reset();
+
+    // Track for CPU-only scopes
+    m_Tracks.clear();
+    m_Tracks.emplace_back();
+    m_Tracks.back().Name = "Main thread";
+}
+
+void TimelineRecorder::AddContext(IDeviceContext* pContext, const char* Name)
+{
+    VERIFY_EXPR(pContext != nullptr);
+    if (m_Device == nullptr)
+        return;
+
+    for (const Track& Tr : m_Tracks)
+    {
+        if (Tr.pContext == pContext)
+            return;
+    }
+
+    const DeviceFeatures& Features = m_Device->GetDeviceInfo().Features;
+
+    m_Tracks.emplace_back();
+    Track& Tr   = m_Tracks.back();
+    Tr.pContext = pContext;
+    Tr.Name     = Name;
+    Tr.GpuTimestamps =
+        Features.TimestampQueries &&
+        ((pContext->GetDesc().QueueType & COMMAND_QUEUE_TYPE_PRIMARY_MASK) > COMMAND_QUEUE_TYPE_TRANSFER || Features.TransferQueueTimestampQueries);
+}
+
+void TimelineRecorder::Calibrate()
+{
+    if (m_Device == nullptr)
+        return;
+
+    m_Device->IdleGPU();
+
+    // Read all pending timestamps with the current offsets.
+    for (Uint32 Slot = 0; Slot < MaxFramesInFlight; ++Slot)
+    {
+        if (Slot != m_FrameId % MaxFramesInFlight)
+            ResolveFrame(Slot);
+    }
+
+    QueryDesc Desc;
+    Desc.Name = "Timeline calibration query";
+    Desc.Type = QUERY_TYPE_TIMESTAMP;
+
+    for (Track& Tr : m_Tracks)
+    {
+        if (!Tr.GpuTimestamps)
+            continue;
+
+        RefCntAutoPtr<IQuery> pQuery;
+        m_Device->CreateQuery(Desc, &pQuery);
+
+        // The timestamp is written somewhere between the submission and the moment the result becomes available.
+        // Use the attempt with the shortest interval.
+        double BestInterval = 1.0e+10;
+        for (Uint32 Attempt = 0; Attempt < 8; ++Attempt)
+        {
+            Tr.pContext->EndQuery(pQuery);
+            const double SubmitTime = GetCpuTime();
+            Tr.pContext->Flush();
+
+            QueryDataTimestamp Data;
+            bool               DataReady = false;
+            double             ReadyTime = SubmitTime;
+            while (!DataReady && ReadyTime - SubmitTime < 1.0)
+            {
+                std::this_thread::yield();
+                DataReady = pQuery->GetData(&Data, sizeof(Data), true);
+                ReadyTime = GetCpuTime();
+            }
+
+            if (!DataReady || Data.Frequency == 0 || ReadyTime - SubmitTime >= BestInterval)
+                continue;
+
+            BestInterval      = ReadyTime - SubmitTime;
+            Tr.GpuToCpuOffset = (SubmitTime + ReadyTime) * 0.5 - static_cast<double>(Data.Counter) / static_cast<double>(Data.Frequency);
+        }
+    }
+}
+
+Uint16 TimelineRecorder::GetNameId(const char* Name)
+{
+    auto it = m_NameIds.find(Name);
+    if (it != m_NameIds.end())
+        return it->second;
+
+    VERIFY(m_Names.size() < 0xFFFFu, "Too many unique scope names");
+    const Uint16 Id = static_cast<Uint16>(m_Names.size());
+    m_Names.emplace_back(Name);
+    m_NameIds.emplace(Name, Id);
+    return Id;
+}
+
+Uint32 TimelineRecorder::GetTrackId(IDeviceContext* pContext)
+{
+    for (Uint32 i = 0; i < m_Tracks.size(); ++i)
+    {
+        if (m_Tracks[i].pContext == pContext)
+            return i;
+    }
+    UNEXPECTED("Context has not been added to the timeline");
+    return 0;
+}
+
+Uint32 TimelineRecorder::AllocateQuery(Uint32 TrackId)
+{
+    QueryPool& Pool = m_Tracks[TrackId].QueryPools[m_FrameId % MaxFramesInFlight];
+    if (Pool.NumUsed == Pool.Queries.size())
+    {
+        QueryDesc Desc;
+        Desc.Name = "Timeline timestamp query";
+        Desc.Type = QUERY_TYPE_TIMESTAMP;
+
+        // Begin and end queries
+        for (Uint32 i = 0; i < 2; ++i)
+        {
+            Pool.Queries.emplace_back();
+            m_Device->CreateQuery(Desc, &Pool.Queries.back());
+        }
+    }
+
+    const Uint32 QueryBegin = Pool.NumUsed;
+    Pool.NumUsed += 2;
+    return QueryBegin;
+}
+
+void TimelineRecorder::BeginFrame()
+{
+    if (m_Device == nullptr)
+        return;
+
+    ++m_FrameId;
+
+    const Uint32 Slot = m_FrameId % MaxFramesInFlight;
+    ResolveFrame(Slot);
+    m_Frames[Slot].FrameId = m_FrameId;
+
+    // Scopes may remain open if recording was disabled in the middle of the frame.
+    for (Track& Tr : m_Tracks)
+        Tr.OpenScopes.clear();
+}
+
+void TimelineRecorder::BeginScope(IDeviceContext* pContext, const char* Name)
+{
+    if (m_Device == nullptr || !Enabled)
+        return;
+
+    const Uint32 TrackId = GetTrackId(pContext);
+    Track&       Tr      = m_Tracks[TrackId];
+    FrameScopes& Frame   = m_Frames[m_FrameId % MaxFramesInFlight];
+
+    PendingScope Scope;
+    Scope.NameId  = GetNameId(Name);
+    Scope.Depth   = static_cast<Uint16>(Tr.OpenScopes.size());
+    Scope.TrackId = TrackId;
+    if (Tr.GpuTimestamps)
+    {
+        Scope.QueryBegin = AllocateQuery(TrackId);
+        pContext->EndQuery(Tr.QueryPools[m_FrameId % MaxFramesInFlight].Queries[Scope.QueryBegin]);
+    }
+    Scope.CpuBegin = GetCpuTime();
+
+    Tr.OpenScopes.push_back(static_cast<Uint32>(Frame.Scopes.size()));
+    Frame.Scopes.push_back(Scope);
+}
+
+void TimelineRecorder::EndScope(IDeviceContext* pContext)
+{
+    if (m_Device == nullptr || !Enabled)
+        return;
+
+    Track& Tr = m_Tracks[GetTrackId(pContext)];
+    if (Tr.OpenScopes.empty())
+        return; // Recording was enabled in the middle of the scope
+
+    PendingScope& Scope = m_Frames[m_FrameId % MaxFramesInFlight].Scopes[Tr.OpenScopes.back()];
+    Tr.OpenScopes.pop_back();
+
+    if (Scope.QueryBegin != InvalidQuery)
+        pContext->EndQuery(Tr.QueryPools[m_FrameId % MaxFramesInFlight].Queries[Scope.QueryBegin + 1]);
+    Scope.CpuEnd = GetCpuTime();
+}
+
+void TimelineRecorder::ResolveFrame(Uint32 Slot)
+{
+    FrameScopes& Frame = m_Frames[Slot];
+
+    const auto ReadTime = [](IQuery* pQuery, double& Time) //
+    {
+        QueryDataTimestamp Data;
+        if (!pQuery->GetData(&Data, sizeof(Data), true) || Data.Frequency == 0)
+            return false;
+        Time = static_cast<double>(Data.Counter) / static_cast<double>(Data.Frequency);
+        return true;
+    };
+
+    for (const PendingScope& Scope : Frame.Scopes)
+    {
+        AddEvent(Scope.NameId, Scope.TrackId, Scope.Depth, Frame.FrameId, false, Scope.CpuBegin, Scope.CpuEnd);
+
+        if (Scope.QueryBegin != InvalidQuery)
+        {
+            Track&     Tr   = m_Tracks[Scope.TrackId];
+            QueryPool& Pool = Tr.QueryPools[Slot];
+
+            double GpuBegin = 0.0;
+            double GpuEnd   = 0.0;
+            if (ReadTime(Pool.Queries[Scope.QueryBegin], GpuBegin) && ReadTime(Pool.Queries[Scope.QueryBegin + 1], GpuEnd))
+                AddEvent(Scope.NameId, Scope.TrackId, Scope.Depth, Frame.FrameId, true, GpuBegin + Tr.GpuToCpuOffset, GpuEnd + Tr.GpuToCpuOffset);
+        }
+    }
+
+    Frame.Scopes.clear();
+    for (Track& Tr : m_Tracks)
+        Tr.QueryPools[Slot].NumUsed = 0;
+}
+
+void TimelineRecorder::AddEvent(Uint16 NameId, Uint32 TrackId, Uint32 Depth, Uint64 FrameId, bool IsGpu, double Begin, double End)
+{
+    if (m_Events.empty())
+        return;
+
+    Event& Ev  = m_Events[m_NumEvents % m_Events.size()];
+    Ev.Begin   = Begin;
+    Ev.End     = std::max(Begin, End);
+    Ev.FrameId = FrameId;
+    Ev.NameId  = NameId;
+    Ev.Depth   = static_cast<Uint16>(Depth);
+    Ev.TrackId = static_cast<Uint16>(TrackId);
+    Ev.IsGpu   = IsGpu;
+    ++m_NumEvents;
+}
+
+void TimelineRecorder::Reset()
+{
+    m_NumEvents = 0;
+}
+
+Uint64 TimelineRecorder::GetNumFrames() const
+{
+    const Uint32 NumEvents = GetNumEvents();
+    if (NumEvents == 0)
+        return 0;
+
+    const Event& Oldest = m_Events[(m_NumEvents - NumEvents) % m_Events.size()];
+    const Event& Newest = m_Events[(m_NumEvents - 1) % m_Events.size()];
+    return Newest.FrameId - Oldest.FrameId + 1;
+}
+
+bool TimelineRecorder::ExportChromeTrace(const char* FilePath) const
+{
+    static constexpr int CpuPid = 1;
+    static constexpr int GpuPid = 2;
+
+    const auto WriteString = [](std::stringstream& ss, const String& Str) //
+    {
+        ss << '"';
+        for (char c : Str)
+        {
+            if (c == '"' || c == '\\')
+                ss << '\\';
+            ss << c;
+        }
+        ss << '"';
+    };
+
+    std::stringstream ss;
+    ss.precision(3);
+    ss.flags(std::ios_base::fixed);
+    ss << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    ss << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << CpuPid << ",\"args\":{\"name\":\"CPU\"}},\n";
+    ss << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << GpuPid << ",\"args\":{\"name\":\"GPU\"}}";
+    for (Uint32 TrackId = 0; TrackId < m_Tracks.size(); ++TrackId)
+    {
+        for (int Pid : {CpuPid, GpuPid})
+        {
+            ss << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << Pid << ",\"tid\":" << TrackId << ",\"args\":{\"name\":";
+            WriteString(ss, m_Tracks[TrackId].Name);
+            ss << "}}";
+        }
+    }
+
+    const Uint32 NumEvents  = GetNumEvents();
+    const Uint64 FirstEvent = m_NumEvents - NumEvents;
+    for (Uint64 i = FirstEvent; i < m_NumEvents; ++i)
+    {
+        const Event& Ev = m_Events[i % m_Events.size()];
+
+        // Timestamps are in microseconds
+        ss << ",\n{\"name\":";
+        WriteString(ss, m_Names[Ev.NameId]);
+        ss << ",\"cat\":\"" << (Ev.IsGpu ? "gpu" : "cpu") << "\",\"ph\":\"X\""
+           << ",\"pid\":" << (Ev.IsGpu ? GpuPid : CpuPid) << ",\"tid\":" << Ev.TrackId
+           << ",\"ts\":" << Ev.Begin * 1.0e+6 << ",\"dur\":" << (Ev.End - Ev.Begin) * 1.0e+6
+           << ",\"args\":{\"frame\":" << Ev.FrameId << ",\"depth\":" << Ev.Depth << "}}";
+    }
+    ss << "\n]}\n";
+
+    FileWrapper pFile{FilePath, EFileAccessMode::Overwrite};
+    if (!pFile)
+    {
+        LOG_ERROR_MESSAGE("Failed to create timeline file '", FilePath, "'.");
+        return false;
+    }
+
+    const String Json = ss.str();
+    if (!pFile->Write(Json.data(), Json.size()))
+    {
+        LOG_ERROR_MESSAGE("Failed to write timeline file '", FilePath, "'.");
+        return false;
+    }
+
+    LOG_INFO_MESSAGE("Exported ", NumEvents, " timeline events to '", FilePath, "'.");
+    return true;
+}
+
+} // namespace Diligent
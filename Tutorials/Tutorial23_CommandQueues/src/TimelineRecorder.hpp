@@ -0,0 +1,149 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
+#include "SampleBase.hpp"
+
+namespace Diligent
+{
+
+// Records named CPU and GPU scopes of multiple device contexts into a ring buffer
+// and exports them in Chrome trace event format, which can be opened in
+// chrome://tracing or https://ui.perfetto.dev.
+//
+// GPU timestamps are converted to the CPU clock using per-context offsets measured by Calibrate().
+// All methods must be called from the same thread.
+class TimelineRecorder
+{
+public:
+    // GPU timestamps are read back with this latency.
+    static constexpr Uint32 MaxFramesInFlight = 8;
+
+    void Initialize(IRenderDevice* pDevice, Uint32 EventCapacity = 1u << 18);
+
+    // Adds a track for the context. Scopes recorded with a null context go to the "Main thread" track.
+    void AddContext(IDeviceContext* pContext, const char* Name);
+
+    // Measures GPU-to-CPU clock offsets of all contexts. Idles the GPU.
+    void Calibrate();
+
+    // Starts the new frame and resolves GPU timestamps of the frame MaxFramesInFlight frames ago.
+    void BeginFrame();
+
+    void BeginScope(IDeviceContext* pContext, const char* Name);
+    void EndScope(IDeviceContext* pContext);
+
+    bool ExportChromeTrace(const char* FilePath) const;
+
+    void Reset();
+
+    bool IsInitialized() const { return m_Device != nullptr; }
+
+    Uint32 GetNumEvents() const { return static_cast<Uint32>(std::min<Uint64>(m_NumEvents, m_Events.size())); }
+    Uint64 GetNumFrames() const;
+
+    bool Enabled = true;
+
+private:
+    using Clock = std::chrono::high_resolution_clock;
+
+    double GetCpuTime() const { return std::chrono::duration<double>{Clock::now() - m_StartTime}.count(); }
+
+    Uint16 GetNameId(const char* Name);
+    Uint32 GetTrackId(IDeviceContext* pContext);
+    Uint32 AllocateQuery(Uint32 TrackId);
+    void   AddEvent(Uint16 NameId, Uint32 TrackId, Uint32 Depth, Uint64 FrameId, bool IsGpu, double Begin, double End);
+    void   ResolveFrame(Uint32 Slot);
+
+    static constexpr Uint32 InvalidQuery = ~0u;
+
+    RefCntAutoPtr<IRenderDevice> m_Device;
+
+    Clock::time_point m_StartTime;
+
+    struct QueryPool
+    {
+        std::vector<RefCntAutoPtr<IQuery>> Queries;
+        Uint32                             NumUsed = 0;
+    };
+
+    struct Track
+    {
+        IDeviceContext* pContext = nullptr;
+        String          Name;
+        bool            GpuTimestamps  = false;
+        double          GpuToCpuOffset = 0.0; // in seconds
+
+        std::vector<Uint32> OpenScopes; // indices of the current frame scopes
+
+        std::array<QueryPool, MaxFramesInFlight> QueryPools;
+    };
+    std::vector<Track> m_Tracks;
+
+    struct PendingScope
+    {
+        Uint16 NameId     = 0;
+        Uint16 Depth      = 0;
+        Uint32 TrackId    = 0;
+        Uint32 QueryBegin = InvalidQuery;
+        double CpuBegin   = 0.0;
+        double CpuEnd     = 0.0;
+    };
+
+    struct FrameScopes
+    {
+        Uint64                    FrameId = 0;
+        std::vector<PendingScope> Scopes;
+    };
+    std::array<FrameScopes, MaxFramesInFlight> m_Frames;
+
+    Uint64 m_FrameId = 0;
+
+    struct Event
+    {
+        double Begin   = 0.0; // in seconds
+        double End     = 0.0;
+        Uint64 FrameId = 0;
+        Uint16 NameId  = 0;
+        Uint16 Depth   = 0;
+        Uint16 TrackId = 0;
+        bool   IsGpu   = false;
+    };
+    std::vector<Event> m_Events; // ring buffer
+    Uint64             m_NumEvents = 0;
+
+    std::vector<String>                m_Names;
+    std::unordered_map<String, Uint16> m_NameIds;
+};
+
+} // namespace Diligent
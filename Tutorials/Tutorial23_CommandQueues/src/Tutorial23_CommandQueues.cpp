@@ -32,9 +32,13 @@
 #include "ImGuiUtils.hpp"
 #include "PlatformMisc.hpp"
 #include "ShaderMacroHelper.hpp"
+#include "CommandLineParser.hpp"
+#include "TextureKernels.hpp"
 
 namespace Diligent
 {
+namespace
+{
 namespace HLSL
 {
 #include "../assets/Structures.fxh"
@@ -43,6 +47,7 @@ static_assert(sizeof(DrawConstants) % 16 == 0, "must be aligned to 16 bytes");
 static_assert(sizeof(PostProcessConstants) % 16 == 0, "must be aligned to 16 bytes");
 static_assert(sizeof(TerrainConstants) % 16 == 0, "must be aligned to 16 bytes");
 } // namespace HLSL
+} // namespace
 
 SampleBase* CreateSample()
 {
@@ -59,6 +64,17 @@ Tutorial23_CommandQueues::~Tutorial23_CommandQueues()
         m_TransferCtxFence->Wait(m_TransferCtxFenceValue);
 }
 
+Tutorial23_CommandQueues::CommandLineStatus Tutorial23_CommandQueues::ProcessCommandLine(int argc, const char* const* argv)
+{
+    CommandLineParser ArgsParser{argc, argv};
+    if (ArgsParser.Parse("texgen_benchmark", m_TexGenBenchmarkSlices))
+    {
+        m_TexGenBenchmarkSlices = clamp(m_TexGenBenchmarkSlices, 0, 4096);
+    }
+
+    return CommandLineStatus::OK;
+}
+
 void Tutorial23_CommandQueues::CreatePostProcessPSO(IShaderSourceInputStreamFactory* pShaderSourceFactory)
 {
     // Create PSO for post process pass
@@ -333,9 +349,21 @@ void Tutorial23_CommandQueues::Initialize(const SampleInitInfo& InitInfo)
     m_Buildings.CreateResources(m_pImmediateContext);
     m_Terrain.CreateResources(m_pImmediateContext);
 
+    if (m_TexGenBenchmarkSlices > 0)
+    {
+        m_TexGenBenchmarkRateMb = m_Buildings.BenchmarkTextureGeneration(static_cast<Uint32>(m_TexGenBenchmarkSlices));
+        LOG_INFO_MESSAGE("Texture generation benchmark (", m_TexGenBenchmarkSlices, " slices, ", GetTextureKernelsISA(), "): ",
+                         m_TexGenBenchmarkRateMb, " Mb/s");
+    }
+
     if (m_pDevice->GetDeviceInfo().Features.TimestampQueries)
     {
         m_Profiler.Initialize(m_pDevice);
+        m_Profiler.AddContext(m_pImmediateContext, "Graphics");
+        if (m_ComputeCtx)
+            m_Profiler.AddContext(m_ComputeCtx, "Compute");
+        if (m_TransferCtx)
+            m_Profiler.AddContext(m_TransferCtx, "Transfer");
     }
 
     // Signal first value to graphics fence.
@@ -354,6 +382,9 @@ void Tutorial23_CommandQueues::Initialize(const SampleInitInfo& InitInfo)
         m_UseAsyncTransfer = true;
         m_TransferCtx->Flush();
     }
+
+    // Align GPU timestamps of all queues with the CPU clock for the timeline.
+    m_Profiler.CalibrateClocks();
 }
 
 void Tutorial23_CommandQueues::ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Attribs)
@@ -452,13 +483,17 @@ void Tutorial23_CommandQueues::ComputePass()
 
     m_Profiler.Begin(ComputeCtx, Profiler::COMPUTE);
 
+    // Select the terrain resource set that graphics passes read least recently.
+    const Uint64 GraphicsFenceValue = m_Terrain.SelectUpdateSet();
     if (m_UseAsyncCompute)
     {
-        // Wait until graphics pass finishes working with terrain height and normal maps
-        ComputeCtx->DeviceWaitForFence(m_GraphicsCtxFence, m_GraphicsCtxFenceValue);
+        // Wait until graphics pass finishes working with terrain height and normal maps of this set
+        ComputeCtx->DeviceWaitForFence(m_GraphicsCtxFence, GraphicsFenceValue);
     }
 
+    m_Profiler.BeginScope(ComputeCtx, "Generate terrain");
     m_Terrain.Update(ComputeCtx);
+    m_Profiler.EndScope(ComputeCtx);
 
     m_Profiler.End(ComputeCtx, Profiler::COMPUTE);
 
@@ -468,17 +503,16 @@ void Tutorial23_CommandQueues::ComputePass()
     {
         ComputeCtx->EnqueueSignal(m_ComputeCtxFence, ++m_ComputeCtxFenceValue);
         ComputeCtx->Flush();
+    }
+    m_Terrain.SubmitUpdate(m_ComputeCtxFenceValue);
 
-        if (m_Terrain.DoubleBuffering)
-        {
-            // Wait for compute queue previous pass.
-            m_pImmediateContext->DeviceWaitForFence(m_ComputeCtxFence, m_ComputeCtxFenceValue - 1);
-        }
-        else
-        {
-            // Wait for compute queue current pass.
-            m_pImmediateContext->DeviceWaitForFence(m_ComputeCtxFence, m_ComputeCtxFenceValue);
-        }
+    // With N resource sets, graphics passes draw the terrain generated N-1 frames ago,
+    // so the compute queue may run up to N-1 frames ahead of the graphics queue.
+    const Uint64 ComputeFenceValue = m_Terrain.SelectDrawSet();
+    if (m_UseAsyncCompute)
+    {
+        // Wait for compute queue pass that generated the selected set.
+        m_pImmediateContext->DeviceWaitForFence(m_ComputeCtxFence, ComputeFenceValue);
     }
 }
 
@@ -503,7 +537,9 @@ void Tutorial23_CommandQueues::UploadPass()
     }
 
     Uint32 CpuToGpuTransferRateMb = 0;
+    m_Profiler.BeginScope(TransferCtx, "Update atlas");
     m_Buildings.UpdateAtlas(TransferCtx, TransferRate, CpuToGpuTransferRateMb);
+    m_Profiler.EndScope(TransferCtx);
     m_Profiler.SetCpuToGpuTransferRate(CpuToGpuTransferRateMb);
 
     m_Profiler.End(TransferCtx, Profiler::TRANSFER);
@@ -548,8 +584,13 @@ void Tutorial23_CommandQueues::GraphicsPass1()
         m_pImmediateContext->ClearDepthStencil(pDSV, CLEAR_DEPTH_FLAG, 1.f, 0, RESOURCE_STATE_TRANSITION_MODE_VERIFY);
 
 
+        m_Profiler.BeginScope(m_pImmediateContext, "Draw terrain");
         m_Terrain.Draw(m_pImmediateContext);
+        m_Profiler.EndScope(m_pImmediateContext);
+
+        m_Profiler.BeginScope(m_pImmediateContext, "Draw buildings");
         m_Buildings.Draw(m_pImmediateContext);
+        m_Profiler.EndScope(m_pImmediateContext);
 
         m_pImmediateContext->SetRenderTargets(0, nullptr, nullptr, RESOURCE_STATE_TRANSITION_MODE_NONE);
 
@@ -567,10 +608,11 @@ void Tutorial23_CommandQueues::GraphicsPass1()
         // Notify transfer context that graphics context finished working with buildings texture atlas.
         m_pImmediateContext->EnqueueSignal(m_GraphicsCtxFence, ++m_GraphicsCtxFenceValue);
 
-        // When used double buffering compute pass may overlap with whole frame.
-        if (!m_Terrain.DoubleBuffering || m_UseAsyncTransfer)
+        // When multiple terrain resource sets are used, compute pass may overlap with whole frame.
+        if (m_Terrain.GetLatency() == 0 || m_UseAsyncTransfer)
             m_pImmediateContext->Flush();
     }
+    m_Terrain.SubmitDraw(m_GraphicsCtxFenceValue);
 }
 
 void Tutorial23_CommandQueues::GraphicsPass2()
@@ -581,14 +623,20 @@ void Tutorial23_CommandQueues::GraphicsPass2()
     m_Profiler.Begin(m_pImmediateContext, Profiler::GRAPHICS_2);
 
     if (m_Glow)
+    {
+        m_Profiler.BeginScope(m_pImmediateContext, "Down sample");
         DownSample();
+        m_Profiler.EndScope(m_pImmediateContext);
+    }
 
     // Final pass
     {
         ITextureView* pRTV = m_pSwapChain->GetCurrentBackBufferRTV();
         m_pImmediateContext->SetRenderTargets(1, &pRTV, nullptr, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
+        m_Profiler.BeginScope(m_pImmediateContext, "Post process");
         PostProcess();
+        m_Profiler.EndScope(m_pImmediateContext);
     }
 
     m_Profiler.End(m_pImmediateContext, Profiler::GRAPHICS_2);
@@ -728,23 +776,40 @@ void Tutorial23_CommandQueues::UpdateUI()
             ImGui::SliderInt("##TransferRate", &m_TransferRateMbExp2, 0, TexSizePOT, TransferRateStr.c_str());
 
             ImGui::Checkbox("Use async transfer", &m_UseAsyncTransfer);
+
+            // CPU side of the transfer workload: procedural texture generation throughput.
+            ImGui::TextDisabled("Texture generation (%s)", GetTextureKernelsISA());
+            ImGui::Text("Async thread: %.0f Mb/s", m_Buildings.GetTextureGenerationRateMb());
+            if (ImGui::Button("Benchmark##TexGen"))
+                m_TexGenBenchmarkRateMb = m_Buildings.BenchmarkTextureGeneration(64);
+            if (m_TexGenBenchmarkRateMb > 0.0)
+            {
+                ImGui::SameLine();
+                ImGui::Text("%.0f Mb/s", m_TexGenBenchmarkRateMb);
+            }
             ImGui::Separator();
         }
 
         // Compute workload
         const bool PrevUseAsyncCompute = m_UseAsyncCompute;
         {
-            const std::string TerrainSizeStr = std::to_string(1u << m_Terrain.TerrainSize);
-            const int         OldTerrainSize = m_Terrain.TerrainSize;
+            const std::string TerrainSizeStr     = std::to_string(1u << m_Terrain.TerrainSize);
+            const int         OldTerrainSize     = m_Terrain.TerrainSize;
+            const int         OldNumResourceSets = m_Terrain.NumResourceSets;
             ImGui::TextDisabled("Terrain dimension");
             ImGui::SliderInt("##TerrainSize", &m_Terrain.TerrainSize, 7, 13, TerrainSizeStr.c_str());
-            if (OldTerrainSize != m_Terrain.TerrainSize)
-                m_Terrain.Recreate(m_pImmediateContext);
 
             if (m_ComputeCtx)
                 ImGui::Checkbox("Use async compute", &m_UseAsyncCompute);
 
-            ImGui::Checkbox("Double buffering##TerrainDB", &m_Terrain.DoubleBuffering);
+            const std::string LatencyStr = std::to_string(m_Terrain.NumResourceSets - 1) + " frame(s) ahead";
+            ImGui::TextDisabled("Terrain resource sets");
+            ImGui::SliderInt("##TerrainSets", &m_Terrain.NumResourceSets, 1, Terrain::MaxResourceSets);
+            ImGui::SameLine();
+            ImGui::TextDisabled("%s", LatencyStr.c_str());
+
+            if (OldTerrainSize != m_Terrain.TerrainSize || OldNumResourceSets != m_Terrain.NumResourceSets)
+                m_Terrain.Recreate(m_pImmediateContext);
             ImGui::Separator();
         }
 
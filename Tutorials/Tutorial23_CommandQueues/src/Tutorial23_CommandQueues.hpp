@@ -42,6 +42,8 @@ class Tutorial23_CommandQueues final : public SampleBase
 public:
     ~Tutorial23_CommandQueues() override;
 
+    virtual CommandLineStatus ProcessCommandLine(int argc, const char* const* argv) override final;
+
     virtual void ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Attribs) override final;
     virtual void Initialize(const SampleInitInfo& InitInfo) override final;
 
@@ -122,6 +124,9 @@ private:
     const float3 m_SkyColor           = {0.7f, 0.5f, 0.2f};
     int          m_SurfaceScaleExp2   = 0; // two to the power of
 
+    double m_TexGenBenchmarkRateMb = 0.0;
+    int    m_TexGenBenchmarkSlices = 0; // Number of slices generated by the benchmark at startup
+
     std::vector<ImmediateContextCreateInfo> m_ContextCI;
 
     Profiler m_Profiler;
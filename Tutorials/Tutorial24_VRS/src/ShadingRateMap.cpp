@@ -0,0 +1,214 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "ShadingRateMap.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "Align.hpp"
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+void ShadingRateMap::Initialize(Uint32 Width, Uint32 Height, const ShadingRateProperties& SRProps)
+{
+    m_Format    = SRProps.Format;
+    m_Width     = Width;
+    m_Height    = Height;
+    m_TexelSize = m_Format == SHADING_RATE_FORMAT_UNORM8 ? 2 : 1;
+    m_RowStride = AlignUp(Width * m_TexelSize, 32u);
+    m_Data.assign(m_RowStride * Height, 0);
+    m_XRates.clear();
+    m_YRates.clear();
+
+    if (m_Format == SHADING_RATE_FORMAT_PALETTE)
+    {
+        for (Uint32 XRate = 0; XRate <= AXIS_SHADING_RATE_MAX; ++XRate)
+        {
+            for (Uint32 YRate = 0; YRate <= AXIS_SHADING_RATE_MAX; ++YRate)
+            {
+                const SHADING_RATE Rate = static_cast<SHADING_RATE>((XRate << SHADING_RATE_X_SHIFT) | YRate);
+                // ShadingRates is sorted from higher to lower rate.
+                for (Uint32 j = 0; j < SRProps.NumShadingRates; ++j)
+                {
+                    if (Rate >= SRProps.ShadingRates[j].Rate)
+                    {
+                        m_PaletteRates[XRate][YRate] = static_cast<Uint8>(SRProps.ShadingRates[j].Rate);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+AXIS_SHADING_RATE ShadingRateMap::GetAxisShadingRate(Uint32 TileIdx, Uint32 NumTiles, float Origin)
+{
+    float  TilePos = (static_cast<float>(TileIdx) + 0.5f) / static_cast<float>(NumTiles);
+    float  Dist    = std::abs(TilePos - Origin);
+    Uint32 Rate    = clamp(static_cast<Uint32>(Dist * (AXIS_SHADING_RATE_MAX + 1) + 0.5f), 0u, Uint32{AXIS_SHADING_RATE_MAX});
+    return static_cast<AXIS_SHADING_RATE>(Rate);
+}
+
+void ShadingRateMap::WriteTexel(Uint8* pTexel, Uint32 XRate, Uint32 YRate) const
+{
+    if (m_Format == SHADING_RATE_FORMAT_UNORM8)
+    {
+        pTexel[0] = static_cast<Uint8>(255u >> XRate);
+        pTexel[1] = static_cast<Uint8>(255u >> YRate);
+    }
+    else
+    {
+        pTexel[0] = m_PaletteRates[XRate][YRate];
+    }
+}
+
+void ShadingRateMap::UpdateAxisRates(std::vector<Uint8>& Rates, Uint32 NumTiles, float Origin, Uint32& FirstChanged, Uint32& EndChanged) const
+{
+    FirstChanged = NumTiles;
+    EndChanged   = 0;
+    if (Rates.size() != NumTiles)
+    {
+        Rates.resize(NumTiles);
+        FirstChanged = 0;
+        EndChanged   = NumTiles;
+    }
+
+    for (Uint32 i = 0; i < NumTiles; ++i)
+    {
+        const Uint8 Rate = static_cast<Uint8>(GetAxisShadingRate(i, NumTiles, Origin));
+        if (Rates[i] != Rate)
+        {
+            Rates[i]     = Rate;
+            FirstChanged = std::min(FirstChanged, i);
+            EndChanged   = std::max(EndChanged, i + 1);
+        }
+    }
+}
+
+void ShadingRateMap::FillRegion(Uint32 MinX, Uint32 MaxX, Uint32 MinY, Uint32 MaxY)
+{
+    const size_t RowSize   = size_t{MaxX - MinX} * m_TexelSize;
+    const Uint8* pPrevRow  = nullptr;
+    Uint32       PrevYRate = ~0u;
+    for (Uint32 y = MinY; y < MaxY; ++y)
+    {
+        Uint8*       pRow  = &m_Data[y * m_RowStride + size_t{MinX} * m_TexelSize];
+        const Uint32 YRate = m_YRates[y];
+        if (YRate == PrevYRate)
+        {
+            // Rows with the same rate are identical
+            std::memcpy(pRow, pPrevRow, RowSize);
+            continue;
+        }
+
+        for (Uint32 x = MinX; x < MaxX;)
+        {
+            const Uint32 XRate  = m_XRates[x];
+            Uint32       RunEnd = x + 1;
+            while (RunEnd < MaxX && m_XRates[RunEnd] == XRate)
+                ++RunEnd;
+
+            Uint8*       pRun    = pRow + size_t{x - MinX} * m_TexelSize;
+            const size_t RunSize = size_t{RunEnd - x} * m_TexelSize;
+            WriteTexel(pRun, XRate, YRate);
+            if (m_TexelSize == 1)
+            {
+                std::memset(pRun, pRun[0], RunSize);
+            }
+            else
+            {
+                // Replicate the texel by doubling the filled part, so that the run is written
+                // with a few wide copies instead of one store per texel.
+                for (size_t Filled = m_TexelSize; Filled < RunSize;)
+                {
+                    const size_t CopySize = std::min(Filled, RunSize - Filled);
+                    std::memcpy(pRun + Filled, pRun, CopySize);
+                    Filled += CopySize;
+                }
+            }
+            x = RunEnd;
+        }
+
+        pPrevRow  = pRow;
+        PrevYRate = YRate;
+    }
+}
+
+Uint32 ShadingRateMap::Update(const float2& Origin, Box pDirtyBoxes[2])
+{
+    Uint32 MinX = 0, MaxX = 0;
+    Uint32 MinY = 0, MaxY = 0;
+    UpdateAxisRates(m_XRates, m_Width, Origin.x, MinX, MaxX);
+    UpdateAxisRates(m_YRates, m_Height, Origin.y, MinY, MaxY);
+
+    // A tile changes if the rate of its column or its row changes, so the dirty area is
+    // the band of changed columns plus the band of changed rows.
+    const bool AllColumns = MinX == 0 && MaxX == m_Width;
+    const bool AllRows    = MinY == 0 && MaxY == m_Height;
+    if ((MinX < MaxX && AllColumns) || (MinY < MaxY && AllRows))
+    {
+        FillRegion(0, m_Width, 0, m_Height);
+        pDirtyBoxes[0] = Box{0, m_Width, 0, m_Height};
+        return 1;
+    }
+
+    Uint32 NumBoxes = 0;
+    if (MinX < MaxX)
+    {
+        FillRegion(MinX, MaxX, 0, m_Height);
+        pDirtyBoxes[NumBoxes++] = Box{MinX, MaxX, 0, m_Height};
+    }
+    if (MinY < MaxY)
+    {
+        FillRegion(0, m_Width, MinY, MaxY);
+        pDirtyBoxes[NumBoxes++] = Box{0, m_Width, MinY, MaxY};
+    }
+    return NumBoxes;
+}
+
+void ShadingRateMap::GenerateReference(const float2& Origin, Box& DirtyBox)
+{
+    for (Uint32 y = 0; y < m_Height; ++y)
+    {
+        for (Uint32 x = 0; x < m_Width; ++x)
+        {
+            AXIS_SHADING_RATE XRate = GetAxisShadingRate(x, m_Width, Origin.x);
+            AXIS_SHADING_RATE YRate = GetAxisShadingRate(y, m_Height, Origin.y);
+
+            WriteTexel(&m_Data[size_t{x} * m_TexelSize + size_t{y} * m_RowStride], XRate, YRate);
+        }
+    }
+    DirtyBox = Box{0, m_Width, 0, m_Height};
+
+    // The rate tables are out of date, so the next Update() rewrites the whole map
+    m_XRates.clear();
+    m_YRates.clear();
+}
+
+} // namespace Diligent
@@ -0,0 +1,90 @@
+/*
+ *  Copyright 2019-2025 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "GraphicsTypes.h"
+#include "BasicMath.hpp"
+
+namespace Diligent
+{
+
+// CPU copy of the shading rate texture used by the texture-based VRS mode.
+//
+// The rate of every tile is a function of its distance to the cursor along X and of its distance
+// along Y, so the map is fully described by a per-column and a per-row table of axis rates.
+// Update() recomputes both tables, and then only rewrites the columns and rows whose rates changed.
+// Within a row, the columns form a few runs of equal rates that are filled with memset, and rows with
+// the same rate are copied from the first one, so the per-tile math of GenerateReference() is avoided.
+class ShadingRateMap
+{
+public:
+    // Initializes the map of Width x Height tiles. The data is invalid until the first update.
+    void Initialize(Uint32 Width, Uint32 Height, const ShadingRateProperties& SRProps);
+
+    // Updates the map for the normalized cursor position and returns the number of boxes
+    // in pDirtyBoxes[0..1] that must be uploaded to the texture.
+    Uint32 Update(const float2& Origin, Box pDirtyBoxes[2]);
+
+    // Computes every tile of the map separately and marks the whole map as dirty.
+    void GenerateReference(const float2& Origin, Box& DirtyBox);
+
+    Uint32 GetWidth() const { return m_Width; }
+    Uint32 GetHeight() const { return m_Height; }
+    Uint32 GetTexelSize() const { return m_TexelSize; }
+    Uint32 GetRowStride() const { return static_cast<Uint32>(m_RowStride); }
+
+    // Returns the pointer to the first texel of the box
+    const Uint8* GetData(const Box& Region) const
+    {
+        return &m_Data[Region.MinY * m_RowStride + size_t{Region.MinX} * m_TexelSize];
+    }
+
+private:
+    static AXIS_SHADING_RATE GetAxisShadingRate(Uint32 TileIdx, Uint32 NumTiles, float Origin);
+
+    void UpdateAxisRates(std::vector<Uint8>& Rates, Uint32 NumTiles, float Origin, Uint32& FirstChanged, Uint32& EndChanged) const;
+    void FillRegion(Uint32 MinX, Uint32 MaxX, Uint32 MinY, Uint32 MaxY);
+    void WriteTexel(Uint8* pTexel, Uint32 XRate, Uint32 YRate) const;
+
+    SHADING_RATE_FORMAT m_Format    = SHADING_RATE_FORMAT_UNKNOWN;
+    Uint32              m_Width     = 0;
+    Uint32              m_Height    = 0;
+    Uint32              m_TexelSize = 1;
+    size_t              m_RowStride = 0;
+    std::vector<Uint8>  m_Data;
+
+    // Axis shading rates of every column and row. Empty until the first update.
+    std::vector<Uint8> m_XRates;
+    std::vector<Uint8> m_YRates;
+
+    // Palette value of every (X rate, Y rate) combination
+    Uint8 m_PaletteRates[AXIS_SHADING_RATE_MAX + 1][AXIS_SHADING_RATE_MAX + 1] = {};
+};
+
+} // namespace Diligent
@@ -26,10 +26,11 @@
 
 #include "Tutorial24_VRS.hpp"
 
+#include <cmath>
 #include <utility>
 
-#include "Align.hpp"
 #include "MapHelper.hpp"
+#include "Timer.hpp"
 #include "TextureUtilities.h"
 #include "../../Common/src/TexturedCube.hpp"
 #include "imgui.h"
@@ -490,6 +491,14 @@ void Tutorial24_VRS::UpdateUI()
         else if (!m_ShadingRates.empty())
             ImGui::Combo("Default shading rate", &m_ShadingRate, m_ShadingRates.data(), static_cast<int>(m_ShadingRates.size()));
 
+#if !(PLATFORM_MACOS || PLATFORM_IOS)
+        if (m_VRSMode == VRS_MODE_TEXTURE_BASED)
+        {
+            ImGui::Checkbox("Incremental map update", &m_IncrementalVRSUpdate);
+            ImGui::Text("Map update: %.3f ms, %llu bytes uploaded", m_VRSUpdateTime * 1000.0, static_cast<unsigned long long>(m_VRSUploadSize));
+        }
+#endif
+
         ImGui::Checkbox("Show shading rate", &m_ShowShadingRate);
         ImGui::Checkbox("Animation", &m_Animation);
 
@@ -504,6 +513,16 @@ void Tutorial24_VRS::UpdateUI()
             const SwapChainDesc& SCDesc = m_pSwapChain->GetDesc();
             WindowResize(SCDesc.Width, SCDesc.Height);
         }
+
+        if (ImGui::Button("Run 4K map benchmark"))
+            RunShadingRateMapBenchmark();
+        if (m_SRMapBenchmark.Width != 0)
+        {
+            const ShadingRateMapBenchmark& Bench = m_SRMapBenchmark;
+            ImGui::Text("%ux%u tiles", Bench.Width, Bench.Height);
+            ImGui::Text("Reference:   %.4f ms, %.0f bytes", Bench.ReferenceTime * 1000.0, Bench.ReferenceUploadSize);
+            ImGui::Text("Incremental: %.4f ms, %.0f bytes", Bench.IncrementalTime * 1000.0, Bench.IncrementalUploadSize);
+        }
     }
     ImGui::End();
 }
@@ -573,6 +592,7 @@ void Tutorial24_VRS::WindowResize(Uint32 Width, Uint32 Height)
     RefCntAutoPtr<ITexture> pSRTex;
     m_pDevice->CreateTexture(TexDesc, nullptr, &pSRTex);
     m_pShadingRateMap = pSRTex->GetDefaultView(TEXTURE_VIEW_SHADING_RATE);
+    m_SRMap.Initialize(TexDesc.Width, TexDesc.Height, SRProps);
 
     UpdateVRSPattern(m_PrevNormMPos);
 
@@ -589,77 +609,28 @@ void Tutorial24_VRS::UpdateVRSPattern(const float2 MPos)
     m_PrevNormMPos = MPos;
 
     ITexture*                    pVRSTex = m_pShadingRateMap->GetTexture();
-    const TextureDesc&           Desc    = pVRSTex->GetDesc();
     const ShadingRateProperties& SRProps = m_pDevice->GetAdapterInfo().ShadingRate;
-    std::vector<Uint8>           SRData;
 
-    auto GetAxisShadingRate = [&](Uint32 TileIdx, Uint32 NumTiles, float Origin) {
-        float  TilePos = (static_cast<float>(TileIdx) + 0.5f) / static_cast<float>(NumTiles);
-        float  Dist    = std::abs(TilePos - Origin);
-        Uint32 Rate    = clamp(static_cast<Uint32>(Dist * (AXIS_SHADING_RATE_MAX + 1) + 0.5f), 0u, Uint32{AXIS_SHADING_RATE_MAX});
-        return static_cast<AXIS_SHADING_RATE>(Rate);
-    };
-
-    switch (SRProps.Format)
+    Timer  UpdateTimer;
+    Box    DirtyBoxes[2];
+    Uint32 NumDirtyBoxes = 0;
+    if (m_IncrementalVRSUpdate)
     {
-        case SHADING_RATE_FORMAT_PALETTE:
-        {
-            SHADING_RATE RemapShadingRate[SHADING_RATE_MAX + 1] = {};
-            for (Uint32 i = 0; i < _countof(RemapShadingRate); ++i)
-            {
-                // ShadingRates is sorted from higher to lower rate.
-                for (Uint32 j = 0; j < SRProps.NumShadingRates; ++j)
-                {
-                    if (static_cast<SHADING_RATE>(i) >= SRProps.ShadingRates[j].Rate)
-                    {
-                        RemapShadingRate[i] = SRProps.ShadingRates[j].Rate;
-                        break;
-                    }
-                }
-            }
-
-            const size_t RowStride = AlignUp(Desc.Width, 32u);
-            SRData.resize(RowStride * size_t{Desc.Height});
-
-            for (Uint32 y = 0; y < Desc.Height; ++y)
-            {
-                for (Uint32 x = 0; x < Desc.Width; ++x)
-                {
-                    AXIS_SHADING_RATE XRate = GetAxisShadingRate(x, Desc.Width, MPos.x);
-                    AXIS_SHADING_RATE YRate = GetAxisShadingRate(y, Desc.Height, MPos.y);
-
-                    SRData[size_t{x} + size_t{y} * RowStride] = RemapShadingRate[(XRate << SHADING_RATE_X_SHIFT) | YRate];
-                }
-            }
-            break;
-        }
-        case SHADING_RATE_FORMAT_UNORM8:
-        {
-            const size_t RowStride = AlignUp(Desc.Width * 2, 32u);
-            SRData.resize(RowStride * size_t{Desc.Height});
-
-            for (Uint32 y = 0; y < Desc.Height; ++y)
-            {
-                for (Uint32 x = 0; x < Desc.Width; ++x)
-                {
-                    AXIS_SHADING_RATE XRate = GetAxisShadingRate(x, Desc.Width, MPos.x);
-                    AXIS_SHADING_RATE YRate = GetAxisShadingRate(y, Desc.Height, MPos.y);
-
-                    SRData[size_t{x} * 2u + size_t{y} * RowStride + 0u] = 255 >> XRate;
-                    SRData[size_t{x} * 2u + size_t{y} * RowStride + 1u] = 255 >> YRate;
-                }
-            }
-            break;
-        }
-        default:
-            UNEXPECTED("Unexpected shading rate texture format");
+        NumDirtyBoxes = m_SRMap.Update(MPos, DirtyBoxes);
     }
+    else
+    {
+        m_SRMap.GenerateReference(MPos, DirtyBoxes[0]);
+        NumDirtyBoxes = 1;
+    }
+    m_VRSUpdateTime = UpdateTimer.GetElapsedTime();
 
-
-    const Box         TexBox{0, Desc.Width, 0, Desc.Height};
-    TextureSubResData SubResData;
-    SubResData.pData  = SRData.data();
-    SubResData.Stride = static_cast<Uint32>(SRData.size() / Desc.Height);
+    m_VRSUploadSize = 0;
+    if (NumDirtyBoxes == 0)
+    {
+        // The cursor moved within the same tiles, so no rate has changed
+        return;
+    }
 
     // If shading rate access type is not ON_GPU, access to the texture happens on the CPU
     // side during SetRenderTargetsExt() or Flush() call, so we have to wait until the texture
@@ -672,7 +643,16 @@ void Tutorial24_VRS::UpdateVRSPattern(const float2 MPos)
         m_pImmediateContext->WaitForIdle();
     }
 
-    m_pImmediateContext->UpdateTexture(pVRSTex, 0, 0, TexBox, SubResData, RESOURCE_STATE_TRANSITION_MODE_NONE, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    for (Uint32 i = 0; i < NumDirtyBoxes; ++i)
+    {
+        const Box&        DirtyBox = DirtyBoxes[i];
+        TextureSubResData SubResData;
+        SubResData.pData  = m_SRMap.GetData(DirtyBox);
+        SubResData.Stride = m_SRMap.GetRowStride();
+        m_pImmediateContext->UpdateTexture(pVRSTex, 0, 0, DirtyBox, SubResData, RESOURCE_STATE_TRANSITION_MODE_NONE, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
+        m_VRSUploadSize += Uint64{DirtyBox.MaxX - DirtyBox.MinX} * m_SRMap.GetTexelSize() * (DirtyBox.MaxY - DirtyBox.MinY);
+    }
 
     if (GPUtoCPUSyncRequired)
     {
@@ -682,4 +662,59 @@ void Tutorial24_VRS::UpdateVRSPattern(const float2 MPos)
 }
 #endif
 
+void Tutorial24_VRS::RunShadingRateMapBenchmark()
+{
+    const ShadingRateProperties& SRProps = m_pDevice->GetAdapterInfo().ShadingRate;
+
+    // Shading rate map of a 3840x2160 render target with the smallest tile size supported by the device
+    const Uint32 TileWidth  = SRProps.MinTileSize[0] != 0 ? SRProps.MinTileSize[0] : 16u;
+    const Uint32 TileHeight = SRProps.MinTileSize[1] != 0 ? SRProps.MinTileSize[1] : 16u;
+    const Uint32 Width      = (3840 + TileWidth - 1) / TileWidth;
+    const Uint32 Height     = (2160 + TileHeight - 1) / TileHeight;
+
+    // The cursor moves along a circle in small steps like when the user drags the mouse
+    constexpr Uint32 NumUpdates = 1000;
+    auto             GetCursorPos = [](Uint32 Step) {
+        const float Angle = static_cast<float>(Step) * (2.f * PI_F / NumUpdates);
+        return float2{0.5f + 0.3f * std::cos(Angle), 0.5f + 0.3f * std::sin(Angle)};
+    };
+
+    ShadingRateMap Map;
+    Map.Initialize(Width, Height, SRProps);
+
+    ShadingRateMapBenchmark Bench;
+    Bench.Width  = Width;
+    Bench.Height = Height;
+
+    Box    DirtyBoxes[2];
+    Uint64 UploadSize = 0;
+    {
+        Timer BenchTimer;
+        for (Uint32 i = 0; i < NumUpdates; ++i)
+        {
+            Map.GenerateReference(GetCursorPos(i), DirtyBoxes[0]);
+            UploadSize += Uint64{Width} * Map.GetTexelSize() * Height;
+        }
+        Bench.ReferenceTime       = BenchTimer.GetElapsedTime() / NumUpdates;
+        Bench.ReferenceUploadSize = static_cast<double>(UploadSize) / NumUpdates;
+    }
+
+    // The first update always rewrites the whole map
+    Map.Update(GetCursorPos(NumUpdates - 1), DirtyBoxes);
+    UploadSize = 0;
+    {
+        Timer BenchTimer;
+        for (Uint32 i = 0; i < NumUpdates; ++i)
+        {
+            const Uint32 NumDirtyBoxes = Map.Update(GetCursorPos(i), DirtyBoxes);
+            for (Uint32 box = 0; box < NumDirtyBoxes; ++box)
+                UploadSize += Uint64{DirtyBoxes[box].MaxX - DirtyBoxes[box].MinX} * Map.GetTexelSize() * (DirtyBoxes[box].MaxY - DirtyBoxes[box].MinY);
+        }
+        Bench.IncrementalTime       = BenchTimer.GetElapsedTime() / NumUpdates;
+        Bench.IncrementalUploadSize = static_cast<double>(UploadSize) / NumUpdates;
+    }
+
+    m_SRMapBenchmark = Bench;
+}
+
 } // namespace Diligent
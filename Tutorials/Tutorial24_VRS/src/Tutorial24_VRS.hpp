@@ -32,6 +32,7 @@
 #include "SampleBase.hpp"
 #include "BasicMath.hpp"
 #include "FirstPersonCamera.hpp"
+#include "ShadingRateMap.hpp"
 
 namespace Diligent
 {
@@ -58,6 +59,7 @@ private:
     void CreateDensityMapPipelineState(IShaderSourceInputStreamFactory* pShaderSourceFactory); // For mobile Vulkan only
     void CreateBlitPipelineState(IShaderSourceInputStreamFactory* pShaderSourceFactory);
     void UpdateVRSPattern(float2 MPos);
+    void RunShadingRateMapBenchmark();
 
     float GetSurfaceScale() const
     {
@@ -99,6 +101,7 @@ private:
     RefCntAutoPtr<ITextureView>           m_pRTV;
     RefCntAutoPtr<ITextureView>           m_pDSV;
     float2                                m_PrevNormMPos{0.5f};
+    ShadingRateMap                        m_SRMap;
     RefCntAutoPtr<IShaderResourceBinding> m_BlitSRB;
     RefCntAutoPtr<IPipelineState>         m_BlitPSO;
 
@@ -115,6 +118,23 @@ private:
     VRS_MODE     m_VRSMode     = VRS_MODE_TEXTURE_BASED;
     SHADING_RATE m_ShadingRate = SHADING_RATE_1X1;
 
+    // Update only the rows and columns of the shading rate map whose rates changed
+    bool   m_IncrementalVRSUpdate = true;
+    double m_VRSUpdateTime        = 0;
+    Uint64 m_VRSUploadSize        = 0;
+
+    // Average time and upload size of one shading rate map update for a 4K render target
+    struct ShadingRateMapBenchmark
+    {
+        Uint32 Width                 = 0;
+        Uint32 Height                = 0;
+        double ReferenceTime         = 0;
+        double IncrementalTime       = 0;
+        double ReferenceUploadSize   = 0;
+        double IncrementalUploadSize = 0;
+    };
+    ShadingRateMapBenchmark m_SRMapBenchmark;
+
     float    m_fCurrentTime = 0.f;
     float4x4 m_WorldViewProjMatrix;
 };
@@ -0,0 +1,21 @@
+#include "FullScreenTriangleVSOutput.fxh"
+
+Texture2D<float> g_TextureDepth;
+
+// Returns the farthest depth of the DOWNSAMPLE_FACTOR x DOWNSAMPLE_FACTOR block of the depth buffer
+float DownsampleDepthPS(FullScreenTriangleVSOutput VSOut) : SV_Target0
+{
+    uint2 Dimensions;
+    g_TextureDepth.GetDimensions(Dimensions.x, Dimensions.y);
+
+    int2 First = int2(VSOut.f4PixelPos.xy) * DOWNSAMPLE_FACTOR;
+    int2 Last  = min(First + DOWNSAMPLE_FACTOR, int2(Dimensions)) - 1;
+
+    float MaxDepth = 0.0;
+    for (int y = First.y; y <= Last.y; ++y)
+    {
+        for (int x = First.x; x <= Last.x; ++x)
+            MaxDepth = max(MaxDepth, g_TextureDepth.Load(int3(x, y, 0)));
+    }
+    return MaxDepth;
+}
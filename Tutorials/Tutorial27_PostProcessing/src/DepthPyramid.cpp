@@ -0,0 +1,159 @@
+/*
+ *  Copyright 2024-2025 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#include "DepthPyramid.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+#include "DebugUtilities.hpp"
+
+namespace Diligent
+{
+
+void DepthPyramid::Build(const void*     pData,
+                         size_t          Stride,
+                         Uint32          Width,
+                         Uint32          Height,
+                         Uint32          SrcWidth,
+                         Uint32          SrcHeight,
+                         const float4x4& ViewProj,
+                         bool            IsGL,
+                         Uint64          FrameId)
+{
+    VERIFY_EXPR(Width > 0 && Height > 0);
+
+    Uint32 NumLevels = 1;
+    while ((std::max(Width, Height) >> (NumLevels - 1)) > 1)
+        ++NumLevels;
+    m_Levels.resize(NumLevels);
+
+    Level& Level0 = m_Levels[0];
+    Level0.Width  = Width;
+    Level0.Height = Height;
+    Level0.Depth.resize(size_t{Width} * Height);
+    for (Uint32 y = 0; y < Height; ++y)
+        memcpy(&Level0.Depth[size_t{y} * Width], static_cast<const Uint8*>(pData) + y * Stride, Width * sizeof(float));
+
+    for (Uint32 l = 1; l < NumLevels; ++l)
+    {
+        const Level& Src = m_Levels[l - 1];
+        Level&       Dst = m_Levels[l];
+        Dst.Width        = (Src.Width + 1) / 2;
+        Dst.Height       = (Src.Height + 1) / 2;
+        Dst.Depth.resize(size_t{Dst.Width} * Dst.Height);
+        for (Uint32 y = 0; y < Dst.Height; ++y)
+        {
+            // The last row and column of an odd-sized level are taken twice
+            const Uint32 y0 = y * 2;
+            const Uint32 y1 = std::min(y0 + 1, Src.Height - 1);
+            for (Uint32 x = 0; x < Dst.Width; ++x)
+            {
+                const Uint32 x0 = x * 2;
+                const Uint32 x1 = std::min(x0 + 1, Src.Width - 1);
+
+                Dst.Depth[size_t{y} * Dst.Width + x] = std::max(std::max(Src.Get(x0, y0), Src.Get(x1, y0)),
+                                                                std::max(Src.Get(x0, y1), Src.Get(x1, y1)));
+            }
+        }
+    }
+
+    // Texel x of the first level covers the source pixels [x * DownsampleFactor, (x + 1) * DownsampleFactor)
+    m_UVToTexel = float2{static_cast<float>(SrcWidth), static_cast<float>(SrcHeight)} / static_cast<float>(DownsampleFactor);
+    m_ViewProj  = ViewProj;
+    m_IsGL      = IsGL;
+    m_FrameId   = FrameId;
+}
+
+void DepthPyramid::Reset()
+{
+    m_Levels.clear();
+    m_FrameId = 0;
+}
+
+bool DepthPyramid::IsOccluded(const BoundBox& Box) const
+{
+    if (m_Levels.empty())
+        return false;
+
+    float2 MinXY{+FLT_MAX, +FLT_MAX};
+    float2 MaxXY{-FLT_MAX, -FLT_MAX};
+    float  MinZ = +FLT_MAX;
+    for (Uint32 i = 0; i < 8; ++i)
+    {
+        const float3 Corner{
+            (i & 0x01) ? Box.Max.x : Box.Min.x,
+            (i & 0x02) ? Box.Max.y : Box.Min.y,
+            (i & 0x04) ? Box.Max.z : Box.Min.z,
+        };
+        const float4 PosPS = float4{Corner, 1.0f} * m_ViewProj;
+        // The box intersects the camera plane
+        if (PosPS.w <= FLT_EPSILON)
+            return false;
+
+        const float3 NDC = float3{PosPS.x, PosPS.y, PosPS.z} / PosPS.w;
+
+        MinXY = std::min(MinXY, float2{NDC.x, NDC.y});
+        MaxXY = std::max(MaxXY, float2{NDC.x, NDC.y});
+        MinZ  = std::min(MinZ, NDC.z);
+    }
+
+    // There is no depth for the parts of the box that were outside of the screen
+    if (MinXY.x < -1.0f || MinXY.y < -1.0f || MaxXY.x > +1.0f || MaxXY.y > +1.0f)
+        return false;
+
+    // Rows of the depth buffer go from the bottom of the screen to the top in OpenGL,
+    // and its depth range is mapped from [-1, +1] to [0, 1].
+    const float  MinU     = MinXY.x * 0.5f + 0.5f;
+    const float  MaxU     = MaxXY.x * 0.5f + 0.5f;
+    const float  MinV     = m_IsGL ? MinXY.y * 0.5f + 0.5f : 0.5f - MaxXY.y * 0.5f;
+    const float  MaxV     = m_IsGL ? MaxXY.y * 0.5f + 0.5f : 0.5f - MinXY.y * 0.5f;
+    const float  BoxDepth = m_IsGL ? MinZ * 0.5f + 0.5f : MinZ;
+    const Level& Level0   = m_Levels[0];
+
+    const Uint32 x0 = std::min(static_cast<Uint32>(MinU * m_UVToTexel.x), Level0.Width - 1);
+    const Uint32 x1 = std::min(static_cast<Uint32>(MaxU * m_UVToTexel.x), Level0.Width - 1);
+    const Uint32 y0 = std::min(static_cast<Uint32>(MinV * m_UVToTexel.y), Level0.Height - 1);
+    const Uint32 y1 = std::min(static_cast<Uint32>(MaxV * m_UVToTexel.y), Level0.Height - 1);
+
+    // Find the first level where the rectangle covers at most 4x4 texels
+    Uint32 l = 0;
+    while (l + 1 < m_Levels.size() && ((x1 >> l) - (x0 >> l) > 3 || (y1 >> l) - (y0 >> l) > 3))
+        ++l;
+
+    const Level& Lvl      = m_Levels[l];
+    float        MaxDepth = 0;
+    for (Uint32 y = y0 >> l; y <= (y1 >> l); ++y)
+    {
+        for (Uint32 x = x0 >> l; x <= (x1 >> l); ++x)
+            MaxDepth = std::max(MaxDepth, Lvl.Get(x, y));
+    }
+
+    return BoxDepth > MaxDepth;
+}
+
+} // namespace Diligent
@@ -0,0 +1,86 @@
+/*
+ *  Copyright 2024-2025 Diligent Graphics LLC
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ *  In no event and under no legal theory, whether in tort (including negligence),
+ *  contract, or otherwise, unless required by applicable law (such as deliberate
+ *  and grossly negligent acts) or agreed to in writing, shall any Contributor be
+ *  liable for any damages, including any direct, indirect, special, incidental,
+ *  or consequential damages of any character arising as a result of this License or
+ *  out of the use or inability to use the software (including but not limited to damages
+ *  for loss of goodwill, work stoppage, computer failure or malfunction, or any and
+ *  all other commercial damages or losses), even if such Contributor has been advised
+ *  of the possibility of such damages.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "BasicMath.hpp"
+#include "AdvancedMath.hpp"
+
+namespace Diligent
+{
+
+// Coarse CPU copy of the depth buffer of a previous frame that is used to cull occluded objects.
+//
+// The GPU reduces the depth buffer to the farthest depth of every DownsampleFactor x DownsampleFactor
+// block, and the result is read back a few frames later. Build() generates the remaining levels by
+// taking the farthest depth of every 2x2 texels, so that any screen rectangle may be tested against
+// at most 4x4 texels of the level where the rectangle spans no more than four texels in each direction.
+class DepthPyramid
+{
+public:
+    static constexpr Uint32 DownsampleFactor = 16;
+
+    // Builds the pyramid from the Width x Height texels of the reduced depth buffer of a SrcWidth x SrcHeight
+    // frame that was rendered with the ViewProj matrix. Stride is the size of the row of texels in bytes.
+    void Build(const void*     pData,
+               size_t          Stride,
+               Uint32          Width,
+               Uint32          Height,
+               Uint32          SrcWidth,
+               Uint32          SrcHeight,
+               const float4x4& ViewProj,
+               bool            IsGL,
+               Uint64          FrameId);
+
+    void Reset();
+
+    bool   IsValid() const { return !m_Levels.empty(); }
+    Uint64 GetFrameId() const { return m_FrameId; }
+
+    // Returns true if the world-space box is entirely behind the depth stored in the pyramid.
+    // Boxes that are partially in front of the camera or outside of the screen are never occluded.
+    bool IsOccluded(const BoundBox& Box) const;
+
+private:
+    struct Level
+    {
+        Uint32             Width  = 0;
+        Uint32             Height = 0;
+        std::vector<float> Depth;
+
+        float Get(Uint32 x, Uint32 y) const { return Depth[size_t{y} * Width + x]; }
+    };
+    std::vector<Level> m_Levels;
+
+    float4x4 m_ViewProj;
+    float2   m_UVToTexel;
+    bool     m_IsGL    = false;
+    Uint64   m_FrameId = 0;
+};
+
+} // namespace Diligent
@@ -46,6 +46,8 @@
 #include "ShaderSourceFactoryUtils.hpp"
 #include "SuperResolution.hpp"
 #include "TextureUtilities.h"
+#include "AdvancedMath.hpp"
+#include "Timer.hpp"
 #include "Utilities/interface/DiligentFXShaderSourceStreamFactory.hpp"
 #include "../../Common/src/TexturedCube.hpp"
 
@@ -203,6 +205,15 @@ void Tutorial27_PostProcessing::Initialize(const SampleInitInfo& InitInfo)
         m_Resources.Insert(RESOURCE_IDENTIFIER_OBJECT_AABB_INDEX_BUFFER, TexturedCube::CreateIndexBuffer(m_pDevice));
     }
 
+#if !PLATFORM_WEB
+    // Occlusion culling reads back the coarse depth buffer, which is not supported in the browser
+    {
+        FenceDesc Desc;
+        Desc.Name = "Tutorial27_PostProcessing::DepthReadback";
+        m_pDevice->CreateFence(Desc, &m_pDepthReadbackFence);
+    }
+#endif
+
     // Create necessary textures for IBL
     {
         LoadEnvironmentMap("textures/papermill.ktx");
@@ -247,11 +258,15 @@ void Tutorial27_PostProcessing::Render()
     }
 
     m_pImmediateContext->UpdateBuffer(m_Resources[RESOURCE_IDENTIFIER_PBR_ATTRIBS_CONSTANT_BUFFER].AsBuffer(), 0, sizeof(HLSL::PBRRendererShaderParameters), &m_ShaderSettings->PBRRenderParams, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    m_pImmediateContext->UpdateBuffer(m_Resources[RESOURCE_IDENTIFIER_OBJECT_ATTRIBS_CONSTANT_BUFFER].AsBuffer(), 0, sizeof(HLSL::ObjectAttribs) * m_MaxObjectCount, m_ObjectAttribs.get(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
     m_pImmediateContext->UpdateBuffer(m_Resources[RESOURCE_IDENTIFIER_MATERIAL_ATTRIBS_CONSTANT_BUFFER].AsBuffer(), 0, sizeof(HLSL::MaterialAttribs) * m_MaxMaterialCount, m_MaterialAttribs.get(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
+    // Only the attributes of the objects that passed culling are uploaded
+    if (m_VisibleObjectCount > 0)
+        m_pImmediateContext->UpdateBuffer(m_Resources[RESOURCE_IDENTIFIER_OBJECT_ATTRIBS_CONSTANT_BUFFER].AsBuffer(), 0, sizeof(HLSL::ObjectAttribs) * m_VisibleObjectCount, m_ObjectAttribs.get(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+
     PrepareResources();
     GenerateGeometry();
+    ComputeDepthPyramid();
     ComputePostFX();
     ComputeSSR();
     ComputeSSAO();
@@ -398,6 +413,8 @@ void Tutorial27_PostProcessing::Update(double CurrTime, double ElapsedTime, bool
             m_AnimationTime += static_cast<float>(ElapsedTime);
     }
 
+    CullObjects(CurrCamAttribs.mViewProj);
+
     auto SetupUpsamplingSettings = [](HLSL::SuperResolutionAttribs& Attribs, const PostFXContext::FrameDesc& FrameDesc) {
         Attribs.OutputSize.x = static_cast<float>(FrameDesc.OutputWidth);
         Attribs.OutputSize.y = static_cast<float>(FrameDesc.OutputHeight);
@@ -413,6 +430,79 @@ void Tutorial27_PostProcessing::Update(double CurrTime, double ElapsedTime, bool
     SetupUpsamplingSettings(m_ShaderSettings->FSRSettings, m_PostFXFrameDesc);
 }
 
+void Tutorial27_PostProcessing::CullObjects(const float4x4& ViewProj)
+{
+    Timer CullTimer;
+
+    ReadBackDepthPyramid();
+
+    ViewFrustumExt Frustum;
+    ExtractViewFrustumPlanesFromMatrix(ViewProj, Frustum, m_pDevice->GetDeviceInfo().IsGLDevice());
+
+    const Uint32 CurrFrameIdx = (m_CurrentFrameNumber + 0x0) & 0x1;
+    const Uint64 CurrFrameId  = Uint64{m_CurrentFrameNumber} + 1;
+
+    m_CullingStats       = {};
+    m_VisibleObjectCount = 0;
+    for (Uint32 ObjectIdx = 0; ObjectIdx < m_ObjectCount; ObjectIdx++)
+    {
+        // Every object is ray traced inside of the [-1, +1] cube that is rasterized for it
+        const BoundBox ObjectBB = BoundBox{float3{-1.0f, -1.0f, -1.0f}, float3{+1.0f, +1.0f, +1.0f}}.Transform(m_ObjectTransforms[CurrFrameIdx][ObjectIdx]);
+
+        if (m_FrustumCulling && GetBoxVisibility(Frustum, ObjectBB, FRUSTUM_PLANE_FLAG_FULL_FRUSTUM) == BoxVisibility::Invisible)
+        {
+            ++m_CullingStats.NumFrustumCulled;
+            continue;
+        }
+
+        if (m_OcclusionCulling && m_DepthPyramid.IsOccluded(ObjectBB))
+        {
+            ++m_CullingStats.NumOcclusionCulled;
+            continue;
+        }
+
+        if (m_VisibleObjectCount != ObjectIdx)
+            m_ObjectAttribs[m_VisibleObjectCount] = m_ObjectAttribs[ObjectIdx];
+        ++m_VisibleObjectCount;
+    }
+
+    if (m_DepthPyramid.IsValid())
+        m_CullingStats.DepthPyramidAge = static_cast<Uint32>(CurrFrameId - m_DepthPyramid.GetFrameId());
+    m_CullingStats.CullTime = CullTimer.GetElapsedTime();
+}
+
+void Tutorial27_PostProcessing::ReadBackDepthPyramid()
+{
+    if (!m_OcclusionCulling || !m_pDepthReadbackFence)
+    {
+        m_DepthPyramid.Reset();
+        return;
+    }
+
+    // Frame IDs are used as fence values, and 0 can't be signaled
+    const Uint64 CurrFrameId      = Uint64{m_CurrentFrameNumber} + 1;
+    const Uint64 CompletedFrameId = m_pDepthReadbackFence->GetCompletedValue();
+
+    // Depth of the frames that are older than the readback latency is discarded. This also
+    // happens when occlusion culling is enabled again after it has been disabled for a while.
+    if (CompletedFrameId <= m_DepthPyramid.GetFrameId() || CompletedFrameId + m_DepthReadbackLatency < CurrFrameId)
+        return;
+
+    const DepthReadbackSlot& Slot = m_DepthReadback[CompletedFrameId % m_DepthReadbackLatency];
+    if (Slot.FrameId != CompletedFrameId)
+        return;
+
+    MappedTextureSubresource MappedData;
+    m_pImmediateContext->MapTextureSubresource(Slot.pStagingTex, 0, 0, MAP_READ, MAP_FLAG_DO_NOT_WAIT, nullptr, MappedData);
+    if (MappedData.pData == nullptr)
+        return;
+
+    const TextureDesc& Desc = Slot.pStagingTex->GetDesc();
+    m_DepthPyramid.Build(MappedData.pData, static_cast<size_t>(MappedData.Stride), Desc.Width, Desc.Height,
+                         Slot.SrcWidth, Slot.SrcHeight, Slot.ViewProj, m_pDevice->GetDeviceInfo().IsGLDevice(), CompletedFrameId);
+    m_pImmediateContext->UnmapTextureSubresource(Slot.pStagingTex, 0, 0);
+}
+
 void Tutorial27_PostProcessing::WindowResize(Uint32 Width, Uint32 Height)
 {
     SampleBase::WindowResize(Width, Height);
@@ -514,8 +604,8 @@ void Tutorial27_PostProcessing::GenerateGeometry()
         ShaderMacroHelper Macros;
         Macros.Add("MAX_MATERIAL_COUNT", m_MaxMaterialCount);
 
-        RefCntAutoPtr<IShader> VS = CreateShader(m_pDevice, nullptr, "GenerateGeometry.vsh", "GenerateGeometryVS", SHADER_TYPE_VERTEX);
-        RefCntAutoPtr<IShader> PS = CreateShader(m_pDevice, nullptr, "GenerateGeometry.psh", "GenerateGeometryPS", SHADER_TYPE_PIXEL, Macros);
+        RefCntAutoPtr<IShader> VS = CreateShader(m_pDevice, m_pRenderStateCache, "GenerateGeometry.vsh", "GenerateGeometryVS", SHADER_TYPE_VERTEX);
+        RefCntAutoPtr<IShader> PS = CreateShader(m_pDevice, m_pRenderStateCache, "GenerateGeometry.psh", "GenerateGeometryPS", SHADER_TYPE_PIXEL, Macros);
 
         PipelineResourceLayoutDescX ResourceLayout;
         ResourceLayout
@@ -543,7 +633,7 @@ void Tutorial27_PostProcessing::GenerateGeometry()
             .SetPrimitiveTopology(PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
             .SetRasterizerDesc(RS_SolidFillCullFront);
 
-        RenderTech.PSO = RenderDeviceWithCache<false>{m_pDevice, nullptr}.CreateGraphicsPipelineState(PipelineCI);
+        RenderTech.PSO = GetRenderDeviceWithCache().CreateGraphicsPipelineState(PipelineCI);
         ShaderResourceVariableX{RenderTech.PSO, SHADER_TYPE_PIXEL, "cbCameraAttribs"}.Set(m_Resources[RESOURCE_IDENTIFIER_CAMERA_CONSTANT_BUFFER].AsBuffer());
         ShaderResourceVariableX{RenderTech.PSO, SHADER_TYPE_PIXEL, "cbObjectMaterial"}.Set(m_Resources[RESOURCE_IDENTIFIER_MATERIAL_ATTRIBS_CONSTANT_BUFFER].AsBuffer());
         RenderTech.InitializeSRB(true);
@@ -569,7 +659,8 @@ void Tutorial27_PostProcessing::GenerateGeometry()
     m_pImmediateContext->SetVertexBuffers(0, 1, pBuffers, Offsets, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
     m_pImmediateContext->SetIndexBuffer(m_Resources[RESOURCE_IDENTIFIER_OBJECT_AABB_INDEX_BUFFER].AsBuffer(), 0, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-    for (Uint32 ObjectIdx = 0; ObjectIdx < m_ObjectCount; ObjectIdx++)
+    // Objects that passed culling are at the beginning of the object attributes buffer
+    for (Uint32 ObjectIdx = 0; ObjectIdx < m_VisibleObjectCount; ObjectIdx++)
     {
         ObjectAttribVariable.SetBufferRange(m_Resources[RESOURCE_IDENTIFIER_OBJECT_ATTRIBS_CONSTANT_BUFFER].AsBuffer(), ObjectIdx * sizeof(HLSL::ObjectAttribs), sizeof(HLSL::ObjectAttribs));
         m_pImmediateContext->CommitShaderResources(RenderTech.SRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
@@ -578,6 +669,88 @@ void Tutorial27_PostProcessing::GenerateGeometry()
     m_pImmediateContext->SetRenderTargets(0, nullptr, nullptr, RESOURCE_STATE_TRANSITION_MODE_NONE);
 }
 
+void Tutorial27_PostProcessing::ComputeDepthPyramid()
+{
+    if (!m_OcclusionCulling || !m_pDepthReadbackFence)
+        return;
+
+    const Uint32 CurrFrameIdx = (m_CurrentFrameNumber + 0x0) & 0x1;
+    const Uint64 CurrFrameId  = Uint64{m_CurrentFrameNumber} + 1;
+    const Uint32 Width        = (m_PostFXFrameDesc.Width + DepthPyramid::DownsampleFactor - 1) / DepthPyramid::DownsampleFactor;
+    const Uint32 Height       = (m_PostFXFrameDesc.Height + DepthPyramid::DownsampleFactor - 1) / DepthPyramid::DownsampleFactor;
+
+    RenderDeviceX_N Device{m_pDevice};
+
+    TextureDesc Desc;
+    Desc.Name      = "Tutorial27_PostProcessing::CoarseDepth";
+    Desc.Type      = RESOURCE_DIM_TEX_2D;
+    Desc.Width     = Width;
+    Desc.Height    = Height;
+    Desc.Format    = TEX_FORMAT_R32_FLOAT;
+    Desc.BindFlags = BIND_RENDER_TARGET;
+    if (!m_Resources[RESOURCE_IDENTIFIER_COARSE_DEPTH] ||
+        Width != m_Resources[RESOURCE_IDENTIFIER_COARSE_DEPTH].AsTexture()->GetDesc().Width ||
+        Height != m_Resources[RESOURCE_IDENTIFIER_COARSE_DEPTH].AsTexture()->GetDesc().Height)
+    {
+        m_Resources.Insert(RESOURCE_IDENTIFIER_COARSE_DEPTH, Device.CreateTexture(Desc));
+    }
+
+    DepthReadbackSlot& Slot = m_DepthReadback[CurrFrameId % m_DepthReadbackLatency];
+    if (!Slot.pStagingTex ||
+        Width != Slot.pStagingTex->GetDesc().Width ||
+        Height != Slot.pStagingTex->GetDesc().Height)
+    {
+        Desc.Name           = "Tutorial27_PostProcessing::CoarseDepthStaging";
+        Desc.Usage          = USAGE_STAGING;
+        Desc.BindFlags      = BIND_NONE;
+        Desc.CPUAccessFlags = CPU_ACCESS_READ;
+        Slot.pStagingTex    = Device.CreateTexture(Desc);
+    }
+
+    RenderTechnique& RenderTech = m_RenderTech[RENDER_TECH_DOWNSAMPLE_DEPTH];
+    if (!RenderTech.IsInitializedPSO())
+    {
+        ShaderMacroHelper Macros;
+        Macros.Add("DOWNSAMPLE_FACTOR", DepthPyramid::DownsampleFactor);
+
+        RefCntAutoPtr<IShader> VS = CreateShader(m_pDevice, m_pRenderStateCache, "FullScreenTriangleVS.fx", "FullScreenTriangleVS", SHADER_TYPE_VERTEX);
+        RefCntAutoPtr<IShader> PS = CreateShader(m_pDevice, m_pRenderStateCache, "DownsampleDepth.fx", "DownsampleDepthPS", SHADER_TYPE_PIXEL, Macros);
+
+        PipelineResourceLayoutDescX ResourceLayout;
+        ResourceLayout.AddVariable(SHADER_TYPE_PIXEL, "g_TextureDepth", SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC);
+
+        RenderTech.InitializePSO(m_pDevice,
+                                 m_pRenderStateCache, "Tutorial27_PostProcessing::DownsampleDepth",
+                                 VS, PS, ResourceLayout,
+                                 {TEX_FORMAT_R32_FLOAT},
+                                 TEX_FORMAT_UNKNOWN,
+                                 DSS_DisableDepth, BS_Default, false);
+        RenderTech.InitializeSRB(false);
+    }
+
+    ShaderResourceVariableX{RenderTech.SRB, SHADER_TYPE_PIXEL, "g_TextureDepth"}.Set(m_Resources[RESOURCE_IDENTIFIER_DEPTH0 + CurrFrameIdx].GetTextureSRV());
+
+    ScopedDebugGroup DebugGroup{m_pImmediateContext, "ComputeDepthPyramid"};
+
+    ITextureView* pRTV = m_Resources[RESOURCE_IDENTIFIER_COARSE_DEPTH].GetTextureRTV();
+    m_pImmediateContext->SetRenderTargets(1, &pRTV, nullptr, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->SetPipelineState(RenderTech.PSO);
+    m_pImmediateContext->CommitShaderResources(RenderTech.SRB, RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    m_pImmediateContext->Draw({3, DRAW_FLAG_VERIFY_ALL});
+    m_pImmediateContext->SetRenderTargets(0, nullptr, nullptr, RESOURCE_STATE_TRANSITION_MODE_NONE);
+
+    // The remaining levels of the pyramid are built on the CPU once the copy is complete
+    CopyTextureAttribs CopyAttribs{m_Resources[RESOURCE_IDENTIFIER_COARSE_DEPTH].AsTexture(), RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+                                   Slot.pStagingTex, RESOURCE_STATE_TRANSITION_MODE_TRANSITION};
+    m_pImmediateContext->CopyTexture(CopyAttribs);
+    m_pImmediateContext->EnqueueSignal(m_pDepthReadbackFence, CurrFrameId);
+
+    Slot.ViewProj  = m_CameraAttribs[CurrFrameIdx].mViewProj;
+    Slot.SrcWidth  = m_PostFXFrameDesc.Width;
+    Slot.SrcHeight = m_PostFXFrameDesc.Height;
+    Slot.FrameId   = CurrFrameId;
+}
+
 void Tutorial27_PostProcessing::ComputePostFX()
 {
     const Uint32 CurrFrameIdx = (m_CurrentFrameNumber + 0x0) & 0x1;
@@ -586,6 +759,7 @@ void Tutorial27_PostProcessing::ComputePostFX()
     {
         PostFXContext::RenderAttributes PostFXAttibs;
         PostFXAttibs.pDevice             = m_pDevice;
+        PostFXAttibs.pStateCache         = m_pRenderStateCache;
         PostFXAttibs.pDeviceContext      = m_pImmediateContext;
         PostFXAttibs.pCameraAttribsCB    = m_Resources[RESOURCE_IDENTIFIER_CAMERA_CONSTANT_BUFFER].AsBuffer();
         PostFXAttibs.pCurrDepthBufferSRV = m_Resources[RESOURCE_IDENTIFIER_DEPTH0 + CurrFrameIdx].GetTextureSRV();
@@ -604,6 +778,7 @@ void Tutorial27_PostProcessing::ComputeSSR()
 
         ScreenSpaceReflection::RenderAttributes SSRRenderAttribs{};
         SSRRenderAttribs.pDevice            = m_pDevice;
+        SSRRenderAttribs.pStateCache        = m_pRenderStateCache;
         SSRRenderAttribs.pDeviceContext     = m_pImmediateContext;
         SSRRenderAttribs.pPostFXContext     = m_PostFXContext.get();
         SSRRenderAttribs.pColorBufferSRV    = m_ShaderSettings->TAAEnabled ? m_TemporalAntiAliasing->GetAccumulatedFrameSRV(true) : m_Resources[RESOURCE_IDENTIFIER_RADIANCE0 + PrevFrameIdx].GetTextureSRV();
@@ -624,6 +799,7 @@ void Tutorial27_PostProcessing::ComputeSSAO()
 
         ScreenSpaceAmbientOcclusion::RenderAttributes SSAORenderAttribs{};
         SSAORenderAttribs.pDevice          = m_pDevice;
+        SSAORenderAttribs.pStateCache      = m_pRenderStateCache;
         SSAORenderAttribs.pDeviceContext   = m_pImmediateContext;
         SSAORenderAttribs.pPostFXContext   = m_PostFXContext.get();
         SSAORenderAttribs.pDepthBufferSRV  = m_Resources[RESOURCE_IDENTIFIER_DEPTH0 + CurrFrameIdx].GetTextureSRV();
@@ -638,8 +814,8 @@ void Tutorial27_PostProcessing::ComputeLighting()
     RenderTechnique& RenderTech = m_RenderTech[RENDER_TECH_COMPUTE_LIGHTING];
     if (!RenderTech.IsInitializedPSO())
     {
-        RefCntAutoPtr<IShader> VS = CreateShader(m_pDevice, nullptr, "FullScreenTriangleVS.fx", "FullScreenTriangleVS", SHADER_TYPE_VERTEX);
-        RefCntAutoPtr<IShader> PS = CreateShader(m_pDevice, nullptr, "ComputeLighting.fx", "ComputeLightingPS", SHADER_TYPE_PIXEL);
+        RefCntAutoPtr<IShader> VS = CreateShader(m_pDevice, m_pRenderStateCache, "FullScreenTriangleVS.fx", "FullScreenTriangleVS", SHADER_TYPE_VERTEX);
+        RefCntAutoPtr<IShader> PS = CreateShader(m_pDevice, m_pRenderStateCache, "ComputeLighting.fx", "ComputeLightingPS", SHADER_TYPE_PIXEL);
 
         PipelineResourceLayoutDescX ResourceLayout;
         ResourceLayout
@@ -663,7 +839,7 @@ void Tutorial27_PostProcessing::ComputeLighting()
             .AddImmutableSampler(SHADER_TYPE_PIXEL, "g_TextureBRDFIntegrationMap", Sam_LinearClamp);
 
         RenderTech.InitializePSO(m_pDevice,
-                                 nullptr, "Tutorial27_PostProcessing::ComputeLighting",
+                                 m_pRenderStateCache, "Tutorial27_PostProcessing::ComputeLighting",
                                  VS, PS, ResourceLayout,
                                  {
                                      m_Resources[RESOURCE_IDENTIFIER_RADIANCE0].AsTexture()->GetDesc().Format,
@@ -711,6 +887,7 @@ void Tutorial27_PostProcessing::ComputeTAA()
 
         TemporalAntiAliasing::RenderAttributes TAARenderAttribs{};
         TAARenderAttribs.pDevice         = m_pDevice;
+        TAARenderAttribs.pStateCache     = m_pRenderStateCache;
         TAARenderAttribs.pDeviceContext  = m_pImmediateContext;
         TAARenderAttribs.pPostFXContext  = m_PostFXContext.get();
         TAARenderAttribs.pColorBufferSRV = m_Resources[RESOURCE_IDENTIFIER_RADIANCE0 + CurrFrameIdx].GetTextureSRV();
@@ -727,6 +904,7 @@ void Tutorial27_PostProcessing::ComputeBloom()
 
         Bloom::RenderAttributes BloomRenderAttribs{};
         BloomRenderAttribs.pDevice         = m_pDevice;
+        BloomRenderAttribs.pStateCache     = m_pRenderStateCache;
         BloomRenderAttribs.pDeviceContext  = m_pImmediateContext;
         BloomRenderAttribs.pPostFXContext  = m_PostFXContext.get();
         BloomRenderAttribs.pColorBufferSRV = m_ShaderSettings->TAAEnabled ? m_TemporalAntiAliasing->GetAccumulatedFrameSRV() : m_Resources[RESOURCE_IDENTIFIER_RADIANCE0 + CurrFrameIdx].GetTextureSRV();
@@ -743,8 +921,8 @@ void Tutorial27_PostProcessing::ComputeToneMapping()
         ShaderMacroHelper Macros;
         Macros.Add("TONE_MAPPING_MODE", TONE_MAPPING_MODE_UNCHARTED2);
 
-        RefCntAutoPtr<IShader> VS = CreateShader(m_pDevice, nullptr, "FullScreenTriangleVS.fx", "FullScreenTriangleVS", SHADER_TYPE_VERTEX);
-        RefCntAutoPtr<IShader> PS = CreateShader(m_pDevice, nullptr, "ApplyToneMap.fx", "ApplyToneMapPS", SHADER_TYPE_PIXEL, Macros);
+        RefCntAutoPtr<IShader> VS = CreateShader(m_pDevice, m_pRenderStateCache, "FullScreenTriangleVS.fx", "FullScreenTriangleVS", SHADER_TYPE_VERTEX);
+        RefCntAutoPtr<IShader> PS = CreateShader(m_pDevice, m_pRenderStateCache, "ApplyToneMap.fx", "ApplyToneMapPS", SHADER_TYPE_PIXEL, Macros);
 
         PipelineResourceLayoutDescX ResourceLayout;
         ResourceLayout
@@ -752,7 +930,7 @@ void Tutorial27_PostProcessing::ComputeToneMapping()
             .AddVariable(SHADER_TYPE_PIXEL, "g_TextureHDR", SHADER_RESOURCE_VARIABLE_TYPE_DYNAMIC);
 
         RenderTech.InitializePSO(m_pDevice,
-                                 nullptr, "Tutorial27_PostProcessing::ComputeToneMapping",
+                                 m_pRenderStateCache, "Tutorial27_PostProcessing::ComputeToneMapping",
                                  VS, PS, ResourceLayout,
                                  {m_Resources[RESOURCE_IDENTIFIER_TONE_MAPPING].AsTexture()->GetDesc().Format},
                                  TEX_FORMAT_UNKNOWN,
@@ -790,6 +968,7 @@ void Tutorial27_PostProcessing::ComputeFSR()
     {
         SuperResolution::RenderAttributes FSRRenderAttribs{};
         FSRRenderAttribs.pDevice         = m_pDevice;
+        FSRRenderAttribs.pStateCache     = m_pRenderStateCache;
         FSRRenderAttribs.pDeviceContext  = m_pImmediateContext;
         FSRRenderAttribs.pPostFXContext  = m_PostFXContext.get();
         FSRRenderAttribs.pFSRAttribs     = &m_ShaderSettings->FSRSettings;
@@ -811,8 +990,8 @@ void Tutorial27_PostProcessing::ComputeGammaCorrection()
         RenderTechnique& RenderTech = m_RenderTech[RENDER_TECH_COMPUTE_GAMMA_CORRECTION];
         if (!RenderTech.IsInitializedPSO())
         {
-            RefCntAutoPtr<IShader> VS = CreateShader(m_pDevice, nullptr, "FullScreenTriangleVS.fx", "FullScreenTriangleVS", SHADER_TYPE_VERTEX);
-            RefCntAutoPtr<IShader> PS = CreateShader(m_pDevice, nullptr, "GammaCorrection.fx", "GammaCorrectionPS", SHADER_TYPE_PIXEL);
+            RefCntAutoPtr<IShader> VS = CreateShader(m_pDevice, m_pRenderStateCache, "FullScreenTriangleVS.fx", "FullScreenTriangleVS", SHADER_TYPE_VERTEX);
+            RefCntAutoPtr<IShader> PS = CreateShader(m_pDevice, m_pRenderStateCache, "GammaCorrection.fx", "GammaCorrectionPS", SHADER_TYPE_PIXEL);
 
             PipelineResourceLayoutDescX ResourceLayout;
             ResourceLayout
@@ -820,7 +999,7 @@ void Tutorial27_PostProcessing::ComputeGammaCorrection()
                 .AddImmutableSampler(SHADER_TYPE_PIXEL, "g_TextureColor", Sam_LinearClamp);
 
             RenderTech.InitializePSO(m_pDevice,
-                                     nullptr, "Tutorial27_PostProcessing::GammaCorrection",
+                                     m_pRenderStateCache, "Tutorial27_PostProcessing::GammaCorrection",
                                      VS, PS, ResourceLayout,
                                      {pRTV->GetDesc().Format},
                                      TEX_FORMAT_UNKNOWN,
@@ -877,6 +1056,27 @@ void Tutorial27_PostProcessing::UpdateUI()
             ImGui::TreePop();
         }
 
+        if (ImGui::TreeNode("Culling"))
+        {
+            ImGui::Checkbox("Frustum culling", &m_FrustumCulling);
+            {
+                ImGui::ScopedDisabler Disabler{!m_pDepthReadbackFence};
+                ImGui::Checkbox("Occlusion culling", &m_OcclusionCulling);
+            }
+            ImGui::Text("Visible objects: %u / %u", m_VisibleObjectCount, m_ObjectCount);
+            ImGui::Text("Frustum culled: %u", m_CullingStats.NumFrustumCulled);
+            ImGui::Text("Occlusion culled: %u", m_CullingStats.NumOcclusionCulled);
+            if (m_OcclusionCulling)
+            {
+                if (m_DepthPyramid.IsValid())
+                    ImGui::Text("Depth pyramid age: %u frames", m_CullingStats.DepthPyramidAge);
+                else
+                    ImGui::TextDisabled("Depth pyramid is not available");
+            }
+            ImGui::Text("Culling time: %.3f ms", m_CullingStats.CullTime * 1000.0);
+            ImGui::TreePop();
+        }
+
         ImGui::SetNextItemOpen(true, ImGuiCond_FirstUseEver);
         if (ImGui::TreeNode("Post Processing"))
         {
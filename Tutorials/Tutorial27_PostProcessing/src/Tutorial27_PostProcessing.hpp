@@ -35,6 +35,7 @@
 #include "ResourceRegistry.hpp"
 #include "PBR_Renderer.hpp"
 #include "PostFXContext.hpp"
+#include "DepthPyramid.hpp"
 
 namespace Diligent
 {
@@ -76,8 +77,11 @@ protected:
     virtual void ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Attribs) override final;
 
 private:
+    void CullObjects(const float4x4& ViewProj);
+    void ReadBackDepthPyramid();
     void PrepareResources();
     void GenerateGeometry();
+    void ComputeDepthPyramid();
     void ComputePostFX();
     void ComputeSSR();
     void ComputeSSAO();
@@ -97,6 +101,7 @@ private:
     enum RENDER_TECH : Uint32
     {
         RENDER_TECH_GENERATE_GEOMETRY = 0,
+        RENDER_TECH_DOWNSAMPLE_DEPTH,
         RENDER_TECH_COMPUTE_MOTION_VECTORS,
         RENDER_TECH_COMPUTE_LIGHTING,
         RENDER_TECH_COMPUTE_TONE_MAPPING,
@@ -116,6 +121,7 @@ private:
         RESOURCE_IDENTIFIER_RADIANCE1,
         RESOURCE_IDENTIFIER_DEPTH0,
         RESOURCE_IDENTIFIER_DEPTH1,
+        RESOURCE_IDENTIFIER_COARSE_DEPTH,
         RESOURCE_IDENTIFIER_ENVIRONMENT_MAP,
         RESOURCE_IDENTIFIER_PREFILTERED_ENVIRONMENT_MAP,
         RESOURCE_IDENTIFIER_IRRADIANCE_MAP,
@@ -149,6 +155,36 @@ private:
     Uint32 m_ObjectCount       = 0;
     Uint32 m_MaterialCount     = 0;
 
+    // Attributes of the objects that passed culling are moved to the beginning of m_ObjectAttribs,
+    // and the G-buffer pass only draws these objects.
+    Uint32 m_VisibleObjectCount = 0;
+    bool   m_FrustumCulling     = true;
+    bool   m_OcclusionCulling   = false;
+
+    struct CullingStatistics
+    {
+        Uint32 NumFrustumCulled   = 0;
+        Uint32 NumOcclusionCulled = 0;
+        Uint32 DepthPyramidAge    = 0;
+        double CullTime           = 0;
+    };
+    CullingStatistics m_CullingStats;
+
+    // The coarse depth of the frame is copied to one of the staging textures and read back
+    // when the fence reports that the copy has completed, so the CPU never waits for the GPU.
+    static constexpr Uint32 m_DepthReadbackLatency = 3;
+    struct DepthReadbackSlot
+    {
+        RefCntAutoPtr<ITexture> pStagingTex;
+        float4x4                ViewProj;
+        Uint32                  SrcWidth  = 0;
+        Uint32                  SrcHeight = 0;
+        Uint64                  FrameId   = 0;
+    };
+    std::array<DepthReadbackSlot, m_DepthReadbackLatency> m_DepthReadback;
+    RefCntAutoPtr<IFence>                                 m_pDepthReadbackFence;
+    DepthPyramid                                          m_DepthPyramid;
+
     static constexpr Uint32 m_MaxObjectCount   = 32;
     static constexpr Uint32 m_MaxMaterialCount = 24;
 
@@ -39,6 +39,9 @@
 namespace Diligent
 {
 
+namespace
+{
+
 namespace HLSL
 {
 #include "../assets/common.fxh"
@@ -51,6 +54,8 @@ struct InstanceData
 
 } // namespace HLSL
 
+} // namespace
+
 SampleBase* CreateSample()
 {
     return new Tutorial29_OIT();
@@ -156,7 +161,7 @@ void Tutorial29_OIT::ModifyEngineInitInfo(const ModifyEngineInitInfoAttribs& Att
 
 void Tutorial29_OIT::CreatePipelineStates()
 {
-    RenderDeviceX_N Device{m_pDevice};
+    RenderDeviceWithCache_N Device = GetRenderDeviceWithCache();
     // WebGPU does not support earlydepthstencil attribute
     m_EarlyDepthStencilSupported = !Device.GetDeviceInfo().IsWebGPUDevice();
 